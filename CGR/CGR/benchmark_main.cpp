@@ -0,0 +1,185 @@
+#include "src\Application.h"
+
+#include "src\SponzaScene.h"
+#include "src\OrthoScene.h"
+#include "src\IndoorLevelScene.h"
+#include "src\OutdoorScene.h"
+#include "src\SpaceScene.h"
+#include "src\VivaScene.h"
+#include "src\StressScene.h"
+#include "src\SceneBenchmark.h"
+#include "src\CullBenchmark.h"
+#include "src\Lights.h"
+#include "src\utils.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+/*
+	Runs every scene, or the ones named, on the null render device with no window and writes the timings out as JSON.
+	Run from the same directory as the engine so the resource paths resolve.
+
+	CGRBenchmark [--frames N] [--warmup N] [--dt seconds] [--width W] [--height H] [--out file] [--stress-<setting> value ...] [scene ...]
+	CGRBenchmark --checks
+
+	--checks runs the CPU culling stages against their brute force references instead of any scene and fails on a mismatch.
+
+	The stress scene only runs when it's named, its counts come from ../stress.ini and then the --stress- arguments.
+*/
+
+static std::atomic<uint64> s_Allocations(0);
+
+void* operator new(size_t size)
+{
+	s_Allocations.fetch_add(1, std::memory_order_relaxed);
+
+	void* p = malloc(size > 0 ? size : 1);
+	if (!p)
+		throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+static uint64 allocationCount()
+{
+	return s_Allocations.load(std::memory_order_relaxed);
+}
+
+template<typename T>
+static bool addScene(Application* app, const char* name)
+{
+	return app->AddScene<T>(new T(name)) == GE_OK;
+}
+
+// Each stage checks itself against a reference as it's timed, results go to the log
+static int runChecks()
+{
+	int failed = 0;
+
+	CullBenchmarkResult cull;
+	if (!RunCullBenchmark(100000, 10, cull))
+	{
+		std::cout << "frustum cull: batch masks differ from the scalar path" << std::endl;
+		++failed;
+	}
+
+	OcclusionBenchmarkResult occlusion;
+	if (!RunOcclusionBenchmark(100000, 10, occlusion))
+	{
+		std::cout << "occlusion cull: hid an object in front of the occluders" << std::endl;
+		++failed;
+	}
+
+	// Light binning as the light count grows, up to the buffer capacity
+	for (size_t lights = 64; lights <= MAX_POINTS; lights *= 4)
+	{
+		LightClusterBenchmarkResult clusters;
+		if (!RunLightClusterBenchmark(lights, lights / 4, 10, clusters))
+		{
+			std::cout << "light clusters: missed a light with " << lights << " points" << std::endl;
+			++failed;
+		}
+	}
+
+	std::cout << "checks: " << (failed == 0 ? "passed" : util::to_str(failed) + " failed") << std::endl;
+	return failed == 0 ? 0 : -1;
+}
+
+int main(int argc, char** argv)
+{
+	SceneBenchmarkSettings settings = { 300, 30, 1.0f / 60.0f, allocationCount };
+	int width = 1280;
+	int height = 720;
+	std::string out = "../resources/log/benchmark.json";
+	std::vector<std::string> scenes;
+	bool checks = false;
+
+	StressSceneSettings stress = DefaultStressSettings();
+	LoadStressSettings("../stress.ini", stress);
+	ParseStressArgs(argc, argv, stress);
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool hasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--frames") == 0 && hasValue)
+			settings.frames = (uint32)util::str_to_int(argv[++i]);
+		else if (strcmp(argv[i], "--warmup") == 0 && hasValue)
+			settings.warmupFrames = (uint32)util::str_to_int(argv[++i]);
+		else if (strcmp(argv[i], "--dt") == 0 && hasValue)
+			settings.deltaTime = util::str_to_float(argv[++i]);
+		else if (strcmp(argv[i], "--width") == 0 && hasValue)
+			width = util::str_to_int(argv[++i]);
+		else if (strcmp(argv[i], "--height") == 0 && hasValue)
+			height = util::str_to_int(argv[++i]);
+		else if (strcmp(argv[i], "--out") == 0 && hasValue)
+			out = argv[++i];
+		else if (strcmp(argv[i], "--checks") == 0)
+			checks = true;
+		else if (strncmp(argv[i], "--stress-", 9) == 0 && hasValue)
+			++i;
+		else
+			scenes.push_back(argv[i]);
+	}
+
+	if (scenes.empty())
+	{
+		const char* all[] = { "indoor", "outdoor", "sponza", "ortho", "space", "viva" };
+		scenes.assign(all, all + ARRAY_SIZE_IN_ELEMENTS(all));
+	}
+
+	Application* app = new Application();
+
+	// Nothing here needs a device, the application is only made for the log
+	if (checks)
+	{
+		const int result = runChecks();
+		SAFE_CLOSE(app);
+		return result;
+	}
+
+	if (!app->InitHeadless(width, height) ||
+		!addScene<IndoorLevelScene>(app, "indoor") ||
+		!addScene<OutDoorScene>(app, "outdoor") ||
+		!addScene<SponzaScene>(app, "sponza") ||
+		!addScene<OrthoScene>(app, "ortho") ||
+		!addScene<SpaceScene>(app, "space") ||
+		!addScene<VivaScene>(app, "viva") ||
+		app->AddScene<StressScene>(new StressScene("stress", stress)) != GE_OK)
+	{
+		std::cout << "Benchmark failed to start, see the log" << std::endl;
+		SAFE_CLOSE(app);
+		return -1;
+	}
+
+	// A scene that fails to load shuts the engine down, the ones after it report as not loaded
+	int failed = 0;
+	std::vector<SceneBenchmarkResult> results;
+	for (size_t i = 0; i < scenes.size(); ++i)
+	{
+		SceneBenchmarkResult result;
+		if (!RunSceneBenchmark(app, scenes[i], settings, result))
+		{
+			std::cout << scenes[i] << ": failed" << std::endl;
+			++failed;
+			results.push_back(result);
+			continue;
+		}
+
+		std::cout << scenes[i] << ": load " << result.loadMs << "ms, frame " << result.stages[0].meanMs << "ms mean, "
+			<< result.stages[0].p99Ms << "ms p99, " << result.drawsPerFrame << " draws" << std::endl;
+		results.push_back(result);
+	}
+
+	WriteSceneBenchmarkJson(out, settings, results);
+
+	SAFE_CLOSE(app);
+	return failed == 0 ? 0 : -1;
+}
@@ -6,6 +6,7 @@
 #include "src\OutdoorScene.h"
 #include "src\SpaceScene.h"
 #include "src\VivaScene.h"
+#include "src\StressScene.h"
 #include "src\TextFile.h"
 #include "src\utils.h"
 
@@ -42,7 +43,7 @@ Cuts
 
 void resolveIniFile(int& windowed, int& resolution_width, int& resolution_height, std::string& scene_load, int& vsync, int& major, int& minor);
 
-int main(void)
+int main(int argc, char** argv)
 {
 	int windowed = 1;
 	int resolution_width = 1280;
@@ -52,6 +53,11 @@ int main(void)
 	int gl_minor = 5;
 	std::string scene_load = "outdoor";
 	resolveIniFile(windowed, resolution_width, resolution_height, scene_load, vsync, gl_major, gl_minor);
+
+	// Stress scene counts from its config file, then any --stress-<setting> <value> arguments
+	StressSceneSettings stress = DefaultStressSettings();
+	LoadStressSettings("../stress.ini", stress);
+	ParseStressArgs(argc, argv, stress);
 	
 	Application* app = new Application();
 
@@ -94,6 +100,12 @@ int main(void)
 			return -1;
 		}
 
+		if (app->AddScene<StressScene>(new StressScene("stress", stress)) != GE_OK)
+		{
+			SAFE_CLOSE(app);
+			return -1;
+		}
+
 		if (app->ChangeScene(scene_load) != GE_OK)
 		{
 			SAFE_CLOSE(app);
@@ -90,6 +90,8 @@ void AnimMesh::Close()
 
 bool AnimMesh::Load(const char* sFilename, ResourceManager* resMan, unsigned materialSet, bool flipUvs)
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	// Load Mesh file
 	FILE* mesh_file = fopen(sFilename, "rb");
 
@@ -148,12 +150,12 @@ bool AnimMesh::Load(const char* sFilename, ResourceManager* resMan, unsigned mat
 	m_AnimData.resize(header.num_frames);
 	for (int i = 0; i < header.num_frames; ++i)
 	{
-		glGenBuffers(1, &m_AnimData[i].vbo);
+		gl->GenBuffers(1, &m_AnimData[i].vbo);
 	}
 
 	// Only need one VBO for texcoords
 	GLuint texVbo;
-	glGenBuffers(1, &texVbo);
+	gl->GenBuffers(1, &texVbo);
 
 	// Loop through GL commands and populate buffer data
 	int i = 0;
@@ -202,13 +204,13 @@ bool AnimMesh::Load(const char* sFilename, ResourceManager* resMan, unsigned mat
 	}
 
 	// Now all necessary data are extracted, let's create VAO for rendering MD2 model
-	glGenVertexArrays(1, &m_VAO);
-	glBindVertexArray(m_VAO);
+	gl->GenVertexArrays(1, &m_VAO);
+	gl->BindVertexArray(m_VAO);
 
 	for (int i = 0; i < header.num_frames; ++i)
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, m_AnimData[i].vbo);
-		glBufferData(GL_ARRAY_BUFFER, m_AnimData[i].buffer.size() * sizeof(AnimVert), m_AnimData[i].buffer.data(), GL_STATIC_DRAW);
+		gl->BindBuffer(GL_ARRAY_BUFFER, m_AnimData[i].vbo);
+		gl->BufferData(GL_ARRAY_BUFFER, m_AnimData[i].buffer.size() * sizeof(AnimVert), m_AnimData[i].buffer.data(), GL_STATIC_DRAW);
 
 		// Get min, max, and centre vertices
 		Vec3 tempMin((float)MAX_TYPE(float));
@@ -251,31 +253,31 @@ bool AnimMesh::Load(const char* sFilename, ResourceManager* resMan, unsigned mat
 	}
 
 	// Vertex and normals data parameters
-	glBindBuffer(GL_ARRAY_BUFFER, m_AnimData[0].vbo);
+	gl->BindBuffer(GL_ARRAY_BUFFER, m_AnimData[0].vbo);
 
 	// Vertex positions
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), 0);
+	gl->EnableVertexAttribArray(0);
+	gl->VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), 0);
 	
 	// Vertices for next keyframe, now we can set it to same VBO
-	glEnableVertexAttribArray(3); 
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), 0);
+	gl->EnableVertexAttribArray(3); 
+	gl->VertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), 0);
 
 	// Normal vectors
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), (void*)(sizeof(Vec3)));
+	gl->EnableVertexAttribArray(2);
+	gl->VertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), (void*)(sizeof(Vec3)));
 
 	// Normals for next keyframe, now we can set it to same VBO
-	glEnableVertexAttribArray(4); 
-	glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), (void*)(sizeof(Vec3)));
+	gl->EnableVertexAttribArray(4); 
+	gl->VertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), (void*)(sizeof(Vec3)));
 
 	// Texture coordinates
-	glBindBuffer(GL_ARRAY_BUFFER, texVbo);
-	glBufferData(GL_ARRAY_BUFFER, texcoords.size() * sizeof(Vec2), texcoords.data(), GL_STATIC_DRAW);
+	gl->BindBuffer(GL_ARRAY_BUFFER, texVbo);
+	gl->BufferData(GL_ARRAY_BUFFER, texcoords.size() * sizeof(Vec2), texcoords.data(), GL_STATIC_DRAW);
 
 	// Texture coordinates
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vec2), 0);
+	gl->EnableVertexAttribArray(1);
+	gl->VertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vec2), 0);
 
 	// Find texture name (modelname.jpg, modelname.png...)
 	std::string sPath = sFilename;
@@ -12,6 +12,8 @@
 #include "Screen.h"
 #include "ResId.h"
 #include "Mesh.h"
+#include "OpenGlLayer.h"
+#include "Profiler.h"
 
 Application::Application() :
 	m_SceneGraph(nullptr),
@@ -85,15 +87,53 @@ bool Application::Init(int width, int height, bool windowed, const char* title,
 	std::string glewVersion = "GLEW_VERSION : " + (std::string)version;
 	WRITE_LOG(glewVersion, "none");
 
+	// Everything graphics related talks to the driver through the render device from here on
+	if (!OpenGLLayer::create_device(GLBackend))
+	{
+		WRITE_LOG("Error: Failed to create render device", "error");
+		return false;
+	}
+
 	glfwSwapInterval(Maths::Clamp(vsync, 0, 1));
 
+	return initSystems(false);
+}
+
+bool Application::InitHeadless(int width, int height)
+{
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+
+	if (!m_SceneGraph)
+		m_SceneGraph = new SceneGraph();
+
+	// What the window would have set
+	Screen::m_ScreenWidth = width;
+	Screen::m_ScreenHeight = height;
+	Screen::m_FrameBuffWidth = width;
+	Screen::m_FrameBuffHeight = height;
+	Screen::m_FullScreen = false;
+
+	if (!OpenGLLayer::create_device(NullBackend))
+	{
+		WRITE_LOG("Error: Failed to create null render device", "error");
+		return false;
+	}
+
+	// Benchmarks time the scene, not the overlay
+	m_ShouldRendedInfoStrings = GE_FALSE;
+
+	return initSystems(true);
+}
+
+bool Application::initSystems(bool headless)
+{
 	// Input system
 	if (!m_Input)
 	{
 		m_Input = new Input();
 	}
 
-	if (m_Input->Init() != GE_OK)
+	if (m_Input->Init(headless) != GE_OK)
 	{
 		WRITE_LOG("Error: Input init failed", "error");
 		return GE_FATAL_ERROR;
@@ -139,6 +179,49 @@ int Application::ChangeScene(const std::string& state)
 	return GE_OK;
 }
 
+void Application::StepFrame(float dt, FrameStageTimes* times)
+{
+	PROFILE_FRAME();
+	PROFILE_ZONE("Frame");
+
+	const uint64 start = Profiler::Now();
+
+	Time::deltaTime = dt;
+	Time::elapsedTime += dt;
+
+	m_SceneGraph->UpdateActiveScene(Time::deltaTime);
+	const uint64 updated = Profiler::Now();
+
+	m_SceneGraph->RenderActiveScene(m_ShouldRenderSceneUI);
+
+	if (m_ShouldRendedInfoStrings)
+		renderInfo();
+
+	const uint64 rendered = Profiler::Now();
+
+	m_Renderer->FlushText();
+	const uint64 end = Profiler::Now();
+
+	if (times)
+	{
+		times->update = (updated - start) / 1000000.0;
+		times->render = (rendered - updated) / 1000000.0;
+		times->text = (end - rendered) / 1000000.0;
+		times->total = (end - start) / 1000000.0;
+	}
+}
+
+bool Application::LoadScene(const std::string& scene)
+{
+	PROFILE_ZONE("ChangeScene");
+
+	// A failed load sends the shutdown event
+	m_PendingSceneChange = GE_FALSE;
+	m_SceneGraph->ChangeSceneByName(scene, m_Renderer->GetResourceManager());
+
+	return m_ShouldClose != GE_TRUE && m_SceneGraph->GetActiveSceneHash() == m_SceneGraph->HashHelper(scene);
+}
+
 void Application::Close()
 {
 	// TODO : Detach all events
@@ -147,6 +230,8 @@ void Application::Close()
 	SAFE_CLOSE(m_Renderer);
 	SAFE_CLOSE(m_SceneGraph);
 	SAFE_CLOSE(m_RenderWindow);
+	OpenGLLayer::destroy_device();
+	Profiler::Close();
 
 	// Assumes all events have been detached by now
 
@@ -177,13 +262,18 @@ void Application::Run()
 	float next_tick = 0;
 
 	Timer timer;
+	PROFILE_THREAD("Main");
 
 	// Update loop
 	while (m_RenderWindow->IsOpen() && m_ShouldClose != GE_TRUE)
 	{
+		PROFILE_FRAME();
+		PROFILE_ZONE("Frame");
+
 		// See if the scene needs changing, make sure everything has been set first
 		if (m_PendingSceneChange == GE_TRUE)
 		{
+			PROFILE_ZONE("ChangeScene");
 			m_PendingSceneChange = GE_FALSE;
 
 			if (m_SceneGraph && !m_SceneGraph->IsEmpty())
@@ -212,8 +302,18 @@ void Application::Run()
 		if (m_ShouldRendedInfoStrings)
 			renderInfo();
 
-		m_RenderWindow->SwapBuffers();
-		glfwPollEvents();
+		// All the frame's text goes out in one batch
+		m_Renderer->FlushText();
+
+		{
+			PROFILE_ZONE("SwapBuffers");
+			m_RenderWindow->SwapBuffers();
+		}
+
+		{
+			PROFILE_ZONE("PollEvents");
+			glfwPollEvents();
+		}
 	}
 
 	glfwSetWindowShouldClose(glfwGetCurrentContext(), GLFW_TRUE);
@@ -226,7 +326,7 @@ void Application::renderInfo()
 	const float top = static_cast<float>(Screen::FrameBufferHeight());
 
 	if(!m_ShouldRenderSceneUI)
-		m_Renderer->RenderText(FONT_CONSOLA, "[Tab] Scene UI, [F11] Info strings, [F10] Frame count, [F9] Culling, [F1-F6] Scenes ", 8, 64, FontAlign::Left, Colour::Red());
+		m_Renderer->RenderText(FONT_CONSOLA, "[Tab] Scene UI, [F11] Info strings, [F10] Frame count, [F9] Culling, [F7] Profile, [F1-F6] Scenes, [F12] Stress ", 8, 64, FontAlign::Left, Colour::Red());
 	
 	m_Renderer->RenderText(FONT_CONSOLA, m_Renderer->GetHardwareStr(),		8, top - (++numItems * divider), FontAlign::Left, Colour::Blue());
 	m_Renderer->RenderText(FONT_CONSOLA, m_Renderer->GetShadingModeStr(),	8, top - (++numItems * divider), FontAlign::Left, Colour::Blue());
@@ -302,6 +402,23 @@ void Application::HandleEvent(Event* e)
 			{
 				this->ChangeScene("viva");
 			}
+			// Stress Scene
+			else if (ke->key == GLFW_KEY_F12 && ke->action == GLFW_RELEASE)
+			{
+				this->ChangeScene("stress");
+			}
+#ifdef CGR_PROFILE
+			// Capture the next frames' CPU zones to a trace file
+			else if (ke->key == GLFW_KEY_F7 && ke->action == GLFW_RELEASE)
+			{
+				Profiler::Capture(PROFILE_CAPTURE_FRAMES);
+			}
+#endif
+			// Toggle Occlusion Culling
+			else if (ke->key == GLFW_KEY_F8 && ke->action == GLFW_RELEASE)
+			{
+				this->m_Renderer->ToggleOcclusionCulling();
+			}
 			// Toggle Culling
 			else if (ke->key == GLFW_KEY_F9 && ke->action == GLFW_RELEASE)
 			{
@@ -13,25 +13,43 @@ class ResourceManager;
 class Renderer;
 class Input;
 
+// CPU milliseconds one StepFrame spent in each stage
+struct FrameStageTimes
+{
+	double	update;
+	double	render;
+	double	text;
+	double	total;
+};
+
 class Application : public Singleton<Application>, public EventHandler
 {
 public:
 	Application();
 
 	bool Init(int width, int height, bool windowed, const char* title, int vsync, int aspX, int aspY, int major = 3, int minor = 3);
+	// No window or context, every GL call goes to the null device. For running scenes without a display
+	bool InitHeadless(int width, int height);
 	void Run();
 	void Close();
 
+	// One frame at a fixed step outside Run, nothing is presented
+	void StepFrame(float dt, FrameStageTimes* times = nullptr);
+	// Changes scene straight away rather than at the start of the next frame, false if it failed to load
+	bool LoadScene(const std::string& scene);
+
 	bool IsRenderingInfoStrings() const;
 	void ShouldRenderInfoStrings(bool should);
 
 	RenderWindow* GetRenderWindow();
+	Renderer* GetRenderer();
 
 	// Event and Scene Management
 	template<typename T> int AddScene(T* state);
 	int ChangeScene(const std::string& firstState);
 
 private:
+	bool initSystems(bool headless);
 	void HandleEvent(Event* ev) override;
 	void renderInfo();
 	static void glfw_error_callback(int error, const char* description);
@@ -55,6 +73,11 @@ inline RenderWindow* Application::GetRenderWindow()
 	return m_RenderWindow;
 }
 
+inline Renderer* Application::GetRenderer()
+{
+	return m_Renderer;
+}
+
 template<typename T>
 int Application::AddScene(T* state)
 {
@@ -5,6 +5,9 @@
 #include "Shader.h"
 #include "ShaderProgram.h"
 #include <vector>
+#include <algorithm>
+#include <random>
+#include <cmath>
 
 BillboardList::BillboardList() :
 	m_ShaderIndex(0),
@@ -12,7 +15,19 @@ BillboardList::BillboardList() :
 	m_NumInstances(0),
 	m_VBO(0),
 	m_VAO(0),
-	m_BillboardScale(0)
+	m_BillboardScale(0),
+	m_Cells(),
+	m_CellBoxes(),
+	m_CellBoxScale(-1.0f),
+	m_Visible(),
+	m_Order(),
+	m_DrawFirsts(),
+	m_DrawCounts(),
+	m_LodStart(BILLBOARD_LOD_START),
+	m_LodEnd(BILLBOARD_LOD_END),
+	m_LodMinDensity(BILLBOARD_LOD_MIN_DENSITY),
+	m_SortBackToFront(false),
+	m_Stats()
 {
 }
 
@@ -42,18 +57,7 @@ bool BillboardList::Init(size_t shaderIndex, size_t textureIndex, float scale, s
 		}
 	}
 
-	glGenVertexArrays(1, &m_VAO);
-	glBindVertexArray(m_VAO);
-	glGenBuffers(1, &m_VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(Vec3) * positions.size(), positions.data(), GL_STATIC_DRAW);
-
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-
-	return true;
+	return createBuffers(positions);
 }
 
 bool BillboardList::InitWithPositions(size_t shaderIndex, size_t texture, float setScale, const std::vector<Vec3>& positions)
@@ -64,18 +68,7 @@ bool BillboardList::InitWithPositions(size_t shaderIndex, size_t texture, float
 
 	m_NumInstances = positions.size();
 
-	glGenVertexArrays(1, &m_VAO);
-	glBindVertexArray(m_VAO);
-	glGenBuffers(1, &m_VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(Vec3) * positions.size(), positions.data(), GL_STATIC_DRAW);
-
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-
-	return true;
+	return createBuffers(positions);
 }
 
 void BillboardList::SetScale(float scale)
@@ -86,4 +79,177 @@ void BillboardList::SetScale(float scale)
 float BillboardList::GetScale() const
 {
 	return m_BillboardScale;
-}
\ No newline at end of file
+}
+
+void BillboardList::SetLodDistances(float start, float end, float minDensity)
+{
+	m_LodStart = start;
+	m_LodEnd = end;
+	m_LodMinDensity = Maths::Clamp(minDensity, 0.0f, 1.0f);
+}
+
+void BillboardList::SetSortBackToFront(bool sort)
+{
+	m_SortBackToFront = sort;
+}
+
+bool BillboardList::createBuffers(const std::vector<Vec3>& positions)
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	m_Cells.clear();
+	m_CellBoxScale = -1.0f;
+	m_Stats = BillboardStats();
+
+	if (positions.empty())
+		return false;
+
+	// Grid over the xz extent of the positions
+	Vec3 lo = positions[0];
+	Vec3 hi = positions[0];
+	for (size_t i = 1; i < positions.size(); ++i)
+	{
+		lo = glm::min(lo, positions[i]);
+		hi = glm::max(hi, positions[i]);
+	}
+
+	const size_t cellsX = (size_t)((hi.x - lo.x) / BILLBOARD_CELL_SIZE) + 1;
+	const size_t cellsZ = (size_t)((hi.z - lo.z) / BILLBOARD_CELL_SIZE) + 1;
+
+	std::vector<uint32> cellOf(positions.size());
+	std::vector<uint32> starts(cellsX * cellsZ + 1, 0);
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		const size_t cx = (size_t)((positions[i].x - lo.x) / BILLBOARD_CELL_SIZE);
+		const size_t cz = (size_t)((positions[i].z - lo.z) / BILLBOARD_CELL_SIZE);
+		cellOf[i] = (uint32)(cz * cellsX + cx);
+		++starts[cellOf[i] + 1];
+	}
+
+	// Counting sort, the buffer holds each cell's points back to back
+	for (size_t c = 1; c < starts.size(); ++c)
+		starts[c] += starts[c - 1];
+
+	std::vector<Vec3> sorted(positions.size());
+	std::vector<uint32> next(starts.begin(), starts.end() - 1);
+	for (size_t i = 0; i < positions.size(); ++i)
+		sorted[next[cellOf[i]]++] = positions[i];
+
+	// A fixed seed keeps the thinning the same from run to run
+	std::mt19937 rng(0xB111B0A2);
+
+	for (size_t c = 0; c + 1 < starts.size(); ++c)
+	{
+		if (starts[c] == starts[c + 1])
+			continue;
+
+		std::shuffle(sorted.begin() + starts[c], sorted.begin() + starts[c + 1], rng);
+
+		BillboardCell cell;
+		cell.first = (GLint)starts[c];
+		cell.count = (GLsizei)(starts[c + 1] - starts[c]);
+		cell.min = cell.max = sorted[starts[c]];
+		for (uint32 i = starts[c] + 1; i < starts[c + 1]; ++i)
+		{
+			cell.min = glm::min(cell.min, sorted[i]);
+			cell.max = glm::max(cell.max, sorted[i]);
+		}
+
+		m_Cells.push_back(cell);
+	}
+
+	gl->GenVertexArrays(1, &m_VAO);
+	gl->BindVertexArray(m_VAO);
+	gl->GenBuffers(1, &m_VBO);
+	gl->BindBuffer(GL_ARRAY_BUFFER, m_VBO);
+	gl->BufferData(GL_ARRAY_BUFFER, sizeof(Vec3) * sorted.size(), sorted.data(), GL_STATIC_DRAW);
+
+	gl->EnableVertexAttribArray(0);
+	gl->VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+	gl->BindBuffer(GL_ARRAY_BUFFER, 0);
+	gl->BindVertexArray(0);
+
+	m_Stats.cells = (uint32)m_Cells.size();
+	m_Stats.billboards = (uint32)m_NumInstances;
+	return true;
+}
+
+void BillboardList::buildCellBoxes()
+{
+	// Grow each cell by what the geometry shader can add around its points
+	const float side = m_BillboardScale * 0.5f + BILLBOARD_MAX_SWAY;
+	const Vec3 below(side, 0.0f, side);
+	const Vec3 above(side, BILLBOARD_MAX_HEIGHT, side);
+
+	m_CellBoxes.Clear();
+	m_CellBoxes.Reserve(m_Cells.size());
+	for (size_t i = 0; i < m_Cells.size(); ++i)
+		m_CellBoxes.Push(m_Cells[i].min - below, m_Cells[i].max + above);
+
+	m_CellBoxScale = m_BillboardScale;
+}
+
+uint32 BillboardList::Cull(const Frustum* frustum, const Vec3& eye)
+{
+	m_Order.clear();
+	m_DrawFirsts.clear();
+	m_DrawCounts.clear();
+
+	if (m_CellBoxScale != m_BillboardScale)
+		buildCellBoxes();
+
+	if (frustum)
+		frustum->CullBoxes(m_CellBoxes, m_Visible);
+
+	const bool thin = m_LodEnd > 0.0f;
+	const float endSq = m_LodEnd * m_LodEnd;
+
+	for (size_t i = 0; i < m_Cells.size(); ++i)
+	{
+		if (frustum && !Frustum::IsVisible(m_Visible, i))
+			continue;
+
+		// Distance to the nearest point of the cell so a big cell isn't thinned while the eye stands in it
+		const Vec3 nearest = glm::clamp(eye, m_Cells[i].min, m_Cells[i].max);
+		const Vec3 d = nearest - eye;
+		const float distSq = glm::dot(d, d);
+
+		if (thin && distSq > endSq)
+			continue;
+
+		CellOrder order = { distSq, (uint32)i };
+		m_Order.push_back(order);
+	}
+
+	// Farthest first, the nearer grass then covers it properly with alpha to coverage
+	if (m_SortBackToFront)
+	{
+		std::sort(m_Order.begin(), m_Order.end(), [](const CellOrder& a, const CellOrder& b) { return a.distSq > b.distSq; });
+	}
+
+	uint32 drawn = 0;
+	for (size_t i = 0; i < m_Order.size(); ++i)
+	{
+		const BillboardCell& cell = m_Cells[m_Order[i].cell];
+		GLsizei count = cell.count;
+
+		if (thin)
+		{
+			const float dist = sqrtf(m_Order[i].distSq);
+			const float t = Maths::Clamp((dist - m_LodStart) / std::max(m_LodEnd - m_LodStart, 1.0f), 0.0f, 1.0f);
+			const float density = 1.0f + (m_LodMinDensity - 1.0f) * t;
+			count = (GLsizei)std::ceil(cell.count * density);
+		}
+
+		if (count <= 0)
+			continue;
+
+		m_DrawFirsts.push_back(cell.first);
+		m_DrawCounts.push_back(count);
+		drawn += (uint32)count;
+	}
+
+	m_Stats.visibleCells = (uint32)m_DrawFirsts.size();
+	m_Stats.drawn = drawn;
+	return drawn;
+}
@@ -1,16 +1,56 @@
 #ifndef __BILLBOARD_LIST_H__
-#define __BILLBOARD_LIST_H_
+#define __BILLBOARD_LIST_H__
 
 #include <vector>
 #include "gl_headers.h"
 #include "types.h"
 #include "Vertex.h"
+#include "Frustum.h"
 
 class ShaderProgram;
 class Renderer;
 
+// Width and depth of the cells positions are bucketed into, each cell is culled and thinned as one
+#define BILLBOARD_CELL_SIZE			32.0f
+// How far the geometry shader can take a patch from its point, tallest patch above it and wind sway to the side
+#define BILLBOARD_MAX_HEIGHT		5.5f
+#define BILLBOARD_MAX_SWAY			1.0f
+
+// Default distances for thinning, full density up to the start falling to the minimum at the end
+#define BILLBOARD_LOD_START			150.0f
+#define BILLBOARD_LOD_END			600.0f
+#define BILLBOARD_LOD_MIN_DENSITY	0.2f
+
+struct BillboardCell
+{
+	Vec3	min;		// Bounds of the positions, the patches drawn from them are added at cull time
+	Vec3	max;
+	GLint	first;
+	GLsizei	count;
+};
+
+struct BillboardStats
+{
+	uint32	cells;
+	uint32	visibleCells;
+	uint32	billboards;
+	uint32	drawn;
+};
+
+/*
+	Positions are bucketed into square cells on the xz plane and stored cell by cell in the one buffer, each
+	cell's points shuffled so any prefix of its range is an even spread over the cell. Culling tests the cell
+	bounds against the frustum and thins cells by distance just by drawing a shorter prefix, the visible ranges
+	then go out in a single multi draw. Cells can be ordered back to front for the alpha to coverage path.
+*/
 class BillboardList
 {
+	struct CellOrder
+	{
+		float	distSq;
+		uint32	cell;
+	};
+
 public:
 	BillboardList();
 	~BillboardList();
@@ -20,14 +60,45 @@ public:
 	void	SetScale			(float scale);
 	float	GetScale			() const;
 
+	// An end of 0 turns thinning off and draws every visible cell in full
+	void	SetLodDistances		(float start, float end, float minDensity);
+	void	SetSortBackToFront	(bool sort);
+
+	// Works out the ranges to draw from the eye, without a frustum every cell in range is kept. Returns billboards to draw
+	uint32	Cull				(const Frustum* frustum, const Vec3& eye);
+
+	const BillboardStats&	Stats() const;
+
+private:
+	bool	createBuffers		(const std::vector<Vec3>& positions);
+	void	buildCellBoxes		();
+
 private:
 	friend class Renderer;
-	size_t			m_ShaderIndex;
-	size_t			m_TextureIndex;
-	size_t			m_NumInstances;
-	GLuint			m_VBO;
-	GLuint			m_VAO;
-	float			m_BillboardScale;
+	size_t						m_ShaderIndex;
+	size_t						m_TextureIndex;
+	size_t						m_NumInstances;
+	GLuint						m_VBO;
+	GLuint						m_VAO;
+	float						m_BillboardScale;
+
+	std::vector<BillboardCell>	m_Cells;
+	BoxArrays					m_CellBoxes;
+	float						m_CellBoxScale;
+	std::vector<uint32>			m_Visible;
+	std::vector<CellOrder>		m_Order;
+	std::vector<GLint>			m_DrawFirsts;
+	std::vector<GLsizei>		m_DrawCounts;
+	float						m_LodStart;
+	float						m_LodEnd;
+	float						m_LodMinDensity;
+	bool						m_SortBackToFront;
+	BillboardStats				m_Stats;
 };
 
-#endif
\ No newline at end of file
+INLINE const BillboardStats& BillboardList::Stats() const
+{
+	return m_Stats;
+}
+
+#endif
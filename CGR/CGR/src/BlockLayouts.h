@@ -0,0 +1,39 @@
+#ifndef __BLOCK_LAYOUTS_H__
+#define __BLOCK_LAYOUTS_H__
+
+#include <cstddef>
+
+#include "types.h"
+
+// std140 mirrors of the engine's uniform blocks, a vec3 takes 16 bytes unless a float follows it.
+// The renderer checks these offsets against the linked shaders once they are loaded
+
+// layout (binding = 1, std140) uniform scene
+struct SceneBlockData
+{
+	Mat4	proj_xform;
+	Mat4	view_xform;
+	Vec3	camera_position;
+	float	pad0;
+	Vec3	ambient_light;
+	float	delta_time;
+};
+
+struct DirectionLightData
+{
+	Vec3	direction;
+	float	pad0;
+	Vec3	intensity;
+	float	pad1;
+};
+
+// layout (binding = 0, std140) uniform Lights
+struct LightsBlockData
+{
+	DirectionLightData	directionLight;
+};
+
+static_assert(sizeof(SceneBlockData) == 160, "SceneBlockData no longer matches the std140 scene block");
+static_assert(sizeof(LightsBlockData) == 32, "LightsBlockData no longer matches the std140 Lights block");
+
+#endif
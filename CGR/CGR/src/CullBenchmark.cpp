@@ -0,0 +1,310 @@
+#include "CullBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Frustum.h"
+#include "OcclusionCuller.h"
+#include "LightClusterer.h"
+#include "LogFile.h"
+
+typedef std::chrono::high_resolution_clock BenchClock;
+
+static double elapsedMs(const BenchClock::time_point& start)
+{
+	return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+}
+
+static size_t countVisible(const std::vector<uint32>& mask, size_t count)
+{
+	size_t visible = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (Frustum::IsVisible(mask, i))
+			++visible;
+	}
+
+	return visible;
+}
+
+bool RunCullBenchmark(size_t numObjects, int iterations, CullBenchmarkResult& result)
+{
+	if (numObjects == 0 || iterations <= 0)
+		return false;
+
+	Frustum frustum;
+	frustum.UpdateFrustum(
+		glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f),
+		glm::lookAt(Vec3(0.0f, 10.0f, -50.0f), Vec3(0.0f), Vec3(0.0f, 1.0f, 0.0f)));
+
+	// Fixed seed so runs are comparable
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> pos(-800.0f, 800.0f);
+	std::uniform_real_distribution<float> size(0.5f, 20.0f);
+
+	SphereArrays spheres;
+	BoxArrays boxes;
+	spheres.Reserve(numObjects);
+	boxes.Reserve(numObjects);
+
+	for (size_t i = 0; i < numObjects; ++i)
+	{
+		Vec3 c(pos(rng), pos(rng) * 0.25f, pos(rng));
+		Vec3 e(size(rng), size(rng), size(rng));
+		spheres.Push(c, glm::length(e));
+		boxes.Push(c - e, c + e);
+	}
+
+	std::vector<uint32> scalarMask, batchMask;
+	result.objects = numObjects;
+	result.matches = true;
+	result.sphereScalarMs = result.sphereBatchMs = 0.0;
+	result.boxScalarMs = result.boxBatchMs = 0.0;
+
+	for (int i = 0; i < iterations; ++i)
+	{
+		BenchClock::time_point start = BenchClock::now();
+		frustum.CullSpheresScalar(spheres, scalarMask);
+		result.sphereScalarMs += elapsedMs(start);
+
+		start = BenchClock::now();
+		frustum.CullSpheres(spheres, batchMask);
+		result.sphereBatchMs += elapsedMs(start);
+
+		result.matches &= (scalarMask == batchMask);
+		result.visibleSpheres = countVisible(batchMask, numObjects);
+
+		start = BenchClock::now();
+		frustum.CullBoxesScalar(boxes, scalarMask);
+		result.boxScalarMs += elapsedMs(start);
+
+		start = BenchClock::now();
+		frustum.CullBoxes(boxes, batchMask);
+		result.boxBatchMs += elapsedMs(start);
+
+		result.matches &= (scalarMask == batchMask);
+		result.visibleBoxes = countVisible(batchMask, numObjects);
+	}
+
+	result.sphereScalarMs /= iterations;
+	result.sphereBatchMs /= iterations;
+	result.boxScalarMs /= iterations;
+	result.boxBatchMs /= iterations;
+
+	std::stringstream ss;
+	ss << "Cull benchmark, " << numObjects << " objects: "
+		<< "spheres scalar " << result.sphereScalarMs << "ms, batch " << result.sphereBatchMs << "ms (" << result.visibleSpheres << " visible), "
+		<< "boxes scalar " << result.boxScalarMs << "ms, batch " << result.boxBatchMs << "ms (" << result.visibleBoxes << " visible)";
+	WRITE_LOG(ss.str(), result.matches ? "info" : "error");
+
+	if (!result.matches)
+		WRITE_LOG("Batch cull results differ from the scalar path", "error");
+
+	return result.matches;
+}
+
+bool RunOcclusionBenchmark(size_t numObjects, int iterations, OcclusionBenchmarkResult& result)
+{
+	if (numObjects == 0 || iterations <= 0)
+		return false;
+
+	OcclusionCuller culler;
+	if (!culler.Init())
+		return false;
+
+	const Mat4 projView =
+		glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f) *
+		glm::lookAt(Vec3(0.0f, 10.0f, 0.0f), Vec3(0.0f, 10.0f, -1.0f), Vec3(0.0f, 1.0f, 0.0f));
+
+	// A tessellated wall across the whole view at z = -100, with a gap down the middle to see through
+	const float wallZ = -100.0f;
+	const int cells = 32;
+	const float cellSize = 600.0f / cells;
+	std::vector<Vec3> wallVerts;
+	std::vector<uint32> wallIndices;
+
+	for (int y = 0; y < cells; ++y)
+	{
+		for (int x = 0; x < cells; ++x)
+		{
+			if (x == cells / 2)
+				continue;
+
+			const float x0 = -300.0f + x * cellSize, y0 = -290.0f + y * cellSize;
+			const uint32 base = (uint32)wallVerts.size();
+			wallVerts.push_back(Vec3(x0, y0, wallZ));
+			wallVerts.push_back(Vec3(x0 + cellSize, y0, wallZ));
+			wallVerts.push_back(Vec3(x0 + cellSize, y0 + cellSize, wallZ));
+			wallVerts.push_back(Vec3(x0, y0 + cellSize, wallZ));
+
+			const uint32 quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+			wallIndices.insert(wallIndices.end(), quad, quad + 6);
+		}
+	}
+
+	// Fixed seed so runs are comparable
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> posX(-150.0f, 150.0f);
+	std::uniform_real_distribution<float> posY(-60.0f, 80.0f);
+	std::uniform_real_distribution<float> posZ(-400.0f, -5.0f);
+	std::uniform_real_distribution<float> size(0.5f, 5.0f);
+
+	std::vector<Vec3> mins(numObjects), maxs(numObjects);
+	for (size_t i = 0; i < numObjects; ++i)
+	{
+		Vec3 c(posX(rng), posY(rng), posZ(rng));
+		Vec3 e(size(rng));
+		mins[i] = c - e;
+		maxs[i] = c + e;
+	}
+
+	result.objects = numObjects;
+	result.occluderTriangles = wallIndices.size() / 3;
+	result.rasterMs = result.testMs = 0.0;
+	result.conservative = true;
+
+	for (int i = 0; i < iterations; ++i)
+	{
+		BenchClock::time_point start = BenchClock::now();
+		culler.Begin(projView);
+		culler.AddOccluder(wallVerts, wallIndices, Mat4(1.0f));
+		culler.End();
+		result.rasterMs += elapsedMs(start);
+
+		size_t occluded = 0;
+		start = BenchClock::now();
+		for (size_t j = 0; j < numObjects; ++j)
+		{
+			if (!culler.TestBox(mins[j], maxs[j]))
+			{
+				++occluded;
+				result.conservative &= maxs[j].z < wallZ;
+			}
+		}
+		result.testMs += elapsedMs(start);
+		result.occluded = occluded;
+	}
+
+	result.rasterMs /= iterations;
+	result.testMs /= iterations;
+
+	std::stringstream ss;
+	ss << "Occlusion benchmark, " << numObjects << " objects, " << result.occluderTriangles << " occluder triangles: "
+		<< "raster " << result.rasterMs << "ms, test " << result.testMs << "ms (" << result.occluded << " hidden)";
+	WRITE_LOG(ss.str(), result.conservative ? "info" : "error");
+
+	if (!result.conservative)
+		WRITE_LOG("Occlusion culling hid an object in front of the occluders", "error");
+
+	return result.conservative;
+}
+
+bool RunLightClusterBenchmark(size_t numPoints, size_t numSpots, int iterations, LightClusterBenchmarkResult& result)
+{
+	if (iterations <= 0)
+		return false;
+
+	const float width = 1280.0f, height = 720.0f;
+	const float nearZ = 0.1f, farZ = 1000.0f;
+	const Mat4 proj = glm::perspective(glm::radians(60.0f), width / height, nearZ, farZ);
+	const Mat4 view = glm::lookAt(Vec3(0.0f, 10.0f, -50.0f), Vec3(0.0f), Vec3(0.0f, 1.0f, 0.0f));
+
+	// Fixed seed so runs are comparable, lights are scattered around and in front of the camera
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> pos(-400.0f, 400.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> range(2.0f, 40.0f);
+	std::uniform_real_distribution<float> angle(5.0f, 80.0f);
+
+	std::vector<PointLightData> points(numPoints);
+	for (size_t i = 0; i < numPoints; ++i)
+	{
+		PointLightData& p = points[i];
+		p = PointLightData();
+		p.position = Vec3(pos(rng), pos(rng) * 0.1f, pos(rng));
+		p.range = range(rng);
+	}
+
+	std::vector<SpotLightData> spots(numSpots);
+	for (size_t i = 0; i < numSpots; ++i)
+	{
+		SpotLightData& s = spots[i];
+		s = SpotLightData();
+		s.position = Vec3(pos(rng), pos(rng) * 0.1f, pos(rng));
+		s.direction = glm::normalize(Vec3(unit(rng), unit(rng), unit(rng)) + Vec3(0.0f, 0.0f, 0.001f));
+		s.coneAngle = cosf(glm::radians(angle(rng)));
+		s.range = range(rng) * 2.0f;
+		s.switchedOn = i % 8 != 0 ? 1 : 0;
+	}
+
+	LightClusterer clusters;
+	result.points = numPoints;
+	result.spots = numSpots;
+	result.buildMs = 0.0;
+
+	for (int i = 0; i < iterations; ++i)
+	{
+		BenchClock::time_point start = BenchClock::now();
+		clusters.Build(points, spots, proj, view, width, height);
+		result.buildMs += elapsedMs(start);
+	}
+
+	result.buildMs /= iterations;
+	result.references = clusters.Stats().references;
+	result.maxPerCluster = clusters.Stats().maxPerCluster;
+	result.conservative = true;
+
+	// Random points in the view, spread evenly over the depth slices, are found a cluster the way the shaders do
+	const Mat4 invProj = glm::inverse(proj);
+	const Mat4 invView = glm::inverse(view);
+	const std::vector<uint32>& indices = clusters.Indices();
+	std::uniform_real_distribution<float> pixelX(0.0f, width), pixelY(0.0f, height), slice(0.0f, 1.0f);
+
+	for (int i = 0; i < 20000 && result.conservative; ++i)
+	{
+		const float px = pixelX(rng), py = pixelY(rng);
+		const float depth = nearZ * powf(farZ / nearZ, slice(rng));
+
+		// Back through the projection to the view ray under the pixel, then out to the depth
+		Vec4 ray = invProj * Vec4(px / width * 2.0f - 1.0f, py / height * 2.0f - 1.0f, 1.0f, 1.0f);
+		Vec3 viewPos = Vec3(ray) / ray.w;
+		viewPos *= depth / -viewPos.z;
+		const Vec3 world = Vec3(invView * Vec4(viewPos, 1.0f));
+
+		const ClusterRange& cluster = clusters.Range(clusters.ClusterIndex(viewPos, px, py));
+		const uint32* first = indices.data() + cluster.offset;
+		const uint32* firstSpot = first + cluster.numPoints;
+		const uint32* last = firstSpot + cluster.numSpots;
+
+		for (size_t l = 0; l < numPoints; ++l)
+		{
+			if (glm::length(world - points[l].position) < points[l].range && std::find(first, firstSpot, (uint32)l) == firstSpot)
+				result.conservative = false;
+		}
+
+		for (size_t l = 0; l < numSpots; ++l)
+		{
+			const SpotLightData& s = spots[l];
+			const Vec3 toPoint = world - s.position;
+			const float dist = glm::length(toPoint);
+
+			if (s.switchedOn && dist < s.range && dist > 0.0f && glm::dot(s.direction, toPoint / dist) > s.coneAngle &&
+				std::find(firstSpot, last, (uint32)l) == last)
+				result.conservative = false;
+		}
+	}
+
+	std::stringstream ss;
+	ss << "Light cluster benchmark, " << numPoints << " points, " << numSpots << " spots: "
+		<< "build " << result.buildMs << "ms, " << clusters.Stats().points << " points and " << clusters.Stats().spots << " spots binned, "
+		<< result.references << " references, at most " << result.maxPerCluster << " in a cluster";
+	WRITE_LOG(ss.str(), result.conservative ? "info" : "error");
+
+	if (!result.conservative)
+		WRITE_LOG("Light clustering missed a light at a point it reaches", "error");
+
+	return result.conservative;
+}
@@ -0,0 +1,57 @@
+#ifndef __CULL_BENCHMARK_H__
+#define __CULL_BENCHMARK_H__
+
+#include "types.h"
+
+struct CullBenchmarkResult
+{
+	size_t	objects;
+	size_t	visibleSpheres;
+	size_t	visibleBoxes;
+	double	sphereScalarMs;
+	double	sphereBatchMs;
+	double	boxScalarMs;
+	double	boxBatchMs;
+	bool	matches;		// The batch masks agree bit for bit with the scalar ones
+};
+
+/*
+	Times the scalar frustum tests against the SIMD batch path over a random field of objects
+	scattered around a fixed camera, averaged over a number of runs. Results are written to the log.
+*/
+bool RunCullBenchmark(size_t numObjects, int iterations, CullBenchmarkResult& result);
+
+struct OcclusionBenchmarkResult
+{
+	size_t	objects;
+	size_t	occluderTriangles;
+	size_t	occluded;
+	double	rasterMs;		// Clearing, rasterizing the occluders and building the mip chain
+	double	testMs;
+	bool	conservative;	// Nothing in front of the occluders was reported hidden
+};
+
+/*
+	Rasterizes a wall of occluder quads across the view and tests a random field of boxes either side
+	of it against the hierarchical depth buffer, averaged over a number of runs. Results are written to the log.
+*/
+bool RunOcclusionBenchmark(size_t numObjects, int iterations, OcclusionBenchmarkResult& result);
+
+struct LightClusterBenchmarkResult
+{
+	size_t	points;
+	size_t	spots;
+	size_t	references;	// Entries in the index list
+	size_t	maxPerCluster;
+	double	buildMs;
+	bool	conservative;	// Every sample point a light reaches found that light in its cluster
+};
+
+/*
+	Bins a random field of point and spot lights in front of a fixed camera into the cluster grid,
+	averaged over a number of runs, then checks the binning against brute force at random points in
+	the view: each must find every light that reaches it in its cluster. Results are written to the log.
+*/
+bool RunLightClusterBenchmark(size_t numPoints, size_t numSpots, int iterations, LightClusterBenchmarkResult& result);
+
+#endif
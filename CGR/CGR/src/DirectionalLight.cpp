@@ -3,6 +3,7 @@
 #include "UniformBlockManager.h"
 #include "UniformBlock.h"
 #include "Renderer.h"
+#include "BlockLayouts.h"
 #include "LogFile.h"
 
 int DirectionalLightC::m_Id = DIRECTION_LIGHT_COMPONENT;
@@ -68,8 +69,7 @@ bool DirectionalLightC::SetLight(Renderer* renderer, const Vec3& direction, cons
 	m_Range = range;
 	m_LightValid = GE_TRUE;
 
-	m_LightBlock->SetValue("directionLight.direction", (void*)glm::value_ptr(m_Direction));
-	m_LightBlock->SetValue("directionLight.intensity", (void*)glm::value_ptr(m_Intensity));
+	updateBlock();
 
 	m_Renderer->UpdateDirLight(m_Direction, m_Range);
 	return true;
@@ -79,12 +79,21 @@ void DirectionalLightC::Update()
 {
 }
 
+void DirectionalLightC::updateBlock()
+{
+	// The whole record goes in with one copy at its offset in the block's mirror
+	DirectionLightData data = {};
+	data.direction = m_Direction;
+	data.intensity = m_Intensity;
+	m_LightBlock->Write(offsetof(LightsBlockData, directionLight), &data, sizeof(data));
+}
+
 void DirectionalLightC::SetDirection(const Vec3& newDir)
 {
 	if (m_LightValid && m_LightBlock)
 	{
 		m_Direction = newDir;
-		m_LightBlock->SetValue("directionLight.direction", (void*)glm::value_ptr(m_Direction));
+		updateBlock();
 		m_Renderer->UpdateDirLight(m_Direction, m_Range);
 	}
 }
@@ -103,7 +112,7 @@ void DirectionalLightC::SetDirectionX(float x)
 	if (m_LightValid && m_LightBlock)
 	{
 		m_Direction.x = x;
-		m_LightBlock->SetValue("directionLight.direction", (void*)glm::value_ptr(m_Direction));
+		updateBlock();
 		m_Renderer->UpdateDirLight(m_Direction, m_Range);
 	}
 }
@@ -113,7 +122,7 @@ void DirectionalLightC::SetDirectionY(float y)
 	if (m_LightValid && m_LightBlock)
 	{
 		m_Direction.y = y;
-		m_LightBlock->SetValue("directionLight.direction", (void*)glm::value_ptr(m_Direction));
+		updateBlock();
 		m_Renderer->UpdateDirLight(m_Direction, m_Range);
 	}
 }
@@ -123,7 +132,7 @@ void DirectionalLightC::SetDirectionZ(float z)
 	if (m_LightValid && m_LightBlock)
 	{
 		m_Direction.z = z;
-		m_LightBlock->SetValue("directionLight.direction", (void*)glm::value_ptr(m_Direction));
+		updateBlock();
 		m_Renderer->UpdateDirLight(m_Direction, m_Range);
 	}
 }
@@ -133,7 +142,7 @@ void DirectionalLightC::SetColour(const Vec3& newCol)
 	if (m_LightValid && m_LightBlock)
 	{
 		m_Intensity = newCol;
-		m_LightBlock->SetValue("directionLight.intensity", (void*)glm::value_ptr(m_Intensity));
+		updateBlock();
 	}
 }
 
@@ -142,7 +151,7 @@ void DirectionalLightC::SetColR(float r)
 	if (m_LightValid && m_LightBlock)
 	{
 		m_Intensity.r = r;
-		m_LightBlock->SetValue("directionLight.intensity", (void*)glm::value_ptr(m_Intensity));
+		updateBlock();
 	}
 }
 
@@ -151,7 +160,7 @@ void DirectionalLightC::SetColG(float g)
 	if (m_LightValid && m_LightBlock)
 	{
 		m_Intensity.g = g;
-		m_LightBlock->SetValue("directionLight.intensity", (void*)glm::value_ptr(m_Intensity));
+		updateBlock();
 	}
 }
 
@@ -160,7 +169,7 @@ void DirectionalLightC::SetColB(float b)
 	if (m_LightValid && m_LightBlock)
 	{
 		m_Intensity.b = b;
-		m_LightBlock->SetValue("directionLight.intensity", (void*)glm::value_ptr(m_Intensity));
+		updateBlock();
 	}
 }
 
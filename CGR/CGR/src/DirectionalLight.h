@@ -35,6 +35,9 @@ public:
 
 	static int GetId();
 
+private:
+	void updateBlock();
+
 private:
 	static int m_Id;
 	Renderer*		m_Renderer;		//<-- Weak Ptr
@@ -0,0 +1,392 @@
+#include "DynamicAABBTree.h"
+
+#include "Frustum.h"
+
+static INLINE float surfaceArea(const Vec3& min, const Vec3& max)
+{
+	Vec3 e = max - min;
+	return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+static INLINE bool contains(const Vec3& outerMin, const Vec3& outerMax, const Vec3& min, const Vec3& max)
+{
+	return outerMin.x <= min.x && outerMin.y <= min.y && outerMin.z <= min.z &&
+		max.x <= outerMax.x && max.y <= outerMax.y && max.z <= outerMax.z;
+}
+
+DynamicAABBTree::DynamicAABBTree() :
+	m_Nodes(),
+	m_Root(NULL_TREE_NODE),
+	m_FreeList(NULL_TREE_NODE),
+	m_NumProxies(0),
+	m_Stack()
+{
+}
+
+DynamicAABBTree::~DynamicAABBTree()
+{
+}
+
+void DynamicAABBTree::Clear()
+{
+	m_Nodes.clear();
+	m_Root = NULL_TREE_NODE;
+	m_FreeList = NULL_TREE_NODE;
+	m_NumProxies = 0;
+}
+
+int DynamicAABBTree::allocateNode()
+{
+	if (m_FreeList == NULL_TREE_NODE)
+	{
+		TreeNode node;
+		node.height = -1;
+		node.parent = NULL_TREE_NODE;
+		m_Nodes.push_back(node);
+		m_FreeList = (int)m_Nodes.size() - 1;
+	}
+
+	int id = m_FreeList;
+	TreeNode& node = m_Nodes[id];
+	m_FreeList = node.parent;
+
+	node.parent = NULL_TREE_NODE;
+	node.child1 = NULL_TREE_NODE;
+	node.child2 = NULL_TREE_NODE;
+	node.height = 0;
+	node.userData = -1;
+	return id;
+}
+
+void DynamicAABBTree::freeNode(int node)
+{
+	m_Nodes[node].parent = m_FreeList;
+	m_Nodes[node].height = -1;
+	m_FreeList = node;
+}
+
+int DynamicAABBTree::CreateProxy(const Vec3& min, const Vec3& max, int userData)
+{
+	int proxy = allocateNode();
+
+	// Fatten by a fraction of the box so objects can drift a little before the tree changes
+	Vec3 margin(glm::max(0.1f, 0.1f * glm::max(max.x - min.x, glm::max(max.y - min.y, max.z - min.z))));
+	m_Nodes[proxy].min = min - margin;
+	m_Nodes[proxy].max = max + margin;
+	m_Nodes[proxy].userData = userData;
+
+	insertLeaf(proxy);
+	++m_NumProxies;
+	return proxy;
+}
+
+void DynamicAABBTree::DestroyProxy(int proxy)
+{
+	removeLeaf(proxy);
+	freeNode(proxy);
+	--m_NumProxies;
+}
+
+bool DynamicAABBTree::MoveProxy(int proxy, const Vec3& min, const Vec3& max)
+{
+	TreeNode& node = m_Nodes[proxy];
+	if (contains(node.min, node.max, min, max))
+		return false;
+
+	removeLeaf(proxy);
+
+	Vec3 margin(glm::max(0.1f, 0.1f * glm::max(max.x - min.x, glm::max(max.y - min.y, max.z - min.z))));
+	m_Nodes[proxy].min = min - margin;
+	m_Nodes[proxy].max = max + margin;
+
+	insertLeaf(proxy);
+	return true;
+}
+
+void DynamicAABBTree::insertLeaf(int leaf)
+{
+	if (m_Root == NULL_TREE_NODE)
+	{
+		m_Root = leaf;
+		m_Nodes[leaf].parent = NULL_TREE_NODE;
+		return;
+	}
+
+	// Walk down choosing whichever side costs least in surface area to hold the leaf
+	const Vec3 leafMin = m_Nodes[leaf].min;
+	const Vec3 leafMax = m_Nodes[leaf].max;
+	int index = m_Root;
+
+	while (!m_Nodes[index].IsLeaf())
+	{
+		const TreeNode& node = m_Nodes[index];
+		const int child1 = node.child1;
+		const int child2 = node.child2;
+
+		float area = surfaceArea(node.min, node.max);
+		float combinedArea = surfaceArea(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+
+		// Cost of making a new parent here, and the cost pushed down to the children if we descend
+		float cost = 2.0f * combinedArea;
+		float inheritance = 2.0f * (combinedArea - area);
+
+		float cost1, cost2;
+		{
+			const TreeNode& c = m_Nodes[child1];
+			float a = surfaceArea(glm::min(c.min, leafMin), glm::max(c.max, leafMax));
+			cost1 = (c.IsLeaf() ? a : a - surfaceArea(c.min, c.max)) + inheritance;
+		}
+		{
+			const TreeNode& c = m_Nodes[child2];
+			float a = surfaceArea(glm::min(c.min, leafMin), glm::max(c.max, leafMax));
+			cost2 = (c.IsLeaf() ? a : a - surfaceArea(c.min, c.max)) + inheritance;
+		}
+
+		if (cost < cost1 && cost < cost2)
+			break;
+
+		index = cost1 < cost2 ? child1 : child2;
+	}
+
+	// New parent joining the sibling and the leaf
+	const int sibling = index;
+	const int oldParent = m_Nodes[sibling].parent;
+	const int newParent = allocateNode();
+
+	m_Nodes[newParent].parent = oldParent;
+	m_Nodes[newParent].min = glm::min(leafMin, m_Nodes[sibling].min);
+	m_Nodes[newParent].max = glm::max(leafMax, m_Nodes[sibling].max);
+	m_Nodes[newParent].height = m_Nodes[sibling].height + 1;
+	m_Nodes[newParent].child1 = sibling;
+	m_Nodes[newParent].child2 = leaf;
+	m_Nodes[sibling].parent = newParent;
+	m_Nodes[leaf].parent = newParent;
+
+	if (oldParent != NULL_TREE_NODE)
+	{
+		if (m_Nodes[oldParent].child1 == sibling)
+			m_Nodes[oldParent].child1 = newParent;
+		else
+			m_Nodes[oldParent].child2 = newParent;
+	}
+	else
+	{
+		m_Root = newParent;
+	}
+
+	refit(m_Nodes[leaf].parent);
+}
+
+void DynamicAABBTree::removeLeaf(int leaf)
+{
+	if (leaf == m_Root)
+	{
+		m_Root = NULL_TREE_NODE;
+		return;
+	}
+
+	const int parent = m_Nodes[leaf].parent;
+	const int grandParent = m_Nodes[parent].parent;
+	const int sibling = m_Nodes[parent].child1 == leaf ? m_Nodes[parent].child2 : m_Nodes[parent].child1;
+
+	// The sibling takes the parent's place
+	if (grandParent != NULL_TREE_NODE)
+	{
+		if (m_Nodes[grandParent].child1 == parent)
+			m_Nodes[grandParent].child1 = sibling;
+		else
+			m_Nodes[grandParent].child2 = sibling;
+
+		m_Nodes[sibling].parent = grandParent;
+		freeNode(parent);
+		refit(grandParent);
+	}
+	else
+	{
+		m_Root = sibling;
+		m_Nodes[sibling].parent = NULL_TREE_NODE;
+		freeNode(parent);
+	}
+}
+
+void DynamicAABBTree::refit(int index)
+{
+	// Rebalance and grow the boxes from here to the root
+	while (index != NULL_TREE_NODE)
+	{
+		index = balance(index);
+
+		TreeNode& node = m_Nodes[index];
+		const TreeNode& c1 = m_Nodes[node.child1];
+		const TreeNode& c2 = m_Nodes[node.child2];
+
+		node.height = 1 + glm::max(c1.height, c2.height);
+		node.min = glm::min(c1.min, c2.min);
+		node.max = glm::max(c1.max, c2.max);
+
+		index = node.parent;
+	}
+}
+
+int DynamicAABBTree::balance(int iA)
+{
+	// Rotates the taller grandchild up when A's children differ in height by more than one
+	TreeNode* A = &m_Nodes[iA];
+	if (A->IsLeaf() || A->height < 2)
+		return iA;
+
+	const int iB = A->child1;
+	const int iC = A->child2;
+	const int diff = m_Nodes[iC].height - m_Nodes[iB].height;
+
+	if (diff > 1 || diff < -1)
+	{
+		// Up is the taller child (C rotated above A when diff > 0, B otherwise)
+		const int iUp = diff > 1 ? iC : iB;
+		const int iOther = diff > 1 ? iB : iC;
+		TreeNode& up = m_Nodes[iUp];
+
+		const int iF = up.child1;
+		const int iG = up.child2;
+
+		// Swap A and Up
+		up.child1 = iA;
+		up.parent = A->parent;
+		A->parent = iUp;
+
+		if (up.parent != NULL_TREE_NODE)
+		{
+			if (m_Nodes[up.parent].child1 == iA)
+				m_Nodes[up.parent].child1 = iUp;
+			else
+				m_Nodes[up.parent].child2 = iUp;
+		}
+		else
+		{
+			m_Root = iUp;
+		}
+
+		// The taller of Up's children stays with Up, the shorter moves under A
+		const int iKeep = m_Nodes[iF].height > m_Nodes[iG].height ? iF : iG;
+		const int iMove = iKeep == iF ? iG : iF;
+
+		up.child2 = iKeep;
+		if (diff > 1)
+			A->child2 = iMove;
+		else
+			A->child1 = iMove;
+		m_Nodes[iMove].parent = iA;
+
+		const TreeNode& o = m_Nodes[iOther];
+		const TreeNode& m = m_Nodes[iMove];
+		A->min = glm::min(o.min, m.min);
+		A->max = glm::max(o.max, m.max);
+		A->height = 1 + glm::max(o.height, m.height);
+
+		const TreeNode& k = m_Nodes[iKeep];
+		up.min = glm::min(A->min, k.min);
+		up.max = glm::max(A->max, k.max);
+		up.height = 1 + glm::max(A->height, k.height);
+
+		return iUp;
+	}
+
+	return iA;
+}
+
+void DynamicAABBTree::collectLeaves(int node, std::vector<int>* const* out, uint32 mask) const
+{
+	m_Stack.clear();
+	m_Stack.push_back(node);
+
+	while (!m_Stack.empty())
+	{
+		int index = m_Stack.back();
+		m_Stack.pop_back();
+
+		const TreeNode& n = m_Nodes[index];
+		if (n.IsLeaf())
+		{
+			for (int f = 0; f < MAX_TREE_QUERY_FRUSTUMS && (mask >> f); ++f)
+			{
+				if (mask & (1u << f))
+					out[f]->push_back(n.userData);
+			}
+		}
+		else
+		{
+			m_Stack.push_back(n.child1);
+			m_Stack.push_back(n.child2);
+		}
+	}
+}
+
+void DynamicAABBTree::Query(const Frustum& frustum, std::vector<int>& out, TreeQueryStats* stats) const
+{
+	const Frustum* frustums[1] = { &frustum };
+	std::vector<int>* outs[1] = { &out };
+	const size_t first = out.size();
+
+	uint32 visited = Query(frustums, outs, 1);
+
+	if (stats)
+	{
+		stats->nodesVisited = visited;
+		stats->visible = (uint32)(out.size() - first);
+	}
+}
+
+uint32 DynamicAABBTree::Query(const Frustum* const* frustums, std::vector<int>* const* out, int count) const
+{
+	if (count <= 0 || count > MAX_TREE_QUERY_FRUSTUMS || m_Root == NULL_TREE_NODE)
+		return 0;
+
+	uint32 visited = 0;
+	const uint32 all = count == 32 ? 0xffffffffu : (1u << count) - 1;
+
+	m_QueryStack.clear();
+	QueryEntry root = { m_Root, all, 0 };
+	m_QueryStack.push_back(root);
+
+	while (!m_QueryStack.empty())
+	{
+		QueryEntry entry = m_QueryStack.back();
+		m_QueryStack.pop_back();
+
+		const TreeNode& node = m_Nodes[entry.node];
+		++visited;
+
+		// Only frustums still undecided for this subtree are tested
+		uint32 pending = entry.active & ~entry.inside;
+		for (int f = 0; f < MAX_TREE_QUERY_FRUSTUMS && (pending >> f); ++f)
+		{
+			if (!(pending & (1u << f)))
+				continue;
+
+			switch (frustums[f]->TestBox(node.min, node.max))
+			{
+			case FRUSTUM_OUTSIDE:	entry.active &= ~(1u << f); break;
+			case FRUSTUM_INSIDE:	entry.inside |= 1u << f; break;
+			default: break;
+			}
+		}
+
+		if (entry.active == 0)
+			continue;
+
+		// Every frustum left holds the whole subtree, nothing more to test
+		if (node.IsLeaf() || entry.active == entry.inside)
+		{
+			collectLeaves(entry.node, out, entry.active);
+			continue;
+		}
+
+		QueryEntry child = entry;
+		child.node = node.child1;
+		m_QueryStack.push_back(child);
+		child.node = node.child2;
+		m_QueryStack.push_back(child);
+	}
+
+	return visited;
+}
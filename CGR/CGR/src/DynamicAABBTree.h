@@ -0,0 +1,112 @@
+#ifndef __DYNAMIC_AABB_TREE_H__
+#define __DYNAMIC_AABB_TREE_H__
+
+#include <vector>
+
+#include "types.h"
+
+class Frustum;
+
+#define NULL_TREE_NODE	-1
+
+// Most frustums one walk of the tree can answer, each takes a bit of a mask
+#define MAX_TREE_QUERY_FRUSTUMS	32
+
+struct TreeQueryStats
+{
+	uint32 nodesVisited;	// Nodes whose box was tested against the frustum
+	uint32 visible;			// Leaves returned
+};
+
+/*
+	Bounding volume hierarchy over fattened AABBs, updated incrementally. Leaves are stored with a
+	margin around the real box so small movements don't touch the tree, only an object leaving its
+	fat box is removed and reinserted. Inserts pick the sibling by surface area and the tree is kept
+	balanced with rotations on the way back up, so queries stay logarithmic as objects come and go.
+*/
+class DynamicAABBTree
+{
+	struct TreeNode
+	{
+		Vec3	min;
+		Vec3	max;
+		int		parent;		// Doubles as the next link while the node is on the free list
+		int		child1;
+		int		child2;
+		int		height;		// Leaves are 0, free nodes -1
+		int		userData;
+
+		bool IsLeaf() const { return child1 == NULL_TREE_NODE; }
+	};
+
+public:
+	DynamicAABBTree();
+	~DynamicAABBTree();
+
+	// Returns a proxy id that stays valid until it is destroyed
+	int					CreateProxy(const Vec3& min, const Vec3& max, int userData);
+	void				DestroyProxy(int proxy);
+
+	// Refits the proxy, returns true if the box escaped its fat box and the leaf was reinserted
+	bool				MoveProxy(int proxy, const Vec3& min, const Vec3& max);
+
+	int					GetUserData(int proxy) const;
+	void				SetUserData(int proxy, int userData);
+
+	// Appends the user data of every leaf touching the frustum. Subtrees wholly inside are taken without more tests
+	void				Query(const Frustum& frustum, std::vector<int>& out, TreeQueryStats* stats = nullptr) const;
+
+	// Same, for several frustums in one walk, out[i] gets the leaves touching frustums[i]. A node is only
+	// tested against the frustums it hasn't already been found outside or wholly inside of. Returns nodes visited
+	uint32				Query(const Frustum* const* frustums, std::vector<int>* const* out, int count) const;
+
+	void				Clear();
+	int					NumProxies() const;
+	int					Height() const;
+
+private:
+	int					allocateNode();
+	void				freeNode(int node);
+	void				insertLeaf(int leaf);
+	void				removeLeaf(int leaf);
+	int					balance(int node);
+	void				refit(int node);
+	void				collectLeaves(int node, std::vector<int>* const* out, uint32 mask) const;
+
+private:
+	struct QueryEntry
+	{
+		int		node;
+		uint32	active;		// Frustums the node may still touch
+		uint32	inside;		// Of those, the ones already known to hold it entirely
+	};
+
+	std::vector<TreeNode>	m_Nodes;
+	int						m_Root;
+	int						m_FreeList;
+	int						m_NumProxies;
+	mutable std::vector<int> m_Stack;
+	mutable std::vector<QueryEntry> m_QueryStack;
+};
+
+INLINE int DynamicAABBTree::GetUserData(int proxy) const
+{
+	return m_Nodes[proxy].userData;
+}
+
+INLINE void DynamicAABBTree::SetUserData(int proxy, int userData)
+{
+	m_Nodes[proxy].userData = userData;
+}
+
+INLINE int DynamicAABBTree::NumProxies() const
+{
+	return m_NumProxies;
+}
+
+INLINE int DynamicAABBTree::Height() const
+{
+	return m_Root == NULL_TREE_NODE ? 0 : m_Nodes[m_Root].height;
+}
+
+#endif
@@ -0,0 +1,53 @@
+#include "DynamicBuffer.h"
+
+#include <algorithm>
+#include "OpenGlLayer.h"
+
+DynamicBuffer::DynamicBuffer() :
+	m_Target(GL_ARRAY_BUFFER),
+	m_Buffer(0),
+	m_Capacity(0)
+{
+}
+
+DynamicBuffer::~DynamicBuffer()
+{
+}
+
+bool DynamicBuffer::Init(GLenum target)
+{
+	m_Target = target;
+	m_Capacity = 0;
+	OpenGLLayer::device()->GenBuffers(1, &m_Buffer);
+	return m_Buffer != 0;
+}
+
+void DynamicBuffer::Close()
+{
+	OpenGLLayer::clean_GL_buffer(&m_Buffer, 1);
+	m_Capacity = 0;
+}
+
+void DynamicBuffer::Reserve(size_t bytes, size_t minBytes)
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->BindBuffer(m_Target, m_Buffer);
+
+	if (bytes > m_Capacity || m_Capacity < minBytes)
+	{
+		m_Capacity = std::max(bytes * 2, minBytes);
+		gl->BufferData(m_Target, m_Capacity, nullptr, GL_STREAM_DRAW);
+	}
+}
+
+void DynamicBuffer::Upload(const void* data, size_t bytes, size_t minBytes)
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	this->Reserve(bytes, minBytes);
+	if (bytes)
+		gl->BufferSubData(m_Target, 0, bytes, data);
+
+	gl->BindBuffer(m_Target, 0);
+}
@@ -0,0 +1,45 @@
+#ifndef __DYNAMIC_BUFFER_H__
+#define __DYNAMIC_BUFFER_H__
+
+#include "gl_headers.h"
+#include "types.h"
+
+/*
+	A GL buffer rewritten from the CPU every frame or pass. The store is only reallocated, orphaning the old
+	one, when an upload outgrows it and then at twice the size, otherwise each upload overwrites its start.
+*/
+class DynamicBuffer
+{
+public:
+	DynamicBuffer();
+	~DynamicBuffer();
+
+	bool		Init(GLenum target);
+	void		Close();
+
+	// Binds the buffer and makes sure it holds bytes, and never less than minBytes so the buffer always has a
+	// store to bind. Left bound for the caller's writes
+	void		Reserve(size_t bytes, size_t minBytes = 0);
+	// Reserves, writes the data at the start and unbinds
+	void		Upload(const void* data, size_t bytes, size_t minBytes = 0);
+
+	GLuint		Handle() const;
+	size_t		Capacity() const;
+
+private:
+	GLenum		m_Target;
+	GLuint		m_Buffer;
+	size_t		m_Capacity;
+};
+
+INLINE GLuint DynamicBuffer::Handle() const
+{
+	return m_Buffer;
+}
+
+INLINE size_t DynamicBuffer::Capacity() const
+{
+	return m_Capacity;
+}
+
+#endif
@@ -1,37 +1,55 @@
 #ifndef __FONT_H__
 #define __FONT_H__
 
-#include <map>
 #include <string>
 #include "gl_headers.h"
+#include "types.h"
+#include "GlyphAtlas.h"
 
-#include <ft2build.h>
-#include FT_FREETYPE_H
-
-struct Character
-{
-	GLuint textureID;
-	int sizeX;
-	int sizeY;
-	int bearingX;
-	int bearingY;
-	signed long advance;
-};
+// Preloaded when a font is created, anything else is added to the atlas the first time it's drawn
+#define FONT_PRELOAD_FIRST	32
+#define FONT_PRELOAD_LAST	126
 
+/*
+	A face at a pixel size. The glyphs live in the shared atlas as distance fields at SDF_BASE_SIZE, so every
+	size of the same face uses the same glyphs and only scales their metrics.
+*/
 class Font
 {
 public:
 	Font();
 	~Font();
 
-	bool CreateFont(const std::string& font, int fontSize);
+	bool CreateFont(GlyphAtlas* atlas, const std::string& font, int fontSize);
 	void Close();
 
+	// Makes sure a range of codepoints is in the atlas before it's needed, e.g. a language's alphabet
+	bool				Preload(uint32 first, uint32 last);
+
+	const Glyph&		GetGlyph(uint32 codepoint) const;
+	// Base pixels to this font's pixels
+	float				Scale() const;
+	GLuint				Atlas() const;
+
 private:
-	friend class Renderer;
-	std::map<GLchar, Character>		m_Characters;
-	GLuint							m_Vao;
-	GLuint							m_Vbo;
+	GlyphAtlas*			m_Atlas;
+	int					m_Face;
+	float				m_Scale;
 };
 
-#endif
\ No newline at end of file
+INLINE const Glyph& Font::GetGlyph(uint32 codepoint) const
+{
+	return m_Atlas->GetGlyph(m_Face, codepoint);
+}
+
+INLINE float Font::Scale() const
+{
+	return m_Scale;
+}
+
+INLINE GLuint Font::Atlas() const
+{
+	return m_Atlas->Texture();
+}
+
+#endif
@@ -0,0 +1,501 @@
+#include "FrameGraph.h"
+
+#include "LogFile.h"
+#include "OpenGlLayer.h"
+#include "GpuTimers.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+FrameGraph::FrameGraph() :
+	m_Resources(),
+	m_Passes(),
+	m_Pool(),
+	m_Framebuffers(),
+	m_DrawBuffers(),
+	m_Stats(),
+	m_CurrentPass(-1),
+	m_Frame(0),
+	m_Compiled(false)
+{
+}
+
+FrameGraph::~FrameGraph()
+{
+}
+
+bool FrameGraph::Init()
+{
+	m_DrawBuffers.reserve(FRAME_GRAPH_MAX_COLOUR);
+	return true;
+}
+
+void FrameGraph::Close()
+{
+	ReleaseTextures();
+	Reset();
+}
+
+void FrameGraph::Reset()
+{
+	m_Resources.clear();
+	m_Passes.clear();
+	m_CurrentPass = -1;
+	m_Compiled = false;
+}
+
+void FrameGraph::ReleaseTextures()
+{
+	for (size_t i = 0; i < m_Framebuffers.size(); ++i)
+		OpenGLLayer::clean_GL_fbo(&m_Framebuffers[i].fbo, 1);
+
+	for (size_t i = 0; i < m_Pool.size(); ++i)
+		OpenGLLayer::clean_GL_texture(&m_Pool[i].texture, 1);
+
+	m_Framebuffers.clear();
+	m_Pool.clear();
+
+	// Anything handed out this frame is gone with them
+	for (size_t i = 0; i < m_Resources.size(); ++i)
+	{
+		if (!m_Resources[i].imported)
+			m_Resources[i].texture = 0;
+	}
+}
+
+FrameGraphHandle FrameGraph::Create(const char* name, const FrameGraphTextureDesc& desc)
+{
+	Resource r = { name, desc, false, 0, -1, -1 };
+	m_Resources.push_back(r);
+	return (FrameGraphHandle)m_Resources.size() - 1;
+}
+
+FrameGraphHandle FrameGraph::Import(const char* name, GLuint texture, GLsizei width, GLsizei height)
+{
+	FrameGraphTextureDesc desc = { width, height, 0, 0, 0, 0 };
+	Resource r = { name, desc, true, texture, -1, -1 };
+	m_Resources.push_back(r);
+	return (FrameGraphHandle)m_Resources.size() - 1;
+}
+
+uint32 FrameGraph::AddPass(const char* name, FrameGraphExecute execute)
+{
+	Pass p;
+	p.name = name;
+	p.execute = execute;
+	p.sideEffect = false;
+	p.live = false;
+	m_Passes.push_back(p);
+	return (uint32)m_Passes.size() - 1;
+}
+
+void FrameGraph::Read(uint32 pass, FrameGraphHandle handle, GLenum unit)
+{
+	Access a = { handle, unit, false };
+	m_Passes[pass].reads.push_back(a);
+}
+
+void FrameGraph::ReadAttachment(uint32 pass, FrameGraphHandle handle)
+{
+	Access a = { handle, 0, true };
+	m_Passes[pass].reads.push_back(a);
+}
+
+void FrameGraph::Write(uint32 pass, FrameGraphHandle handle)
+{
+	Access a = { handle, 0, true };
+	m_Passes[pass].writes.push_back(a);
+}
+
+void FrameGraph::SetSideEffect(uint32 pass)
+{
+	m_Passes[pass].sideEffect = true;
+}
+
+void FrameGraph::Compile()
+{
+	PROFILE_ZONE("FrameGraph::Compile");
+
+	memset(&m_Stats, 0, sizeof(FrameGraphStats));
+	m_Stats.passes = (uint32)m_Passes.size();
+
+	// Walk back from the outputs, a pass lives if something after it that lives reads what it writes
+	std::vector<bool> needed(m_Resources.size(), false);
+
+	for (int i = (int)m_Passes.size() - 1; i >= 0; --i)
+	{
+		Pass& pass = m_Passes[i];
+		pass.live = pass.sideEffect;
+
+		for (size_t w = 0; w < pass.writes.size() && !pass.live; ++w)
+		{
+			const FrameGraphHandle h = pass.writes[w].handle;
+			pass.live = m_Resources[h].imported || needed[h];
+		}
+
+		if (!pass.live)
+		{
+			++m_Stats.culled;
+			continue;
+		}
+
+		for (size_t r = 0; r < pass.reads.size(); ++r)
+			needed[pass.reads[r].handle] = true;
+	}
+
+	for (size_t i = 0; i < m_Passes.size(); ++i)
+	{
+		Pass& pass = m_Passes[i];
+		if (!pass.live)
+			continue;
+
+		// Sampling something the pass has attached is a feedback loop, the results are undefined
+		for (size_t r = 0; r < pass.reads.size(); ++r)
+		{
+			if (pass.reads[r].attachment)
+				continue;
+
+			for (size_t w = 0; w < pass.writes.size(); ++w)
+			{
+				if (pass.writes[w].handle == pass.reads[r].handle)
+				{
+					WRITE_LOG(std::string("Frame graph pass ") + pass.name + " samples a texture it writes: " + m_Resources[pass.reads[r].handle].name, "error");
+					pass.live = false;
+				}
+			}
+		}
+
+		if (!pass.live)
+			continue;
+
+		auto use = [&](const Access& a)
+		{
+			Resource& res = m_Resources[a.handle];
+			if (res.firstPass < 0)
+				res.firstPass = (int)i;
+			res.lastPass = (int)i;
+		};
+
+		std::for_each(pass.reads.begin(), pass.reads.end(), use);
+		std::for_each(pass.writes.begin(), pass.writes.end(), use);
+	}
+
+	assignTextures();
+	m_Compiled = true;
+}
+
+void FrameGraph::assignTextures()
+{
+	for (size_t i = 0; i < m_Pool.size(); ++i)
+		m_Pool[i].busyUntil = -1;
+
+	// Hand out in order of first use so a texture freed by an earlier pass is there for a later one
+	std::vector<uint32> order;
+	for (size_t i = 0; i < m_Resources.size(); ++i)
+	{
+		if (!m_Resources[i].imported && m_Resources[i].firstPass >= 0)
+			order.push_back((uint32)i);
+	}
+
+	std::sort(order.begin(), order.end(), [this](uint32 a, uint32 b)
+	{
+		return m_Resources[a].firstPass < m_Resources[b].firstPass;
+	});
+
+	for (size_t o = 0; o < order.size(); ++o)
+	{
+		Resource& res = m_Resources[order[o]];
+		PooledTexture* found = nullptr;
+
+		for (size_t p = 0; p < m_Pool.size() && !found; ++p)
+		{
+			if (m_Pool[p].busyUntil < res.firstPass && sameDesc(m_Pool[p].desc, res.desc))
+				found = &m_Pool[p];
+		}
+
+		if (!found)
+		{
+			PooledTexture t = { res.desc, createTexture(res.desc), -1, m_Frame };
+			m_Pool.push_back(t);
+			found = &m_Pool.back();
+		}
+
+		found->busyUntil = res.lastPass;
+		found->lastFrame = m_Frame;
+		res.texture = found->texture;
+
+		++m_Stats.transients;
+		m_Stats.requestedBytes += textureBytes(res.desc);
+	}
+
+	m_Stats.textures = (uint32)m_Pool.size();
+	for (size_t p = 0; p < m_Pool.size(); ++p)
+		m_Stats.allocatedBytes += textureBytes(m_Pool[p].desc);
+}
+
+void FrameGraph::Execute(GpuTimers* timers)
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	if (!m_Compiled)
+		Compile();
+
+	for (size_t i = 0; i < m_Passes.size(); ++i)
+	{
+		const Pass& pass = m_Passes[i];
+		if (!pass.live)
+			continue;
+
+		PROFILE_ZONE(pass.name);
+		gl->PushMarker(pass.name);
+		if (timers)
+			timers->Begin(pass.name);
+
+		m_CurrentPass = (int)i;
+		bindPass(pass);
+		pass.execute(*this);
+
+		if (timers)
+			timers->End();
+		gl->PopMarker();
+	}
+
+	m_CurrentPass = -1;
+	gl->BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	retireTextures();
+	++m_Frame;
+}
+
+void FrameGraph::bindPass(const Pass& pass)
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	GLuint colour[FRAME_GRAPH_MAX_COLOUR];
+	uint32 numColour = 0;
+	GLuint depth = 0;
+	bool backBuffer = false;
+	const FrameGraphTextureDesc* size = nullptr;
+
+	auto attach = [&](const Access& a)
+	{
+		const Resource& res = m_Resources[a.handle];
+		if (res.imported && res.texture == 0)
+		{
+			backBuffer = true;
+			size = &res.desc;
+		}
+		else if (isDepth(res.desc.format))
+		{
+			depth = res.texture;
+			size = size ? size : &res.desc;
+		}
+		else if (numColour < FRAME_GRAPH_MAX_COLOUR)
+		{
+			colour[numColour++] = res.texture;
+			size = size ? size : &res.desc;
+		}
+	};
+
+	// Writes come first so the colour attachment order is the order they were declared in
+	std::for_each(pass.writes.begin(), pass.writes.end(), attach);
+	for (size_t r = 0; r < pass.reads.size(); ++r)
+	{
+		if (pass.reads[r].attachment)
+			attach(pass.reads[r]);
+	}
+
+	if (backBuffer)
+	{
+		gl->BindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+	else if (size)
+	{
+		gl->BindFramebuffer(GL_FRAMEBUFFER, framebuffer(colour, numColour, depth));
+
+		// Draw buffers belong to the frame buffer, a pass may have changed them last frame
+		m_DrawBuffers.clear();
+		for (uint32 c = 0; c < numColour; ++c)
+			m_DrawBuffers.push_back(GL_COLOR_ATTACHMENT0 + c);
+
+		if (numColour > 0)
+			gl->DrawBuffers((GLsizei)numColour, m_DrawBuffers.data());
+		else
+			gl->DrawBuffer(GL_NONE);
+	}
+
+	if (size)
+		gl->Viewport(0, 0, size->width, size->height);
+
+	for (size_t r = 0; r < pass.reads.size(); ++r)
+	{
+		if (pass.reads[r].attachment)
+			continue;
+
+		gl->ActiveTexture(pass.reads[r].unit);
+		gl->BindTexture(GL_TEXTURE_2D, m_Resources[pass.reads[r].handle].texture);
+	}
+
+	gl->ActiveTexture(GL_TEXTURE0);
+}
+
+GLuint FrameGraph::Texture(FrameGraphHandle handle) const
+{
+	return handle < m_Resources.size() ? m_Resources[handle].texture : 0;
+}
+
+GLenum FrameGraph::ColourAttachment(FrameGraphHandle handle) const
+{
+	if (m_CurrentPass < 0)
+		return GL_NONE;
+
+	// Same order bindPass attached them in
+	const Pass& pass = m_Passes[m_CurrentPass];
+	GLenum next = GL_COLOR_ATTACHMENT0;
+
+	for (size_t i = 0; i < pass.writes.size() + pass.reads.size(); ++i)
+	{
+		const Access& a = i < pass.writes.size() ? pass.writes[i] : pass.reads[i - pass.writes.size()];
+		const Resource& res = m_Resources[a.handle];
+
+		if (!a.attachment || isDepth(res.desc.format) || (res.imported && res.texture == 0))
+			continue;
+
+		if (a.handle == handle)
+			return next;
+
+		++next;
+	}
+
+	return GL_NONE;
+}
+
+GLuint FrameGraph::ReadFramebuffer(FrameGraphHandle handle) const
+{
+	GLuint texture = Texture(handle);
+	return texture ? framebuffer(&texture, 1, 0) : 0;
+}
+
+GLuint FrameGraph::framebuffer(const GLuint* colour, uint32 numColour, GLuint depth) const
+{
+	for (size_t i = 0; i < m_Framebuffers.size(); ++i)
+	{
+		const Framebuffer& f = m_Framebuffers[i];
+		if (f.numColour == numColour && f.depth == depth && std::equal(colour, colour + numColour, f.colour))
+			return f.fbo;
+	}
+
+	RenderDevice* gl = OpenGLLayer::device();
+
+	Framebuffer f;
+	memset(&f, 0, sizeof(Framebuffer));
+	std::copy(colour, colour + numColour, f.colour);
+	f.numColour = numColour;
+	f.depth = depth;
+
+	// Built on the read binding so a pass asking for a blit source doesn't lose its draw target
+	gl->GenFramebuffers(1, &f.fbo);
+	gl->BindFramebuffer(GL_READ_FRAMEBUFFER, f.fbo);
+
+	for (uint32 c = 0; c < numColour; ++c)
+		gl->FramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + c, GL_TEXTURE_2D, colour[c], 0);
+
+	if (depth)
+	{
+		GLenum attachment = GL_DEPTH_ATTACHMENT;
+		for (size_t p = 0; p < m_Pool.size(); ++p)
+		{
+			if (m_Pool[p].texture == depth && m_Pool[p].desc.format == GL_DEPTH_STENCIL)
+				attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+		}
+
+		gl->FramebufferTexture2D(GL_READ_FRAMEBUFFER, attachment, GL_TEXTURE_2D, depth, 0);
+	}
+
+	gl->ReadBuffer(numColour > 0 ? GL_COLOR_ATTACHMENT0 : GL_NONE);
+
+	if (gl->CheckFramebufferStatus(GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		WRITE_LOG("Frame graph frame buffer is incomplete", "error");
+
+	gl->BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+	m_Framebuffers.push_back(f);
+	return f.fbo;
+}
+
+GLuint FrameGraph::createTexture(const FrameGraphTextureDesc& desc)
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	GLuint texture = 0;
+	gl->GenTextures(1, &texture);
+	gl->BindTexture(GL_TEXTURE_2D, texture);
+	gl->TexImage2D(GL_TEXTURE_2D, 0, desc.internalFormat, desc.width, desc.height, 0, desc.format, desc.type, NULL);
+	gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, desc.filter);
+	gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, desc.filter);
+	gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	gl->BindTexture(GL_TEXTURE_2D, 0);
+
+	return texture;
+}
+
+void FrameGraph::retireTextures()
+{
+	for (size_t p = 0; p < m_Pool.size();)
+	{
+		if (m_Frame - m_Pool[p].lastFrame < FRAME_GRAPH_RETIRE_FRAMES)
+		{
+			++p;
+			continue;
+		}
+
+		const GLuint texture = m_Pool[p].texture;
+
+		for (size_t f = 0; f < m_Framebuffers.size();)
+		{
+			const Framebuffer& fb = m_Framebuffers[f];
+			if (fb.depth == texture || std::find(fb.colour, fb.colour + fb.numColour, texture) != fb.colour + fb.numColour)
+			{
+				OpenGLLayer::clean_GL_fbo(&m_Framebuffers[f].fbo, 1);
+				m_Framebuffers.erase(m_Framebuffers.begin() + f);
+			}
+			else
+			{
+				++f;
+			}
+		}
+
+		OpenGLLayer::clean_GL_texture(&m_Pool[p].texture, 1);
+		m_Pool.erase(m_Pool.begin() + p);
+	}
+}
+
+bool FrameGraph::isDepth(GLenum format)
+{
+	return format == GL_DEPTH_COMPONENT || format == GL_DEPTH_STENCIL;
+}
+
+bool FrameGraph::sameDesc(const FrameGraphTextureDesc& a, const FrameGraphTextureDesc& b)
+{
+	return a.width == b.width && a.height == b.height && a.internalFormat == b.internalFormat &&
+		a.format == b.format && a.type == b.type && a.filter == b.filter;
+}
+
+uint64 FrameGraph::textureBytes(const FrameGraphTextureDesc& desc)
+{
+	uint64 texel = 4;
+	switch (desc.internalFormat)
+	{
+	case GL_R8:
+	case GL_RED:				texel = 1; break;
+	case GL_RGBA16F:
+	case GL_DEPTH32F_STENCIL8:	texel = 8; break;
+	case GL_RGB32F:				texel = 12; break;
+	case GL_RGBA32F:			texel = 16; break;
+	default:					texel = 4; break;
+	}
+
+	return texel * desc.width * desc.height;
+}
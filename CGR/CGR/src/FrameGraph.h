@@ -0,0 +1,165 @@
+#ifndef __FRAME_GRAPH_H__
+#define __FRAME_GRAPH_H__
+
+#include <vector>
+#include <functional>
+#include "gl_headers.h"
+#include "types.h"
+
+class FrameGraph;
+class GpuTimers;
+
+typedef uint32 FrameGraphHandle;
+
+#define FRAME_GRAPH_INVALID			0xffffffff
+// Colour attachments a pass can write at once, the g-buffer uses four
+#define FRAME_GRAPH_MAX_COLOUR		4
+// Frames a pooled texture can sit unused before it's deleted, e.g. the g-buffer after switching to forward
+#define FRAME_GRAPH_RETIRE_FRAMES	3
+
+struct FrameGraphTextureDesc
+{
+	GLsizei	width;
+	GLsizei	height;
+	GLint	internalFormat;
+	GLenum	format;
+	GLenum	type;
+	GLint	filter;
+};
+
+struct FrameGraphStats
+{
+	uint32	passes;
+	uint32	culled;
+	uint32	transients;		// Transient textures the live passes declared
+	uint32	textures;		// Textures the pool actually holds
+	uint64	requestedBytes;	// What the transients would take with a texture each
+	uint64	allocatedBytes;	// What the pool holds after aliasing
+};
+
+typedef std::function<void(const FrameGraph&)> FrameGraphExecute;
+
+/*
+	Passes are added each frame with the textures they read and write, then the graph is compiled and run.
+	Compiling walks back from the passes that write an imported target (the back buffer) or are flagged as
+	having side effects and drops any pass nothing live depends on. Transient textures only exist from their
+	first live use to their last, so each is given a pooled texture of the same description that no other
+	transient is using over that range, and textures the graph stops asking for are deleted after a few frames.
+	A transient's contents are undefined when its first pass starts, that pass has to clear or cover it.
+
+	Before a pass runs the graph binds a frame buffer made from what it writes and attaches for depth, sets the
+	draw buffers and viewport and binds its sampled reads to their units, so a pass only issues its own draws.
+	GL orders attachment writes before later sampling on its own, the graph's part is making sure no pass
+	samples a texture it has attached.
+*/
+class FrameGraph
+{
+	struct Resource
+	{
+		const char*				name;
+		FrameGraphTextureDesc	desc;
+		bool					imported;
+		GLuint					texture;	// Imported or assigned at compile, 0 for the back buffer
+		int						firstPass;
+		int						lastPass;
+	};
+
+	struct Access
+	{
+		FrameGraphHandle		handle;
+		GLenum					unit;		// Sampled reads only
+		bool					attachment;
+	};
+
+	struct Pass
+	{
+		const char*				name;
+		FrameGraphExecute		execute;
+		std::vector<Access>		reads;
+		std::vector<Access>		writes;
+		bool					sideEffect;
+		bool					live;
+	};
+
+	struct PooledTexture
+	{
+		FrameGraphTextureDesc	desc;
+		GLuint					texture;
+		int						busyUntil;	// Last pass this frame using it, -1 when free
+		uint32					lastFrame;
+	};
+
+	struct Framebuffer
+	{
+		GLuint					fbo;
+		GLuint					colour[FRAME_GRAPH_MAX_COLOUR];
+		uint32					numColour;
+		GLuint					depth;
+	};
+
+public:
+	FrameGraph();
+	~FrameGraph();
+
+	bool						Init();
+	void						Close();
+
+	// Drops the passes and resources of the last frame, the pooled textures stay for reuse
+	void						Reset();
+	// Deletes every pooled texture and frame buffer, for when the screen size changes
+	void						ReleaseTextures();
+
+	FrameGraphHandle			Create(const char* name, const FrameGraphTextureDesc& desc);
+	// A texture the graph doesn't own, 0 is the back buffer. Writing one keeps the pass alive
+	FrameGraphHandle			Import(const char* name, GLuint texture, GLsizei width, GLsizei height);
+
+	uint32						AddPass(const char* name, FrameGraphExecute execute);
+	// Sampled in the pass, bound to the unit before it runs
+	void						Read(uint32 pass, FrameGraphHandle handle, GLenum unit);
+	// Attached but not written, e.g. a depth buffer only tested against
+	void						ReadAttachment(uint32 pass, FrameGraphHandle handle);
+	// Colour writes are attached in the order they are declared
+	void						Write(uint32 pass, FrameGraphHandle handle);
+	// Kept even when nothing reads what it writes
+	void						SetSideEffect(uint32 pass);
+
+	void						Compile();
+	// Each live pass is timed under its name when given the timers
+	void						Execute(GpuTimers* timers = nullptr);
+
+	// For use inside a pass
+	GLuint						Texture(FrameGraphHandle handle) const;
+	GLenum						ColourAttachment(FrameGraphHandle handle) const;
+	// A frame buffer with just this texture at colour attachment 0, as a blit source
+	GLuint						ReadFramebuffer(FrameGraphHandle handle) const;
+
+	const FrameGraphStats&		Stats() const;
+
+private:
+	void						assignTextures();
+	GLuint						createTexture(const FrameGraphTextureDesc& desc);
+	GLuint						framebuffer(const GLuint* colour, uint32 numColour, GLuint depth) const;
+	void						bindPass(const Pass& pass);
+	void						retireTextures();
+	static bool					isDepth(GLenum format);
+	static bool					sameDesc(const FrameGraphTextureDesc& a, const FrameGraphTextureDesc& b);
+	static uint64				textureBytes(const FrameGraphTextureDesc& desc);
+
+private:
+	std::vector<Resource>				m_Resources;
+	std::vector<Pass>					m_Passes;
+	std::vector<PooledTexture>			m_Pool;
+	mutable std::vector<Framebuffer>	m_Framebuffers;
+	std::vector<GLenum>					m_DrawBuffers;
+	FrameGraphStats						m_Stats;
+	int									m_CurrentPass;
+	uint32								m_Frame;
+	bool								m_Compiled;
+};
+
+INLINE const FrameGraphStats& FrameGraph::Stats() const
+{
+	return m_Stats;
+}
+
+#endif
@@ -2,8 +2,60 @@
 
 #include "math_utils.h"
 
+// SSE is always there on the platforms we build for, AVX only when the compiler is told it can use it (/arch:AVX)
+#if defined(__AVX__)
+#define FRUSTUM_AVX
+#include <immintrin.h>
+#elif defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define FRUSTUM_SSE
+#include <xmmintrin.h>
+#endif
+
+// ---- SoA containers ----
+void SphereArrays::Clear()
+{
+	x.clear(); y.clear(); z.clear(); radius.clear();
+}
+
+void SphereArrays::Reserve(size_t count)
+{
+	x.reserve(count); y.reserve(count); z.reserve(count); radius.reserve(count);
+}
+
+void SphereArrays::Push(const Vec3& centre, float r)
+{
+	x.push_back(centre.x);
+	y.push_back(centre.y);
+	z.push_back(centre.z);
+	radius.push_back(r);
+}
+
+void BoxArrays::Clear()
+{
+	minX.clear(); minY.clear(); minZ.clear();
+	maxX.clear(); maxY.clear(); maxZ.clear();
+}
+
+void BoxArrays::Reserve(size_t count)
+{
+	minX.reserve(count); minY.reserve(count); minZ.reserve(count);
+	maxX.reserve(count); maxY.reserve(count); maxZ.reserve(count);
+}
+
+void BoxArrays::Push(const Vec3& min, const Vec3& max)
+{
+	minX.push_back(min.x); minY.push_back(min.y); minZ.push_back(min.z);
+	maxX.push_back(max.x); maxY.push_back(max.y); maxZ.push_back(max.z);
+}
+
+// ---- Frustum ----
+
 Frustum::Frustum()
 {
+	for (int i = 0; i < NumPlanes; ++i)
+	{
+		planeX[i] = planeY[i] = planeZ[i] = planeD[i] = 0.0f;
+	}
 }
 
 Frustum::~Frustum()
@@ -63,9 +115,29 @@ void Frustum::UpdateFrustum(const Mat4& proj, const Mat4& view)
 			temp[1][3] + temp[1][1],
 			temp[2][3] + temp[2][1],
 			temp[3][3] + temp[3][1]));
+
+	for (int i = 0; i < NumPlanes; ++i)
+	{
+		planeX[i] = planes[i].a;
+		planeY[i] = planes[i].b;
+		planeZ[i] = planes[i].c;
+		planeD[i] = planes[i].d;
+	}
+}
+
+void Frustum::ExtrudeNear()
+{
+	// A plane everything is in front of, written directly as Set would normalise the zero normal
+	Plane& nearPlane = planes[Near];
+	nearPlane.a = nearPlane.b = nearPlane.c = 0.0f;
+	nearPlane.d = 1.0f;
+	nearPlane.norm = Vec3(0.0f);
+
+	planeX[Near] = planeY[Near] = planeZ[Near] = 0.0f;
+	planeD[Near] = 1.0f;
 }
 
-bool Frustum::IsPointWithinFrustum(const Vec3& pos)
+bool Frustum::IsPointWithinFrustum(const Vec3& pos) const
 {
 	for (auto i = planes.begin(); i != planes.end(); ++i)
 	{
@@ -78,7 +150,7 @@ bool Frustum::IsPointWithinFrustum(const Vec3& pos)
 	return true;
 }
 
-bool Frustum::SphereInFrustum(const Vec3& centre, float r)
+bool Frustum::SphereInFrustum(const Vec3& centre, float r) const
 {
 	for (auto i = planes.begin(); i != planes.end(); ++i)
 	{
@@ -91,15 +163,214 @@ bool Frustum::SphereInFrustum(const Vec3& centre, float r)
 	return true;
 }
 
-bool Frustum::BoxInFrustum(AABox &b, bool checkIntersections)
+bool Frustum::SweptSphereInFrustum(const Vec3& centre, float r, const Vec3& dir) const
 {
+	// Only a plane the sphere starts behind and never moves towards can rule the sweep out
 	for (auto i = planes.begin(); i != planes.end(); ++i)
 	{
-		if( ( (*i).Distance(b.min) < 0.0f ) )
+		if ((*i).Distance(centre) <= -r && i->a * dir.x + i->b * dir.y + i->c * dir.z <= 0.0f)
 		{
 			return false;
 		}
 	}
 
 	return true;
-}
\ No newline at end of file
+}
+
+size_t Frustum::CullSweptSpheres(const SphereArrays& spheres, const Vec3& dir, std::vector<uint32>& visibleMask) const
+{
+	size_t hidden = 0;
+	const size_t count = spheres.Size();
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (!IsVisible(visibleMask, i))
+			continue;
+
+		if (!SweptSphereInFrustum(Vec3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i], dir))
+		{
+			visibleMask[i >> 5] &= ~(1u << (i & 31));
+			++hidden;
+		}
+	}
+
+	return hidden;
+}
+
+FrustumTest Frustum::TestBox(const Vec3& min, const Vec3& max) const
+{
+	FrustumTest result = FRUSTUM_INSIDE;
+
+	for (auto i = planes.begin(); i != planes.end(); ++i)
+	{
+		// The corner furthest along the normal (p) and the one furthest against it (n)
+		Vec3 p(i->a >= 0.0f ? max.x : min.x, i->b >= 0.0f ? max.y : min.y, i->c >= 0.0f ? max.z : min.z);
+		Vec3 n(i->a >= 0.0f ? min.x : max.x, i->b >= 0.0f ? min.y : max.y, i->c >= 0.0f ? min.z : max.z);
+
+		if ((*i).Distance(p) < 0.0f)
+			return FRUSTUM_OUTSIDE;
+
+		if ((*i).Distance(n) < 0.0f)
+			result = FRUSTUM_INTERSECT;
+	}
+
+	return result;
+}
+
+bool Frustum::BoxInFrustum(const AABox& b, bool checkIntersections) const
+{
+	// With checkIntersections only boxes entirely inside pass
+	FrustumTest t = TestBox(b.min, b.max);
+	return checkIntersections ? t == FRUSTUM_INSIDE : t != FRUSTUM_OUTSIDE;
+}
+
+void Frustum::CullSpheresScalar(const SphereArrays& spheres, std::vector<uint32>& visibleMask) const
+{
+	const size_t count = spheres.Size();
+	visibleMask.assign((count + 31) / 32, 0);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (SphereInFrustum(Vec3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i]))
+			visibleMask[i >> 5] |= 1u << (i & 31);
+	}
+}
+
+void Frustum::CullBoxesScalar(const BoxArrays& boxes, std::vector<uint32>& visibleMask) const
+{
+	const size_t count = boxes.Size();
+	visibleMask.assign((count + 31) / 32, 0);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		Vec3 min(boxes.minX[i], boxes.minY[i], boxes.minZ[i]);
+		Vec3 max(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]);
+
+		if (TestBox(min, max) != FRUSTUM_OUTSIDE)
+			visibleMask[i >> 5] |= 1u << (i & 31);
+	}
+}
+
+void Frustum::CullSpheres(const SphereArrays& spheres, std::vector<uint32>& visibleMask) const
+{
+	const size_t count = spheres.Size();
+	visibleMask.assign((count + 31) / 32, 0);
+
+	size_t i = 0;
+
+#if defined(FRUSTUM_AVX)
+	// 8 spheres against all planes, visible while distance > -radius for every plane
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 cx = _mm256_loadu_ps(&spheres.x[i]);
+		__m256 cy = _mm256_loadu_ps(&spheres.y[i]);
+		__m256 cz = _mm256_loadu_ps(&spheres.z[i]);
+		__m256 nr = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+		for (int p = 0; p < NumPlanes; ++p)
+		{
+			__m256 d = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(cx, _mm256_set1_ps(planeX[p])), _mm256_mul_ps(cy, _mm256_set1_ps(planeY[p]))),
+				_mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(planeZ[p])), _mm256_set1_ps(planeD[p])));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, nr, _CMP_GT_OQ));
+		}
+
+		visibleMask[i >> 5] |= (uint32)_mm256_movemask_ps(inside) << (i & 31);
+	}
+#elif defined(FRUSTUM_SSE)
+	// 4 spheres against all planes, visible while distance > -radius for every plane
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 cx = _mm_loadu_ps(&spheres.x[i]);
+		__m128 cy = _mm_loadu_ps(&spheres.y[i]);
+		__m128 cz = _mm_loadu_ps(&spheres.z[i]);
+		__m128 nr = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+		__m128 inside = _mm_cmpeq_ps(cx, cx);
+
+		for (int p = 0; p < NumPlanes; ++p)
+		{
+			__m128 d = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(planeX[p])), _mm_mul_ps(cy, _mm_set1_ps(planeY[p]))),
+				_mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(planeZ[p])), _mm_set1_ps(planeD[p])));
+			inside = _mm_and_ps(inside, _mm_cmpgt_ps(d, nr));
+		}
+
+		visibleMask[i >> 5] |= (uint32)_mm_movemask_ps(inside) << (i & 31);
+	}
+#endif
+
+	// Whatever doesn't fill a register
+	for (; i < count; ++i)
+	{
+		if (SphereInFrustum(Vec3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i]))
+			visibleMask[i >> 5] |= 1u << (i & 31);
+	}
+}
+
+void Frustum::CullBoxes(const BoxArrays& boxes, std::vector<uint32>& visibleMask) const
+{
+	const size_t count = boxes.Size();
+	visibleMask.assign((count + 31) / 32, 0);
+
+	// The p-vertex picks min or max per axis from the sign of the plane normal, which is the same for
+	// every box so it is chosen once per plane rather than per lane
+	const float* px[NumPlanes];
+	const float* py[NumPlanes];
+	const float* pz[NumPlanes];
+	for (int p = 0; p < NumPlanes; ++p)
+	{
+		px[p] = planeX[p] >= 0.0f ? boxes.maxX.data() : boxes.minX.data();
+		py[p] = planeY[p] >= 0.0f ? boxes.maxY.data() : boxes.minY.data();
+		pz[p] = planeZ[p] >= 0.0f ? boxes.maxZ.data() : boxes.minZ.data();
+	}
+
+	size_t i = 0;
+
+#if defined(FRUSTUM_AVX)
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+		for (int p = 0; p < NumPlanes; ++p)
+		{
+			__m256 d = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(px[p] + i), _mm256_set1_ps(planeX[p])), _mm256_mul_ps(_mm256_loadu_ps(py[p] + i), _mm256_set1_ps(planeY[p]))),
+				_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(pz[p] + i), _mm256_set1_ps(planeZ[p])), _mm256_set1_ps(planeD[p])));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GE_OQ));
+		}
+
+		visibleMask[i >> 5] |= (uint32)_mm256_movemask_ps(inside) << (i & 31);
+	}
+#elif defined(FRUSTUM_SSE)
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 zero = _mm_setzero_ps();
+		__m128 inside = _mm_cmpeq_ps(zero, zero);
+
+		for (int p = 0; p < NumPlanes; ++p)
+		{
+			__m128 d = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(px[p] + i), _mm_set1_ps(planeX[p])), _mm_mul_ps(_mm_loadu_ps(py[p] + i), _mm_set1_ps(planeY[p]))),
+				_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pz[p] + i), _mm_set1_ps(planeZ[p])), _mm_set1_ps(planeD[p])));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(d, zero));
+		}
+
+		visibleMask[i >> 5] |= (uint32)_mm_movemask_ps(inside) << (i & 31);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		float dMin = 0.0f;
+		for (int p = 0; p < NumPlanes; ++p)
+		{
+			float d = px[p][i] * planeX[p] + py[p][i] * planeY[p] + pz[p][i] * planeZ[p] + planeD[p];
+			if (p == 0 || d < dMin)
+				dMin = d;
+		}
+
+		if (dMin >= 0.0f)
+			visibleMask[i >> 5] |= 1u << (i & 31);
+	}
+}
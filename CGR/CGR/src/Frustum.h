@@ -1,4 +1,4 @@
-#ifndef __FRUSTRUM_H__
+#ifndef __FRUSTUM_H__
 #define __FRUSTUM_H__
 
 #include <vector>
@@ -6,19 +6,92 @@
 #include "Plane.h"
 #include "gl_headers.h"
 
+// Structure of arrays input for the batch tests, one float stream per component so 4/8 objects load at once
+struct SphereArrays
+{
+	std::vector<float> x, y, z, radius;
+
+	void	Clear();
+	void	Reserve(size_t count);
+	void	Push(const Vec3& centre, float r);
+	size_t	Size() const;
+};
+
+struct BoxArrays
+{
+	std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+	void	Clear();
+	void	Reserve(size_t count);
+	void	Push(const Vec3& min, const Vec3& max);
+	size_t	Size() const;
+};
+
+enum FrustumTest
+{
+	FRUSTUM_OUTSIDE,
+	FRUSTUM_INTERSECT,
+	FRUSTUM_INSIDE
+};
+
 class Frustum
 {
-	enum {Near, Far, Left, Right, Top, Bottom };
+	enum {Near, Far, Left, Right, Top, Bottom, NumPlanes };
 public:
 	Frustum();
 	~Frustum();
 
 	void UpdateFrustum			(const Mat4& proj, const Mat4& view);
-	bool IsPointWithinFrustum	(const Vec3& pos);
-	bool BoxInFrustum			(AABox &b, bool checkIntersections);
-	bool SphereInFrustum		(const Vec3& centre, float r);
+
+	// Drops the near plane so nothing between the eye and the volume is rejected, for shadow casters nearer the light than what it lights
+	void ExtrudeNear			();
+
+	bool IsPointWithinFrustum	(const Vec3& pos) const;
+	bool BoxInFrustum			(const AABox& b, bool checkIntersections = false) const;
+	bool SphereInFrustum		(const Vec3& centre, float r) const;
+
+	// The sphere dragged along dir without end, only false when the whole sweep misses. Tells if a caster's shadow can land in view
+	bool SweptSphereInFrustum	(const Vec3& centre, float r, const Vec3& dir) const;
+
+	// p-vertex rejects, n-vertex tells a box fully inside apart from one crossing a plane
+	FrustumTest TestBox			(const Vec3& min, const Vec3& max) const;
+
+	// Batch tests, bit i of the mask (32 per word) is set when object i is visible. The mask is resized to fit
+	void CullSpheres			(const SphereArrays& spheres, std::vector<uint32>& visibleMask) const;
+	void CullBoxes				(const BoxArrays& boxes, std::vector<uint32>& visibleMask) const;
+
+	// Refines a mask from another test, clears the bit of each sphere still set whose sweep misses. Returns how many were cleared
+	size_t CullSweptSpheres		(const SphereArrays& spheres, const Vec3& dir, std::vector<uint32>& visibleMask) const;
+
+	// Scalar versions of the batch tests, kept as the reference the SIMD paths are checked and timed against
+	void CullSpheresScalar		(const SphereArrays& spheres, std::vector<uint32>& visibleMask) const;
+	void CullBoxesScalar		(const BoxArrays& boxes, std::vector<uint32>& visibleMask) const;
+
+	static bool IsVisible		(const std::vector<uint32>& visibleMask, size_t index);
 
 private:
-	std::vector <Plane> planes{ 6 };
+	std::vector <Plane> planes{ NumPlanes };
+
+	// The same planes split into streams for the SIMD loops
+	float planeX[NumPlanes];
+	float planeY[NumPlanes];
+	float planeZ[NumPlanes];
+	float planeD[NumPlanes];
 };
-#endif
\ No newline at end of file
+
+INLINE bool Frustum::IsVisible(const std::vector<uint32>& visibleMask, size_t index)
+{
+	return (visibleMask[index >> 5] & (1u << (index & 31))) != 0;
+}
+
+INLINE size_t SphereArrays::Size() const
+{
+	return x.size();
+}
+
+INLINE size_t BoxArrays::Size() const
+{
+	return minX.size();
+}
+
+#endif
@@ -0,0 +1,556 @@
+#include "GLRenderDevice.h"
+
+GLRenderDevice::GLRenderDevice()
+{
+}
+
+GLRenderDevice::~GLRenderDevice()
+{
+}
+
+RenderBackend GLRenderDevice::Backend() const
+{
+	return GLBackend;
+}
+
+void GLRenderDevice::Enable(GLenum cap)
+{
+	glEnable(cap);
+}
+
+void GLRenderDevice::Disable(GLenum cap)
+{
+	glDisable(cap);
+}
+
+void GLRenderDevice::Clear(GLbitfield mask)
+{
+	glClear(mask);
+}
+
+void GLRenderDevice::ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+	glClearColor(r, g, b, a);
+}
+
+void GLRenderDevice::CullFace(GLenum mode)
+{
+	glCullFace(mode);
+}
+
+void GLRenderDevice::DepthFunc(GLenum func)
+{
+	glDepthFunc(func);
+}
+
+void GLRenderDevice::DepthMask(GLboolean flag)
+{
+	glDepthMask(flag);
+}
+
+void GLRenderDevice::BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+	glBlendFunc(sfactor, dfactor);
+}
+
+void GLRenderDevice::BlendEquation(GLenum mode)
+{
+	glBlendEquation(mode);
+}
+
+void GLRenderDevice::StencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+	glStencilFunc(func, ref, mask);
+}
+
+void GLRenderDevice::StencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass)
+{
+	glStencilOpSeparate(face, sfail, dpfail, dppass);
+}
+
+void GLRenderDevice::PolygonMode(GLenum face, GLenum mode)
+{
+	glPolygonMode(face, mode);
+}
+
+void GLRenderDevice::Viewport(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+	glViewport(x, y, w, h);
+}
+
+void GLRenderDevice::PixelStorei(GLenum pname, GLint param)
+{
+	glPixelStorei(pname, param);
+}
+
+void GLRenderDevice::Flush()
+{
+	glFlush();
+}
+
+void GLRenderDevice::GetIntegerv(GLenum pname, GLint* data)
+{
+	glGetIntegerv(pname, data);
+}
+
+const GLubyte* GLRenderDevice::GetString(GLenum name)
+{
+	return glGetString(name);
+}
+
+GLenum GLRenderDevice::GetError()
+{
+	return glGetError();
+}
+
+void GLRenderDevice::GenBuffers(GLsizei n, GLuint* buffers)
+{
+	glGenBuffers(n, buffers);
+}
+
+void GLRenderDevice::DeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+	glDeleteBuffers(n, buffers);
+}
+
+GLboolean GLRenderDevice::IsBuffer(GLuint buffer)
+{
+	return glIsBuffer(buffer);
+}
+
+void GLRenderDevice::BindBuffer(GLenum target, GLuint buffer)
+{
+	glBindBuffer(target, buffer);
+}
+
+void GLRenderDevice::BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+	glBufferData(target, size, data, usage);
+}
+
+void GLRenderDevice::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+	glBufferSubData(target, offset, size, data);
+}
+
+void GLRenderDevice::BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	glBindBufferBase(target, index, buffer);
+}
+
+void GLRenderDevice::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void GLRenderDevice::BufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+	glBufferStorage(target, size, data, flags);
+}
+
+void* GLRenderDevice::MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+	return glMapBufferRange(target, offset, length, access);
+}
+
+GLboolean GLRenderDevice::UnmapBuffer(GLenum target)
+{
+	return glUnmapBuffer(target);
+}
+
+void GLRenderDevice::GenVertexArrays(GLsizei n, GLuint* arrays)
+{
+	glGenVertexArrays(n, arrays);
+}
+
+void GLRenderDevice::DeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+	glDeleteVertexArrays(n, arrays);
+}
+
+GLboolean GLRenderDevice::IsVertexArray(GLuint array)
+{
+	return glIsVertexArray(array);
+}
+
+void GLRenderDevice::BindVertexArray(GLuint array)
+{
+	glBindVertexArray(array);
+}
+
+void GLRenderDevice::EnableVertexAttribArray(GLuint index)
+{
+	glEnableVertexAttribArray(index);
+}
+
+void GLRenderDevice::DisableVertexAttribArray(GLuint index)
+{
+	glDisableVertexAttribArray(index);
+}
+
+void GLRenderDevice::VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+{
+	glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+void GLRenderDevice::VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer)
+{
+	glVertexAttribIPointer(index, size, type, stride, pointer);
+}
+
+void GLRenderDevice::VertexAttribDivisor(GLuint index, GLuint divisor)
+{
+	glVertexAttribDivisor(index, divisor);
+}
+
+void GLRenderDevice::GenTextures(GLsizei n, GLuint* textures)
+{
+	glGenTextures(n, textures);
+}
+
+void GLRenderDevice::DeleteTextures(GLsizei n, const GLuint* textures)
+{
+	glDeleteTextures(n, textures);
+}
+
+GLboolean GLRenderDevice::IsTexture(GLuint texture)
+{
+	return glIsTexture(texture);
+}
+
+void GLRenderDevice::ActiveTexture(GLenum unit)
+{
+	glActiveTexture(unit);
+}
+
+void GLRenderDevice::BindTexture(GLenum target, GLuint texture)
+{
+	glBindTexture(target, texture);
+}
+
+void GLRenderDevice::TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+{
+	glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+}
+
+void GLRenderDevice::TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+{
+	glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+}
+
+void GLRenderDevice::TexParameteri(GLenum target, GLenum pname, GLint param)
+{
+	glTexParameteri(target, pname, param);
+}
+
+void GLRenderDevice::TexParameterf(GLenum target, GLenum pname, GLfloat param)
+{
+	glTexParameterf(target, pname, param);
+}
+
+void GLRenderDevice::GenerateMipmap(GLenum target)
+{
+	glGenerateMipmap(target);
+}
+
+void GLRenderDevice::GenFramebuffers(GLsizei n, GLuint* fbos)
+{
+	glGenFramebuffers(n, fbos);
+}
+
+void GLRenderDevice::DeleteFramebuffers(GLsizei n, const GLuint* fbos)
+{
+	glDeleteFramebuffers(n, fbos);
+}
+
+GLboolean GLRenderDevice::IsFramebuffer(GLuint fbo)
+{
+	return glIsFramebuffer(fbo);
+}
+
+void GLRenderDevice::BindFramebuffer(GLenum target, GLuint fbo)
+{
+	glBindFramebuffer(target, fbo);
+}
+
+void GLRenderDevice::FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+	glFramebufferTexture2D(target, attachment, textarget, texture, level);
+}
+
+GLenum GLRenderDevice::CheckFramebufferStatus(GLenum target)
+{
+	return glCheckFramebufferStatus(target);
+}
+
+void GLRenderDevice::DrawBuffer(GLenum buf)
+{
+	glDrawBuffer(buf);
+}
+
+void GLRenderDevice::DrawBuffers(GLsizei n, const GLenum* bufs)
+{
+	glDrawBuffers(n, bufs);
+}
+
+void GLRenderDevice::ReadBuffer(GLenum src)
+{
+	glReadBuffer(src);
+}
+
+void GLRenderDevice::BlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+	glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+}
+
+GLuint GLRenderDevice::CreateShader(GLenum type)
+{
+	return glCreateShader(type);
+}
+
+void GLRenderDevice::DeleteShader(GLuint shader)
+{
+	glDeleteShader(shader);
+}
+
+GLboolean GLRenderDevice::IsShader(GLuint shader)
+{
+	return glIsShader(shader);
+}
+
+void GLRenderDevice::ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+{
+	glShaderSource(shader, count, strings, lengths);
+}
+
+void GLRenderDevice::CompileShader(GLuint shader)
+{
+	glCompileShader(shader);
+}
+
+void GLRenderDevice::GetShaderiv(GLuint shader, GLenum pname, GLint* params)
+{
+	glGetShaderiv(shader, pname, params);
+}
+
+void GLRenderDevice::GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* log)
+{
+	glGetShaderInfoLog(shader, bufSize, length, log);
+}
+
+GLuint GLRenderDevice::CreateProgram()
+{
+	return glCreateProgram();
+}
+
+void GLRenderDevice::DeleteProgram(GLuint program)
+{
+	glDeleteProgram(program);
+}
+
+GLboolean GLRenderDevice::IsProgram(GLuint program)
+{
+	return glIsProgram(program);
+}
+
+void GLRenderDevice::AttachShader(GLuint program, GLuint shader)
+{
+	glAttachShader(program, shader);
+}
+
+void GLRenderDevice::BindAttribLocation(GLuint program, GLuint index, const GLchar* name)
+{
+	glBindAttribLocation(program, index, name);
+}
+
+void GLRenderDevice::BindFragDataLocation(GLuint program, GLuint color, const GLchar* name)
+{
+	glBindFragDataLocation(program, color, name);
+}
+
+void GLRenderDevice::LinkProgram(GLuint program)
+{
+	glLinkProgram(program);
+}
+
+void GLRenderDevice::GetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+	glGetProgramiv(program, pname, params);
+}
+
+void GLRenderDevice::GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* log)
+{
+	glGetProgramInfoLog(program, bufSize, length, log);
+}
+
+void GLRenderDevice::UseProgram(GLuint program)
+{
+	glUseProgram(program);
+}
+
+GLint GLRenderDevice::GetUniformLocation(GLuint program, const GLchar* name)
+{
+	return glGetUniformLocation(program, name);
+}
+
+void GLRenderDevice::GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+	glGetActiveUniform(program, index, bufSize, length, size, type, name);
+}
+
+void GLRenderDevice::GetActiveUniformBlockName(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name)
+{
+	glGetActiveUniformBlockName(program, index, bufSize, length, name);
+}
+
+GLuint GLRenderDevice::GetUniformBlockIndex(GLuint program, const GLchar* name)
+{
+	return glGetUniformBlockIndex(program, name);
+}
+
+void GLRenderDevice::GetActiveUniformBlockiv(GLuint program, GLuint index, GLenum pname, GLint* params)
+{
+	glGetActiveUniformBlockiv(program, index, pname, params);
+}
+
+void GLRenderDevice::GetUniformIndices(GLuint program, GLsizei count, const GLchar* const* names, GLuint* indices)
+{
+	glGetUniformIndices(program, count, names, indices);
+}
+
+void GLRenderDevice::GetActiveUniformsiv(GLuint program, GLsizei count, const GLuint* indices, GLenum pname, GLint* params)
+{
+	glGetActiveUniformsiv(program, count, indices, pname, params);
+}
+
+void GLRenderDevice::Uniform1i(GLint location, GLint v)
+{
+	glUniform1i(location, v);
+}
+
+void GLRenderDevice::Uniform1f(GLint location, GLfloat v)
+{
+	glUniform1f(location, v);
+}
+
+void GLRenderDevice::Uniform2fv(GLint location, GLsizei count, const GLfloat* v)
+{
+	glUniform2fv(location, count, v);
+}
+
+void GLRenderDevice::Uniform3fv(GLint location, GLsizei count, const GLfloat* v)
+{
+	glUniform3fv(location, count, v);
+}
+
+void GLRenderDevice::Uniform4fv(GLint location, GLsizei count, const GLfloat* v)
+{
+	glUniform4fv(location, count, v);
+}
+
+void GLRenderDevice::UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* v)
+{
+	glUniformMatrix4fv(location, count, transpose, v);
+}
+
+void GLRenderDevice::DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	glDrawArrays(mode, first, count);
+}
+
+void GLRenderDevice::MultiDrawArrays(GLenum mode, const GLint* first, const GLsizei* count, GLsizei drawcount)
+{
+	glMultiDrawArrays(mode, first, count, drawcount);
+}
+
+void GLRenderDevice::DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex)
+{
+	glDrawElementsBaseVertex(mode, count, type, indices, basevertex);
+}
+
+void GLRenderDevice::DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex)
+{
+	glDrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount, basevertex);
+}
+
+void GLRenderDevice::DrawElementsInstancedBaseVertexBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex, GLuint baseinstance)
+{
+	glDrawElementsInstancedBaseVertexBaseInstance(mode, count, type, indices, instancecount, basevertex, baseinstance);
+}
+
+void GLRenderDevice::DrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instancecount, GLuint baseinstance)
+{
+	glDrawArraysInstancedBaseInstance(mode, first, count, instancecount, baseinstance);
+}
+
+void GLRenderDevice::CreateQueries(GLenum target, GLsizei n, GLuint* ids)
+{
+	glCreateQueries(target, n, ids);
+}
+
+void GLRenderDevice::DeleteQueries(GLsizei n, const GLuint* ids)
+{
+	glDeleteQueries(n, ids);
+}
+
+void GLRenderDevice::BeginQuery(GLenum target, GLuint id)
+{
+	glBeginQuery(target, id);
+}
+
+void GLRenderDevice::EndQuery(GLenum target)
+{
+	glEndQuery(target);
+}
+
+void GLRenderDevice::GetQueryObjectiv(GLuint id, GLenum pname, GLint* params)
+{
+	glGetQueryObjectiv(id, pname, params);
+}
+
+void GLRenderDevice::GetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params)
+{
+	glGetQueryObjectuiv(id, pname, params);
+}
+
+void GLRenderDevice::GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params)
+{
+	glGetQueryObjectui64v(id, pname, params);
+}
+
+void GLRenderDevice::QueryCounter(GLuint id, GLenum target)
+{
+	glQueryCounter(id, target);
+}
+
+GLsync GLRenderDevice::FenceSync(GLenum condition, GLbitfield flags)
+{
+	return glFenceSync(condition, flags);
+}
+
+GLenum GLRenderDevice::ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+	return glClientWaitSync(sync, flags, timeout);
+}
+
+void GLRenderDevice::DeleteSync(GLsync sync)
+{
+	glDeleteSync(sync);
+}
+
+void GLRenderDevice::PushMarker(const char* name)
+{
+	// Only shows up in a frame debugger, so skip it on drivers without KHR_debug
+	if (GLEW_KHR_debug)
+	{
+		glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+	}
+}
+
+void GLRenderDevice::PopMarker()
+{
+	if (GLEW_KHR_debug)
+	{
+		glPopDebugGroup();
+	}
+}
@@ -1,5 +1,6 @@
 #include "GameObject.h"
 #include "Component.h"
+#include "Profiler.h"
 
 GameObject::GameObject() :
 	m_Components(),
@@ -35,6 +36,8 @@ void GameObject::Start()
 
 void GameObject::Update()
 {
+	PROFILE_ZONE("GameObject::Update");
+
 	if (this->m_Enabled)
 	{
 		for (CompIter i = m_Components.begin(); i != m_Components.end(); ++i)
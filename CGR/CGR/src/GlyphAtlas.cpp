@@ -0,0 +1,336 @@
+#include "GlyphAtlas.h"
+
+#include "LogFile.h"
+#include "Texture.h"
+#include "OpenGlLayer.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+// Glyphs per distance field job, each one is a few hundred thousand comparisons
+#define SDF_GLYPHS_PER_JOB	4
+
+// Each field pixel is its distance to the nearest bitmap pixel on the other side of the edge, searched within
+// the spread. 0.5 sits on the edge, inside is above it, so the shader only has to threshold the sample
+static void buildDistanceField(const std::vector<byte>& bitmap, int width, int height, std::vector<byte>& field)
+{
+	const int fieldWidth = width + SDF_SPREAD * 2;
+	const int fieldHeight = height + SDF_SPREAD * 2;
+	const int maxDistSq = SDF_SPREAD * SDF_SPREAD;
+
+	field.resize(fieldWidth * fieldHeight);
+
+	auto inside = [&](int x, int y)
+	{
+		return x >= 0 && y >= 0 && x < width && y < height && bitmap[y * width + x] >= 128;
+	};
+
+	for (int fy = 0; fy < fieldHeight; ++fy)
+	{
+		for (int fx = 0; fx < fieldWidth; ++fx)
+		{
+			const int bx = fx - SDF_SPREAD;
+			const int by = fy - SDF_SPREAD;
+			const bool in = inside(bx, by);
+
+			int bestSq = maxDistSq;
+			for (int dy = -SDF_SPREAD; dy <= SDF_SPREAD; ++dy)
+			{
+				for (int dx = -SDF_SPREAD; dx <= SDF_SPREAD; ++dx)
+				{
+					const int distSq = dx * dx + dy * dy;
+					if (distSq < bestSq && inside(bx + dx, by + dy) != in)
+						bestSq = distSq;
+				}
+			}
+
+			// The edge lies half way between the two pixel centres
+			const float dist = sqrtf((float)bestSq) - 0.5f;
+			const float value = 0.5f + (in ? dist : -dist) / (2.0f * SDF_SPREAD);
+			field[fy * fieldWidth + fx] = (byte)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f);
+		}
+	}
+}
+
+GlyphAtlas::GlyphAtlas() :
+	m_Faces(),
+	m_Pending(),
+	m_PackOrder(),
+	m_Pixels(),
+	m_Packer(),
+	m_Library(nullptr),
+	m_Jobs(nullptr),
+	m_Texture(0),
+	m_Full(false)
+{
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+}
+
+bool GlyphAtlas::Init(JobSystem* jobs)
+{
+	m_Jobs = jobs;
+
+	if (FT_Init_FreeType(&m_Library))
+	{
+		WRITE_LOG("Could not Initialize freetype library.", "error");
+		return false;
+	}
+
+	m_Pixels.assign(GLYPH_ATLAS_SIZE * GLYPH_ATLAS_SIZE, 0);
+	m_Packer.Init(GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE, GLYPH_ATLAS_PADDING);
+
+	return Texture::create_tex2D(
+		&m_Texture,
+		GL_TEXTURE0,
+		GL_RED,
+		GLYPH_ATLAS_SIZE,
+		GLYPH_ATLAS_SIZE,
+		GL_RED,
+		GL_UNSIGNED_BYTE,
+		m_Pixels.data(),
+		GL_CLAMP_TO_EDGE,
+		GL_CLAMP_TO_EDGE,
+		GL_LINEAR,
+		GL_LINEAR,
+		false
+	);
+}
+
+void GlyphAtlas::Close()
+{
+	for (size_t i = 0; i < m_Faces.size(); ++i)
+	{
+		FT_Done_Face(m_Faces[i]->face);
+		SAFE_DELETE(m_Faces[i]);
+	}
+	m_Faces.clear();
+
+	if (m_Library)
+	{
+		FT_Done_FreeType(m_Library);
+		m_Library = nullptr;
+	}
+
+	OpenGLLayer::clean_GL_texture(&m_Texture, 1);
+	m_Pixels.clear();
+	m_Pending.clear();
+	m_PackOrder.clear();
+	m_Full = false;
+}
+
+int GlyphAtlas::OpenFace(const std::string& path)
+{
+	for (size_t i = 0; i < m_Faces.size(); ++i)
+	{
+		if (m_Faces[i]->path == path)
+			return (int)i;
+	}
+
+	FT_Face ftFace;
+	if (FT_New_Face(m_Library, path.c_str(), 0, &ftFace))
+	{
+		WRITE_LOG("Error Could not open font: " + path, "error");
+		return -1;
+	}
+
+	FT_Set_Pixel_Sizes(ftFace, 0, SDF_BASE_SIZE);
+
+	Face* face = new Face();
+	face->face = ftFace;
+	face->path = path;
+	memset(face->direct, 0, sizeof(face->direct));
+	memset(face->directLoaded, 0, sizeof(face->directLoaded));
+
+	m_Faces.push_back(face);
+	return (int)m_Faces.size() - 1;
+}
+
+bool GlyphAtlas::AddRange(int face, uint32 first, uint32 last)
+{
+	if (face < 0 || face >= (int)m_Faces.size())
+		return false;
+
+	std::vector<uint32> codepoints;
+	for (uint32 c = first; c <= last; ++c)
+	{
+		if (!isLoaded(*m_Faces[face], c))
+			codepoints.push_back(c);
+	}
+
+	return codepoints.empty() || addGlyphs(*m_Faces[face], codepoints);
+}
+
+const Glyph& GlyphAtlas::GetGlyph(int face, uint32 codepoint)
+{
+	Face& f = *m_Faces[face];
+
+	if (codepoint < GLYPH_DIRECT_COUNT)
+	{
+		if (!f.directLoaded[codepoint])
+			addGlyphs(f, std::vector<uint32>(1, codepoint));
+
+		return f.direct[codepoint];
+	}
+
+	auto it = f.glyphs.find(codepoint);
+	if (it != f.glyphs.end())
+		return it->second;
+
+	addGlyphs(f, std::vector<uint32>(1, codepoint));
+	return f.glyphs[codepoint];
+}
+
+bool GlyphAtlas::isLoaded(const Face& face, uint32 codepoint) const
+{
+	if (codepoint < GLYPH_DIRECT_COUNT)
+		return face.directLoaded[codepoint];
+
+	return face.glyphs.find(codepoint) != face.glyphs.end();
+}
+
+void GlyphAtlas::store(Face& face, uint32 codepoint, const Glyph& glyph)
+{
+	if (codepoint < GLYPH_DIRECT_COUNT)
+	{
+		face.direct[codepoint] = glyph;
+		face.directLoaded[codepoint] = true;
+	}
+	else
+	{
+		face.glyphs[codepoint] = glyph;
+	}
+}
+
+bool GlyphAtlas::addGlyphs(Face& face, const std::vector<uint32>& codepoints)
+{
+	PROFILE_ZONE("GlyphAtlas::addGlyphs");
+
+	m_Pending.resize(codepoints.size());
+
+	// FreeType faces can't be shared between threads, so rasterizing stays on this one
+	for (size_t i = 0; i < codepoints.size(); ++i)
+	{
+		PendingGlyph& pending = m_Pending[i];
+		pending.codepoint = codepoints[i];
+		memset(&pending.glyph, 0, sizeof(Glyph));
+		pending.bitmapWidth = 0;
+		pending.bitmapHeight = 0;
+		pending.bitmap.clear();
+		pending.field.clear();
+
+		if (FT_Load_Char(face.face, codepoints[i], FT_LOAD_RENDER))
+		{
+			WRITE_LOG("ERROR::FREETYTPE: Failed to load Glyph", "warning");
+			continue;
+		}
+
+		const FT_GlyphSlot slot = face.face->glyph;
+		const FT_Bitmap& bitmap = slot->bitmap;
+
+		pending.glyph.advance = (float)(slot->advance.x >> 6);
+		pending.bitmapWidth = bitmap.width;
+		pending.bitmapHeight = bitmap.rows;
+
+		// Spaces and the like only move the pen
+		if (bitmap.width == 0 || bitmap.rows == 0)
+			continue;
+
+		pending.glyph.left = (float)(slot->bitmap_left - SDF_SPREAD);
+		pending.glyph.top = (float)(slot->bitmap_top + SDF_SPREAD);
+		pending.glyph.width = (float)(bitmap.width + SDF_SPREAD * 2);
+		pending.glyph.height = (float)(bitmap.rows + SDF_SPREAD * 2);
+
+		// Rows can be padded in freetype's copy, keep them tight
+		pending.bitmap.resize(bitmap.width * bitmap.rows);
+		for (unsigned row = 0; row < bitmap.rows; ++row)
+			memcpy(&pending.bitmap[row * bitmap.width], bitmap.buffer + row * bitmap.pitch, bitmap.width);
+	}
+
+	auto buildFields = [this](size_t begin, size_t end, unsigned)
+	{
+		PROFILE_ZONE("BuildDistanceFields");
+		for (size_t i = begin; i < end; ++i)
+		{
+			PendingGlyph& pending = m_Pending[i];
+			if (!pending.bitmap.empty())
+				buildDistanceField(pending.bitmap, pending.bitmapWidth, pending.bitmapHeight, pending.field);
+		}
+	};
+
+	if (m_Jobs)
+		m_Jobs->ParallelFor(m_Pending.size(), SDF_GLYPHS_PER_JOB, buildFields);
+	else
+		buildFields(0, m_Pending.size(), 0);
+
+	// Tallest first so each shelf is opened by the tallest glyph it will hold
+	m_PackOrder.resize(m_Pending.size());
+	for (size_t i = 0; i < m_PackOrder.size(); ++i)
+		m_PackOrder[i] = (uint32)i;
+
+	std::stable_sort(m_PackOrder.begin(), m_PackOrder.end(), [this](uint32 a, uint32 b)
+	{
+		return m_Pending[a].glyph.height > m_Pending[b].glyph.height;
+	});
+
+	// Pack and copy in, tracking the rows touched so only they are sent
+	int minRow = GLYPH_ATLAS_SIZE;
+	int maxRow = 0;
+	bool success = true;
+
+	for (size_t i = 0; i < m_PackOrder.size(); ++i)
+	{
+		PendingGlyph& pending = m_Pending[m_PackOrder[i]];
+
+		if (!pending.field.empty())
+		{
+			const int w = (int)pending.glyph.width;
+			const int h = (int)pending.glyph.height;
+			int x, y;
+
+			if (!m_Packer.Pack(w, h, &x, &y))
+			{
+				// Keep the advance so the text still spaces correctly, the glyph just isn't drawn
+				if (!m_Full)
+					WRITE_LOG("Glyph atlas is full, new glyphs won't be drawn", "warning");
+
+				m_Full = true;
+				success = false;
+				pending.glyph.width = 0.0f;
+				pending.glyph.height = 0.0f;
+			}
+			else
+			{
+				for (int row = 0; row < h; ++row)
+					memcpy(&m_Pixels[(y + row) * GLYPH_ATLAS_SIZE + x], &pending.field[row * w], w);
+
+				pending.glyph.u0 = (float)x / GLYPH_ATLAS_SIZE;
+				pending.glyph.v0 = (float)y / GLYPH_ATLAS_SIZE;
+				pending.glyph.u1 = (float)(x + w) / GLYPH_ATLAS_SIZE;
+				pending.glyph.v1 = (float)(y + h) / GLYPH_ATLAS_SIZE;
+
+				minRow = std::min(minRow, y);
+				maxRow = std::max(maxRow, y + h);
+			}
+		}
+
+		store(face, pending.codepoint, pending.glyph);
+	}
+
+	if (maxRow > minRow)
+	{
+		RenderDevice* gl = OpenGLLayer::device();
+
+		gl->PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		gl->BindTexture(GL_TEXTURE_2D, m_Texture);
+		gl->TexSubImage2D(GL_TEXTURE_2D, 0, 0, minRow, GLYPH_ATLAS_SIZE, maxRow - minRow, GL_RED, GL_UNSIGNED_BYTE, &m_Pixels[minRow * GLYPH_ATLAS_SIZE]);
+		gl->BindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	return success;
+}
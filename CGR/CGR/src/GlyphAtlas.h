@@ -0,0 +1,107 @@
+#ifndef __GLYPH_ATLAS_H__
+#define __GLYPH_ATLAS_H__
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "gl_headers.h"
+#include "types.h"
+#include "RectPacker.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+class JobSystem;
+
+#define GLYPH_ATLAS_SIZE		2048
+#define GLYPH_ATLAS_PADDING		1
+// Pixel size every glyph is rasterized at, each text size scales the distance field from this
+#define SDF_BASE_SIZE			48
+// How far in base pixels the field reaches either side of a glyph's edge
+#define SDF_SPREAD				6
+// Glyphs below this are kept in a flat array per face, the rest of unicode goes through a map
+#define GLYPH_DIRECT_COUNT		128
+
+// A glyph's distance field in the atlas, sizes are in base pixels and include the spread
+struct Glyph
+{
+	float u0;
+	float v0;
+	float u1;
+	float v1;
+	float left;		// From the pen position to the field's left edge
+	float top;		// From the baseline up to the field's top edge
+	float width;
+	float height;
+	float advance;
+};
+
+/*
+	One texture holding signed distance fields for the glyphs of every font, shared by all sizes of a face.
+	Faces are opened once with the one FreeType library. Glyphs are rasterized on the calling thread (a face
+	isn't thread safe), their distance fields are then built across the job system and packed into the
+	atlas, only the rows that changed are sent. Anything not preloaded is generated the first time it's asked for.
+*/
+class GlyphAtlas
+{
+	struct Face
+	{
+		FT_Face								face;
+		std::string							path;
+		Glyph								direct[GLYPH_DIRECT_COUNT];
+		bool								directLoaded[GLYPH_DIRECT_COUNT];
+		std::unordered_map<uint32, Glyph>	glyphs;
+	};
+
+	// A glyph between being rasterized and placed in the atlas
+	struct PendingGlyph
+	{
+		uint32				codepoint;
+		Glyph				glyph;
+		std::vector<byte>	bitmap;
+		int					bitmapWidth;
+		int					bitmapHeight;
+		std::vector<byte>	field;
+	};
+
+public:
+	GlyphAtlas();
+	~GlyphAtlas();
+
+	// Without a job system the distance fields are built on the calling thread
+	bool						Init(JobSystem* jobs);
+	void						Close();
+
+	// Returns the face's index, the same file is only opened once. -1 on failure
+	int							OpenFace(const std::string& path);
+	// Generates every glyph in [first, last] the face doesn't have yet
+	bool						AddRange(int face, uint32 first, uint32 last);
+	// Generated on first use, codepoints the face doesn't cover come back as its missing glyph
+	const Glyph&				GetGlyph(int face, uint32 codepoint);
+
+	GLuint						Texture() const;
+
+private:
+	bool						addGlyphs(Face& face, const std::vector<uint32>& codepoints);
+	bool						isLoaded(const Face& face, uint32 codepoint) const;
+	void						store(Face& face, uint32 codepoint, const Glyph& glyph);
+
+private:
+	std::vector<Face*>			m_Faces;
+	std::vector<PendingGlyph>	m_Pending;
+	std::vector<uint32>			m_PackOrder;	// m_Pending indices, tallest first
+	std::vector<byte>			m_Pixels;
+	RectPacker					m_Packer;
+	FT_Library					m_Library;
+	JobSystem*					m_Jobs;
+	GLuint						m_Texture;
+	bool						m_Full;
+};
+
+INLINE GLuint GlyphAtlas::Texture() const
+{
+	return m_Texture;
+}
+
+#endif
@@ -0,0 +1,207 @@
+#include "GpuTimers.h"
+
+#include "LogFile.h"
+#include "OpenGlLayer.h"
+
+#include <cstring>
+
+// Marks an open range that didn't fit in the frame, its End has nothing to write
+#define NO_RANGE	-1
+
+GpuTimers::GpuTimers() :
+	m_Queries(),
+	m_Timings(),
+	m_Open(),
+	m_Frame(0),
+	m_Dropped(0),
+	m_Enabled(false)
+{
+}
+
+GpuTimers::~GpuTimers()
+{
+}
+
+bool GpuTimers::Init()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	m_Queries.resize(GPU_TIMER_FRAMES * GPU_TIMER_MAX_RANGES * 2, 0);
+	gl->CreateQueries(GL_TIMESTAMP, (GLsizei)m_Queries.size(), m_Queries.data());
+
+	for (size_t i = 0; i < m_Queries.size(); ++i)
+	{
+		if (m_Queries[i] == 0)
+		{
+			WRITE_LOG("Failed to create GPU timer queries", "error");
+			return false;
+		}
+	}
+
+	for (uint32 f = 0; f < GPU_TIMER_FRAMES; ++f)
+	{
+		m_Frames[f].ranges.reserve(GPU_TIMER_MAX_RANGES);
+		m_Frames[f].frame = 0;
+	}
+
+	m_Open.reserve(GPU_TIMER_MAX_RANGES);
+	return true;
+}
+
+void GpuTimers::Close()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	if (!m_Queries.empty())
+	{
+		gl->DeleteQueries((GLsizei)m_Queries.size(), m_Queries.data());
+		m_Queries.clear();
+	}
+
+	for (uint32 f = 0; f < GPU_TIMER_FRAMES; ++f)
+		m_Frames[f].ranges.clear();
+
+	m_Timings.clear();
+	m_Open.clear();
+}
+
+void GpuTimers::BeginFrame(bool enabled)
+{
+	if (!m_Open.empty())
+	{
+		WRITE_LOG("GPU timer range left open at the end of a frame", "warning");
+		m_Open.clear();
+	}
+
+	++m_Frame;
+	m_Enabled = enabled && !m_Queries.empty();
+
+	// This block was last written GPU_TIMER_FRAMES ago
+	resolve(m_Frames[m_Frame % GPU_TIMER_FRAMES]);
+	m_Frames[m_Frame % GPU_TIMER_FRAMES].frame = m_Frame;
+}
+
+void GpuTimers::Begin(const char* name)
+{
+	if (!m_Enabled)
+		return;
+
+	Frame& frame = m_Frames[m_Frame % GPU_TIMER_FRAMES];
+	if (frame.ranges.size() >= GPU_TIMER_MAX_RANGES)
+	{
+		m_Open.push_back(NO_RANGE);
+		return;
+	}
+
+	RenderDevice* gl = OpenGLLayer::device();
+
+	const uint32 block = (m_Frame % GPU_TIMER_FRAMES) * GPU_TIMER_MAX_RANGES * 2;
+	Range range = { timingIndex(name), block + (uint32)frame.ranges.size() * 2 };
+
+	gl->QueryCounter(m_Queries[range.query], GL_TIMESTAMP);
+
+	m_Open.push_back((int)frame.ranges.size());
+	frame.ranges.push_back(range);
+}
+
+void GpuTimers::End()
+{
+	if (!m_Enabled || m_Open.empty())
+		return;
+
+	const int open = m_Open.back();
+	m_Open.pop_back();
+
+	if (open == NO_RANGE)
+		return;
+
+	RenderDevice* gl = OpenGLLayer::device();
+
+	const Range& range = m_Frames[m_Frame % GPU_TIMER_FRAMES].ranges[open];
+	gl->QueryCounter(m_Queries[range.query + 1], GL_TIMESTAMP);
+}
+
+void GpuTimers::resolve(Frame& frame)
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	for (size_t i = 0; i < frame.ranges.size(); ++i)
+	{
+		const Range& range = frame.ranges[i];
+
+		// The end stamp was issued after the start, once it's there both are
+		GLint available = 0;
+		gl->GetQueryObjectiv(m_Queries[range.query + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+		{
+			++m_Dropped;
+			continue;
+		}
+
+		GLuint64 start = 0;
+		GLuint64 end = 0;
+		gl->GetQueryObjectui64v(m_Queries[range.query], GL_QUERY_RESULT, &start);
+		gl->GetQueryObjectui64v(m_Queries[range.query + 1], GL_QUERY_RESULT, &end);
+
+		GpuTiming& timing = m_Timings[range.timing];
+		timing.latest = end > start ? (float)(end - start) / 1000000.0f : 0.0f;
+		timing.frame = frame.frame;
+		timing.history[timing.next] = timing.latest;
+		timing.next = (timing.next + 1) % GPU_TIMER_HISTORY;
+		if (timing.samples < GPU_TIMER_HISTORY)
+			++timing.samples;
+	}
+
+	frame.ranges.clear();
+}
+
+uint32 GpuTimers::timingIndex(const char* name)
+{
+	for (size_t i = 0; i < m_Timings.size(); ++i)
+	{
+		if (m_Timings[i].name == name)
+			return (uint32)i;
+	}
+
+	GpuTiming timing;
+	timing.name = name;
+	memset(timing.history, 0, sizeof(timing.history));
+	timing.next = 0;
+	timing.samples = 0;
+	timing.latest = 0.0f;
+	timing.frame = 0;
+
+	m_Timings.push_back(timing);
+	return (uint32)m_Timings.size() - 1;
+}
+
+const GpuTiming* GpuTimers::Find(const std::string& name) const
+{
+	for (size_t i = 0; i < m_Timings.size(); ++i)
+	{
+		if (m_Timings[i].name == name)
+			return &m_Timings[i];
+	}
+
+	return nullptr;
+}
+
+float GpuTimers::Average(size_t index) const
+{
+	const GpuTiming& timing = m_Timings[index];
+	if (timing.samples == 0)
+		return 0.0f;
+
+	float total = 0.0f;
+	for (uint32 i = 0; i < timing.samples; ++i)
+		total += timing.history[i];
+
+	return total / timing.samples;
+}
+
+bool GpuTimers::IsCurrent(size_t index) const
+{
+	// Ranges only timed in some modes, e.g. the deferred passes, drop out once the mode changes
+	const GpuTiming& timing = m_Timings[index];
+	return timing.samples > 0 && m_Frame - timing.frame <= GPU_TIMER_FRAMES * 2;
+}
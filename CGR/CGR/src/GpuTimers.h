@@ -0,0 +1,102 @@
+#ifndef __GPU_TIMERS_H__
+#define __GPU_TIMERS_H__
+
+#include <vector>
+#include <string>
+#include "gl_headers.h"
+#include "types.h"
+
+// Frames of queries in flight, a frame's results are read when its queries come round again
+#define GPU_TIMER_FRAMES		4
+// Timed ranges a frame can hold, anything past this isn't timed
+#define GPU_TIMER_MAX_RANGES	32
+// Results kept per range for the history
+#define GPU_TIMER_HISTORY		120
+
+struct GpuTiming
+{
+	std::string		name;
+	float			history[GPU_TIMER_HISTORY];	// Milliseconds, written round from next
+	uint32			next;
+	uint32			samples;
+	float			latest;
+	uint32			frame;						// Frame the latest result was recorded in
+};
+
+/*
+	Times ranges of GPU work with a pair of timestamp queries each, nested ranges are fine. The queries are
+	split into GPU_TIMER_FRAMES blocks used in turn, a block is only read back when it's about to be reused,
+	so the GPU has had that many frames to finish it and reading never stalls. A result still not there by
+	then is dropped rather than waited on. Results are kept per range name, in the order first seen.
+*/
+class GpuTimers
+{
+	struct Range
+	{
+		uint32	timing;
+		uint32	query;		// First of the pair in the frame's block
+	};
+
+	struct Frame
+	{
+		std::vector<Range>	ranges;
+		uint32				frame;
+	};
+
+public:
+	GpuTimers();
+	~GpuTimers();
+
+	bool					Init();
+	void					Close();
+
+	// Reads back the oldest frame's results and starts recording into its queries
+	void					BeginFrame(bool enabled);
+	void					Begin(const char* name);
+	void					End();
+
+	size_t					Count() const;
+	const GpuTiming&		Timing(size_t index) const;
+	const GpuTiming*		Find(const std::string& name) const;
+	// Mean of the range's history, 0 if it has none
+	float					Average(size_t index) const;
+	// Frames behind the results are, and whether a range was last timed recently enough to be current
+	uint32					Latency() const;
+	bool					IsCurrent(size_t index) const;
+	uint32					Dropped() const;
+
+private:
+	void					resolve(Frame& frame);
+	uint32					timingIndex(const char* name);
+
+private:
+	std::vector<GLuint>		m_Queries;
+	Frame					m_Frames[GPU_TIMER_FRAMES];
+	std::vector<GpuTiming>	m_Timings;
+	std::vector<int>		m_Open;
+	uint32					m_Frame;
+	uint32					m_Dropped;
+	bool					m_Enabled;
+};
+
+INLINE size_t GpuTimers::Count() const
+{
+	return m_Timings.size();
+}
+
+INLINE const GpuTiming& GpuTimers::Timing(size_t index) const
+{
+	return m_Timings[index];
+}
+
+INLINE uint32 GpuTimers::Latency() const
+{
+	return GPU_TIMER_FRAMES - 1;
+}
+
+INLINE uint32 GpuTimers::Dropped() const
+{
+	return m_Dropped;
+}
+
+#endif
@@ -76,6 +76,7 @@ int IndoorLevelScene::OnSceneLoad(ResourceManager* resManager)
 		true,
 		false,
 		false);
+	m_LvlMeshRenderer->SetOccluder(true);
 	m_GameObjects.push_back(level);
 
 	// Point Lights
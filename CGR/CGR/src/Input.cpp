@@ -6,6 +6,7 @@
 #include "RenderWindow.h"
 #include "EventManager.h"
 #include "KeyEvent.h"
+#include "Screen.h"
 
 #include <string>
 
@@ -17,7 +18,7 @@ Input::~Input()
 		delete Mouse::Instance();
 }
 
-int Input::Init()
+int Input::Init(bool headless)
 {
 	{
 		// Setup Hash
@@ -146,6 +147,13 @@ int Input::Init()
 	RenderWindow* win = Application::Instance()->GetRenderWindow();
 	new Mouse(this);
 
+	// Nothing to take input from, keys stay released and the mouse sits mid screen so cameras hold still
+	if (headless)
+	{
+		Mouse::Instance()->SetMousePosition(Screen::ScreenWidth() * 0.5, Screen::ScreenHeight() * 0.5);
+		return GE_OK;
+	}
+
 	if (!win)
 	{
 		WRITE_LOG("Error: can't init input without a window", "error");
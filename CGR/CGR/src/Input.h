@@ -38,7 +38,8 @@ class Input
 public:
 	~Input();
 
-	int Init();
+	// Headless skips the window callbacks, for runs without a display
+	int Init(bool headless = false);
 	static std::map<int, int> Keys;
 
 private:
@@ -0,0 +1,101 @@
+#include "InstanceBatcher.h"
+
+#include "OpenGlLayer.h"
+
+bool InstanceKey::operator<(const InstanceKey& other) const
+{
+	if (mesh != other.mesh)							return mesh < other.mesh;
+	if (materialSet != other.materialSet)			return materialSet < other.materialSet;
+	if (shader != other.shader)						return shader < other.shader;
+	if (bumpMaps != other.bumpMaps)					return bumpMaps < other.bumpMaps;
+	return receiveShadows < other.receiveShadows;
+}
+
+InstanceBatcher::InstanceBatcher() :
+	m_Groups(),
+	m_InstanceData(),
+	m_VBO()
+{
+}
+
+InstanceBatcher::~InstanceBatcher()
+{
+}
+
+bool InstanceBatcher::Init()
+{
+	return m_VBO.Init(GL_ARRAY_BUFFER);
+}
+
+void InstanceBatcher::Close()
+{
+	m_VBO.Close();
+	m_Groups.clear();
+	m_InstanceData.clear();
+}
+
+void InstanceBatcher::Begin()
+{
+	// Keep the groups around so their vectors don't reallocate every pass
+	for (auto g = m_Groups.begin(); g != m_Groups.end(); ++g)
+	{
+		g->second.objects.clear();
+		g->second.xforms.clear();
+	}
+}
+
+void InstanceBatcher::Add(const InstanceKey& key, const Renderable* object, const Mat4& world, float depth)
+{
+	InstanceGroup& group = m_Groups[key];
+
+	if (group.objects.empty() || depth < group.nearestDepth)
+		group.nearestDepth = depth;
+
+	group.objects.push_back(object);
+	group.xforms.push_back(world);
+}
+
+uint32 InstanceBatcher::Append(const InstanceGroup& group)
+{
+	uint32 first = (uint32)m_InstanceData.size();
+	m_InstanceData.insert(m_InstanceData.end(), group.xforms.begin(), group.xforms.end());
+	return first;
+}
+
+void InstanceBatcher::Upload()
+{
+	if (m_InstanceData.empty())
+		return;
+
+	m_VBO.Upload(m_InstanceData.data(), m_InstanceData.size() * sizeof(Mat4));
+	m_InstanceData.clear();
+}
+
+void InstanceBatcher::BindInstanceAttributes(uint32 firstInstance)
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	// Expects the mesh vao to be bound, points its instance attributes at this group's matrices
+	gl->BindBuffer(GL_ARRAY_BUFFER, m_VBO.Handle());
+
+	const size_t base = firstInstance * sizeof(Mat4);
+	for (GLuint col = 0; col < 4; ++col)
+	{
+		gl->EnableVertexAttribArray(INSTANCE_XFORM_ATTR + col);
+		gl->VertexAttribPointer(INSTANCE_XFORM_ATTR + col, 4, GL_FLOAT, GL_FALSE, sizeof(Mat4), (void*)(base + col * sizeof(Vec4)));
+		gl->VertexAttribDivisor(INSTANCE_XFORM_ATTR + col, 1);
+	}
+
+	gl->BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBatcher::UnbindInstanceAttributes()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	for (GLuint col = 0; col < 4; ++col)
+	{
+		gl->DisableVertexAttribArray(INSTANCE_XFORM_ATTR + col);
+		gl->VertexAttribDivisor(INSTANCE_XFORM_ATTR + col, 0);
+	}
+}
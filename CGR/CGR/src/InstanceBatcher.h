@@ -0,0 +1,82 @@
+#ifndef __INSTANCE_BATCHER_H__
+#define __INSTANCE_BATCHER_H__
+
+#include <vector>
+#include <map>
+
+#include "gl_headers.h"
+#include "types.h"
+#include "DynamicBuffer.h"
+
+struct Renderable;
+
+// Attribute location of the per instance world matrix, a mat4 takes this and the next three
+#define INSTANCE_XFORM_ATTR		4
+
+// Mesh renderers that can share a draw, the flags are uniforms in the lighting shader so must match too
+struct InstanceKey
+{
+	size_t	mesh;
+	size_t	materialSet;
+	size_t	shader;
+	int		bumpMaps;
+	int		receiveShadows;
+
+	bool operator<(const InstanceKey& other) const;
+};
+
+// An object found visible by a queueing job, added to its group once the jobs are merged
+struct InstanceCandidate
+{
+	InstanceKey			key;
+	const Renderable*	object;
+	float				depth;
+};
+
+struct InstanceGroup
+{
+	std::vector<const Renderable*>	objects;
+	std::vector<Mat4>				xforms;
+	float							nearestDepth;
+};
+
+/*
+	Groups visible mesh renderers sharing mesh, material set and shader, then streams their world
+	matrices into one instance buffer so each group is drawn with a single instanced call per sub mesh.
+*/
+class InstanceBatcher
+{
+public:
+	typedef std::map<InstanceKey, InstanceGroup> GroupMap;
+
+	InstanceBatcher();
+	~InstanceBatcher();
+
+	bool				Init();
+	void				Close();
+
+	void				Begin();
+	void				Add(const InstanceKey& key, const Renderable* object, const Mat4& world, float depth);
+	GroupMap&			Groups();
+
+	// Copies a group's matrices into the frame's instance data, returns the index of its first instance
+	uint32				Append(const InstanceGroup& group);
+	// Streams everything appended since the last upload to the instance buffer
+	void				Upload();
+	// Both expect the mesh vao to be bound. The vao is shared with plain draws of the mesh, so the attributes
+	// are turned off again once the group has drawn
+	void				BindInstanceAttributes(uint32 firstInstance);
+	void				UnbindInstanceAttributes();
+
+private:
+	GroupMap			m_Groups;
+	std::vector<Mat4>	m_InstanceData;
+	DynamicBuffer		m_VBO;
+};
+
+INLINE InstanceBatcher::GroupMap& InstanceBatcher::Groups()
+{
+	return m_Groups;
+}
+
+#endif
@@ -0,0 +1,147 @@
+#include "JobSystem.h"
+
+#include "LogFile.h"
+#include "utils.h"
+#include "Profiler.h"
+
+JobSystem::JobSystem() :
+	m_Workers(),
+	m_Job(nullptr),
+	m_Count(0),
+	m_ChunkSize(0),
+	m_NumChunks(0),
+	m_NextChunk(0),
+	m_Pending(0),
+	m_Generation(0),
+	m_Quit(false)
+{
+}
+
+JobSystem::~JobSystem()
+{
+}
+
+bool JobSystem::Init(unsigned numWorkers)
+{
+	if (numWorkers == 0)
+	{
+		unsigned hw = std::thread::hardware_concurrency();
+		numWorkers = hw > 1 ? hw - 1 : 0;
+	}
+
+	m_Quit = false;
+	for (unsigned i = 0; i < numWorkers; ++i)
+	{
+		m_Workers.push_back(std::thread(&JobSystem::workerLoop, this, m_Generation, i + 1));
+	}
+
+	WRITE_LOG("Job system started with " + util::to_str(NumThreads()) + " threads", "info");
+	return true;
+}
+
+void JobSystem::Close()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Quit = true;
+	}
+
+	m_WakeCV.notify_all();
+
+	for (auto t = m_Workers.begin(); t != m_Workers.end(); ++t)
+	{
+		if (t->joinable())
+			t->join();
+	}
+
+	m_Workers.clear();
+}
+
+unsigned JobSystem::ParallelFor(size_t count, size_t minPerChunk, const RangeJob& job)
+{
+	if (count == 0)
+		return 0;
+
+	if (minPerChunk == 0)
+		minPerChunk = 1;
+
+	// Not worth waking anyone for
+	const size_t threads = NumThreads();
+	if (threads == 1 || count <= minPerChunk)
+	{
+		job(0, count, 0);
+		return 1;
+	}
+
+	size_t chunkSize = (count + threads - 1) / threads;
+	if (chunkSize < minPerChunk)
+		chunkSize = minPerChunk;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Job = &job;
+		m_Count = count;
+		m_ChunkSize = chunkSize;
+		m_NumChunks = (unsigned)((count + chunkSize - 1) / chunkSize);
+		m_NextChunk = 0;
+		m_Pending = (unsigned)m_Workers.size();
+		++m_Generation;
+	}
+
+	m_WakeCV.notify_all();
+
+	// The caller takes chunks as well rather than sitting idle
+	runChunks();
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_DoneCV.wait(lock, [this] { return m_Pending == 0; });
+	m_Job = nullptr;
+
+	return m_NumChunks;
+}
+
+void JobSystem::runChunks()
+{
+	for (;;)
+	{
+		unsigned chunk = m_NextChunk++;
+		if (chunk >= m_NumChunks)
+			break;
+
+		size_t begin = chunk * m_ChunkSize;
+		size_t end = begin + m_ChunkSize;
+		if (end > m_Count)
+			end = m_Count;
+
+		(*m_Job)(begin, end, chunk);
+	}
+}
+
+void JobSystem::workerLoop(uint64 generation, unsigned index)
+{
+	PROFILE_THREAD("Worker " + util::to_str(index));
+
+	// Starts from the generation current at Init, so a ParallelFor issued before this thread gets going isn't missed
+	uint64 seen = generation;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WakeCV.wait(lock, [this, seen] { return m_Quit || m_Generation != seen; });
+
+			if (m_Quit)
+				return;
+
+			seen = m_Generation;
+		}
+
+		runChunks();
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (--m_Pending == 0)
+				m_DoneCV.notify_one();
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#ifndef __JOB_SYSTEM_H__
+#define __JOB_SYSTEM_H__
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+#include "types.h"
+
+/*
+	A fixed pool of worker threads for splitting a loop over the cores. ParallelFor cuts the range
+	into at most NumThreads() contiguous chunks, the calling thread works on chunks too and the call
+	returns once every chunk is done. Chunk indices are stable for a given count so per chunk output
+	can be merged back in order.
+*/
+class JobSystem
+{
+public:
+	typedef std::function<void(size_t begin, size_t end, unsigned chunk)> RangeJob;
+
+	JobSystem();
+	~JobSystem();
+
+	// 0 workers picks one per hardware thread, minus the caller
+	bool				Init(unsigned numWorkers = 0);
+	void				Close();
+
+	// Workers plus the calling thread, the most chunks a ParallelFor will be split into
+	unsigned			NumThreads() const;
+
+	// Runs job over [0, count), ranges are never smaller than minPerChunk. Returns the number of chunks used
+	unsigned			ParallelFor(size_t count, size_t minPerChunk, const RangeJob& job);
+
+private:
+	void				workerLoop(uint64 generation, unsigned index);
+	void				runChunks();
+
+private:
+	std::vector<std::thread>	m_Workers;
+	std::mutex					m_Mutex;
+	std::condition_variable		m_WakeCV;
+	std::condition_variable		m_DoneCV;
+	const RangeJob*				m_Job;
+	size_t						m_Count;
+	size_t						m_ChunkSize;
+	unsigned					m_NumChunks;
+	std::atomic<unsigned>		m_NextChunk;
+	unsigned					m_Pending;
+	uint64						m_Generation;
+	bool						m_Quit;
+};
+
+INLINE unsigned JobSystem::NumThreads() const
+{
+	return (unsigned)m_Workers.size() + 1;
+}
+
+#endif
@@ -0,0 +1,417 @@
+#include "LightClusterer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "OpenGlLayer.h"
+
+// Same rule as the frustum batch tests, SSE is there on every platform we build for
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define CLUSTER_SSE
+#include <xmmintrin.h>
+#endif
+
+// Depth ranges are widened by this fraction so the shader's log can't round a lit fragment into a slice the light missed
+#define CLUSTER_DEPTH_PAD	1e-4f
+
+// And the screen rects by this much of a cell
+#define CLUSTER_TILE_PAD	1e-3f
+
+// Smallest store a light or cluster buffer gets, so a frame without lights still has something bound
+#define LIGHT_BUFFER_MIN_BYTES	256
+
+static INLINE int toCell(float ndc, int cells, float pad)
+{
+	// Clamped as a float first, ndc is unbounded for lights right on the near plane
+	float f = (ndc * 0.5f + 0.5f) * cells + pad;
+	f = f < 0.0f ? 0.0f : (f > (float)(cells - 1) ? (float)(cells - 1) : f);
+	return (int)f;
+}
+
+LightClusterer::LightClusterer() :
+	m_Header(),
+	m_Ranges(),
+	m_Indices(),
+	m_Spans(),
+	m_Cursor(),
+	m_NumSlices(1),
+	m_Stats(),
+	m_Spheres(),
+	m_ViewX(),
+	m_ViewY(),
+	m_ViewZ(),
+	m_FirstSlice(),
+	m_LastSlice()
+{
+	for (int i = 0; i <= CLUSTER_Z; ++i)
+		m_SliceDepth[i] = 0.0f;
+}
+
+LightClusterer::~LightClusterer()
+{
+}
+
+bool LightClusterer::Init()
+{
+	bool success = true;
+	for (int i = 0; i < NumBuffers; ++i)
+		success &= m_Buffers[i].Init(GL_SHADER_STORAGE_BUFFER);
+
+	m_Ranges.assign(NUM_CLUSTERS, ClusterRange());
+	m_Cursor.resize(NUM_CLUSTERS);
+	return success;
+}
+
+void LightClusterer::Close()
+{
+	for (int i = 0; i < NumBuffers; ++i)
+		m_Buffers[i].Close();
+
+	m_Ranges.clear();
+	m_Indices.clear();
+	m_Spans.clear();
+}
+
+void LightClusterer::SpotBounds(const SpotLightData& spot, Vec3& centre, float& radius)
+{
+	const float cosAngle = spot.coneAngle;
+
+	if (cosAngle <= 0.0f)
+	{
+		// Wider than a hemisphere, only the range sphere holds it
+		centre = spot.position;
+		radius = spot.range;
+	}
+	else if (cosAngle < 0.70710678f)
+	{
+		// Past 45 degrees the rim of the cone's cap is the widest part, centre the sphere on it
+		centre = spot.position + spot.direction * (spot.range * cosAngle);
+		radius = spot.range * sqrtf(1.0f - cosAngle * cosAngle);
+	}
+	else
+	{
+		// Narrow cones fit a sphere through the apex and the cap's rim
+		radius = spot.range / (2.0f * cosAngle);
+		centre = spot.position + spot.direction * radius;
+	}
+}
+
+void LightClusterer::setSlices(const Mat4& proj)
+{
+	// glm matrices are column major, proj[col][row]
+	const bool ortho = proj[3][3] == 1.0f;
+	float nearZ, farZ;
+
+	if (ortho)
+	{
+		nearZ = (proj[3][2] + 1.0f) / proj[2][2];
+		farZ = (proj[3][2] - 1.0f) / proj[2][2];
+	}
+	else
+	{
+		nearZ = proj[3][2] / (proj[2][2] - 1.0f);
+		farZ = proj[3][2] / (proj[2][2] + 1.0f);
+	}
+
+	// Orthographic views, and anything the log can't slice, are one slice deep
+	if (ortho || nearZ <= 0.0f || !(farZ > nearZ) || farZ == FLT_MAX || !std::isfinite(farZ))
+	{
+		m_NumSlices = 1;
+		m_SliceDepth[0] = nearZ;
+		m_SliceDepth[1] = std::isfinite(farZ) ? farZ : FLT_MAX;
+		m_Header.depthScale = 0.0f;
+		m_Header.depthBias = 0.0f;
+	}
+	else
+	{
+		m_NumSlices = CLUSTER_Z;
+		const float logRatio = logf(farZ / nearZ);
+
+		for (int i = 0; i <= CLUSTER_Z; ++i)
+			m_SliceDepth[i] = nearZ * expf(logRatio * (float)i / (float)CLUSTER_Z);
+
+		m_SliceDepth[CLUSTER_Z] = farZ;
+		m_Header.depthScale = (float)CLUSTER_Z / logRatio;
+		m_Header.depthBias = -(float)CLUSTER_Z * logf(nearZ) / logRatio;
+	}
+
+	m_Header.grid[0] = CLUSTER_X;
+	m_Header.grid[1] = CLUSTER_Y;
+	m_Header.grid[2] = (uint32)m_NumSlices;
+	m_Header.grid[3] = 0;
+}
+
+void LightClusterer::Build(const std::vector<PointLightData>& points, const std::vector<SpotLightData>& spots,
+	const Mat4& proj, const Mat4& view, float width, float height)
+{
+	setSlices(proj);
+	m_Header.screenWidth = width;
+	m_Header.screenHeight = height;
+
+	m_Spans.clear();
+	m_Stats = ClusterStats();
+
+	// Points first, so filling the index list in span order leaves each cluster's points ahead of its spots
+	m_Spheres.Clear();
+	for (auto p = points.begin(); p != points.end(); ++p)
+		m_Spheres.Push(p->position, p->range);
+
+	binSpheres(proj, view, 0);
+
+	m_Spheres.Clear();
+	for (auto s = spots.begin(); s != spots.end(); ++s)
+	{
+		Vec3 centre;
+		float radius;
+		SpotBounds(*s, centre, radius);
+
+		// Switched off spots keep their slot with a radius that bins nothing
+		m_Spheres.Push(centre, s->switchedOn ? radius : -1.0f);
+	}
+
+	binSpheres(proj, view, 1);
+
+	// Count each cluster's lights
+	m_Ranges.assign(NUM_CLUSTERS, ClusterRange());
+	m_Cursor.resize(NUM_CLUSTERS);
+
+	for (auto s = m_Spans.begin(); s != m_Spans.end(); ++s)
+	{
+		for (int y = s->y0; y <= s->y1; ++y)
+		{
+			ClusterRange* row = &m_Ranges[(s->slice * CLUSTER_Y + y) * CLUSTER_X];
+			for (int x = s->x0; x <= s->x1; ++x)
+			{
+				if (s->spot)
+					++row[x].numSpots;
+				else
+					++row[x].numPoints;
+			}
+		}
+	}
+
+	// Prefix sum gives each cluster its place in the index list
+	uint32 offset = 0;
+	for (int c = 0; c < NUM_CLUSTERS; ++c)
+	{
+		const uint32 count = m_Ranges[c].numPoints + m_Ranges[c].numSpots;
+		m_Ranges[c].offset = offset;
+		m_Cursor[c] = offset;
+		offset += count;
+		m_Stats.maxPerCluster = std::max(m_Stats.maxPerCluster, count);
+	}
+
+	m_Indices.resize(offset);
+	m_Stats.references = offset;
+
+	// Fill, same walk as the count
+	for (auto s = m_Spans.begin(); s != m_Spans.end(); ++s)
+	{
+		for (int y = s->y0; y <= s->y1; ++y)
+		{
+			uint32* cursor = &m_Cursor[(s->slice * CLUSTER_Y + y) * CLUSTER_X];
+			for (int x = s->x0; x <= s->x1; ++x)
+				m_Indices[cursor[x]++] = s->light;
+		}
+	}
+}
+
+void LightClusterer::binSpheres(const Mat4& proj, const Mat4& view, byte spot)
+{
+	const size_t count = m_Spheres.Size();
+	m_ViewX.resize(count);
+	m_ViewY.resize(count);
+	m_ViewZ.resize(count);
+	m_FirstSlice.resize(count);
+	m_LastSlice.resize(count);
+
+	const float nearZ = m_SliceDepth[0];
+	const float farZ = m_SliceDepth[m_NumSlices];
+	size_t i = 0;
+
+#if defined(CLUSTER_SSE)
+	// 4 lights to view space, then their slice range is how many slice boundaries lie at or before each end
+	const __m128 v00 = _mm_set1_ps(view[0][0]), v10 = _mm_set1_ps(view[1][0]), v20 = _mm_set1_ps(view[2][0]), v30 = _mm_set1_ps(view[3][0]);
+	const __m128 v01 = _mm_set1_ps(view[0][1]), v11 = _mm_set1_ps(view[1][1]), v21 = _mm_set1_ps(view[2][1]), v31 = _mm_set1_ps(view[3][1]);
+	const __m128 v02 = _mm_set1_ps(view[0][2]), v12 = _mm_set1_ps(view[1][2]), v22 = _mm_set1_ps(view[2][2]), v32 = _mm_set1_ps(view[3][2]);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 pad = _mm_set1_ps(CLUSTER_DEPTH_PAD);
+	const __m128 nearV = _mm_set1_ps(nearZ);
+	const __m128 farV = _mm_set1_ps(farZ);
+	const __m128 noSlice = _mm_set1_ps((float)CLUSTER_Z);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(&m_Spheres.x[i]);
+		__m128 y = _mm_loadu_ps(&m_Spheres.y[i]);
+		__m128 z = _mm_loadu_ps(&m_Spheres.z[i]);
+		__m128 r = _mm_loadu_ps(&m_Spheres.radius[i]);
+
+		__m128 vx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v00, x), _mm_mul_ps(v10, y)), _mm_add_ps(_mm_mul_ps(v20, z), v30));
+		__m128 vy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v01, x), _mm_mul_ps(v11, y)), _mm_add_ps(_mm_mul_ps(v21, z), v31));
+		__m128 depth = _mm_sub_ps(zero, _mm_add_ps(_mm_add_ps(_mm_mul_ps(v02, x), _mm_mul_ps(v12, y)), _mm_add_ps(_mm_mul_ps(v22, z), v32)));
+
+		// Widened by a fraction of |depth| + r
+		__m128 widen = _mm_add_ps(r, _mm_mul_ps(pad, _mm_add_ps(_mm_max_ps(depth, _mm_sub_ps(zero, depth)), r)));
+		__m128 minD = _mm_sub_ps(depth, widen);
+		__m128 maxD = _mm_add_ps(depth, widen);
+
+		__m128 first = zero, last = zero;
+		for (int s = 1; s < m_NumSlices; ++s)
+		{
+			__m128 boundary = _mm_set1_ps(m_SliceDepth[s]);
+			first = _mm_add_ps(first, _mm_and_ps(_mm_cmple_ps(boundary, minD), one));
+			last = _mm_add_ps(last, _mm_and_ps(_mm_cmple_ps(boundary, maxD), one));
+		}
+
+		// Lights wholly before the near plane or past the far one, and switched off spots, get an empty range
+		__m128 valid = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(maxD, nearV), _mm_cmple_ps(minD, farV)), _mm_cmpge_ps(r, zero));
+		first = _mm_or_ps(_mm_and_ps(valid, first), _mm_andnot_ps(valid, noSlice));
+
+		_mm_storeu_ps(&m_ViewX[i], vx);
+		_mm_storeu_ps(&m_ViewY[i], vy);
+		_mm_storeu_ps(&m_ViewZ[i], depth);
+		_mm_storeu_ps(&m_FirstSlice[i], first);
+		_mm_storeu_ps(&m_LastSlice[i], last);
+	}
+#endif
+
+	// Whatever doesn't fill a register
+	for (; i < count; ++i)
+	{
+		const Vec3 c(m_Spheres.x[i], m_Spheres.y[i], m_Spheres.z[i]);
+		const float r = m_Spheres.radius[i];
+		const Vec4 v = view * Vec4(c, 1.0f);
+		const float depth = -v.z;
+		const float widen = r + CLUSTER_DEPTH_PAD * (fabsf(depth) + r);
+		const float minD = depth - widen;
+		const float maxD = depth + widen;
+
+		int first = 0, last = 0;
+		for (int s = 1; s < m_NumSlices; ++s)
+		{
+			first += m_SliceDepth[s] <= minD ? 1 : 0;
+			last += m_SliceDepth[s] <= maxD ? 1 : 0;
+		}
+
+		if (maxD < nearZ || minD > farZ || r < 0.0f)
+			first = CLUSTER_Z;
+
+		m_ViewX[i] = v.x;
+		m_ViewY[i] = v.y;
+		m_ViewZ[i] = depth;
+		m_FirstSlice[i] = (float)first;
+		m_LastSlice[i] = (float)last;
+	}
+
+	for (i = 0; i < count; ++i)
+	{
+		const int first = (int)m_FirstSlice[i];
+		const int last = (int)m_LastSlice[i];
+		if (first > last)
+			continue;
+
+		if (addSpans((uint32)i, Vec3(m_ViewX[i], m_ViewY[i], m_ViewZ[i]), m_Spheres.radius[i], first, last, proj, spot))
+		{
+			if (spot)
+				++m_Stats.spots;
+			else
+				++m_Stats.points;
+		}
+	}
+}
+
+bool LightClusterer::addSpans(uint32 light, const Vec3& centre, float radius, int firstSlice, int lastSlice, const Mat4& proj, byte spot)
+{
+	// centre is view space x and y with z as the depth in front of the eye
+	bool added = false;
+
+	for (int s = firstSlice; s <= lastSlice; ++s)
+	{
+		// The part of the sphere's depth inside this slice, the box it makes with the sphere's x and y is
+		// projected by its corners, which is where a rational function of x or y and z peaks on a box
+		const float d0 = std::max(centre.z - radius, m_SliceDepth[s]);
+		const float d1 = std::max(d0, std::min(centre.z + radius, m_SliceDepth[s + 1]));
+
+		float minX = FLT_MAX, maxX = -FLT_MAX;
+		float minY = FLT_MAX, maxY = -FLT_MAX;
+
+		for (int c = 0; c < 2; ++c)
+		{
+			const float z = -(c == 0 ? d0 : d1);
+			const float invW = 1.0f / (proj[2][3] * z + proj[3][3]);
+			const float bx = proj[2][0] * z + proj[3][0];
+			const float by = proj[2][1] * z + proj[3][1];
+
+			const float x0 = (proj[0][0] * (centre.x - radius) + bx) * invW;
+			const float x1 = (proj[0][0] * (centre.x + radius) + bx) * invW;
+			const float y0 = (proj[1][1] * (centre.y - radius) + by) * invW;
+			const float y1 = (proj[1][1] * (centre.y + radius) + by) * invW;
+
+			minX = std::min(minX, std::min(x0, x1));
+			maxX = std::max(maxX, std::max(x0, x1));
+			minY = std::min(minY, std::min(y0, y1));
+			maxY = std::max(maxY, std::max(y0, y1));
+		}
+
+		// Off screen within this slice
+		if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+			continue;
+
+		ClusterSpan span;
+		span.light = light;
+		span.slice = (byte)s;
+		span.x0 = (byte)toCell(minX, CLUSTER_X, -CLUSTER_TILE_PAD);
+		span.x1 = (byte)toCell(maxX, CLUSTER_X, CLUSTER_TILE_PAD);
+		span.y0 = (byte)toCell(minY, CLUSTER_Y, -CLUSTER_TILE_PAD);
+		span.y1 = (byte)toCell(maxY, CLUSTER_Y, CLUSTER_TILE_PAD);
+		span.spot = spot;
+		m_Spans.push_back(span);
+		added = true;
+	}
+
+	return added;
+}
+
+uint32 LightClusterer::ClusterIndex(const Vec3& viewPos, float pixelX, float pixelY) const
+{
+	const float depth = std::max(-viewPos.z, 1e-4f);
+
+	float slice = logf(depth) * m_Header.depthScale + m_Header.depthBias;
+	slice = std::min(std::max(slice, 0.0f), (float)(m_Header.grid[2] - 1));
+
+	const float u = std::min(std::max(pixelX / m_Header.screenWidth, 0.0f), 0.999999f);
+	const float v = std::min(std::max(pixelY / m_Header.screenHeight, 0.0f), 0.999999f);
+	const uint32 x = (uint32)(u * CLUSTER_X);
+	const uint32 y = (uint32)(v * CLUSTER_Y);
+
+	return ((uint32)slice * CLUSTER_Y + y) * CLUSTER_X + x;
+}
+
+void LightClusterer::Upload(const std::vector<PointLightData>& points, const std::vector<SpotLightData>& spots, bool lightsChanged)
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	// The lights only go up when one of them has changed, the clusters follow the camera so go every frame.
+	// None are ever left without a store so the bindings are always valid
+	if (lightsChanged || m_Buffers[PointBuffer].Capacity() == 0)
+	{
+		m_Buffers[PointBuffer].Upload(points.data(), points.size() * sizeof(PointLightData), LIGHT_BUFFER_MIN_BYTES);
+		m_Buffers[SpotBuffer].Upload(spots.data(), spots.size() * sizeof(SpotLightData), LIGHT_BUFFER_MIN_BYTES);
+	}
+
+	const size_t rangeBytes = m_Ranges.size() * sizeof(ClusterRange);
+	m_Buffers[ClusterBuffer].Reserve(sizeof(ClusterHeader) + rangeBytes, LIGHT_BUFFER_MIN_BYTES);
+	gl->BufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(ClusterHeader), &m_Header);
+	gl->BufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(ClusterHeader), rangeBytes, m_Ranges.data());
+	gl->BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	m_Buffers[IndexBuffer].Upload(m_Indices.data(), m_Indices.size() * sizeof(uint32), LIGHT_BUFFER_MIN_BYTES);
+
+	gl->BindBufferBase(GL_SHADER_STORAGE_BUFFER, POINT_LIGHT_BINDING, m_Buffers[PointBuffer].Handle());
+	gl->BindBufferBase(GL_SHADER_STORAGE_BUFFER, SPOT_LIGHT_BINDING, m_Buffers[SpotBuffer].Handle());
+	gl->BindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_CLUSTER_BINDING, m_Buffers[ClusterBuffer].Handle());
+	gl->BindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_INDEX_BINDING, m_Buffers[IndexBuffer].Handle());
+}
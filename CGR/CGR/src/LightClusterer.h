@@ -0,0 +1,136 @@
+#ifndef __LIGHT_CLUSTERER_H__
+#define __LIGHT_CLUSTERER_H__
+
+#include <vector>
+
+#include "gl_headers.h"
+#include "types.h"
+#include "DynamicBuffer.h"
+#include "Lights.h"
+#include "Frustum.h"
+
+// Froxel grid, x and y split the screen evenly and z is split exponentially between the near and far planes
+#define CLUSTER_X	16
+#define CLUSTER_Y	9
+#define CLUSTER_Z	24
+#define NUM_CLUSTERS (CLUSTER_X * CLUSTER_Y * CLUSTER_Z)
+
+// Head of the cluster buffer, the per cluster ranges follow it
+struct ClusterHeader
+{
+	uint32	grid[4];		// Cells in x, y and z
+	float	depthScale;		// slice = log(depth) * depthScale + depthBias
+	float	depthBias;
+	float	screenWidth;
+	float	screenHeight;
+};
+
+// One per cluster, the cluster's points then its spots are listed from offset in the index list
+struct ClusterRange
+{
+	uint32	offset;
+	uint32	numPoints;
+	uint32	numSpots;
+	uint32	pad;
+};
+
+struct ClusterStats
+{
+	uint32	points;			// Lights binned this frame, off screen lights aren't counted
+	uint32	spots;
+	uint32	references;		// Entries in the index list
+	uint32	maxPerCluster;
+};
+
+/*
+	Bins point and spot lights into a view space froxel grid so a fragment only lights itself with the
+	lights that can reach its cluster. Each light's sphere is moved to view space and given a range of
+	depth slices four at a time with SSE, then every slice it spans is given the screen rect of the
+	sphere's bounds within that slice. Ranges are counted, offset with a prefix sum and filled into one
+	index list, which goes to the shaders with the cluster table as shader storage buffers.
+
+	Build only touches the CPU so binning can be run and checked without a GL context, Upload sends
+	the results and the light data.
+*/
+class LightClusterer
+{
+	enum { PointBuffer, SpotBuffer, ClusterBuffer, IndexBuffer, NumBuffers };
+public:
+	LightClusterer();
+	~LightClusterer();
+
+	bool						Init();
+	void						Close();
+
+	// Bins the lights for a view, width and height are the size of the target in pixels
+	void						Build(const std::vector<PointLightData>& points, const std::vector<SpotLightData>& spots,
+									const Mat4& proj, const Mat4& view, float width, float height);
+
+	// Sends the cluster table and index list, and the light data when lightsChanged, then binds all four
+	void						Upload(const std::vector<PointLightData>& points, const std::vector<SpotLightData>& spots, bool lightsChanged);
+
+	// Cluster a view space position falls in, the same sums the shaders do
+	uint32						ClusterIndex(const Vec3& viewPos, float pixelX, float pixelY) const;
+
+	const ClusterHeader&		Header() const;
+	const ClusterRange&			Range(uint32 cluster) const;
+	const std::vector<uint32>&	Indices() const;
+	const ClusterStats&			Stats() const;
+
+	// Sphere that holds a spot's cone out to its range
+	static void					SpotBounds(const SpotLightData& spot, Vec3& centre, float& radius);
+
+private:
+	// Screen rect and slice of one light, filled by the binning pass and walked twice
+	struct ClusterSpan
+	{
+		uint32	light;
+		byte	slice;
+		byte	x0, x1;
+		byte	y0, y1;
+		byte	spot;
+	};
+
+	void						setSlices(const Mat4& proj);
+	void						binSpheres(const Mat4& proj, const Mat4& view, byte spot);
+	bool						addSpans(uint32 light, const Vec3& centre, float radius, int firstSlice, int lastSlice, const Mat4& proj, byte spot);
+
+private:
+	ClusterHeader				m_Header;
+	std::vector<ClusterRange>	m_Ranges;
+	std::vector<uint32>			m_Indices;
+	std::vector<ClusterSpan>	m_Spans;
+	std::vector<uint32>			m_Cursor;
+	float						m_SliceDepth[CLUSTER_Z + 1];	// Near depth of each slice, the last is the far plane
+	int							m_NumSlices;
+	ClusterStats				m_Stats;
+
+	// World spheres of the lights being binned, and their view space centres and slice ranges
+	SphereArrays				m_Spheres;
+	std::vector<float>			m_ViewX, m_ViewY, m_ViewZ;
+	std::vector<float>			m_FirstSlice, m_LastSlice;
+
+	DynamicBuffer				m_Buffers[NumBuffers];
+};
+
+INLINE const ClusterHeader& LightClusterer::Header() const
+{
+	return m_Header;
+}
+
+INLINE const ClusterRange& LightClusterer::Range(uint32 cluster) const
+{
+	return m_Ranges[cluster];
+}
+
+INLINE const std::vector<uint32>& LightClusterer::Indices() const
+{
+	return m_Indices;
+}
+
+INLINE const ClusterStats& LightClusterer::Stats() const
+{
+	return m_Stats;
+}
+
+#endif
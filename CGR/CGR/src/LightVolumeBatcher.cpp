@@ -0,0 +1,85 @@
+#include "LightVolumeBatcher.h"
+
+#include "OpenGlLayer.h"
+
+LightVolumeBatcher::LightVolumeBatcher() :
+	m_Instances(),
+	m_Spheres(),
+	m_Visible(),
+	m_VBO()
+{
+}
+
+LightVolumeBatcher::~LightVolumeBatcher()
+{
+}
+
+bool LightVolumeBatcher::Init()
+{
+	return m_VBO.Init(GL_ARRAY_BUFFER);
+}
+
+void LightVolumeBatcher::Close()
+{
+	m_VBO.Close();
+	m_Instances.clear();
+}
+
+uint32 LightVolumeBatcher::Upload(const std::vector<PointLightData>& lights, const Frustum* frustum)
+{
+	m_Instances.clear();
+
+	if (frustum)
+	{
+		m_Spheres.Clear();
+		m_Spheres.Reserve(lights.size());
+		for (size_t i = 0; i < lights.size(); ++i)
+			m_Spheres.Push(lights[i].position, lights[i].range);
+
+		frustum->CullSpheres(m_Spheres, m_Visible);
+
+		for (size_t i = 0; i < lights.size(); ++i)
+		{
+			if (Frustum::IsVisible(m_Visible, i))
+				m_Instances.push_back(lights[i]);
+		}
+	}
+	else
+	{
+		m_Instances = lights;
+	}
+
+	if (m_Instances.empty())
+		return 0;
+
+	m_VBO.Upload(m_Instances.data(), m_Instances.size() * sizeof(PointLightData));
+	return (uint32)m_Instances.size();
+}
+
+void LightVolumeBatcher::BindInstanceAttributes()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->BindBuffer(GL_ARRAY_BUFFER, m_VBO.Handle());
+
+	// position/range, intensity/ambient and the attenuation terms, one light per instance
+	for (GLuint i = 0; i < LIGHT_VOLUME_NUM_ATTRS; ++i)
+	{
+		gl->EnableVertexAttribArray(LIGHT_VOLUME_ATTR + i);
+		gl->VertexAttribPointer(LIGHT_VOLUME_ATTR + i, 4, GL_FLOAT, GL_FALSE, sizeof(PointLightData), (void*)(i * sizeof(Vec4)));
+		gl->VertexAttribDivisor(LIGHT_VOLUME_ATTR + i, 1);
+	}
+
+	gl->BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void LightVolumeBatcher::UnbindInstanceAttributes()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	for (GLuint i = 0; i < LIGHT_VOLUME_NUM_ATTRS; ++i)
+	{
+		gl->DisableVertexAttribArray(LIGHT_VOLUME_ATTR + i);
+		gl->VertexAttribDivisor(LIGHT_VOLUME_ATTR + i, 0);
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef __LIGHT_VOLUME_BATCHER_H__
+#define __LIGHT_VOLUME_BATCHER_H__
+
+#include <vector>
+
+#include "gl_headers.h"
+#include "types.h"
+#include "DynamicBuffer.h"
+#include "Lights.h"
+#include "Frustum.h"
+
+// Attribute locations of the per light data, three vec4s laid out the same as PointLightData
+#define LIGHT_VOLUME_ATTR		4
+#define LIGHT_VOLUME_NUM_ATTRS	3
+
+/*
+	Streams the point lights the camera can see into one instance buffer so the deferred pass can draw
+	every light volume with a single instanced call per sub mesh, the vertex shader scales and places
+	the unit sphere from the instance data and hands the light to the fragment shader.
+*/
+class LightVolumeBatcher
+{
+public:
+	LightVolumeBatcher();
+	~LightVolumeBatcher();
+
+	bool						Init();
+	void						Close();
+
+	// Culls the light spheres against the frustum, or keeps them all without one, and uploads the survivors. Returns how many
+	uint32						Upload(const std::vector<PointLightData>& lights, const Frustum* frustum);
+	// Expects the volume mesh vao to be bound
+	void						BindInstanceAttributes();
+	// The sphere vao is shared with plain draws of the mesh, call once the volumes have drawn
+	void						UnbindInstanceAttributes();
+
+	uint32						Count() const;
+
+private:
+	std::vector<PointLightData>	m_Instances;
+	SphereArrays				m_Spheres;
+	std::vector<uint32>			m_Visible;
+	DynamicBuffer				m_VBO;
+};
+
+INLINE uint32 LightVolumeBatcher::Count() const
+{
+	return (uint32)m_Instances.size();
+}
+
+#endif
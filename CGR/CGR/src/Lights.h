@@ -1,7 +1,43 @@
 #ifndef __LIGHTS_H__
 #define __LIGHTS_H__
 
-#define MAX_SPOTS 10
-#define MAX_POINTS 10
+#include "types.h"
 
-#endif
\ No newline at end of file
+// Capacity of the light buffers, the shaders only ever loop over the lights binned into their cluster
+#define MAX_SPOTS 256
+#define MAX_POINTS 1024
+
+// Shader storage binding points of the light data, the cluster table and the light index list
+#define POINT_LIGHT_BINDING		2
+#define SPOT_LIGHT_BINDING		3
+#define LIGHT_CLUSTER_BINDING	4
+#define LIGHT_INDEX_BINDING		5
+
+// std430 mirrors of the shader structs, keep the padding so the layouts match
+struct PointLightData
+{
+	Vec3	position;
+	float	range;
+	Vec3	intensity;
+	float	ambientIntensity;
+	float	aConstant;
+	float	aLinear;
+	float	aQuadratic;
+	float	pad;
+};
+
+struct SpotLightData
+{
+	Vec3	position;
+	float	range;
+	Vec3	direction;
+	float	coneAngle;		// Cosine of the half angle
+	Vec3	intensity;
+	int		switchedOn;
+	float	aConstant;
+	float	aLinear;
+	float	aQuadratic;
+	float	pad;
+};
+
+#endif
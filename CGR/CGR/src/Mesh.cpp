@@ -1,6 +1,7 @@
 #include "Mesh.h"
 
 #include <fstream>
+#include <algorithm>
 #include "LogFile.h"
 #include "Vertex.h"
 #include "OpenGlLayer.h"
@@ -8,6 +9,8 @@
 #include "Material.h"
 #include "Image.h"
 #include "ResourceManager.h"
+#include "MeshOptimizer.h"
+#include "utils.h"
 
 // Assimp
 #include "assimp\Importer.hpp"
@@ -19,6 +22,9 @@
 uint64 Mesh::NumVerts = 0;
 uint64 Mesh::NumMeshes = 0;
 
+// Walls, floors and pillars are the few big triangles, past this many the rest hide too little to be worth rasterizing
+#define MAX_OCCLUDER_TRIANGLES	4096
+
 // This is no good having these global but doesn't seem to work otherwise!!
 const struct aiScene* scene = NULL;
 Assimp::Importer importer;
@@ -199,6 +205,36 @@ void SubMesh::Init(const aiMesh* paiMesh, std::vector<VertexTan>& vertices, std:
 	}
 }
 
+// Optimises each sub mesh on its own and appends it, indices stay local to the sub mesh's vertices
+template<typename V>
+static void loadSubMeshes(const std::string& mesh, std::vector<SubMesh>& subMeshes, std::vector<V>& vertices, std::vector<dword>& indices)
+{
+	uint32 before = 0;
+	for (size_t m = 0; m < subMeshes.size(); ++m)
+	{
+		std::vector<V> subVertices;
+		std::vector<dword> subIndices;
+		subMeshes[m].Init(scene->mMeshes[m], subVertices, subIndices);
+
+		MeshOptimizeStats stats;
+		MeshOptimizer::Optimize(subVertices, subIndices, stats);
+
+		subMeshes[m].BaseVertex = (unsigned)vertices.size();
+		subMeshes[m].BaseIndex = (unsigned)indices.size();
+		subMeshes[m].NumVertices = (unsigned)subVertices.size();
+		subMeshes[m].NumIndices = (unsigned)subIndices.size();
+
+		vertices.insert(vertices.end(), subVertices.begin(), subVertices.end());
+		indices.insert(indices.end(), subIndices.begin(), subIndices.end());
+		before += stats.verticesBefore;
+
+		WRITE_LOG("Optimised " + mesh + " sub mesh " + util::to_str(m) + ": verts " + util::to_str(stats.verticesBefore) + " -> " +
+			util::to_str(stats.verticesAfter) + ", ACMR " + util::to_str(stats.acmrBefore) + " -> " + util::to_str(stats.acmrAfter), "info");
+	}
+
+	WRITE_LOG("Optimised " + mesh + ": verts " + util::to_str(before) + " -> " + util::to_str(vertices.size()), "info");
+}
+
 
 //--------------------------------
 Mesh::Mesh() :
@@ -218,6 +254,8 @@ Mesh::~Mesh()
 
 bool Mesh::Load(const std::string& mesh, bool withTangents, bool loadTextures, unsigned textureSet, ResourceManager* resMan)
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	// Will pass path here and have scene local
 	if (!Import3DFromFile("../resources/meshes/" + mesh))
 	{
@@ -226,12 +264,12 @@ bool Mesh::Load(const std::string& mesh, bool withTangents, bool loadTextures, u
 	}
 
 	// Create the VAO
-	glGenVertexArrays(1, &m_VAO);
-	glBindVertexArray(m_VAO);
+	gl->GenVertexArrays(1, &m_VAO);
+	gl->BindVertexArray(m_VAO);
 
 	// Create the buffers for the vertices atttributes
-	glGenBuffers(1, &m_VertexVBO);
-	glGenBuffers(1, &m_IndexVBO);
+	gl->GenBuffers(1, &m_VertexVBO);
+	gl->GenBuffers(1, &m_IndexVBO);
 
 	// Load here
 	m_SubMeshes.resize(scene->mNumMeshes);
@@ -254,75 +292,78 @@ bool Mesh::Load(const std::string& mesh, bool withTangents, bool loadTextures, u
 			m_SubMeshes[i].MaterialIndex = i;
 		}
 		
-		m_SubMeshes[i].NumIndices = scene->mMeshes[i]->mNumFaces * 3;
-		m_SubMeshes[i].BaseVertex = num_vertices;
-		m_SubMeshes[i].BaseIndex = num_indices;
 
+		// Offsets and counts are set once each sub mesh has been optimised
 		num_vertices += scene->mMeshes[i]->mNumVertices;
-		num_indices += m_SubMeshes[i].NumIndices;
+		num_indices += scene->mMeshes[i]->mNumFaces * 3;
 	}
-
-	Mesh::NumVerts += num_vertices;
 	
 	std::vector<unsigned int> indices;
 	indices.reserve(num_indices);
 
+	std::vector<Vec3> positions;
+	positions.reserve(num_vertices);
+
 	if (!withTangents)
 	{
 		std::vector<Vertex> vertices;
 		vertices.reserve(num_vertices);
 
-		for (int m = 0; m < m_SubMeshes.size(); ++m)
-		{
-			m_SubMeshes[m].Init(scene->mMeshes[m], vertices, indices);
-		}
+		loadSubMeshes(mesh, m_SubMeshes, vertices, indices);
+		Mesh::NumVerts += vertices.size();
+
+		for (size_t v = 0; v < vertices.size(); ++v)
+			positions.push_back(vertices[v].position);
 
 		// Generate and populate the buffers with vertex attributes and the indices
-		glBindBuffer(GL_ARRAY_BUFFER, m_VertexVBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
-
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)12);
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)24);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		gl->BindBuffer(GL_ARRAY_BUFFER, m_VertexVBO);
+		gl->BufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+
+		gl->EnableVertexAttribArray(0);
+		gl->VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
+		gl->EnableVertexAttribArray(1);
+		gl->VertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)12);
+		gl->EnableVertexAttribArray(2);
+		gl->VertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)24);
+		gl->BindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 	else
 	{
 		std::vector<VertexTan> vertTans;
 		vertTans.reserve(num_vertices);
 
-		for (int m = 0; m < m_SubMeshes.size(); ++m)
-		{
-			m_SubMeshes[m].Init(scene->mMeshes[m], vertTans, indices);
-		}
+		loadSubMeshes(mesh, m_SubMeshes, vertTans, indices);
+		Mesh::NumVerts += vertTans.size();
+
+		for (size_t v = 0; v < vertTans.size(); ++v)
+			positions.push_back(vertTans[v].position);
 
 		// Generate and populate the buffers with vertex attributes and the indices
-		glBindBuffer(GL_ARRAY_BUFFER, m_VertexVBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(VertexTan) * vertTans.size(), vertTans.data(), GL_STATIC_DRAW);
+		gl->BindBuffer(GL_ARRAY_BUFFER, m_VertexVBO);
+		gl->BufferData(GL_ARRAY_BUFFER, sizeof(VertexTan) * vertTans.size(), vertTans.data(), GL_STATIC_DRAW);
 
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexTan), 0);
+		gl->EnableVertexAttribArray(0);
+		gl->VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexTan), 0);
 		
-		glEnableVertexAttribArray(1);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(VertexTan), (void*)12);
+		gl->EnableVertexAttribArray(1);
+		gl->VertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(VertexTan), (void*)12);
 		
-		glEnableVertexAttribArray(2);
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VertexTan), (void*)24);
+		gl->EnableVertexAttribArray(2);
+		gl->VertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VertexTan), (void*)24);
 
-		glEnableVertexAttribArray(3);
-		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(VertexTan), (void*)32);
+		gl->EnableVertexAttribArray(3);
+		gl->VertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(VertexTan), (void*)32);
 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		gl->BindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexVBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned) * indices.size(), indices.data(), GL_STATIC_DRAW);
+	gl->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexVBO);
+	gl->BufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned) * indices.size(), indices.data(), GL_STATIC_DRAW);
 
 	// End
-	glBindVertexArray(0);
+	gl->BindVertexArray(0);
+
+	buildOccluder(positions, indices);
 
 	if (loadTextures)
 	{
@@ -335,29 +376,31 @@ bool Mesh::Load(const std::string& mesh, bool withTangents, bool loadTextures, u
 
 bool Mesh::Construct(const std::vector<Vertex>& vertices, const std::vector<uint32>& indices, unsigned materialSet)
 {
-	glGenVertexArrays(1, &m_VAO);
-	glBindVertexArray(m_VAO);
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->GenVertexArrays(1, &m_VAO);
+	gl->BindVertexArray(m_VAO);
 
 	// Create the buffers for the vertices atttributes
-	glGenBuffers(1, &m_VertexVBO);
-	glGenBuffers(1, &m_IndexVBO);
+	gl->GenBuffers(1, &m_VertexVBO);
+	gl->GenBuffers(1, &m_IndexVBO);
 
 	// Generate and populate the buffers with vertex attributes and the indices
-	glBindBuffer(GL_ARRAY_BUFFER, m_VertexVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+	gl->BindBuffer(GL_ARRAY_BUFFER, m_VertexVBO);
+	gl->BufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
 
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)12);
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)24);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	gl->EnableVertexAttribArray(0);
+	gl->VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
+	gl->EnableVertexAttribArray(1);
+	gl->VertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)12);
+	gl->EnableVertexAttribArray(2);
+	gl->VertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)24);
+	gl->BindBuffer(GL_ARRAY_BUFFER, 0);
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexVBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(dword) * indices.size(), indices.data(), GL_STATIC_DRAW);
+	gl->BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_IndexVBO);
+	gl->BufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(dword) * indices.size(), indices.data(), GL_STATIC_DRAW);
 
-	glBindVertexArray(0);
+	gl->BindVertexArray(0);
 
 	m_SubMeshes.resize(1);
 	m_SubMeshes[0].BaseIndex = 0;
@@ -404,9 +447,75 @@ bool Mesh::Construct(const std::vector<Vertex>& vertices, const std::vector<uint
 	m_SubMeshes[0].maxVertex = tempMax;
 	m_SubMeshes[0].centre = (m_SubMeshes[0].minvertex + m_SubMeshes[0].maxVertex) / 2.0f;
 
+	std::vector<Vec3> positions(vertices.size());
+	for (size_t i = 0; i < vertices.size(); ++i)
+		positions[i] = vertices[i].position;
+
+	buildOccluder(positions, indices);
+
 	return true;
 }
 
+void Mesh::buildOccluder(const std::vector<Vec3>& positions, const std::vector<uint32>& indices)
+{
+	struct OccluderTri
+	{
+		float	area;
+		uint32	index[3];
+	};
+
+	m_OccluderVerts.clear();
+	m_OccluderIndices.clear();
+
+	// Indices are local to each sub mesh, flatten them into the one vertex list
+	std::vector<OccluderTri> tris;
+	for (size_t s = 0; s < m_SubMeshes.size(); ++s)
+	{
+		const SubMesh& subMesh = m_SubMeshes[s];
+		for (unsigned i = 0; i + 2 < subMesh.NumIndices; i += 3)
+		{
+			OccluderTri tri;
+			for (int k = 0; k < 3; ++k)
+				tri.index[k] = indices[subMesh.BaseIndex + i + k] + subMesh.BaseVertex;
+
+			if (tri.index[0] >= positions.size() || tri.index[1] >= positions.size() || tri.index[2] >= positions.size())
+				continue;
+
+			const Vec3& a = positions[tri.index[0]];
+			tri.area = glm::length(glm::cross(positions[tri.index[1]] - a, positions[tri.index[2]] - a));
+			if (tri.area > 0.0f)
+				tris.push_back(tri);
+		}
+	}
+
+	// Keep the largest, order doesn't matter to the rasterizer
+	if (tris.size() > MAX_OCCLUDER_TRIANGLES)
+	{
+		std::nth_element(tris.begin(), tris.begin() + MAX_OCCLUDER_TRIANGLES, tris.end(),
+			[](const OccluderTri& a, const OccluderTri& b) { return a.area > b.area; });
+		tris.resize(MAX_OCCLUDER_TRIANGLES);
+	}
+
+	// Only copy the vertices that are used
+	std::vector<int> remap(positions.size(), -1);
+	m_OccluderIndices.reserve(tris.size() * 3);
+
+	for (size_t t = 0; t < tris.size(); ++t)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			const uint32 index = tris[t].index[k];
+			if (remap[index] < 0)
+			{
+				remap[index] = (int)m_OccluderVerts.size();
+				m_OccluderVerts.push_back(positions[index]);
+			}
+
+			m_OccluderIndices.push_back((uint32)remap[index]);
+		}
+	}
+}
+
 bool Mesh::InitMaterials(const aiScene* pScene, const std::string& filename, unsigned textureSet, ResourceManager* resMan)
 {
 	std::map<unsigned, Material*> materials;
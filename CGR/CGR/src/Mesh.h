@@ -57,9 +57,15 @@ public:
 	bool Construct(const std::vector<Vertex>& vertices, const std::vector<uint32>& indices, unsigned materialSet);
 
 	size_t GetNumSubMeshes() const;
+
+	// Model space stand in for occlusion culling, only ever a subset of the real triangles so it can't hide more than the mesh does
+	const std::vector<Vec3>&	OccluderVertices() const;
+	const std::vector<uint32>&	OccluderIndices() const;
+	bool						HasOccluder() const;
 	
 private:
 	bool InitMaterials(const aiScene* pScene, const std::string& filename, unsigned textureSet, ResourceManager* resMan);
+	void buildOccluder(const std::vector<Vec3>& positions, const std::vector<uint32>& indices);
 
 private:
 	friend class Renderer;
@@ -67,10 +73,27 @@ private:
 	GLuint							m_VertexVBO;
 	GLuint							m_IndexVBO;
 	GLuint							m_VAO;
+	std::vector<Vec3>				m_OccluderVerts;
+	std::vector<uint32>				m_OccluderIndices;
 };
 
 INLINE size_t Mesh::GetNumSubMeshes() const
 {
 	return m_SubMeshes.size();
 }
+
+INLINE const std::vector<Vec3>& Mesh::OccluderVertices() const
+{
+	return m_OccluderVerts;
+}
+
+INLINE const std::vector<uint32>& Mesh::OccluderIndices() const
+{
+	return m_OccluderIndices;
+}
+
+INLINE bool Mesh::HasOccluder() const
+{
+	return !m_OccluderIndices.empty();
+}
 #endif
@@ -0,0 +1,356 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Forsyth's scoring, an LRU of this many vertices is modelled
+#define FORSYTH_CACHE_SIZE			32
+#define FORSYTH_CACHE_DECAY_POWER	1.5f
+#define FORSYTH_LAST_TRI_SCORE		0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE	2.0f
+#define FORSYTH_VALENCE_BOOST_POWER	0.5f
+
+// FNV-1a over the vertex's bytes
+static uint32 hashBytes(const byte* data, size_t size)
+{
+	uint32 hash = 2166136261u;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+// Vertices used by few remaining triangles and recently in the cache score highest
+static float forsythScore(int cachePosition, uint32 valence)
+{
+	if (valence == 0)
+		return -1.0f;
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		// The last triangle's vertices get a fixed score so the next one doesn't just reuse the same edge
+		if (cachePosition < 3)
+			score = FORSYTH_LAST_TRI_SCORE;
+		else
+			score = powf(1.0f - (cachePosition - 3) * (1.0f / (FORSYTH_CACHE_SIZE - 3)), FORSYTH_CACHE_DECAY_POWER);
+	}
+
+	return score + FORSYTH_VALENCE_BOOST_SCALE * powf((float)valence, -FORSYTH_VALENCE_BOOST_POWER);
+}
+
+size_t MeshOptimizer::weldRemap(const byte* data, size_t stride, size_t count, std::vector<uint32>& indices, std::vector<uint32>& remap)
+{
+	remap.assign(count, MESH_UNUSED_VERTEX);
+
+	// Open addressed, kept under half full
+	size_t buckets = 1;
+	while (buckets < count * 2)
+		buckets <<= 1;
+
+	std::vector<uint32> table(buckets, MESH_UNUSED_VERTEX);
+	const size_t mask = buckets - 1;
+	size_t unique = 0;
+
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		const uint32 v = indices[i];
+		if (remap[v] == MESH_UNUSED_VERTEX)
+		{
+			const byte* vertex = data + v * stride;
+			size_t slot = hashBytes(vertex, stride) & mask;
+
+			while (table[slot] != MESH_UNUSED_VERTEX && memcmp(data + table[slot] * stride, vertex, stride) != 0)
+				slot = (slot + 1) & mask;
+
+			if (table[slot] == MESH_UNUSED_VERTEX)
+			{
+				table[slot] = v;
+				remap[v] = (uint32)unique++;
+			}
+			else
+			{
+				remap[v] = remap[table[slot]];
+			}
+		}
+
+		indices[i] = remap[v];
+	}
+
+	return unique;
+}
+
+size_t MeshOptimizer::fetchRemap(std::vector<uint32>& indices, size_t numVertices, std::vector<uint32>& remap)
+{
+	remap.assign(numVertices, MESH_UNUSED_VERTEX);
+	uint32 next = 0;
+
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		const uint32 v = indices[i];
+		if (remap[v] == MESH_UNUSED_VERTEX)
+			remap[v] = next++;
+
+		indices[i] = remap[v];
+	}
+
+	return next;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<uint32>& indices, size_t numVertices)
+{
+	const size_t numTris = indices.size() / 3;
+	if (numTris < 2 || numVertices == 0)
+		return;
+
+	// Triangles each vertex is in, the live ones are kept at the front of its range
+	std::vector<uint32> valence(numVertices, 0);
+	for (size_t i = 0; i < numTris * 3; ++i)
+		++valence[indices[i]];
+
+	std::vector<uint32> offsets(numVertices + 1, 0);
+	for (size_t v = 0; v < numVertices; ++v)
+		offsets[v + 1] = offsets[v] + valence[v];
+
+	std::vector<uint32> adjacency(numTris * 3);
+	std::vector<uint32> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t i = 0; i < numTris * 3; ++i)
+		adjacency[fill[indices[i]]++] = (uint32)(i / 3);
+
+	std::vector<int> cachePosition(numVertices, -1);
+	std::vector<float> vertexScore(numVertices);
+	for (size_t v = 0; v < numVertices; ++v)
+		vertexScore[v] = forsythScore(-1, valence[v]);
+
+	std::vector<float> triScore(numTris);
+	std::vector<byte> emitted(numTris, 0);
+	int best = 0;
+
+	for (size_t t = 0; t < numTris; ++t)
+	{
+		triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+		if (triScore[t] > triScore[best])
+			best = (int)t;
+	}
+
+	std::vector<uint32> ordered;
+	ordered.reserve(numTris * 3);
+
+	uint32 cache[FORSYTH_CACHE_SIZE + 3];
+	uint32 newCache[FORSYTH_CACHE_SIZE + 3];
+	uint32 cacheCount = 0;
+	size_t cursor = 0;
+
+	while (best >= 0)
+	{
+		const uint32* tri = &indices[best * 3];
+		emitted[best] = 1;
+		ordered.push_back(tri[0]);
+		ordered.push_back(tri[1]);
+		ordered.push_back(tri[2]);
+
+		// Take it off each vertex's live triangles
+		for (int k = 0; k < 3; ++k)
+		{
+			const uint32 v = tri[k];
+			uint32* live = &adjacency[offsets[v]];
+			for (uint32 a = 0; a < valence[v]; ++a)
+			{
+				if (live[a] == (uint32)best)
+				{
+					live[a] = live[valence[v] - 1];
+					--valence[v];
+					break;
+				}
+			}
+		}
+
+		// The triangle's vertices go to the front, then the rest of the cache in order
+		uint32 count = 0;
+		for (int k = 0; k < 3; ++k)
+		{
+			if (std::find(newCache, newCache + count, tri[k]) == newCache + count)
+				newCache[count++] = tri[k];
+		}
+
+		for (uint32 c = 0; c < cacheCount; ++c)
+		{
+			if (cache[c] != tri[0] && cache[c] != tri[1] && cache[c] != tri[2])
+				newCache[count++] = cache[c];
+		}
+
+		// Anything pushed past the end is out of the cache
+		for (uint32 c = FORSYTH_CACHE_SIZE; c < count; ++c)
+		{
+			cachePosition[newCache[c]] = -1;
+			vertexScore[newCache[c]] = forsythScore(-1, valence[newCache[c]]);
+		}
+
+		cacheCount = std::min(count, (uint32)FORSYTH_CACHE_SIZE);
+		for (uint32 c = 0; c < cacheCount; ++c)
+		{
+			cache[c] = newCache[c];
+			cachePosition[cache[c]] = (int)c;
+			vertexScore[cache[c]] = forsythScore((int)c, valence[cache[c]]);
+		}
+
+		// Only the triangles those vertices are in have changed, the best of them goes next
+		best = -1;
+		float bestScore = -1.0f;
+		for (uint32 c = 0; c < count; ++c)
+		{
+			const uint32 v = newCache[c];
+			for (uint32 a = 0; a < valence[v]; ++a)
+			{
+				const uint32 t = adjacency[offsets[v] + a];
+				triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+				if (triScore[t] > bestScore)
+				{
+					bestScore = triScore[t];
+					best = (int)t;
+				}
+			}
+		}
+
+		// Dead end, nothing left touches the cache
+		if (best < 0)
+		{
+			while (cursor < numTris && emitted[cursor])
+				++cursor;
+
+			best = cursor < numTris ? (int)cursor : -1;
+		}
+	}
+
+	indices.swap(ordered);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<uint32>& indices, const std::vector<Vec3>& positions, float threshold)
+{
+	struct Cluster
+	{
+		uint32	first;		// Triangle
+		uint32	count;
+		float	key;
+	};
+
+	const size_t numTris = indices.size() / 3;
+	if (numTris < 2)
+		return;
+
+	// A cluster starts wherever a triangle misses on all three vertices, the cache order is starting over there anyway
+	std::vector<Cluster> clusters;
+	{
+		std::vector<uint32> cached(positions.size(), 0);
+		uint32 timestamp = MESH_ACMR_CACHE_SIZE + 1;
+
+		for (size_t t = 0; t < numTris; ++t)
+		{
+			int misses = 0;
+			for (int k = 0; k < 3; ++k)
+			{
+				const uint32 v = indices[t * 3 + k];
+				if (timestamp - cached[v] > MESH_ACMR_CACHE_SIZE)
+				{
+					cached[v] = timestamp++;
+					++misses;
+				}
+			}
+
+			if (t == 0 || misses == 3)
+			{
+				Cluster cluster = { (uint32)t, 0, 0.0f };
+				clusters.push_back(cluster);
+			}
+
+			++clusters.back().count;
+		}
+	}
+
+	if (clusters.size() < 2)
+		return;
+
+	// Area weighted centres, the cross products are twice each triangle's area along its normal
+	std::vector<Vec3> triNormal(numTris);
+	std::vector<Vec3> triCentre(numTris);
+	std::vector<float> triArea(numTris);
+	Vec3 meshCentre(0.0f);
+	float meshArea = 0.0f;
+
+	for (size_t t = 0; t < numTris; ++t)
+	{
+		const Vec3& a = positions[indices[t * 3]];
+		const Vec3& b = positions[indices[t * 3 + 1]];
+		const Vec3& c = positions[indices[t * 3 + 2]];
+
+		triNormal[t] = glm::cross(b - a, c - a);
+		triArea[t] = glm::length(triNormal[t]);
+		triCentre[t] = (a + b + c) / 3.0f;
+
+		meshCentre += triCentre[t] * triArea[t];
+		meshArea += triArea[t];
+	}
+
+	if (meshArea <= 0.0f)
+		return;
+
+	meshCentre /= meshArea;
+
+	// Clusters facing away from the middle are the outside of the mesh, they go first
+	for (size_t i = 0; i < clusters.size(); ++i)
+	{
+		Cluster& cluster = clusters[i];
+		Vec3 centre(0.0f);
+		Vec3 normal(0.0f);
+		float area = 0.0f;
+
+		for (uint32 t = cluster.first; t < cluster.first + cluster.count; ++t)
+		{
+			centre += triCentre[t] * triArea[t];
+			normal += triNormal[t];
+			area += triArea[t];
+		}
+
+		const float length = glm::length(normal);
+		cluster.key = area > 0.0f && length > 0.0f ? glm::dot(centre / area - meshCentre, normal / length) : 0.0f;
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.key > b.key; });
+
+	std::vector<uint32> sorted;
+	sorted.reserve(numTris * 3);
+	for (size_t i = 0; i < clusters.size(); ++i)
+		sorted.insert(sorted.end(), indices.begin() + clusters[i].first * 3, indices.begin() + (clusters[i].first + clusters[i].count) * 3);
+
+	// Cluster edges lose some reuse, keep the cache order if it's too much
+	if (ACMR(sorted, positions.size()) <= ACMR(indices, positions.size()) * threshold)
+		indices.swap(sorted);
+}
+
+float MeshOptimizer::ACMR(const std::vector<uint32>& indices, size_t numVertices, uint32 cacheSize)
+{
+	const size_t numTris = indices.size() / 3;
+	if (numTris == 0)
+		return 0.0f;
+
+	// FIFO, a vertex is still in it if fewer than cacheSize misses have happened since it was loaded
+	std::vector<uint32> cached(numVertices, 0);
+	uint32 timestamp = cacheSize + 1;
+	size_t misses = 0;
+
+	for (size_t i = 0; i < numTris * 3; ++i)
+	{
+		const uint32 v = indices[i];
+		if (timestamp - cached[v] > cacheSize)
+		{
+			cached[v] = timestamp++;
+			++misses;
+		}
+	}
+
+	return (float)misses / numTris;
+}
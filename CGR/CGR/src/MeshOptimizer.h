@@ -0,0 +1,109 @@
+#ifndef __MESH_OPTIMIZER_H__
+#define __MESH_OPTIMIZER_H__
+
+#include <vector>
+#include "types.h"
+
+// Post transform cache size ACMR is measured against, a FIFO the size of older hardware's so the numbers compare
+#define MESH_ACMR_CACHE_SIZE		16
+// Overdraw ordering is dropped if it costs the cache order more than this much
+#define MESH_OVERDRAW_THRESHOLD		1.05f
+// A vertex no index uses
+#define MESH_UNUSED_VERTEX			0xffffffff
+
+struct MeshOptimizeStats
+{
+	uint32	verticesBefore;
+	uint32	verticesAfter;
+	uint32	triangles;
+	float	acmrBefore;		// Average cache misses per triangle
+	float	acmrAfter;
+};
+
+/*
+	Reorders a mesh for the GPU without changing what it draws, run per sub mesh at load:
+	- bitwise identical vertices are welded, every imported triangle starts with its own three
+	- triangles are ordered for the post transform cache with Forsyth's linear speed scoring
+	- the cache ordered list is cut into clusters where the cache starts over, and the clusters are drawn
+	  outward facing first so the parts of the mesh that cover the rest are in the depth buffer early
+	- vertices are renumbered in the order the indices first use them, so fetches walk memory forwards
+	Indices are local to the sub mesh's vertices.
+*/
+class MeshOptimizer
+{
+public:
+	template<typename V>
+	static void			Optimize(std::vector<V>& vertices, std::vector<uint32>& indices, MeshOptimizeStats& stats);
+
+	// Returns the new vertex count
+	template<typename V>
+	static size_t		WeldVertices(std::vector<V>& vertices, std::vector<uint32>& indices);
+	static void			OptimizeVertexCache(std::vector<uint32>& indices, size_t numVertices);
+	static void			OptimizeOverdraw(std::vector<uint32>& indices, const std::vector<Vec3>& positions, float threshold);
+	template<typename V>
+	static void			OptimizeVertexFetch(std::vector<V>& vertices, std::vector<uint32>& indices);
+
+	static float		ACMR(const std::vector<uint32>& indices, size_t numVertices, uint32 cacheSize = MESH_ACMR_CACHE_SIZE);
+
+private:
+	// Where each vertex goes, all of these leave the index buffer pointing at the new positions
+	static size_t		weldRemap(const byte* data, size_t stride, size_t count, std::vector<uint32>& indices, std::vector<uint32>& remap);
+	static size_t		fetchRemap(std::vector<uint32>& indices, size_t numVertices, std::vector<uint32>& remap);
+
+	template<typename V>
+	static void			applyRemap(std::vector<V>& vertices, const std::vector<uint32>& remap, size_t newCount);
+};
+
+template<typename V>
+void MeshOptimizer::Optimize(std::vector<V>& vertices, std::vector<uint32>& indices, MeshOptimizeStats& stats)
+{
+	stats.verticesBefore = (uint32)vertices.size();
+	stats.triangles = (uint32)(indices.size() / 3);
+	stats.acmrBefore = ACMR(indices, vertices.size());
+
+	WeldVertices(vertices, indices);
+	OptimizeVertexCache(indices, vertices.size());
+
+	std::vector<Vec3> positions(vertices.size());
+	for (size_t i = 0; i < vertices.size(); ++i)
+		positions[i] = vertices[i].position;
+
+	OptimizeOverdraw(indices, positions, MESH_OVERDRAW_THRESHOLD);
+	OptimizeVertexFetch(vertices, indices);
+
+	stats.verticesAfter = (uint32)vertices.size();
+	stats.acmrAfter = ACMR(indices, vertices.size());
+}
+
+template<typename V>
+size_t MeshOptimizer::WeldVertices(std::vector<V>& vertices, std::vector<uint32>& indices)
+{
+	std::vector<uint32> remap;
+	const size_t count = weldRemap(reinterpret_cast<const byte*>(vertices.data()), sizeof(V), vertices.size(), indices, remap);
+	applyRemap(vertices, remap, count);
+	return count;
+}
+
+template<typename V>
+void MeshOptimizer::OptimizeVertexFetch(std::vector<V>& vertices, std::vector<uint32>& indices)
+{
+	std::vector<uint32> remap;
+	const size_t count = fetchRemap(indices, vertices.size(), remap);
+	applyRemap(vertices, remap, count);
+}
+
+template<typename V>
+void MeshOptimizer::applyRemap(std::vector<V>& vertices, const std::vector<uint32>& remap, size_t newCount)
+{
+	// Vertices nothing maps to are dropped
+	std::vector<V> remapped(newCount);
+	for (size_t i = 0; i < vertices.size(); ++i)
+	{
+		if (remap[i] != MESH_UNUSED_VERTEX)
+			remapped[remap[i]] = vertices[i];
+	}
+
+	vertices.swap(remapped);
+}
+
+#endif
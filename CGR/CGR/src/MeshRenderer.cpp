@@ -11,7 +11,17 @@ MeshRenderer::MeshRenderer(GameObject* go) :
 	m_HasBumpMaps(GE_FALSE),
 	m_ReceiveShadows(GE_FALSE),
 	m_MultiTextures(false),
-	m_HasAnimations(false)
+	m_HasAnimations(false),
+	m_IsOccluder(false),
+	m_WorldBounds(),
+	m_WorldMin(0.0f),
+	m_WorldMax(0.0f),
+	m_BoundsVersion(0),
+	m_BoundsStamp(0),
+	m_BoundsFrame(-1),
+	m_BoundsValid(false),
+	m_TreeProxy(-1),
+	m_TreeStamp(0)
 {
 }
 
@@ -43,6 +53,7 @@ void MeshRenderer::SetMeshData(
 	m_ReceiveShadows = receiveShadows ? GE_TRUE : GE_FALSE;
 	m_MultiTextures = hasMultiTextures;
 	m_HasAnimations = isAnimatedMesh;
+	m_BoundsValid = false;
 }
 
 bool MeshRenderer::UsingBumpMaps() const
@@ -65,6 +76,11 @@ bool MeshRenderer::HasMultiTextures() const
 	return m_MultiTextures;
 }
 
+bool MeshRenderer::IsOccluder() const
+{
+	return m_IsOccluder;
+}
+
 void MeshRenderer::SetUseBumpMaps(bool should)
 {
 	m_HasBumpMaps = should ? GE_TRUE : GE_FALSE;
@@ -88,4 +104,10 @@ void MeshRenderer::SetShaderIndex(size_t index)
 void MeshRenderer::SetMeshIndex(size_t index)
 {
 	m_MeshIndex = index;
+	m_BoundsValid = false;
+}
+
+void MeshRenderer::SetOccluder(bool should)
+{
+	m_IsOccluder = should;
 }
@@ -7,6 +7,13 @@
 
 class GameObject;
 
+// World space bounding sphere of a sub mesh, or of the current frame for key framed meshes
+struct WorldSphere
+{
+	Vec3	centre;
+	float	radius;
+};
+
 class MeshRenderer : public Component
 {
 public:
@@ -41,6 +48,7 @@ public:
 	bool ReceivingShadows() const;
 	bool HasAnimations() const;
 	bool HasMultiTextures() const;
+	bool IsOccluder() const;
 
 	void SetUseBumpMaps(bool should);
 	void SetReceiveShadows(bool should);
@@ -48,6 +56,9 @@ public:
 	void SetShaderIndex(size_t index);
 	void SetMeshIndex(size_t index);
 
+	// Large static meshes (level geometry) can hide what is behind them, only flagged meshes are drawn into the occlusion buffer
+	void SetOccluder(bool should);
+
 private:
 	friend class						Renderer;
 	static int							m_Id;
@@ -59,6 +70,20 @@ private:
 	int									m_ReceiveShadows{ GE_FALSE };
 	bool								m_MultiTextures{ false };
 	bool								m_HasAnimations{ false };
+	bool								m_IsOccluder{ false };
+
+	// Filled in by the renderer, only rebuilt when the transform version, mesh or anim frame changes
+	std::vector<WorldSphere>			m_WorldBounds;
+	Vec3								m_WorldMin;
+	Vec3								m_WorldMax;
+	uint32								m_BoundsVersion;
+	uint32								m_BoundsStamp;
+	int									m_BoundsFrame;
+	bool								m_BoundsValid{ false };
+
+	// Scene tree leaf, refit when the bounds stamp moves on from the one it was built with
+	int									m_TreeProxy;
+	uint32								m_TreeStamp;
 };
 
 INLINE int MeshRenderer::GetId()
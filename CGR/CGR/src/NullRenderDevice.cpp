@@ -0,0 +1,1329 @@
+#include "NullRenderDevice.h"
+
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <cstdio>
+
+// ---- GLSL reflection helpers ----
+// This is not a GLSL compiler, it understands just enough of the declarations at file scope
+// (defines, structs, std140 blocks and default block uniforms) to answer the reflection queries
+// the engine makes after linking.
+
+struct GlslMember
+{
+	std::string type;
+	std::string name;
+	int			arraySize;	// 0 if not an array
+};
+
+typedef std::map<std::string, std::vector<GlslMember>> GlslStructMap;
+
+struct GlslBlock
+{
+	std::string				name;
+	int						binding;
+	std::vector<GlslMember>	members;
+};
+
+struct GlslReflection
+{
+	GlslStructMap			structs;
+	std::vector<GlslBlock>	blocks;
+	std::vector<GlslMember>	uniforms;
+};
+
+static std::string stripComments(const std::string& src)
+{
+	std::string out;
+	out.reserve(src.size());
+
+	for (size_t i = 0; i < src.size(); ++i)
+	{
+		if (src[i] == '/' && i + 1 < src.size() && src[i + 1] == '/')
+		{
+			while (i < src.size() && src[i] != '\n')
+				++i;
+			out += '\n';
+		}
+		else if (src[i] == '/' && i + 1 < src.size() && src[i + 1] == '*')
+		{
+			i += 2;
+			while (i + 1 < src.size() && !(src[i] == '*' && src[i + 1] == '/'))
+				++i;
+			++i;
+			out += ' ';
+		}
+		else
+		{
+			out += src[i];
+		}
+	}
+
+	return out;
+}
+
+static std::vector<std::string> tokenise(const std::string& src, std::map<std::string, std::string>& defines)
+{
+	std::vector<std::string> tokens;
+	size_t i = 0;
+
+	while (i < src.size())
+	{
+		char c = src[i];
+
+		if (c == '#')
+		{
+			// Preprocessor line, only integer defines are kept (array sizes)
+			size_t end = src.find('\n', i);
+			std::string line = src.substr(i, end == std::string::npos ? std::string::npos : end - i);
+			char name[64] = "", value[64] = "";
+			if (sscanf(line.c_str(), "#define %63s %63s", name, value) == 2)
+				defines[name] = value;
+			i = (end == std::string::npos) ? src.size() : end;
+		}
+		else if (isspace((unsigned char)c))
+		{
+			++i;
+		}
+		else if (isalpha((unsigned char)c) || c == '_')
+		{
+			size_t start = i;
+			while (i < src.size() && (isalnum((unsigned char)src[i]) || src[i] == '_'))
+				++i;
+
+			std::string ident = src.substr(start, i - start);
+			auto def = defines.find(ident);
+			tokens.push_back(def != defines.end() ? def->second : ident);
+		}
+		else if (isdigit((unsigned char)c))
+		{
+			size_t start = i;
+			while (i < src.size() && (isalnum((unsigned char)src[i]) || src[i] == '.'))
+				++i;
+			tokens.push_back(src.substr(start, i - start));
+		}
+		else
+		{
+			tokens.push_back(std::string(1, c));
+			++i;
+		}
+	}
+
+	return tokens;
+}
+
+static bool isQualifier(const std::string& tok)
+{
+	return tok == "highp" || tok == "mediump" || tok == "lowp" || tok == "const" || tok == "flat";
+}
+
+// Parses 'type name[N], name2;' starting at tok, stops after the ';'
+static void parseDeclaration(const std::vector<std::string>& tokens, size_t& tok, std::vector<GlslMember>& out)
+{
+	while (tok < tokens.size() && isQualifier(tokens[tok]))
+		++tok;
+
+	if (tok >= tokens.size())
+		return;
+
+	std::string type = tokens[tok++];
+
+	while (tok < tokens.size() && tokens[tok] != ";")
+	{
+		GlslMember member = { type, tokens[tok++], 0 };
+
+		if (tok < tokens.size() && tokens[tok] == "[")
+		{
+			member.arraySize = atoi(tokens[tok + 1].c_str());
+			tok += 3;
+		}
+
+		out.push_back(member);
+
+		// Skip initialisers such as 'uniform float u_scale = 4.0;'
+		while (tok < tokens.size() && tokens[tok] != "," && tokens[tok] != ";")
+			++tok;
+
+		if (tok < tokens.size() && tokens[tok] == ",")
+			++tok;
+	}
+
+	++tok;
+}
+
+static void parseMembers(const std::vector<std::string>& tokens, size_t& tok, std::vector<GlslMember>& out)
+{
+	// Expects tok to be on the opening brace, leaves it after the closing one
+	++tok;
+	while (tok < tokens.size() && tokens[tok] != "}")
+	{
+		parseDeclaration(tokens, tok, out);
+	}
+	++tok;
+}
+
+static GlslReflection reflectSource(const std::string& source)
+{
+	GlslReflection result;
+	std::map<std::string, std::string> defines;
+	std::vector<std::string> tokens = tokenise(stripComments(source), defines);
+
+	size_t tok = 0;
+	int depth = 0;
+	int binding = -1;
+
+	while (tok < tokens.size())
+	{
+		const std::string& t = tokens[tok];
+
+		if (t == "{")
+		{
+			++depth; ++tok;
+		}
+		else if (t == "}")
+		{
+			--depth; ++tok;
+		}
+		else if (depth > 0)
+		{
+			++tok;
+		}
+		else if (t == "layout")
+		{
+			// Remember an explicit binding for the block that follows
+			binding = -1;
+			while (tok < tokens.size() && tokens[tok] != ")")
+			{
+				if (tokens[tok] == "binding" && tok + 2 < tokens.size())
+					binding = atoi(tokens[tok + 2].c_str());
+				++tok;
+			}
+			++tok;
+		}
+		else if (t == "struct" && tok + 2 < tokens.size())
+		{
+			std::string name = tokens[tok + 1];
+			tok += 2;
+			parseMembers(tokens, tok, result.structs[name]);
+		}
+		else if (t == "uniform" && tok + 2 < tokens.size())
+		{
+			if (tokens[tok + 2] == "{")
+			{
+				GlslBlock block;
+				block.name = tokens[tok + 1];
+				block.binding = binding;
+				tok += 2;
+				parseMembers(tokens, tok, block.members);
+				result.blocks.push_back(block);
+
+				// Skip an instance name
+				while (tok < tokens.size() && tokens[tok] != ";")
+					++tok;
+			}
+			else
+			{
+				++tok;
+				parseDeclaration(tokens, tok, result.uniforms);
+			}
+
+			binding = -1;
+		}
+		else
+		{
+			if (t == ";")
+				binding = -1;
+			++tok;
+		}
+	}
+
+	return result;
+}
+
+struct GlslTypeInfo
+{
+	const char* name;
+	GLenum		type;
+	GLint		size;	// std140 size
+	GLint		align;	// std140 base alignment
+};
+
+static const GlslTypeInfo* findType(const std::string& name)
+{
+	static const GlslTypeInfo types[] =
+	{
+		{ "float",				GL_FLOAT,				4,	4 },
+		{ "vec2",				GL_FLOAT_VEC2,			8,	8 },
+		{ "vec3",				GL_FLOAT_VEC3,			12, 16 },
+		{ "vec4",				GL_FLOAT_VEC4,			16, 16 },
+		{ "int",				GL_INT,					4,	4 },
+		{ "ivec2",				GL_INT_VEC2,			8,	8 },
+		{ "ivec3",				GL_INT_VEC3,			12, 16 },
+		{ "ivec4",				GL_INT_VEC4,			16, 16 },
+		{ "uint",				GL_UNSIGNED_INT,		4,	4 },
+		{ "uvec2",				GL_UNSIGNED_INT_VEC2,	8,	8 },
+		{ "uvec3",				GL_UNSIGNED_INT_VEC3,	12, 16 },
+		{ "uvec4",				GL_UNSIGNED_INT_VEC4,	16, 16 },
+		{ "bool",				GL_BOOL,				4,	4 },
+		{ "bvec2",				GL_BOOL_VEC2,			8,	8 },
+		{ "bvec3",				GL_BOOL_VEC3,			12, 16 },
+		{ "bvec4",				GL_BOOL_VEC4,			16, 16 },
+		{ "mat2",				GL_FLOAT_MAT2,			32, 16 },
+		{ "mat3",				GL_FLOAT_MAT3,			48, 16 },
+		{ "mat4",				GL_FLOAT_MAT4,			64, 16 },
+		{ "sampler2D",			GL_SAMPLER_2D,			4,	4 },
+		{ "sampler2DShadow",	GL_SAMPLER_2D_SHADOW,	4,	4 },
+		{ "sampler3D",			GL_SAMPLER_3D,			4,	4 },
+		{ "samplerCube",		GL_SAMPLER_CUBE,		4,	4 },
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE_IN_ELEMENTS(types); ++i)
+	{
+		if (name == types[i].name)
+			return &types[i];
+	}
+
+	return nullptr;
+}
+
+static GLint roundUp(GLint value, GLint align)
+{
+	return (value + align - 1) / align * align;
+}
+
+static GLint std140Align(const GlslStructMap& structs, const GlslMember& member);
+static GLint std140Size(const GlslStructMap& structs, const GlslMember& member);
+
+static GLint std140StructSize(const GlslStructMap& structs, const std::vector<GlslMember>& members)
+{
+	GLint offset = 0;
+	for (size_t i = 0; i < members.size(); ++i)
+	{
+		offset = roundUp(offset, std140Align(structs, members[i]));
+		offset += std140Size(structs, members[i]);
+	}
+
+	return roundUp(offset, 16);
+}
+
+static GLint std140Align(const GlslStructMap& structs, const GlslMember& member)
+{
+	auto s = structs.find(member.type);
+	if (s != structs.end())
+		return 16;
+
+	const GlslTypeInfo* info = findType(member.type);
+	GLint align = info ? info->align : 16;
+	return member.arraySize > 0 ? roundUp(align, 16) : align;
+}
+
+static GLint std140Size(const GlslStructMap& structs, const GlslMember& member)
+{
+	GLint elementSize = 0;
+
+	auto s = structs.find(member.type);
+	if (s != structs.end())
+	{
+		elementSize = std140StructSize(structs, s->second);
+	}
+	else
+	{
+		const GlslTypeInfo* info = findType(member.type);
+		elementSize = info ? info->size : 16;
+	}
+
+	if (member.arraySize > 0)
+		return roundUp(elementSize, 16) * member.arraySize;
+
+	return elementSize;
+}
+
+// ---- NullRenderDevice ----
+
+NullRenderDevice::NullRenderDevice() :
+	m_Commands(),
+	m_Passes(),
+	m_PassStack(),
+	m_Objects(),
+	m_ShaderSources(),
+	m_Programs(),
+	m_BoundBuffers(),
+	m_BufferMemory(),
+	m_NextHandle(1),
+	m_CurrentProgram(0),
+	m_CullFaceMode(GL_BACK),
+	m_DepthFunc(GL_LESS),
+	m_BytesUploaded(0),
+	m_Recording(true)
+{
+}
+
+NullRenderDevice::~NullRenderDevice()
+{
+}
+
+RenderBackend NullRenderDevice::Backend() const
+{
+	return NullBackend;
+}
+
+size_t NullRenderDevice::Count(RenderCmdType type) const
+{
+	size_t count = 0;
+	for (auto cmd = m_Commands.begin(); cmd != m_Commands.end(); ++cmd)
+	{
+		if (cmd->type == type)
+			++count;
+	}
+
+	return count;
+}
+
+size_t NullRenderDevice::CountInPass(const std::string& pass, RenderCmdType type) const
+{
+	size_t count = 0;
+	for (auto cmd = m_Commands.begin(); cmd != m_Commands.end(); ++cmd)
+	{
+		if (cmd->type == type && cmd->pass >= 0 && m_Passes[cmd->pass] == pass)
+			++count;
+	}
+
+	return count;
+}
+
+void NullRenderDevice::ClearLog()
+{
+	m_Commands.clear();
+	m_Passes.clear();
+	m_PassStack.clear();
+	m_BytesUploaded = 0;
+}
+
+void NullRenderDevice::record(RenderCmdType type, const char* name, GLenum target, GLuint handle, GLsizei count, size_t bytes, GLsizei instances)
+{
+	m_BytesUploaded += bytes;
+
+	if (!m_Recording)
+		return;
+
+	RenderCommand cmd;
+	cmd.type = type;
+	cmd.name = name;
+	cmd.target = target;
+	cmd.handle = handle;
+	cmd.count = count;
+	cmd.instances = instances;
+	cmd.bytes = bytes;
+	cmd.pass = m_PassStack.empty() ? -1 : m_PassStack.back();
+	m_Commands.push_back(cmd);
+}
+
+GLuint NullRenderDevice::genHandle(ObjectKind kind)
+{
+	GLuint handle = m_NextHandle++;
+	m_Objects[handle] = kind;
+	return handle;
+}
+
+bool NullRenderDevice::isKind(GLuint handle, ObjectKind kind) const
+{
+	auto obj = m_Objects.find(handle);
+	return obj != m_Objects.end() && obj->second == kind;
+}
+
+void NullRenderDevice::deleteHandles(GLsizei n, const GLuint* handles, const char* name)
+{
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		m_Objects.erase(handles[i]);
+		record(CMD_DELETE, name, 0, handles[i]);
+	}
+}
+
+void NullRenderDevice::copyName(const std::string& src, GLsizei bufSize, GLsizei* length, GLchar* dst) const
+{
+	GLsizei len = 0;
+	if (dst && bufSize > 0)
+	{
+		len = (GLsizei)src.size() < bufSize - 1 ? (GLsizei)src.size() : bufSize - 1;
+		memcpy(dst, src.c_str(), len);
+		dst[len] = 0;
+	}
+
+	if (length)
+		*length = len;
+}
+
+// ---- Global State ----
+
+void NullRenderDevice::Enable(GLenum cap)
+{
+	record(CMD_STATE, "Enable", cap);
+}
+
+void NullRenderDevice::Disable(GLenum cap)
+{
+	record(CMD_STATE, "Disable", cap);
+}
+
+void NullRenderDevice::Clear(GLbitfield mask)
+{
+	record(CMD_CLEAR, "Clear", mask);
+}
+
+void NullRenderDevice::ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+	record(CMD_STATE, "ClearColor");
+}
+
+void NullRenderDevice::CullFace(GLenum mode)
+{
+	m_CullFaceMode = mode;
+	record(CMD_STATE, "CullFace", mode);
+}
+
+void NullRenderDevice::DepthFunc(GLenum func)
+{
+	m_DepthFunc = func;
+	record(CMD_STATE, "DepthFunc", func);
+}
+
+void NullRenderDevice::DepthMask(GLboolean flag)
+{
+	record(CMD_STATE, "DepthMask", flag);
+}
+
+void NullRenderDevice::BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+	record(CMD_STATE, "BlendFunc", sfactor);
+}
+
+void NullRenderDevice::BlendEquation(GLenum mode)
+{
+	record(CMD_STATE, "BlendEquation", mode);
+}
+
+void NullRenderDevice::StencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+	record(CMD_STATE, "StencilFunc", func);
+}
+
+void NullRenderDevice::StencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass)
+{
+	record(CMD_STATE, "StencilOpSeparate", face);
+}
+
+void NullRenderDevice::PolygonMode(GLenum face, GLenum mode)
+{
+	record(CMD_STATE, "PolygonMode", mode);
+}
+
+void NullRenderDevice::Viewport(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+	record(CMD_STATE, "Viewport");
+}
+
+void NullRenderDevice::PixelStorei(GLenum pname, GLint param)
+{
+	record(CMD_STATE, "PixelStorei", pname);
+}
+
+void NullRenderDevice::Flush()
+{
+	record(CMD_OTHER, "Flush");
+}
+
+void NullRenderDevice::GetIntegerv(GLenum pname, GLint* data)
+{
+	if (!data)
+		return;
+
+	switch (pname)
+	{
+	case GL_CULL_FACE_MODE:
+		*data = m_CullFaceMode;
+		break;
+	case GL_DEPTH_FUNC:
+		*data = m_DepthFunc;
+		break;
+	case GL_CURRENT_PROGRAM:
+		*data = (GLint)m_CurrentProgram;
+		break;
+	case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT:
+		*data = 256;
+		break;
+	default:
+		*data = 0;
+		break;
+	}
+}
+
+const GLubyte* NullRenderDevice::GetString(GLenum name)
+{
+	switch (name)
+	{
+	case GL_VENDOR:		return (const GLubyte*)"CGR";
+	case GL_RENDERER:	return (const GLubyte*)"Null Render Device";
+	case GL_VERSION:	return (const GLubyte*)"4.5 (null)";
+	default:			return (const GLubyte*)"";
+	}
+}
+
+GLenum NullRenderDevice::GetError()
+{
+	return GL_NO_ERROR;
+}
+
+// ---- Buffers and Vertex Arrays ----
+
+void NullRenderDevice::GenBuffers(GLsizei n, GLuint* buffers)
+{
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		buffers[i] = genHandle(OBJ_BUFFER);
+		record(CMD_CREATE, "GenBuffers", 0, buffers[i]);
+	}
+}
+
+void NullRenderDevice::DeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+	for (GLsizei i = 0; i < n; ++i)
+		m_BufferMemory.erase(buffers[i]);
+
+	deleteHandles(n, buffers, "DeleteBuffers");
+}
+
+GLboolean NullRenderDevice::IsBuffer(GLuint buffer)
+{
+	return isKind(buffer, OBJ_BUFFER) ? GL_TRUE : GL_FALSE;
+}
+
+void NullRenderDevice::BindBuffer(GLenum target, GLuint buffer)
+{
+	m_BoundBuffers[target] = buffer;
+	record(CMD_BIND_BUFFER, "BindBuffer", target, buffer);
+}
+
+void NullRenderDevice::BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+	record(CMD_BUFFER_UPLOAD, "BufferData", target, m_BoundBuffers[target], 0, (size_t)size);
+}
+
+void NullRenderDevice::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+	record(CMD_BUFFER_UPLOAD, "BufferSubData", target, m_BoundBuffers[target], 0, (size_t)size);
+}
+
+void NullRenderDevice::BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	m_BoundBuffers[target] = buffer;
+	record(CMD_BIND_BUFFER, "BindBufferBase", target, buffer, index);
+}
+
+void NullRenderDevice::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	m_BoundBuffers[target] = buffer;
+	record(CMD_BIND_BUFFER, "BindBufferRange", target, buffer, index);
+}
+
+void NullRenderDevice::BufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+	// Kept so the buffer can be mapped, writes through a mapping never show up as uploads
+	std::vector<byte>& memory = m_BufferMemory[m_BoundBuffers[target]];
+	memory.assign((size_t)size, 0);
+	if (data)
+		memcpy(memory.data(), data, (size_t)size);
+
+	record(CMD_BUFFER_UPLOAD, "BufferStorage", target, m_BoundBuffers[target], 0, data ? (size_t)size : 0);
+}
+
+void* NullRenderDevice::MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+	auto memory = m_BufferMemory.find(m_BoundBuffers[target]);
+	if (memory == m_BufferMemory.end() || (size_t)(offset + length) > memory->second.size())
+		return nullptr;
+
+	record(CMD_OTHER, "MapBufferRange", target, m_BoundBuffers[target]);
+	return memory->second.data() + offset;
+}
+
+GLboolean NullRenderDevice::UnmapBuffer(GLenum target)
+{
+	record(CMD_OTHER, "UnmapBuffer", target, m_BoundBuffers[target]);
+	return GL_TRUE;
+}
+
+void NullRenderDevice::GenVertexArrays(GLsizei n, GLuint* arrays)
+{
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		arrays[i] = genHandle(OBJ_VAO);
+		record(CMD_CREATE, "GenVertexArrays", 0, arrays[i]);
+	}
+}
+
+void NullRenderDevice::DeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+	deleteHandles(n, arrays, "DeleteVertexArrays");
+}
+
+GLboolean NullRenderDevice::IsVertexArray(GLuint array)
+{
+	return isKind(array, OBJ_VAO) ? GL_TRUE : GL_FALSE;
+}
+
+void NullRenderDevice::BindVertexArray(GLuint array)
+{
+	record(CMD_BIND_VAO, "BindVertexArray", 0, array);
+}
+
+void NullRenderDevice::EnableVertexAttribArray(GLuint index)
+{
+	record(CMD_STATE, "EnableVertexAttribArray", 0, index);
+}
+
+void NullRenderDevice::DisableVertexAttribArray(GLuint index)
+{
+	record(CMD_STATE, "DisableVertexAttribArray", 0, index);
+}
+
+void NullRenderDevice::VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+{
+	record(CMD_STATE, "VertexAttribPointer", type, index, size);
+}
+
+void NullRenderDevice::VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer)
+{
+	record(CMD_STATE, "VertexAttribIPointer", type, index, size);
+}
+
+void NullRenderDevice::VertexAttribDivisor(GLuint index, GLuint divisor)
+{
+	record(CMD_STATE, "VertexAttribDivisor", 0, index, divisor);
+}
+
+// ---- Textures ----
+
+void NullRenderDevice::GenTextures(GLsizei n, GLuint* textures)
+{
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		textures[i] = genHandle(OBJ_TEXTURE);
+		record(CMD_CREATE, "GenTextures", 0, textures[i]);
+	}
+}
+
+void NullRenderDevice::DeleteTextures(GLsizei n, const GLuint* textures)
+{
+	deleteHandles(n, textures, "DeleteTextures");
+}
+
+GLboolean NullRenderDevice::IsTexture(GLuint texture)
+{
+	return isKind(texture, OBJ_TEXTURE) ? GL_TRUE : GL_FALSE;
+}
+
+void NullRenderDevice::ActiveTexture(GLenum unit)
+{
+	record(CMD_STATE, "ActiveTexture", unit);
+}
+
+void NullRenderDevice::BindTexture(GLenum target, GLuint texture)
+{
+	record(CMD_BIND_TEXTURE, "BindTexture", target, texture);
+}
+
+// Only count bytes that are actually sent, allocating storage with a null pointer is free
+static size_t pixelBytes(GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+{
+	size_t components = 4;
+	switch (format)
+	{
+	case GL_RED: case GL_DEPTH_COMPONENT:	components = 1; break;
+	case GL_RG:								components = 2; break;
+	case GL_RGB: case GL_BGR:				components = 3; break;
+	default:								components = 4; break;
+	}
+
+	size_t typeSize = (type == GL_UNSIGNED_BYTE || type == GL_BYTE) ? 1 : 4;
+	return pixels ? (size_t)width * (size_t)height * components * typeSize : 0;
+}
+
+void NullRenderDevice::TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+{
+	record(CMD_TEXTURE_UPLOAD, "TexImage2D", target, 0, 0, pixelBytes(width, height, format, type, pixels));
+}
+
+void NullRenderDevice::TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+{
+	record(CMD_TEXTURE_UPLOAD, "TexSubImage2D", target, 0, 0, pixelBytes(width, height, format, type, pixels));
+}
+
+void NullRenderDevice::TexParameteri(GLenum target, GLenum pname, GLint param)
+{
+	record(CMD_STATE, "TexParameteri", pname);
+}
+
+void NullRenderDevice::TexParameterf(GLenum target, GLenum pname, GLfloat param)
+{
+	record(CMD_STATE, "TexParameterf", pname);
+}
+
+void NullRenderDevice::GenerateMipmap(GLenum target)
+{
+	record(CMD_OTHER, "GenerateMipmap", target);
+}
+
+// ---- Frame Buffers ----
+
+void NullRenderDevice::GenFramebuffers(GLsizei n, GLuint* fbos)
+{
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		fbos[i] = genHandle(OBJ_FBO);
+		record(CMD_CREATE, "GenFramebuffers", 0, fbos[i]);
+	}
+}
+
+void NullRenderDevice::DeleteFramebuffers(GLsizei n, const GLuint* fbos)
+{
+	deleteHandles(n, fbos, "DeleteFramebuffers");
+}
+
+GLboolean NullRenderDevice::IsFramebuffer(GLuint fbo)
+{
+	return isKind(fbo, OBJ_FBO) ? GL_TRUE : GL_FALSE;
+}
+
+void NullRenderDevice::BindFramebuffer(GLenum target, GLuint fbo)
+{
+	record(CMD_BIND_FBO, "BindFramebuffer", target, fbo);
+}
+
+void NullRenderDevice::FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+	record(CMD_OTHER, "FramebufferTexture2D", attachment, texture);
+}
+
+GLenum NullRenderDevice::CheckFramebufferStatus(GLenum target)
+{
+	return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void NullRenderDevice::DrawBuffer(GLenum buf)
+{
+	record(CMD_STATE, "DrawBuffer", buf);
+}
+
+void NullRenderDevice::DrawBuffers(GLsizei n, const GLenum* bufs)
+{
+	record(CMD_STATE, "DrawBuffers", 0, 0, n);
+}
+
+void NullRenderDevice::ReadBuffer(GLenum src)
+{
+	record(CMD_STATE, "ReadBuffer", src);
+}
+
+void NullRenderDevice::BlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+	record(CMD_OTHER, "BlitFramebuffer", mask);
+}
+
+// ---- Shaders and Programs ----
+
+GLuint NullRenderDevice::CreateShader(GLenum type)
+{
+	GLuint shader = genHandle(OBJ_SHADER);
+	record(CMD_CREATE, "CreateShader", type, shader);
+	return shader;
+}
+
+void NullRenderDevice::DeleteShader(GLuint shader)
+{
+	m_ShaderSources.erase(shader);
+	deleteHandles(1, &shader, "DeleteShader");
+}
+
+GLboolean NullRenderDevice::IsShader(GLuint shader)
+{
+	return isKind(shader, OBJ_SHADER) ? GL_TRUE : GL_FALSE;
+}
+
+void NullRenderDevice::ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+{
+	std::string& src = m_ShaderSources[shader];
+	src.clear();
+
+	for (GLsizei i = 0; i < count; ++i)
+	{
+		if (lengths && lengths[i] >= 0)
+			src.append(strings[i], lengths[i]);
+		else
+			src.append(strings[i]);
+	}
+}
+
+void NullRenderDevice::CompileShader(GLuint shader)
+{
+	record(CMD_OTHER, "CompileShader", 0, shader);
+}
+
+void NullRenderDevice::GetShaderiv(GLuint shader, GLenum pname, GLint* params)
+{
+	*params = (pname == GL_COMPILE_STATUS) ? GL_TRUE : 0;
+}
+
+void NullRenderDevice::GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* log)
+{
+	copyName("", bufSize, length, log);
+}
+
+GLuint NullRenderDevice::CreateProgram()
+{
+	GLuint program = genHandle(OBJ_PROGRAM);
+	m_Programs[program] = ProgramData();
+	record(CMD_CREATE, "CreateProgram", 0, program);
+	return program;
+}
+
+void NullRenderDevice::DeleteProgram(GLuint program)
+{
+	m_Programs.erase(program);
+	deleteHandles(1, &program, "DeleteProgram");
+}
+
+GLboolean NullRenderDevice::IsProgram(GLuint program)
+{
+	return isKind(program, OBJ_PROGRAM) ? GL_TRUE : GL_FALSE;
+}
+
+void NullRenderDevice::AttachShader(GLuint program, GLuint shader)
+{
+	m_Programs[program].shaders.push_back(shader);
+}
+
+void NullRenderDevice::BindAttribLocation(GLuint program, GLuint index, const GLchar* name)
+{
+}
+
+void NullRenderDevice::BindFragDataLocation(GLuint program, GLuint color, const GLchar* name)
+{
+}
+
+void NullRenderDevice::LinkProgram(GLuint program)
+{
+	reflectProgram(m_Programs[program]);
+	record(CMD_OTHER, "LinkProgram", 0, program);
+}
+
+void NullRenderDevice::reflectProgram(ProgramData& program)
+{
+	program.uniforms.clear();
+	program.blocks.clear();
+
+	GLint nextLocation = 0;
+
+	for (auto shader = program.shaders.begin(); shader != program.shaders.end(); ++shader)
+	{
+		GlslReflection glsl = reflectSource(m_ShaderSources[*shader]);
+
+		// Uniform blocks, each member is flattened into names the way GL reports them
+		for (auto b = glsl.blocks.begin(); b != glsl.blocks.end(); ++b)
+		{
+			bool exists = false;
+			for (auto pb = program.blocks.begin(); pb != program.blocks.end(); ++pb)
+				exists |= (pb->name == b->name);
+
+			if (exists)
+				continue;
+
+			ReflectedBlock block;
+			block.name = b->name;
+			block.binding = b->binding < 0 ? 0 : b->binding;
+			GLint blockIndex = (GLint)program.blocks.size();
+
+			GLint offset = 0;
+			for (auto m = b->members.begin(); m != b->members.end(); ++m)
+			{
+				offset = roundUp(offset, std140Align(glsl.structs, *m));
+
+				auto s = glsl.structs.find(m->type);
+				if (s != glsl.structs.end())
+				{
+					GLint elementSize = std140StructSize(glsl.structs, s->second);
+					int elements = m->arraySize > 0 ? m->arraySize : 1;
+
+					for (int e = 0; e < elements; ++e)
+					{
+						std::string prefix = m->name;
+						if (m->arraySize > 0)
+							prefix += "[" + std::to_string(e) + "]";
+
+						GLint memberOffset = offset + e * elementSize;
+						for (auto sm = s->second.begin(); sm != s->second.end(); ++sm)
+						{
+							memberOffset = roundUp(memberOffset, std140Align(glsl.structs, *sm));
+
+							const GlslTypeInfo* info = findType(sm->type);
+							ReflectedUniform u = { prefix + "." + sm->name, info ? info->type : GL_FLOAT,
+								sm->arraySize > 0 ? sm->arraySize : 1, -1, blockIndex, memberOffset };
+							if (sm->arraySize > 0)
+								u.name += "[0]";
+
+							block.uniforms.push_back((GLuint)program.uniforms.size());
+							program.uniforms.push_back(u);
+							memberOffset += std140Size(glsl.structs, *sm);
+						}
+					}
+				}
+				else
+				{
+					const GlslTypeInfo* info = findType(m->type);
+					ReflectedUniform u = { m->name, info ? info->type : GL_FLOAT,
+						m->arraySize > 0 ? m->arraySize : 1, -1, blockIndex, offset };
+					if (m->arraySize > 0)
+						u.name += "[0]";
+
+					block.uniforms.push_back((GLuint)program.uniforms.size());
+					program.uniforms.push_back(u);
+				}
+
+				offset += std140Size(glsl.structs, *m);
+			}
+
+			block.dataSize = roundUp(offset, 16);
+			program.blocks.push_back(block);
+		}
+
+		// Default block uniforms get sequential locations, arrays take one per element
+		for (auto m = glsl.uniforms.begin(); m != glsl.uniforms.end(); ++m)
+		{
+			std::string name = m->arraySize > 0 ? m->name + "[0]" : m->name;
+
+			bool exists = false;
+			for (auto u = program.uniforms.begin(); u != program.uniforms.end(); ++u)
+				exists |= (u->name == name);
+
+			if (exists)
+				continue;
+
+			const GlslTypeInfo* info = findType(m->type);
+			GLint size = m->arraySize > 0 ? m->arraySize : 1;
+			ReflectedUniform u = { name, info ? info->type : GL_FLOAT, size, nextLocation, -1, -1 };
+			program.uniforms.push_back(u);
+			nextLocation += size;
+		}
+	}
+}
+
+void NullRenderDevice::GetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+	const ProgramData& data = m_Programs[program];
+
+	switch (pname)
+	{
+	case GL_LINK_STATUS:
+		*params = GL_TRUE;
+		break;
+	case GL_ACTIVE_UNIFORMS:
+		*params = (GLint)data.uniforms.size();
+		break;
+	case GL_ACTIVE_UNIFORM_BLOCKS:
+		*params = (GLint)data.blocks.size();
+		break;
+	default:
+		*params = 0;
+		break;
+	}
+}
+
+void NullRenderDevice::GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* log)
+{
+	copyName("", bufSize, length, log);
+}
+
+void NullRenderDevice::UseProgram(GLuint program)
+{
+	m_CurrentProgram = program;
+	record(CMD_BIND_PROGRAM, "UseProgram", 0, program);
+}
+
+GLint NullRenderDevice::GetUniformLocation(GLuint program, const GLchar* name)
+{
+	const ProgramData& data = m_Programs[program];
+	std::string search = name;
+
+	// 'name', 'name[0]' and 'name[i]' all resolve against the reflected 'name[0]'
+	GLint element = 0;
+	size_t bracket = search.find('[');
+	if (bracket != std::string::npos)
+	{
+		element = atoi(search.c_str() + bracket + 1);
+		search = search.substr(0, bracket);
+	}
+
+	for (auto u = data.uniforms.begin(); u != data.uniforms.end(); ++u)
+	{
+		if (u->location < 0)
+			continue;
+
+		if (u->name == search || u->name == search + "[0]")
+			return element < u->size ? u->location + element : -1;
+	}
+
+	return -1;
+}
+
+void NullRenderDevice::GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+	const ProgramData& data = m_Programs[program];
+	if (index >= data.uniforms.size())
+	{
+		copyName("", bufSize, length, name);
+		return;
+	}
+
+	const ReflectedUniform& u = data.uniforms[index];
+	copyName(u.name, bufSize, length, name);
+	*size = u.size;
+	*type = u.type;
+}
+
+void NullRenderDevice::GetActiveUniformBlockName(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name)
+{
+	const ProgramData& data = m_Programs[program];
+	copyName(index < data.blocks.size() ? data.blocks[index].name : "", bufSize, length, name);
+}
+
+GLuint NullRenderDevice::GetUniformBlockIndex(GLuint program, const GLchar* name)
+{
+	const ProgramData& data = m_Programs[program];
+	for (size_t i = 0; i < data.blocks.size(); ++i)
+	{
+		if (data.blocks[i].name == name)
+			return (GLuint)i;
+	}
+
+	return GL_INVALID_INDEX;
+}
+
+void NullRenderDevice::GetActiveUniformBlockiv(GLuint program, GLuint index, GLenum pname, GLint* params)
+{
+	const ProgramData& data = m_Programs[program];
+	if (index >= data.blocks.size())
+		return;
+
+	const ReflectedBlock& block = data.blocks[index];
+	switch (pname)
+	{
+	case GL_UNIFORM_BLOCK_DATA_SIZE:
+		*params = block.dataSize;
+		break;
+	case GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS:
+		*params = (GLint)block.uniforms.size();
+		break;
+	case GL_UNIFORM_BLOCK_BINDING:
+		*params = block.binding;
+		break;
+	case GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES:
+		for (size_t i = 0; i < block.uniforms.size(); ++i)
+			params[i] = (GLint)block.uniforms[i];
+		break;
+	default:
+		break;
+	}
+}
+
+void NullRenderDevice::GetUniformIndices(GLuint program, GLsizei count, const GLchar* const* names, GLuint* indices)
+{
+	const ProgramData& data = m_Programs[program];
+	for (GLsizei i = 0; i < count; ++i)
+	{
+		indices[i] = GL_INVALID_INDEX;
+		for (size_t u = 0; u < data.uniforms.size(); ++u)
+		{
+			if (data.uniforms[u].name == names[i])
+			{
+				indices[i] = (GLuint)u;
+				break;
+			}
+		}
+	}
+}
+
+void NullRenderDevice::GetActiveUniformsiv(GLuint program, GLsizei count, const GLuint* indices, GLenum pname, GLint* params)
+{
+	const ProgramData& data = m_Programs[program];
+	for (GLsizei i = 0; i < count; ++i)
+	{
+		if (indices[i] >= data.uniforms.size())
+		{
+			params[i] = -1;
+			continue;
+		}
+
+		const ReflectedUniform& u = data.uniforms[indices[i]];
+		switch (pname)
+		{
+		case GL_UNIFORM_OFFSET:			params[i] = u.offset;		break;
+		case GL_UNIFORM_SIZE:			params[i] = u.size;			break;
+		case GL_UNIFORM_TYPE:			params[i] = (GLint)u.type;	break;
+		case GL_UNIFORM_BLOCK_INDEX:	params[i] = u.blockIndex;	break;
+		default:						params[i] = 0;				break;
+		}
+	}
+}
+
+// ---- Uniforms ----
+
+void NullRenderDevice::Uniform1i(GLint location, GLint v)
+{
+	record(CMD_UNIFORM, "Uniform1i", GL_INT, location, 1, sizeof(GLint));
+}
+
+void NullRenderDevice::Uniform1f(GLint location, GLfloat v)
+{
+	record(CMD_UNIFORM, "Uniform1f", GL_FLOAT, location, 1, sizeof(GLfloat));
+}
+
+void NullRenderDevice::Uniform2fv(GLint location, GLsizei count, const GLfloat* v)
+{
+	record(CMD_UNIFORM, "Uniform2fv", GL_FLOAT_VEC2, location, count, count * 2 * sizeof(GLfloat));
+}
+
+void NullRenderDevice::Uniform3fv(GLint location, GLsizei count, const GLfloat* v)
+{
+	record(CMD_UNIFORM, "Uniform3fv", GL_FLOAT_VEC3, location, count, count * 3 * sizeof(GLfloat));
+}
+
+void NullRenderDevice::Uniform4fv(GLint location, GLsizei count, const GLfloat* v)
+{
+	record(CMD_UNIFORM, "Uniform4fv", GL_FLOAT_VEC4, location, count, count * 4 * sizeof(GLfloat));
+}
+
+void NullRenderDevice::UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* v)
+{
+	record(CMD_UNIFORM, "UniformMatrix4fv", GL_FLOAT_MAT4, location, count, count * 16 * sizeof(GLfloat));
+}
+
+// ---- Draws ----
+
+void NullRenderDevice::DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	record(CMD_DRAW, "DrawArrays", mode, 0, count);
+}
+
+void NullRenderDevice::MultiDrawArrays(GLenum mode, const GLint* first, const GLsizei* count, GLsizei drawcount)
+{
+	// One command for the whole call, counting every vertex it draws
+	GLsizei total = 0;
+	for (GLsizei i = 0; i < drawcount; ++i)
+		total += count[i];
+
+	record(CMD_DRAW, "MultiDrawArrays", mode, 0, total);
+}
+
+void NullRenderDevice::DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex)
+{
+	record(CMD_DRAW, "DrawElementsBaseVertex", mode, 0, count);
+}
+
+void NullRenderDevice::DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex)
+{
+	record(CMD_DRAW, "DrawElementsInstancedBaseVertex", mode, 0, count, 0, instancecount);
+}
+
+void NullRenderDevice::DrawElementsInstancedBaseVertexBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex, GLuint baseinstance)
+{
+	record(CMD_DRAW, "DrawElementsInstancedBaseVertexBaseInstance", mode, 0, count, 0, instancecount);
+}
+
+void NullRenderDevice::DrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instancecount, GLuint baseinstance)
+{
+	record(CMD_DRAW, "DrawArraysInstancedBaseInstance", mode, 0, count, 0, instancecount);
+}
+
+// ---- Queries ----
+
+void NullRenderDevice::CreateQueries(GLenum target, GLsizei n, GLuint* ids)
+{
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		ids[i] = genHandle(OBJ_QUERY);
+		record(CMD_CREATE, "CreateQueries", target, ids[i]);
+	}
+}
+
+void NullRenderDevice::DeleteQueries(GLsizei n, const GLuint* ids)
+{
+	deleteHandles(n, ids, "DeleteQueries");
+}
+
+void NullRenderDevice::BeginQuery(GLenum target, GLuint id)
+{
+	record(CMD_QUERY, "BeginQuery", target, id);
+}
+
+void NullRenderDevice::EndQuery(GLenum target)
+{
+	record(CMD_QUERY, "EndQuery", target);
+}
+
+void NullRenderDevice::GetQueryObjectiv(GLuint id, GLenum pname, GLint* params)
+{
+	// Results are always 'available' so nothing ever spins waiting on a GPU that isn't there
+	*params = (pname == GL_QUERY_RESULT_AVAILABLE) ? GL_TRUE : 0;
+}
+
+void NullRenderDevice::GetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params)
+{
+	*params = (pname == GL_QUERY_RESULT_AVAILABLE) ? GL_TRUE : 0;
+}
+
+void NullRenderDevice::GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params)
+{
+	// Every timestamp reads back as 0, so each timed range comes out as taking no time
+	*params = (pname == GL_QUERY_RESULT_AVAILABLE) ? GL_TRUE : 0;
+}
+
+void NullRenderDevice::QueryCounter(GLuint id, GLenum target)
+{
+	record(CMD_QUERY, "QueryCounter", target, id);
+}
+
+// ---- Sync ----
+
+GLsync NullRenderDevice::FenceSync(GLenum condition, GLbitfield flags)
+{
+	// Nothing is ever in flight, the handle only has to be unique and non zero
+	GLuint handle = genHandle(OBJ_SYNC);
+	record(CMD_OTHER, "FenceSync", condition, handle);
+	return (GLsync)(size_t)handle;
+}
+
+GLenum NullRenderDevice::ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+	return GL_ALREADY_SIGNALED;
+}
+
+void NullRenderDevice::DeleteSync(GLsync sync)
+{
+	GLuint handle = (GLuint)(size_t)sync;
+	deleteHandles(1, &handle, "DeleteSync");
+}
+
+// ---- Debug markers ----
+
+void NullRenderDevice::PushMarker(const char* name)
+{
+	m_PassStack.push_back((int)m_Passes.size());
+	m_Passes.push_back(name);
+}
+
+void NullRenderDevice::PopMarker()
+{
+	if (!m_PassStack.empty())
+		m_PassStack.pop_back();
+}
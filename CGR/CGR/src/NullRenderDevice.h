@@ -0,0 +1,274 @@
+#ifndef __NULL_RENDER_DEVICE_H__
+#define __NULL_RENDER_DEVICE_H__
+
+#include "RenderDevice.h"
+#include "types.h"
+
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+
+enum RenderCmdType
+{
+	CMD_STATE,			// Enable, Disable, Blend, Depth, Cull, Stencil, Viewport...
+	CMD_CLEAR,
+	CMD_BIND_BUFFER,
+	CMD_BIND_VAO,
+	CMD_BIND_TEXTURE,
+	CMD_BIND_FBO,
+	CMD_BIND_PROGRAM,
+	CMD_BUFFER_UPLOAD,
+	CMD_TEXTURE_UPLOAD,
+	CMD_UNIFORM,
+	CMD_DRAW,
+	CMD_CREATE,
+	CMD_DELETE,
+	CMD_QUERY,
+	CMD_OTHER,
+	CMD_TYPE_COUNT
+};
+
+struct RenderCommand
+{
+	RenderCmdType	type;
+	const char*		name;		// The GL entry point this came from, without the 'gl' prefix
+	GLenum			target;
+	GLuint			handle;
+	GLsizei			count;		// Vertex/index count for draws, element count for uniforms
+	GLsizei			instances;	// Instance count for instanced draws, 1 for everything else
+	size_t			bytes;		// Bytes that would have crossed the bus
+	int				pass;		// Index into Passes(), -1 if issued outside a marker
+};
+
+/*
+	Has no context and touches no driver, handles are faked and GLSL is reflected from the
+	source strings so shader programs and std140 blocks resolve the same way they would on a GPU.
+	Every call is appended to a command log that can be inspected and cleared per frame.
+*/
+class NullRenderDevice : public RenderDevice
+{
+public:
+	NullRenderDevice();
+	~NullRenderDevice();
+
+	const std::vector<RenderCommand>&	Commands() const;
+	const std::vector<std::string>&		Passes() const;
+	size_t								Count(RenderCmdType type) const;
+	size_t								CountInPass(const std::string& pass, RenderCmdType type) const;
+	size_t								BytesUploaded() const;
+	void								ClearLog();
+	void								SetRecording(bool record);
+
+	RenderBackend	Backend() const override;
+
+	// ---- Global State ----
+	void			Enable(GLenum cap) override;
+	void			Disable(GLenum cap) override;
+	void			Clear(GLbitfield mask) override;
+	void			ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) override;
+	void			CullFace(GLenum mode) override;
+	void			DepthFunc(GLenum func) override;
+	void			DepthMask(GLboolean flag) override;
+	void			BlendFunc(GLenum sfactor, GLenum dfactor) override;
+	void			BlendEquation(GLenum mode) override;
+	void			StencilFunc(GLenum func, GLint ref, GLuint mask) override;
+	void			StencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass) override;
+	void			PolygonMode(GLenum face, GLenum mode) override;
+	void			Viewport(GLint x, GLint y, GLsizei w, GLsizei h) override;
+	void			PixelStorei(GLenum pname, GLint param) override;
+	void			Flush() override;
+	void			GetIntegerv(GLenum pname, GLint* data) override;
+	const GLubyte*	GetString(GLenum name) override;
+	GLenum			GetError() override;
+
+	// ---- Buffers and Vertex Arrays ----
+	void			GenBuffers(GLsizei n, GLuint* buffers) override;
+	void			DeleteBuffers(GLsizei n, const GLuint* buffers) override;
+	GLboolean		IsBuffer(GLuint buffer) override;
+	void			BindBuffer(GLenum target, GLuint buffer) override;
+	void			BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) override;
+	void			BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) override;
+	void			BindBufferBase(GLenum target, GLuint index, GLuint buffer) override;
+	void			BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) override;
+	void			BufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags) override;
+	void*			MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) override;
+	GLboolean		UnmapBuffer(GLenum target) override;
+	void			GenVertexArrays(GLsizei n, GLuint* arrays) override;
+	void			DeleteVertexArrays(GLsizei n, const GLuint* arrays) override;
+	GLboolean		IsVertexArray(GLuint array) override;
+	void			BindVertexArray(GLuint array) override;
+	void			EnableVertexAttribArray(GLuint index) override;
+	void			DisableVertexAttribArray(GLuint index) override;
+	void			VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) override;
+	void			VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) override;
+	void			VertexAttribDivisor(GLuint index, GLuint divisor) override;
+
+	// ---- Textures ----
+	void			GenTextures(GLsizei n, GLuint* textures) override;
+	void			DeleteTextures(GLsizei n, const GLuint* textures) override;
+	GLboolean		IsTexture(GLuint texture) override;
+	void			ActiveTexture(GLenum unit) override;
+	void			BindTexture(GLenum target, GLuint texture) override;
+	void			TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels) override;
+	void			TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels) override;
+	void			TexParameteri(GLenum target, GLenum pname, GLint param) override;
+	void			TexParameterf(GLenum target, GLenum pname, GLfloat param) override;
+	void			GenerateMipmap(GLenum target) override;
+
+	// ---- Frame Buffers ----
+	void			GenFramebuffers(GLsizei n, GLuint* fbos) override;
+	void			DeleteFramebuffers(GLsizei n, const GLuint* fbos) override;
+	GLboolean		IsFramebuffer(GLuint fbo) override;
+	void			BindFramebuffer(GLenum target, GLuint fbo) override;
+	void			FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level) override;
+	GLenum			CheckFramebufferStatus(GLenum target) override;
+	void			DrawBuffer(GLenum buf) override;
+	void			DrawBuffers(GLsizei n, const GLenum* bufs) override;
+	void			ReadBuffer(GLenum src) override;
+	void			BlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) override;
+
+	// ---- Shaders and Programs ----
+	GLuint			CreateShader(GLenum type) override;
+	void			DeleteShader(GLuint shader) override;
+	GLboolean		IsShader(GLuint shader) override;
+	void			ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths) override;
+	void			CompileShader(GLuint shader) override;
+	void			GetShaderiv(GLuint shader, GLenum pname, GLint* params) override;
+	void			GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* log) override;
+	GLuint			CreateProgram() override;
+	void			DeleteProgram(GLuint program) override;
+	GLboolean		IsProgram(GLuint program) override;
+	void			AttachShader(GLuint program, GLuint shader) override;
+	void			BindAttribLocation(GLuint program, GLuint index, const GLchar* name) override;
+	void			BindFragDataLocation(GLuint program, GLuint color, const GLchar* name) override;
+	void			LinkProgram(GLuint program) override;
+	void			GetProgramiv(GLuint program, GLenum pname, GLint* params) override;
+	void			GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* log) override;
+	void			UseProgram(GLuint program) override;
+	GLint			GetUniformLocation(GLuint program, const GLchar* name) override;
+	void			GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) override;
+	void			GetActiveUniformBlockName(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name) override;
+	GLuint			GetUniformBlockIndex(GLuint program, const GLchar* name) override;
+	void			GetActiveUniformBlockiv(GLuint program, GLuint index, GLenum pname, GLint* params) override;
+	void			GetUniformIndices(GLuint program, GLsizei count, const GLchar* const* names, GLuint* indices) override;
+	void			GetActiveUniformsiv(GLuint program, GLsizei count, const GLuint* indices, GLenum pname, GLint* params) override;
+
+	// ---- Uniforms ----
+	void			Uniform1i(GLint location, GLint v) override;
+	void			Uniform1f(GLint location, GLfloat v) override;
+	void			Uniform2fv(GLint location, GLsizei count, const GLfloat* v) override;
+	void			Uniform3fv(GLint location, GLsizei count, const GLfloat* v) override;
+	void			Uniform4fv(GLint location, GLsizei count, const GLfloat* v) override;
+	void			UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* v) override;
+
+	// ---- Draws ----
+	void			DrawArrays(GLenum mode, GLint first, GLsizei count) override;
+	void			MultiDrawArrays(GLenum mode, const GLint* first, const GLsizei* count, GLsizei drawcount) override;
+	void			DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex) override;
+	void			DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex) override;
+	void			DrawElementsInstancedBaseVertexBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex, GLuint baseinstance) override;
+	void			DrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instancecount, GLuint baseinstance) override;
+
+	// ---- Queries ----
+	void			CreateQueries(GLenum target, GLsizei n, GLuint* ids) override;
+	void			DeleteQueries(GLsizei n, const GLuint* ids) override;
+	void			BeginQuery(GLenum target, GLuint id) override;
+	void			EndQuery(GLenum target) override;
+	void			GetQueryObjectiv(GLuint id, GLenum pname, GLint* params) override;
+	void			GetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params) override;
+	void			GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) override;
+	void			QueryCounter(GLuint id, GLenum target) override;
+
+	// ---- Sync ----
+	GLsync			FenceSync(GLenum condition, GLbitfield flags) override;
+	GLenum			ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) override;
+	void			DeleteSync(GLsync sync) override;
+
+	// ---- Debug markers, used to group commands into passes ----
+	void			PushMarker(const char* name) override;
+	void			PopMarker() override;
+
+private:
+	enum ObjectKind
+	{
+		OBJ_BUFFER,
+		OBJ_VAO,
+		OBJ_TEXTURE,
+		OBJ_FBO,
+		OBJ_SHADER,
+		OBJ_PROGRAM,
+		OBJ_QUERY,
+		OBJ_SYNC
+	};
+
+	struct ReflectedUniform
+	{
+		std::string	name;
+		GLenum		type;
+		GLint		size;		// Array length, 1 for non arrays
+		GLint		location;	// -1 for block members
+		GLint		blockIndex;	// -1 for the default block
+		GLint		offset;		// std140 offset within the block
+	};
+
+	struct ReflectedBlock
+	{
+		std::string	name;
+		GLint		dataSize;
+		GLint		binding;
+		std::vector<GLuint> uniforms;
+	};
+
+	struct ProgramData
+	{
+		std::vector<GLuint>				shaders;
+		std::vector<ReflectedUniform>	uniforms;
+		std::vector<ReflectedBlock>		blocks;
+	};
+
+	GLuint	genHandle(ObjectKind kind);
+	bool	isKind(GLuint handle, ObjectKind kind) const;
+	void	deleteHandles(GLsizei n, const GLuint* handles, const char* name);
+	void	record(RenderCmdType type, const char* name, GLenum target = 0, GLuint handle = 0, GLsizei count = 0, size_t bytes = 0, GLsizei instances = 1);
+	void	reflectProgram(ProgramData& program);
+	void	copyName(const std::string& src, GLsizei bufSize, GLsizei* length, GLchar* dst) const;
+
+private:
+	std::vector<RenderCommand>				m_Commands;
+	std::vector<std::string>				m_Passes;
+	std::vector<int>						m_PassStack;
+	std::unordered_map<GLuint, ObjectKind>	m_Objects;
+	std::unordered_map<GLuint, std::string>	m_ShaderSources;
+	std::unordered_map<GLuint, ProgramData>	m_Programs;
+	std::map<GLenum, GLuint>				m_BoundBuffers;
+	std::unordered_map<GLuint, std::vector<byte>>	m_BufferMemory;		// Backing store of immutable buffers so they can be mapped
+	GLuint									m_NextHandle;
+	GLuint									m_CurrentProgram;
+	GLint									m_CullFaceMode;
+	GLint									m_DepthFunc;
+	size_t									m_BytesUploaded;
+	bool									m_Recording;
+};
+
+INLINE const std::vector<RenderCommand>& NullRenderDevice::Commands() const
+{
+	return m_Commands;
+}
+
+INLINE const std::vector<std::string>& NullRenderDevice::Passes() const
+{
+	return m_Passes;
+}
+
+INLINE size_t NullRenderDevice::BytesUploaded() const
+{
+	return m_BytesUploaded;
+}
+
+INLINE void NullRenderDevice::SetRecording(bool record)
+{
+	m_Recording = record;
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include "ObjectDataBuffer.h"
+
+#include "OpenGlLayer.h"
+
+ObjectDataBuffer::ObjectDataBuffer() :
+	m_Objects(),
+	m_Slots(),
+	m_Ids(),
+	m_SSBO(),
+	m_IdVBO(0)
+{
+}
+
+ObjectDataBuffer::~ObjectDataBuffer()
+{
+}
+
+bool ObjectDataBuffer::Init()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->GenBuffers(1, &m_IdVBO);
+	return m_SSBO.Init(GL_SHADER_STORAGE_BUFFER) && m_IdVBO != 0;
+}
+
+void ObjectDataBuffer::Close()
+{
+	m_SSBO.Close();
+	OpenGLLayer::clean_GL_buffer(&m_IdVBO, 1);
+	m_Objects.clear();
+	m_Slots.clear();
+	m_Ids.clear();
+}
+
+void ObjectDataBuffer::Begin(size_t numRenderables)
+{
+	m_Objects.clear();
+	m_Slots.assign(numRenderables, NO_OBJECT_SLOT);
+}
+
+uint32 ObjectDataBuffer::Add(size_t renderable, const Mat4& world, const Mat4& lightXform, int useBumpMap, int useShadow)
+{
+	// A renderable drawn by several sub meshes shares the one slot
+	if (m_Slots[renderable] != NO_OBJECT_SLOT)
+		return m_Slots[renderable];
+
+	ObjectData data;
+	data.world = world;
+	data.lightXform = lightXform;
+	data.useBumpMap = useBumpMap;
+	data.useShadow = useShadow;
+	data.pad0 = 0;
+	data.pad1 = 0;
+
+	m_Slots[renderable] = (uint32)m_Objects.size();
+	m_Objects.push_back(data);
+	return m_Slots[renderable];
+}
+
+void ObjectDataBuffer::Upload()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	// The ids never change, only grow the list when more objects turn up
+	if (m_Objects.size() > m_Ids.size())
+	{
+		const size_t first = m_Ids.size();
+		m_Ids.resize(m_Objects.size() * 2);
+		for (size_t i = first; i < m_Ids.size(); ++i)
+			m_Ids[i] = (uint32)i;
+
+		gl->BindBuffer(GL_ARRAY_BUFFER, m_IdVBO);
+		gl->BufferData(GL_ARRAY_BUFFER, m_Ids.size() * sizeof(uint32), m_Ids.data(), GL_STATIC_DRAW);
+		gl->BindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	if (m_Objects.empty())
+		return;
+
+	m_SSBO.Upload(m_Objects.data(), m_Objects.size() * sizeof(ObjectData));
+	gl->BindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_DATA_BINDING, m_SSBO.Handle());
+}
+
+void ObjectDataBuffer::BindIdAttribute()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->BindBuffer(GL_ARRAY_BUFFER, m_IdVBO);
+	gl->EnableVertexAttribArray(OBJECT_ID_ATTR);
+	gl->VertexAttribIPointer(OBJECT_ID_ATTR, 1, GL_UNSIGNED_INT, sizeof(uint32), 0);
+	gl->VertexAttribDivisor(OBJECT_ID_ATTR, 1);
+	gl->BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ObjectDataBuffer::UnbindIdAttribute()
+{
+	OpenGLLayer::device()->DisableVertexAttribArray(OBJECT_ID_ATTR);
+}
@@ -0,0 +1,76 @@
+#ifndef __OBJECT_DATA_BUFFER_H__
+#define __OBJECT_DATA_BUFFER_H__
+
+#include <vector>
+
+#include "gl_headers.h"
+#include "types.h"
+#include "DynamicBuffer.h"
+
+// Storage buffer binding of the object array, after the light and cluster buffers
+#define OBJECT_DATA_BINDING		6
+// Attribute location of the per instance object id, the draw's base instance selects the object
+#define OBJECT_ID_ATTR			8
+#define NO_OBJECT_SLOT			0xFFFFFFFF
+
+// std430 mirror of ObjectData in forward_geom_object_vs.glsl
+struct ObjectData
+{
+	Mat4	world;
+	Mat4	lightXform;		// Light proj * view * world
+	int		useBumpMap;
+	int		useShadow;
+	int		pad0;
+	int		pad1;
+};
+
+static_assert(sizeof(ObjectData) == 144, "ObjectData must match the std430 layout of the shader's object array");
+
+/*
+	Holds the matrices and flags of every object a pass draws, written in one go before the pass so the
+	draws read their object from a storage buffer instead of being sent uniforms one at a time. Each draw
+	passes its object's slot as the base instance, a per instance id attribute turns that into the index.
+*/
+class ObjectDataBuffer
+{
+public:
+	ObjectDataBuffer();
+	~ObjectDataBuffer();
+
+	bool						Init();
+	void						Close();
+
+	// Forgets the last pass's objects, slots are looked up by renderable index
+	void						Begin(size_t numRenderables);
+	// Returns the renderable's slot, its data is only written the first time it's added in a pass
+	uint32						Add(size_t renderable, const Mat4& world, const Mat4& lightXform, int useBumpMap, int useShadow);
+	uint32						Slot(size_t renderable) const;
+
+	// Sends the objects and binds the buffer
+	void						Upload();
+	// Both expect the mesh vao to be bound. The attribute is left enabled on the vao, so it's turned off again
+	// before anything else draws from it, as other instanced draws would read an id per instance past the end
+	void						BindIdAttribute();
+	void						UnbindIdAttribute();
+
+	uint32						Count() const;
+
+private:
+	std::vector<ObjectData>		m_Objects;
+	std::vector<uint32>			m_Slots;
+	std::vector<uint32>			m_Ids;
+	DynamicBuffer				m_SSBO;
+	GLuint						m_IdVBO;
+};
+
+INLINE uint32 ObjectDataBuffer::Slot(size_t renderable) const
+{
+	return renderable < m_Slots.size() ? m_Slots[renderable] : NO_OBJECT_SLOT;
+}
+
+INLINE uint32 ObjectDataBuffer::Count() const
+{
+	return (uint32)m_Objects.size();
+}
+
+#endif
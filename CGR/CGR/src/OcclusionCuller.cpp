@@ -0,0 +1,363 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Frustum.h"
+#include "LogFile.h"
+
+// Same rule as the frustum batch tests, SSE is there on every platform we build for
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define OCCLUSION_SSE
+#include <xmmintrin.h>
+#endif
+
+// Anything closer to the eye than this in clip w can't be projected safely
+#define OCCLUSION_MIN_W		1e-5f
+
+OcclusionCuller::OcclusionCuller() :
+	m_Levels(),
+	m_LevelWidth(),
+	m_LevelHeight(),
+	m_ClipVerts(),
+	m_ProjView(1.0f),
+	m_Stats(),
+	m_Ready(false)
+{
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+}
+
+bool OcclusionCuller::Init(int width, int height)
+{
+	if (width <= 0 || height <= 0)
+	{
+		WRITE_LOG("Occlusion buffer size must be positive", "error");
+		return false;
+	}
+
+	// Round the width up so every row is whole blocks of four
+	width = (width + 3) & ~3;
+
+	m_Levels.clear();
+	m_LevelWidth.clear();
+	m_LevelHeight.clear();
+
+	int w = width, h = height;
+	for (;;)
+	{
+		m_Levels.push_back(std::vector<float>((size_t)w * h, 1.0f));
+		m_LevelWidth.push_back(w);
+		m_LevelHeight.push_back(h);
+
+		if (w == 1 && h == 1)
+			break;
+
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
+	}
+
+	m_Ready = false;
+	return true;
+}
+
+void OcclusionCuller::Close()
+{
+	m_Levels.clear();
+	m_LevelWidth.clear();
+	m_LevelHeight.clear();
+	m_Ready = false;
+}
+
+void OcclusionCuller::Begin(const Mat4& projView)
+{
+	m_ProjView = projView;
+	m_Stats = OcclusionStats();
+	m_Ready = false;
+
+	if (!m_Levels.empty())
+		std::fill(m_Levels[0].begin(), m_Levels[0].end(), 1.0f);
+}
+
+void OcclusionCuller::AddOccluder(const std::vector<Vec3>& vertices, const std::vector<uint32>& indices, const Mat4& world)
+{
+	if (m_Levels.empty() || vertices.empty())
+		return;
+
+	const Mat4 xform = m_ProjView * world;
+
+	m_ClipVerts.resize(vertices.size());
+	for (size_t i = 0; i < vertices.size(); ++i)
+		m_ClipVerts[i] = xform * Vec4(vertices[i], 1.0f);
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		clipAndRaster(m_ClipVerts[indices[i]], m_ClipVerts[indices[i + 1]], m_ClipVerts[indices[i + 2]]);
+
+	++m_Stats.occluders;
+	m_Stats.triangles += (uint32)(indices.size() / 3);
+}
+
+void OcclusionCuller::End()
+{
+	if (m_Levels.empty())
+		return;
+
+	buildLevels();
+	m_Ready = true;
+}
+
+void OcclusionCuller::clipAndRaster(const Vec4& a, const Vec4& b, const Vec4& c)
+{
+	// Clip against the near plane (z >= -w), a triangle becomes at most a quad
+	const Vec4* in[3] = { &a, &b, &c };
+	Vec4 poly[4];
+	int count = 0;
+
+	for (int i = 0; i < 3; ++i)
+	{
+		const Vec4& p = *in[i];
+		const Vec4& q = *in[(i + 1) % 3];
+		const float dp = p.z + p.w;
+		const float dq = q.z + q.w;
+
+		if (dp >= 0.0f)
+			poly[count++] = p;
+
+		if ((dp >= 0.0f) != (dq >= 0.0f))
+			poly[count++] = p + (q - p) * (dp / (dp - dq));
+	}
+
+	if (count < 3)
+		return;
+
+	Vec3 screen[4];
+	const float w = (float)m_LevelWidth[0];
+	const float h = (float)m_LevelHeight[0];
+
+	for (int i = 0; i < count; ++i)
+	{
+		const float invW = 1.0f / glm::max(poly[i].w, OCCLUSION_MIN_W);
+		screen[i].x = (poly[i].x * invW * 0.5f + 0.5f) * w;
+		screen[i].y = (poly[i].y * invW * 0.5f + 0.5f) * h;
+		screen[i].z = poly[i].z * invW * 0.5f + 0.5f;
+	}
+
+	rasterTriangle(screen[0], screen[1], screen[2]);
+	if (count == 4)
+		rasterTriangle(screen[0], screen[2], screen[3]);
+}
+
+void OcclusionCuller::rasterTriangle(const Vec3& v0, const Vec3& v1, const Vec3& v2)
+{
+	// Occluders are rasterized double sided, wind everything counter clockwise
+	Vec3 a = v0, b = v1, c = v2;
+	float area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+	if (std::fabs(area) < 1e-8f)
+		return;
+
+	if (area < 0.0f)
+	{
+		std::swap(b, c);
+		area = -area;
+	}
+
+	const int width = m_LevelWidth[0];
+	const int height = m_LevelHeight[0];
+
+	int minX = (int)std::floor(glm::min(a.x, glm::min(b.x, c.x)));
+	int maxX = (int)std::ceil(glm::max(a.x, glm::max(b.x, c.x)));
+	int minY = (int)std::floor(glm::min(a.y, glm::min(b.y, c.y)));
+	int maxY = (int)std::ceil(glm::max(a.y, glm::max(b.y, c.y)));
+
+	minX = glm::max(minX, 0) & ~3;
+	minY = glm::max(minY, 0);
+	maxX = glm::min(maxX, width - 1);
+	maxY = glm::min(maxY, height - 1);
+
+	if (minX > maxX || minY > maxY)
+		return;
+
+	++m_Stats.rasterized;
+
+	// Edge functions, positive inside: E = A * x + B * y + C
+	const float A0 = b.y - c.y, B0 = c.x - b.x, C0 = -(A0 * b.x + B0 * b.y);
+	const float A1 = c.y - a.y, B1 = a.x - c.x, C1 = -(A1 * c.x + B1 * c.y);
+	const float A2 = a.y - b.y, B2 = b.x - a.x, C2 = -(A2 * a.x + B2 * a.y);
+
+	// Depth is affine in screen space after the divide
+	const float invArea = 1.0f / area;
+	const float dzdx = (A0 * a.z + A1 * b.z + A2 * c.z) * invArea;
+	const float dzdy = (B0 * a.z + B1 * b.z + B2 * c.z) * invArea;
+	const float z0 = (C0 * a.z + C1 * b.z + C2 * c.z) * invArea;
+
+	float* depth = m_Levels[0].data();
+
+	for (int y = minY; y <= maxY; ++y)
+	{
+		const float py = (float)y + 0.5f;
+		float* row = depth + (size_t)y * width;
+
+#if defined(OCCLUSION_SSE)
+		const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 a0 = _mm_set1_ps(A0), a1 = _mm_set1_ps(A1), a2 = _mm_set1_ps(A2);
+		const __m128 dz = _mm_set1_ps(dzdx);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 r0 = _mm_set1_ps(B0 * py + C0);
+		const __m128 r1 = _mm_set1_ps(B1 * py + C1);
+		const __m128 r2 = _mm_set1_ps(B2 * py + C2);
+		const __m128 rz = _mm_set1_ps(dzdy * py + z0);
+
+		for (int x = minX; x <= maxX; x += 4)
+		{
+			const __m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+			const __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, px), r0);
+			const __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, px), r1);
+			const __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, px), r2);
+
+			__m128 inside = _mm_and_ps(_mm_cmpgt_ps(e0, zero), _mm_cmpgt_ps(e1, zero));
+			inside = _mm_and_ps(inside, _mm_cmpgt_ps(e2, zero));
+			if (_mm_movemask_ps(inside) == 0)
+				continue;
+
+			const __m128 z = _mm_add_ps(_mm_mul_ps(dz, px), rz);
+			const __m128 old = _mm_loadu_ps(row + x);
+			const __m128 nearer = _mm_min_ps(old, z);
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+		}
+#else
+		for (int x = minX; x <= maxX; ++x)
+		{
+			const float px = (float)x + 0.5f;
+			if (A0 * px + B0 * py + C0 > 0.0f &&
+				A1 * px + B1 * py + C1 > 0.0f &&
+				A2 * px + B2 * py + C2 > 0.0f)
+			{
+				const float z = dzdx * px + dzdy * py + z0;
+				if (z < row[x])
+					row[x] = z;
+			}
+		}
+#endif
+	}
+}
+
+void OcclusionCuller::buildLevels()
+{
+	// Each texel keeps the farthest of the (up to) four below it, an edge texel on an odd size repeats
+	for (size_t l = 1; l < m_Levels.size(); ++l)
+	{
+		const std::vector<float>& src = m_Levels[l - 1];
+		std::vector<float>& dst = m_Levels[l];
+		const int sw = m_LevelWidth[l - 1], sh = m_LevelHeight[l - 1];
+		const int dw = m_LevelWidth[l], dh = m_LevelHeight[l];
+
+		for (int y = 0; y < dh; ++y)
+		{
+			const int y0 = y * 2;
+			const int y1 = glm::min(y0 + 1, sh - 1);
+
+			for (int x = 0; x < dw; ++x)
+			{
+				const int x0 = x * 2;
+				const int x1 = glm::min(x0 + 1, sw - 1);
+
+				dst[(size_t)y * dw + x] = glm::max(
+					glm::max(src[(size_t)y0 * sw + x0], src[(size_t)y0 * sw + x1]),
+					glm::max(src[(size_t)y1 * sw + x0], src[(size_t)y1 * sw + x1]));
+			}
+		}
+	}
+}
+
+bool OcclusionCuller::TestBox(const Vec3& min, const Vec3& max) const
+{
+	if (!m_Ready)
+		return true;
+
+	const float w = (float)m_LevelWidth[0];
+	const float h = (float)m_LevelHeight[0];
+
+	float minX = w, maxX = 0.0f, minY = h, maxY = 0.0f, nearest = 1.0f;
+
+	for (int i = 0; i < 8; ++i)
+	{
+		const Vec4 corner((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z, 1.0f);
+		const Vec4 clip = m_ProjView * corner;
+
+		// Crosses the near plane, can't be put on screen so keep it
+		if (clip.w <= OCCLUSION_MIN_W || clip.z < -clip.w)
+			return true;
+
+		const float invW = 1.0f / clip.w;
+		const float sx = (clip.x * invW * 0.5f + 0.5f) * w;
+		const float sy = (clip.y * invW * 0.5f + 0.5f) * h;
+
+		minX = glm::min(minX, sx);
+		maxX = glm::max(maxX, sx);
+		minY = glm::min(minY, sy);
+		maxY = glm::max(maxY, sy);
+		nearest = glm::min(nearest, clip.z * invW * 0.5f + 0.5f);
+	}
+
+	// Off the buffer, the frustum test has the say on these
+	if (maxX < 0.0f || maxY < 0.0f || minX >= w || minY >= h)
+		return true;
+
+	int x0 = glm::max((int)minX, 0);
+	int y0 = glm::max((int)minY, 0);
+	int x1 = glm::min((int)maxX, m_LevelWidth[0] - 1);
+	int y1 = glm::min((int)maxY, m_LevelHeight[0] - 1);
+
+	// Drop down the chain until the rect is at most two texels each way
+	int level = 0;
+	while (level + 1 < (int)m_Levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+		++level;
+
+	x0 >>= level; x1 >>= level;
+	y0 >>= level; y1 >>= level;
+
+	const std::vector<float>& depth = m_Levels[level];
+	const int lw = m_LevelWidth[level];
+
+	for (int y = y0; y <= y1; ++y)
+	{
+		for (int x = x0; x <= x1; ++x)
+		{
+			if (nearest <= depth[(size_t)y * lw + x])
+				return true;
+		}
+	}
+
+	return false;
+}
+
+bool OcclusionCuller::TestSphere(const Vec3& centre, float radius) const
+{
+	return TestBox(centre - Vec3(radius), centre + Vec3(radius));
+}
+
+size_t OcclusionCuller::CullSpheres(const SphereArrays& spheres, std::vector<uint32>& visibleMask) const
+{
+	if (!m_Ready)
+		return 0;
+
+	size_t hidden = 0;
+	const size_t count = spheres.Size();
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (!Frustum::IsVisible(visibleMask, i))
+			continue;
+
+		const Vec3 centre(spheres.x[i], spheres.y[i], spheres.z[i]);
+		if (!TestSphere(centre, spheres.radius[i]))
+		{
+			visibleMask[i >> 5] &= ~(1u << (i & 31));
+			++hidden;
+		}
+	}
+
+	return hidden;
+}
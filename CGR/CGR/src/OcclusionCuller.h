@@ -0,0 +1,108 @@
+#ifndef __OCCLUSION_CULLER_H__
+#define __OCCLUSION_CULLER_H__
+
+#include <vector>
+
+#include "types.h"
+
+struct SphereArrays;
+
+// Width is kept a multiple of 4 so rows rasterize four pixels at a time
+#define OCCLUSION_WIDTH		256
+#define OCCLUSION_HEIGHT	128
+
+struct OcclusionStats
+{
+	uint32	occluders;				// Meshes added this frame
+	uint32	triangles;				// Occluder triangles submitted
+	uint32	rasterized;				// Triangles that survived clipping and covered the buffer
+};
+
+/*
+	Software occlusion culling. Occluder triangles are rasterized into a small CPU depth buffer, a
+	chain of mips holding the farthest depth of each block is built from it, and bounds are then
+	tested against the one mip level where they cover no more than 2x2 texels. An object is hidden
+	only when its nearest point is behind everything drawn over its screen rect. Nothing touches the
+	GPU so the culler runs the same with any render device.
+
+	Begin, AddOccluder and End are called from one thread; the tests are const and safe to run from
+	any number of jobs once End has returned.
+*/
+class OcclusionCuller
+{
+public:
+	OcclusionCuller();
+	~OcclusionCuller();
+
+	bool					Init(int width = OCCLUSION_WIDTH, int height = OCCLUSION_HEIGHT);
+	void					Close();
+
+	// Clears the depth buffer for a new view
+	void					Begin(const Mat4& projView);
+
+	// Occluders are model space triangle lists, see Mesh::OccluderVertices
+	void					AddOccluder(const std::vector<Vec3>& vertices, const std::vector<uint32>& indices, const Mat4& world);
+
+	// Builds the mip chain, after this the tests can be used
+	void					End();
+
+	// True if any part of the bounds might be seen. Anything crossing the near plane or off screen is kept
+	bool					TestBox(const Vec3& min, const Vec3& max) const;
+	bool					TestSphere(const Vec3& centre, float radius) const;
+
+	// Clears the bit of every sphere still set in the mask that is hidden, returns how many were cleared
+	size_t					CullSpheres(const SphereArrays& spheres, std::vector<uint32>& visibleMask) const;
+
+	bool					IsReady() const;
+	const OcclusionStats&	Stats() const;
+	int						Width() const;
+	int						Height() const;
+	int						NumLevels() const;
+	const float*			Depth(int level) const;
+
+private:
+	void					clipAndRaster(const Vec4& a, const Vec4& b, const Vec4& c);
+	void					rasterTriangle(const Vec3& a, const Vec3& b, const Vec3& c);
+	void					buildLevels();
+
+private:
+	std::vector<std::vector<float>>	m_Levels;		// Level 0 is the raster target
+	std::vector<int>				m_LevelWidth;
+	std::vector<int>				m_LevelHeight;
+	std::vector<Vec4>				m_ClipVerts;
+	Mat4							m_ProjView;
+	OcclusionStats					m_Stats;
+	bool							m_Ready;
+};
+
+INLINE bool OcclusionCuller::IsReady() const
+{
+	return m_Ready;
+}
+
+INLINE const OcclusionStats& OcclusionCuller::Stats() const
+{
+	return m_Stats;
+}
+
+INLINE int OcclusionCuller::Width() const
+{
+	return m_LevelWidth.empty() ? 0 : m_LevelWidth[0];
+}
+
+INLINE int OcclusionCuller::Height() const
+{
+	return m_LevelHeight.empty() ? 0 : m_LevelHeight[0];
+}
+
+INLINE int OcclusionCuller::NumLevels() const
+{
+	return (int)m_Levels.size();
+}
+
+INLINE const float* OcclusionCuller::Depth(int level) const
+{
+	return m_Levels[level].data();
+}
+
+#endif
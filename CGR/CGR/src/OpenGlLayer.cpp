@@ -1,20 +1,62 @@
 #include "OpenGlLayer.h"
 
 #include "LogFile.h"
+#include "GLRenderDevice.h"
+#include "NullRenderDevice.h"
+#include "StateCacheDevice.h"
+
+RenderDevice* OpenGLLayer::m_Device = nullptr;
+StateCacheDevice* OpenGLLayer::m_StateCache = nullptr;
+
+bool OpenGLLayer::create_device(RenderBackend backend)
+{
+	if (m_Device)
+	{
+		WRITE_LOG("Render device already created", "warning");
+		return true;
+	}
+
+	RenderDevice* backendDevice = nullptr;
+
+	switch (backend)
+	{
+	case GLBackend:
+		backendDevice = new GLRenderDevice();
+		break;
+	case NullBackend:
+		backendDevice = new NullRenderDevice();
+		break;
+	default:
+		WRITE_LOG("Unknown render backend", "error");
+		return false;
+	}
+
+	// Everything goes through the state cache so redundant state changes never reach the backend
+	m_StateCache = new StateCacheDevice(backendDevice);
+	m_Device = m_StateCache;
+
+	return true;
+}
+
+void OpenGLLayer::destroy_device()
+{
+	SAFE_DELETE(m_Device);
+	m_StateCache = nullptr;
+}
 
 void OpenGLLayer::enable_GL_state(GLenum state)
 {
-	glEnable(state);
+	m_Device->Enable(state);
 }
 
 void OpenGLLayer::disable_GL_state(GLenum state)
 {
-	glDisable(state);
+	m_Device->Disable(state);
 }
 
 bool OpenGLLayer::check_GL_error()
 {
-	GLenum err = glGetError();
+	GLenum err = m_Device->GetError();
 
 	if (err != GL_NO_ERROR)
 	{
@@ -32,9 +74,9 @@ void OpenGLLayer::clean_GL_texture(GLuint* texID, int count)
 {
 	if (texID)
 	{
-		if (glIsTexture(*texID))
+		if (m_Device->IsTexture(*texID))
 		{
-			glDeleteTextures(count, texID);
+			m_Device->DeleteTextures(count, texID);
 			OpenGLLayer::check_GL_error();
 		}
 	}
@@ -44,9 +86,9 @@ void OpenGLLayer::clean_GL_buffer(GLuint* buff, int count)
 {
 	if (buff)
 	{
-		if (glIsBuffer(*buff))
+		if (m_Device->IsBuffer(*buff))
 		{
-			glDeleteBuffers(count, buff);
+			m_Device->DeleteBuffers(count, buff);
 			OpenGLLayer::check_GL_error();
 		}
 	}
@@ -56,9 +98,9 @@ void OpenGLLayer::clean_GL_vao(GLuint* buff, int count)
 {
 	if (buff)
 	{
-		if (glIsVertexArray(*buff))
+		if (m_Device->IsVertexArray(*buff))
 		{
-			glDeleteVertexArrays(count, buff);
+			m_Device->DeleteVertexArrays(count, buff);
 			OpenGLLayer::check_GL_error();
 		}
 	}
@@ -68,9 +110,9 @@ void OpenGLLayer::clean_GL_program(GLuint* buff)
 {
 	if (buff)
 	{
-		if (glIsProgram(*buff))
+		if (m_Device->IsProgram(*buff))
 		{
-			glDeleteProgram(*buff);
+			m_Device->DeleteProgram(*buff);
 			OpenGLLayer::check_GL_error();
 		}
 	}
@@ -78,18 +120,18 @@ void OpenGLLayer::clean_GL_program(GLuint* buff)
 
 void OpenGLLayer::clean_GL_shader(GLuint* shader)
 {
-	if (glIsShader(*shader))
+	if (m_Device->IsShader(*shader))
 	{
-		glDeleteShader(*shader);
+		m_Device->DeleteShader(*shader);
 		OpenGLLayer::check_GL_error();
 	}
 }
 
 void OpenGLLayer::clean_GL_fbo(GLuint* fbo, int count)
 {
-	if (glIsFramebuffer(*fbo))
+	if (m_Device->IsFramebuffer(*fbo))
 	{
-		glDeleteFramebuffers(count, fbo);
+		m_Device->DeleteFramebuffers(count, fbo);
 	}
 }
 
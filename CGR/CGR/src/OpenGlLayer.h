@@ -2,10 +2,19 @@
 #define __OPEN_GL_LAYER_H__
 
 #include "gl_headers.h"
+#include "RenderDevice.h"
+#include "types.h"
+
+class StateCacheDevice;
 
 class OpenGLLayer
 {
 public:
+	static bool				create_device		(RenderBackend backend);
+	static void				destroy_device		();
+	static RenderDevice*	device				();
+	static StateCacheDevice*	state_cache		();
+
 	static bool		check_GL_error		();
 	static void		enable_GL_state		(GLenum state);
 	static void		disable_GL_state	(GLenum state);
@@ -16,6 +25,20 @@ public:
 	static void		clean_GL_shader		(GLuint* shader);
 	static void		clean_GL_fbo		(GLuint* fbo, int count);
 	static size_t	glTypeSize			(GLenum type);
+
+private:
+	static RenderDevice*		m_Device;
+	static StateCacheDevice*	m_StateCache;
 };
 
+INLINE RenderDevice* OpenGLLayer::device()
+{
+	return m_Device;
+}
+
+INLINE StateCacheDevice* OpenGLLayer::state_cache()
+{
+	return m_StateCache;
+}
+
 #endif
@@ -8,18 +8,18 @@ Plane::Plane() :
 {
 }
 
-float Plane::Distance(const Vec3& pos)
-{
-	return glm::dot(Vec3(a, b, c), pos) + d;
-}
-
 void Plane::Set(const Vec4& v)
 {
-	a = v.x;
-	b = v.y;
-	c = v.z;
-	d = v.w;
-	norm = glm::normalize(Vec3(a, b, c));
+	// Planes pulled from a projection aren't unit length, sphere radii would be compared against scaled distances
+	float len = glm::length(Vec3(v.x, v.y, v.z));
+	if (len <= 0.0f)
+		len = 1.0f;
+
+	a = v.x / len;
+	b = v.y / len;
+	c = v.z / len;
+	d = v.w / len;
+	norm = Vec3(a, b, c);
 }
 
 const Vec3& Plane::Normal() const
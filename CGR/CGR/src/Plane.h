@@ -8,8 +8,9 @@ class Plane
 public:
 	Plane();
 
+	// Normalises the equation so Distance is a true signed distance
 	void			Set(const Vec4& abcd);
-	float			Distance(const Vec3& pos);
+	float			Distance(const Vec3& pos) const;
 	const Vec3&		Normal() const;
 
 private:
@@ -18,4 +19,9 @@ private:
 	float a, b, c, d;
 };
 
-#endif
\ No newline at end of file
+INLINE float Plane::Distance(const Vec3& pos) const
+{
+	return a * pos.x + b * pos.y + c * pos.z + d;
+}
+
+#endif
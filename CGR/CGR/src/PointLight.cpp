@@ -1,7 +1,5 @@
 #include "PointLight.h"
 
-#include "UniformBlockManager.h"
-#include "UniformBlock.h"
 #include "Renderer.h"
 #include "LogFile.h"
 
@@ -10,13 +8,13 @@ int PointLightC::m_Id = POINT_LIGHT_COMPONENT;
 PointLightC::PointLightC(GameObject* owner) :
 	Component(owner),
 	m_Renderer(nullptr),
-	m_LightBlock(nullptr),
 	m_Position(),
 	m_Intensity(),
 	m_AmbientIntensity(0.0f),
 	m_aConstant(0.0f),
 	m_aLinear(0.0f),
 	m_aQuadratic(0.0f),
+	m_Range(0.0f),
 	m_LightIndex(-1),
 	m_LightValid(GE_FALSE)
 {
@@ -50,33 +48,12 @@ bool PointLightC::SetLight(
 		return false;
 	}
 
-	UniformBlockManager* ubm = UniformBlockManager::Instance();
-	if (!ubm)
-	{
-		WRITE_LOG("Can't create point light without uniform block manager, is the renderer created?", "error");
-		return false;
-	}
-
-	m_LightBlock = ubm->GetBlock("Lights");
-	if (!m_LightBlock)
-	{
-		WRITE_LOG("Can't create point light without 'Lights' uniform blocks, is the renderer created?", "error");
-		return false;
-	}
-
-	if (!m_LightBlock->IsBound())
-	{
-		WRITE_LOG("Can't create point light without 'Lights' uniform blocks being bound", "error");
-		m_LightBlock = nullptr;
-		return false;
-	}
-
 	m_LightIndex = m_Renderer->GetPointLightIndex();
 
 	if (m_LightIndex < 0)
 	{
 		WRITE_LOG("Can't create point light, exceeded max num point lights", "warning");
-		m_LightBlock = nullptr;
+		m_Renderer = nullptr;
 		return false;
 	}
 
@@ -89,103 +66,102 @@ bool PointLightC::SetLight(
 	m_LightValid = GE_TRUE;
 	m_Range = calcPointLightBSphere();
 
-	m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].position", &m_Position);
-	m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].intensity", &m_Intensity);
-	m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].ambient_intensity", &m_AmbientIntensity);
-	m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].aConstant", &m_aConstant);
-	m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].aLinear", &m_aLinear);
-	m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].aQuadratic", &m_aQuadratic);
-
-	int num_points = m_LightIndex + 1;
-	m_LightBlock->SetValue("numPoints", &num_points);
-	m_Renderer->UpdatePointLight(m_LightIndex, m_Position, m_Range);
+	updateLight();
 	return true;
 }
 
 void PointLightC::SetPosition(const Vec3& pos)
 {
-	if (m_LightValid && m_LightBlock)
+	if (m_LightValid && m_Renderer)
 	{
 		m_Position = pos;
-		m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].position", &m_Position);
-		m_Renderer->UpdatePointLight(m_LightIndex, m_Position, m_Range);
+		updateLight();
 	}
 }
 
 void PointLightC::SetPositionX(float x)
 {
-	if (m_LightValid && m_LightBlock)
+	if (m_LightValid && m_Renderer)
 	{
 		m_Position.x = x;
-		m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].position", &m_Position);
-		m_Renderer->UpdatePointLight(m_LightIndex, m_Position, m_Range);
+		updateLight();
 	}
 }
 
 void PointLightC::SetPositionY(float y)
 {
-	if (m_LightValid && m_LightBlock)
+	if (m_LightValid && m_Renderer)
 	{
 		m_Position.y = y;
-		m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].position", &m_Position);
-		m_Renderer->UpdatePointLight(m_LightIndex, m_Position, m_Range);
+		updateLight();
 	}
 }
 
 void PointLightC::SetPositionZ(float z)
 {
-	if (m_LightValid && m_LightBlock)
+	if (m_LightValid && m_Renderer)
 	{
 		m_Position.z = z;
-		m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].position", &m_Position);
-		m_Renderer->UpdatePointLight(m_LightIndex, m_Position, m_Range);
+		updateLight();
 	}
 }
 
 void PointLightC::SetColour(const Vec3& newCol)
 {
-	if (m_LightValid && m_LightBlock)
+	if (m_LightValid && m_Renderer)
 	{
 		m_Intensity = newCol;
-		m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].intensity", &m_Intensity);
 		m_Range = calcPointLightBSphere();
-		m_Renderer->UpdatePointLight(m_LightIndex, m_Position, m_Range);
+		updateLight();
 	}
 }
 
 void PointLightC::SetColR(float r)
 {
-	if (m_LightValid && m_LightBlock)
+	if (m_LightValid && m_Renderer)
 	{
 		m_Intensity.r = r;
-		m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].intensity", &m_Intensity);
 		m_Range = calcPointLightBSphere();
-		m_Renderer->UpdatePointLight(m_LightIndex, m_Position, m_Range);
+		updateLight();
 	}
 }
 
 void PointLightC::SetColG(float g)
 {
-	if (m_LightValid && m_LightBlock)
+	if (m_LightValid && m_Renderer)
 	{
 		m_Intensity.g = g;
-		m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].intensity", &m_Intensity);
 		m_Range = calcPointLightBSphere();
-		m_Renderer->UpdatePointLight(m_LightIndex, m_Position, m_Range);
+		updateLight();
 	}
 }
 
 void PointLightC::SetColB(float b)
 {
-	if (m_LightValid && m_LightBlock)
+	if (m_LightValid && m_Renderer)
 	{
 		m_Intensity.b = b;
-		m_LightBlock->SetValue("pointLights[" + std::to_string(m_LightIndex) + "].intensity", &m_Intensity);
 		m_Range = calcPointLightBSphere();
-		m_Renderer->UpdatePointLight(m_LightIndex, m_Position, m_Range);
+		updateLight();
 	}
 }
 
+void PointLightC::updateLight()
+{
+	// The renderer keeps every point light in one buffer, the range both bins the light and cuts it off in the shaders
+	PointLightData light;
+	light.position = m_Position;
+	light.range = m_Range;
+	light.intensity = m_Intensity;
+	light.ambientIntensity = m_AmbientIntensity;
+	light.aConstant = m_aConstant;
+	light.aLinear = m_aLinear;
+	light.aQuadratic = m_aQuadratic;
+	light.pad = 0.0f;
+
+	m_Renderer->UpdatePointLight(m_LightIndex, light);
+}
+
 float PointLightC::calcPointLightBSphere()
 {
 	//float lightMax = std::fmaxf(std::fmaxf(m_Intensity.r, m_Intensity.g), m_Intensity.b);
@@ -4,7 +4,6 @@
 #include "Component.h"
 #include "types.h"
 
-class UniformBlock;
 class Renderer;
 
 class PointLightC : public Component
@@ -41,11 +40,11 @@ public:
 
 private:
 	float calcPointLightBSphere();
+	void updateLight();
 
 private:
 	static int		m_Id;
 	Renderer*		m_Renderer;		// <-- Weak ptr
-	UniformBlock*	m_LightBlock;	// <-- Weak ptr
 	Vec3			m_Position;
 	Vec3			m_Intensity;
 	float			m_AmbientIntensity;
@@ -0,0 +1,168 @@
+#include "Profiler.h"
+
+#include "LogFile.h"
+#include "utils.h"
+
+#include <chrono>
+#include <fstream>
+#include <cstdio>
+
+// Events a thread's buffer starts with room for, the main thread records a few thousand a frame
+#define PROFILE_RESERVE_EVENTS	16384
+
+static const std::chrono::steady_clock::time_point s_Epoch = std::chrono::steady_clock::now();
+
+thread_local Profiler::ThreadBuffer* Profiler::m_Thread = nullptr;
+std::mutex Profiler::m_Mutex;
+std::vector<Profiler::ThreadBuffer*> Profiler::m_Buffers;
+std::atomic<bool> Profiler::m_Capturing(false);
+std::string Profiler::m_OutputPath("../resources/log/");
+uint32 Profiler::m_Frame = 0;
+uint32 Profiler::m_CaptureStart = 0;
+uint32 Profiler::m_CaptureFrames = 0;
+uint32 Profiler::m_FramesLeft = 0;
+uint32 Profiler::m_NextThreadId = 1;
+
+void Profiler::Capture(uint32 frames)
+{
+	CaptureAt(m_Frame + 1, frames);
+}
+
+void Profiler::CaptureAt(uint32 frame, uint32 frames)
+{
+	if (IsCapturing() || frames == 0)
+		return;
+
+	m_CaptureStart = frame;
+	m_CaptureFrames = frames;
+}
+
+void Profiler::SetOutputPath(const std::string& path)
+{
+	m_OutputPath = path;
+}
+
+void Profiler::Close()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	m_Capturing = false;
+	for (size_t i = 0; i < m_Buffers.size(); ++i)
+		SAFE_DELETE(m_Buffers[i]);
+
+	m_Buffers.clear();
+	m_Thread = nullptr;
+}
+
+void Profiler::BeginFrame()
+{
+	++m_Frame;
+
+	if (IsCapturing())
+	{
+		if (--m_FramesLeft == 0)
+		{
+			m_Capturing = false;
+			writeTrace();
+		}
+	}
+	else if (m_CaptureFrames > 0 && m_Frame >= m_CaptureStart)
+	{
+		// Workers are parked between frames, nothing is writing to their buffers
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (size_t i = 0; i < m_Buffers.size(); ++i)
+			m_Buffers[i]->events.clear();
+
+		m_CaptureStart = m_Frame;
+		m_FramesLeft = m_CaptureFrames;
+		m_CaptureFrames = 0;
+		m_Capturing = true;
+	}
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+	ThreadBuffer* buffer = threadBuffer();
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	buffer->name = name;
+}
+
+uint64 Profiler::Now()
+{
+	return (uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Epoch).count();
+}
+
+void Profiler::Record(const char* name, uint64 start, uint64 end)
+{
+	// A zone still open when its capture was written is left out of the next one
+	if (!IsCapturing())
+		return;
+
+	ProfileEvent e = { name, start, end };
+	threadBuffer()->events.push_back(e);
+}
+
+Profiler::ThreadBuffer* Profiler::threadBuffer()
+{
+	if (!m_Thread)
+	{
+		ThreadBuffer* buffer = new ThreadBuffer();
+		buffer->events.reserve(PROFILE_RESERVE_EVENTS);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		buffer->id = m_NextThreadId++;
+		buffer->name = "Thread " + util::to_str(buffer->id);
+		m_Buffers.push_back(buffer);
+		m_Thread = buffer;
+	}
+
+	return m_Thread;
+}
+
+bool Profiler::writeTrace()
+{
+	const std::string path = m_OutputPath + "trace_frame" + util::to_str(m_CaptureStart) + ".json";
+
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+	if (!file.is_open())
+	{
+		WRITE_LOG("Could not write profile trace: " + path, "error");
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	size_t count = 0;
+	char line[256];
+	file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+	// Track names first, then every zone as a complete event with microsecond times
+	for (size_t t = 0; t < m_Buffers.size(); ++t)
+	{
+		const ThreadBuffer& buffer = *m_Buffers[t];
+		snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+			t == 0 ? "" : ",\n", buffer.id, buffer.name.c_str());
+		file << line;
+	}
+
+	for (size_t t = 0; t < m_Buffers.size(); ++t)
+	{
+		const ThreadBuffer& buffer = *m_Buffers[t];
+		for (size_t i = 0; i < buffer.events.size(); ++i)
+		{
+			const ProfileEvent& e = buffer.events[i];
+			snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				e.name, buffer.id, e.start / 1000.0, (e.end - e.start) / 1000.0);
+			file << line;
+		}
+
+		count += buffer.events.size();
+	}
+
+	file << "\n]}\n";
+	file.close();
+
+	WRITE_LOG("Wrote " + util::to_str(count) + " profile zones to " + path, "info");
+	return true;
+}
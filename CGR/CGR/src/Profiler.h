@@ -0,0 +1,112 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include "types.h"
+
+// Frames a keypress capture records before the trace is written
+#define PROFILE_CAPTURE_FRAMES	120
+
+/*
+	CGR_PROFILE is defined by the Debug and Release configurations. The Shipping configuration, Release without
+	it, builds CGR_Shipping and every PROFILE_ macro compiles to nothing. Zone names must outlive the capture, string literals are what they're for.
+*/
+#ifdef CGR_PROFILE
+#define PROFILE_CONCAT_INNER(a, b)	a##b
+#define PROFILE_CONCAT(a, b)		PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name)			ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_THREAD(name)		Profiler::SetThreadName(name)
+#define PROFILE_FRAME()				Profiler::BeginFrame()
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_THREAD(name)
+#define PROFILE_FRAME()
+#endif
+
+struct ProfileEvent
+{
+	const char*	name;
+	uint64		start;		// Nanoseconds since the profiler's epoch
+	uint64		end;
+};
+
+/*
+	Zones are timed on whichever thread they run on and pushed into that thread's own buffer, so recording
+	takes no lock and each thread shows as its own track. Nothing is recorded outside a capture. A capture
+	runs for a number of frames from a keypress or a set frame, then every buffer is written out as Chrome
+	trace_event JSON (chrome://tracing or ui.perfetto.dev). Buffers are read at a frame boundary, when the
+	job system's workers are parked.
+*/
+class Profiler
+{
+	struct ThreadBuffer
+	{
+		std::vector<ProfileEvent>	events;
+		std::string					name;
+		uint32						id;
+	};
+
+public:
+	// Starts recording from the next frame for this many frames
+	static void				Capture(uint32 frames);
+	// Same, once the frame counter reaches frame. For runs that can't take a keypress
+	static void				CaptureAt(uint32 frame, uint32 frames);
+	static void				SetOutputPath(const std::string& path);
+	// Frees every thread's buffer, nothing can be recording
+	static void				Close();
+
+	// Frame boundary, starts and finishes captures
+	static void				BeginFrame();
+	static void				SetThreadName(const std::string& name);
+
+	static bool				IsCapturing();
+	static uint64			Now();
+	static void				Record(const char* name, uint64 start, uint64 end);
+
+private:
+	static ThreadBuffer*	threadBuffer();
+	static bool				writeTrace();
+
+private:
+	static thread_local ThreadBuffer*	m_Thread;
+	static std::mutex					m_Mutex;
+	static std::vector<ThreadBuffer*>	m_Buffers;
+	static std::atomic<bool>			m_Capturing;
+	static std::string					m_OutputPath;
+	static uint32						m_Frame;
+	static uint32						m_CaptureStart;
+	static uint32						m_CaptureFrames;
+	static uint32						m_FramesLeft;
+	static uint32						m_NextThreadId;
+};
+
+INLINE bool Profiler::IsCapturing()
+{
+	return m_Capturing.load(std::memory_order_relaxed);
+}
+
+// Times its scope, a zone that starts outside a capture isn't recorded even if one begins before it ends
+class ProfileZone
+{
+public:
+	explicit ProfileZone(const char* name) :
+		m_Name(Profiler::IsCapturing() ? name : nullptr),
+		m_Start(m_Name ? Profiler::Now() : 0)
+	{
+	}
+
+	~ProfileZone()
+	{
+		if (m_Name)
+			Profiler::Record(m_Name, m_Start, Profiler::Now());
+	}
+
+private:
+	const char*	m_Name;
+	uint64		m_Start;
+};
+
+#endif
@@ -1,6 +1,10 @@
 #include "Queery.h"
 
-Query::Query()
+#include "OpenGlLayer.h"
+
+Query::Query() :
+	m_Query(0U),
+	m_Target(0U)
 {
 }
 
@@ -31,8 +35,10 @@ Query::~Query()
 
 bool Query::Init(const GLenum target)
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	GLuint query;
-	glCreateQueries(target, 1, &query);
+	gl->CreateQueries(target, 1, &query);
 
 	if (query == 0U)
 	{
@@ -47,33 +53,42 @@ bool Query::Init(const GLenum target)
 
 void Query::Clean()
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	if (IsInit())
 	{
-		glDeleteQueries(1, &m_Query);
+		gl->DeleteQueries(1, &m_Query);
+		m_Query = 0U;
 		m_Target = 0U;
 	}
 }
 
 void Query::Start() const
 {
-	glBeginQuery(m_Target, m_Query);
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->BeginQuery(m_Target, m_Query);
 }
 
 void Query::End() const
 {
-	glEndQuery(m_Target);
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->EndQuery(m_Target);
 }
 
 GLuint Query::Result(const bool flushGPU) const
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	int done = 0;
 	while (!done)
 	{
-		glGetQueryObjectiv(m_Query, GL_QUERY_RESULT_AVAILABLE, &done);
+		gl->GetQueryObjectiv(m_Query, GL_QUERY_RESULT_AVAILABLE, &done);
 	}
 
 	const int param = flushGPU ? GL_QUERY_RESULT : GL_QUERY_RESULT_NO_WAIT;
 	GLuint result{ 0 };
-	glGetQueryObjectuiv(m_Query, param, &result);
+	gl->GetQueryObjectuiv(m_Query, param, &result);
 	return result;
 }
\ No newline at end of file
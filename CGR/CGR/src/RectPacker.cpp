@@ -0,0 +1,53 @@
+#include "RectPacker.h"
+
+RectPacker::RectPacker() :
+	m_Shelves(),
+	m_Width(0),
+	m_Height(0),
+	m_Padding(0),
+	m_Top(0)
+{
+}
+
+void RectPacker::Init(int width, int height, int padding)
+{
+	m_Shelves.clear();
+	m_Width = width;
+	m_Height = height;
+	m_Padding = padding;
+	m_Top = padding;
+}
+
+bool RectPacker::Pack(int width, int height, int* x, int* y)
+{
+	const int w = width + m_Padding;
+	const int h = height + m_Padding;
+
+	// Best fit, the shelf with room left that wastes the least height
+	Shelf* best = nullptr;
+	for (size_t i = 0; i < m_Shelves.size(); ++i)
+	{
+		Shelf& shelf = m_Shelves[i];
+		if (shelf.height < h || shelf.used + w > m_Width)
+			continue;
+
+		if (!best || shelf.height < best->height)
+			best = &shelf;
+	}
+
+	if (!best)
+	{
+		if (m_Top + h > m_Height || m_Padding + w > m_Width)
+			return false;
+
+		Shelf shelf = { m_Top, h, m_Padding };
+		m_Shelves.push_back(shelf);
+		m_Top += h;
+		best = &m_Shelves.back();
+	}
+
+	*x = best->used;
+	*y = best->y;
+	best->used += w;
+	return true;
+}
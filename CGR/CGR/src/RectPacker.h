@@ -0,0 +1,50 @@
+#ifndef __RECT_PACKER_H__
+#define __RECT_PACKER_H__
+
+#include <vector>
+
+#include "types.h"
+
+/*
+	Shelf packer for texture atlases. Rectangles are placed left to right along the current shelf and a new
+	shelf is opened above it once a rectangle doesn't fit, packing tallest first keeps the wasted space low.
+*/
+class RectPacker
+{
+	struct Shelf
+	{
+		int y;
+		int height;
+		int used;
+	};
+
+public:
+	RectPacker();
+
+	// Padding is left between neighbours so filtering at the edges doesn't pick up the next rectangle
+	void				Init(int width, int height, int padding);
+	// False once the atlas is full, x and y are the rectangle's corner otherwise
+	bool				Pack(int width, int height, int* x, int* y);
+
+	int					Width() const;
+	int					Height() const;
+
+private:
+	std::vector<Shelf>	m_Shelves;
+	int					m_Width;
+	int					m_Height;
+	int					m_Padding;
+	int					m_Top;
+};
+
+INLINE int RectPacker::Width() const
+{
+	return m_Width;
+}
+
+INLINE int RectPacker::Height() const
+{
+	return m_Height;
+}
+
+#endif
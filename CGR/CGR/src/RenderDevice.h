@@ -0,0 +1,153 @@
+#ifndef __RENDER_DEVICE_H__
+#define __RENDER_DEVICE_H__
+
+#include "gl_headers.h"
+
+enum RenderBackend
+{
+	GLBackend,
+	NullBackend
+};
+
+/*
+	Every call the engine makes to the graphics API goes through this interface, the
+	functions mirror their GL counterparts (minus the 'gl' prefix) so porting call sites is mechanical.
+	The GL backend forwards straight to the driver, the Null backend records what would have been
+	submitted so we can run and measure the renderer without a context.
+*/
+class RenderDevice
+{
+public:
+	virtual ~RenderDevice() {}
+
+	virtual RenderBackend	Backend() const = 0;
+
+	// ---- Global State ----
+	virtual void			Enable(GLenum cap) = 0;
+	virtual void			Disable(GLenum cap) = 0;
+	virtual void			Clear(GLbitfield mask) = 0;
+	virtual void			ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) = 0;
+	virtual void			CullFace(GLenum mode) = 0;
+	virtual void			DepthFunc(GLenum func) = 0;
+	virtual void			DepthMask(GLboolean flag) = 0;
+	virtual void			BlendFunc(GLenum sfactor, GLenum dfactor) = 0;
+	virtual void			BlendEquation(GLenum mode) = 0;
+	virtual void			StencilFunc(GLenum func, GLint ref, GLuint mask) = 0;
+	virtual void			StencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass) = 0;
+	virtual void			PolygonMode(GLenum face, GLenum mode) = 0;
+	virtual void			Viewport(GLint x, GLint y, GLsizei w, GLsizei h) = 0;
+	virtual void			PixelStorei(GLenum pname, GLint param) = 0;
+	virtual void			Flush() = 0;
+	virtual void			GetIntegerv(GLenum pname, GLint* data) = 0;
+	virtual const GLubyte*	GetString(GLenum name) = 0;
+	virtual GLenum			GetError() = 0;
+
+	// ---- Buffers and Vertex Arrays ----
+	virtual void			GenBuffers(GLsizei n, GLuint* buffers) = 0;
+	virtual void			DeleteBuffers(GLsizei n, const GLuint* buffers) = 0;
+	virtual GLboolean		IsBuffer(GLuint buffer) = 0;
+	virtual void			BindBuffer(GLenum target, GLuint buffer) = 0;
+	virtual void			BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) = 0;
+	virtual void			BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) = 0;
+	virtual void			BindBufferBase(GLenum target, GLuint index, GLuint buffer) = 0;
+	virtual void			BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) = 0;
+	virtual void			BufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags) = 0;
+	virtual void*			MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) = 0;
+	virtual GLboolean		UnmapBuffer(GLenum target) = 0;
+	virtual void			GenVertexArrays(GLsizei n, GLuint* arrays) = 0;
+	virtual void			DeleteVertexArrays(GLsizei n, const GLuint* arrays) = 0;
+	virtual GLboolean		IsVertexArray(GLuint array) = 0;
+	virtual void			BindVertexArray(GLuint array) = 0;
+	virtual void			EnableVertexAttribArray(GLuint index) = 0;
+	virtual void			DisableVertexAttribArray(GLuint index) = 0;
+	virtual void			VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) = 0;
+	virtual void			VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) = 0;
+	virtual void			VertexAttribDivisor(GLuint index, GLuint divisor) = 0;
+
+	// ---- Textures ----
+	virtual void			GenTextures(GLsizei n, GLuint* textures) = 0;
+	virtual void			DeleteTextures(GLsizei n, const GLuint* textures) = 0;
+	virtual GLboolean		IsTexture(GLuint texture) = 0;
+	virtual void			ActiveTexture(GLenum unit) = 0;
+	virtual void			BindTexture(GLenum target, GLuint texture) = 0;
+	virtual void			TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels) = 0;
+	virtual void			TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels) = 0;
+	virtual void			TexParameteri(GLenum target, GLenum pname, GLint param) = 0;
+	virtual void			TexParameterf(GLenum target, GLenum pname, GLfloat param) = 0;
+	virtual void			GenerateMipmap(GLenum target) = 0;
+
+	// ---- Frame Buffers ----
+	virtual void			GenFramebuffers(GLsizei n, GLuint* fbos) = 0;
+	virtual void			DeleteFramebuffers(GLsizei n, const GLuint* fbos) = 0;
+	virtual GLboolean		IsFramebuffer(GLuint fbo) = 0;
+	virtual void			BindFramebuffer(GLenum target, GLuint fbo) = 0;
+	virtual void			FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level) = 0;
+	virtual GLenum			CheckFramebufferStatus(GLenum target) = 0;
+	virtual void			DrawBuffer(GLenum buf) = 0;
+	virtual void			DrawBuffers(GLsizei n, const GLenum* bufs) = 0;
+	virtual void			ReadBuffer(GLenum src) = 0;
+	virtual void			BlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) = 0;
+
+	// ---- Shaders and Programs ----
+	virtual GLuint			CreateShader(GLenum type) = 0;
+	virtual void			DeleteShader(GLuint shader) = 0;
+	virtual GLboolean		IsShader(GLuint shader) = 0;
+	virtual void			ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths) = 0;
+	virtual void			CompileShader(GLuint shader) = 0;
+	virtual void			GetShaderiv(GLuint shader, GLenum pname, GLint* params) = 0;
+	virtual void			GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* log) = 0;
+	virtual GLuint			CreateProgram() = 0;
+	virtual void			DeleteProgram(GLuint program) = 0;
+	virtual GLboolean		IsProgram(GLuint program) = 0;
+	virtual void			AttachShader(GLuint program, GLuint shader) = 0;
+	virtual void			BindAttribLocation(GLuint program, GLuint index, const GLchar* name) = 0;
+	virtual void			BindFragDataLocation(GLuint program, GLuint color, const GLchar* name) = 0;
+	virtual void			LinkProgram(GLuint program) = 0;
+	virtual void			GetProgramiv(GLuint program, GLenum pname, GLint* params) = 0;
+	virtual void			GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* log) = 0;
+	virtual void			UseProgram(GLuint program) = 0;
+	virtual GLint			GetUniformLocation(GLuint program, const GLchar* name) = 0;
+	virtual void			GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) = 0;
+	virtual void			GetActiveUniformBlockName(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name) = 0;
+	virtual GLuint			GetUniformBlockIndex(GLuint program, const GLchar* name) = 0;
+	virtual void			GetActiveUniformBlockiv(GLuint program, GLuint index, GLenum pname, GLint* params) = 0;
+	virtual void			GetUniformIndices(GLuint program, GLsizei count, const GLchar* const* names, GLuint* indices) = 0;
+	virtual void			GetActiveUniformsiv(GLuint program, GLsizei count, const GLuint* indices, GLenum pname, GLint* params) = 0;
+
+	// ---- Uniforms ----
+	virtual void			Uniform1i(GLint location, GLint v) = 0;
+	virtual void			Uniform1f(GLint location, GLfloat v) = 0;
+	virtual void			Uniform2fv(GLint location, GLsizei count, const GLfloat* v) = 0;
+	virtual void			Uniform3fv(GLint location, GLsizei count, const GLfloat* v) = 0;
+	virtual void			Uniform4fv(GLint location, GLsizei count, const GLfloat* v) = 0;
+	virtual void			UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* v) = 0;
+
+	// ---- Draws ----
+	virtual void			DrawArrays(GLenum mode, GLint first, GLsizei count) = 0;
+	virtual void			MultiDrawArrays(GLenum mode, const GLint* first, const GLsizei* count, GLsizei drawcount) = 0;
+	virtual void			DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex) = 0;
+	virtual void			DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex) = 0;
+	virtual void			DrawElementsInstancedBaseVertexBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex, GLuint baseinstance) = 0;
+	virtual void			DrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instancecount, GLuint baseinstance) = 0;
+
+	// ---- Queries ----
+	virtual void			CreateQueries(GLenum target, GLsizei n, GLuint* ids) = 0;
+	virtual void			DeleteQueries(GLsizei n, const GLuint* ids) = 0;
+	virtual void			BeginQuery(GLenum target, GLuint id) = 0;
+	virtual void			EndQuery(GLenum target) = 0;
+	virtual void			GetQueryObjectiv(GLuint id, GLenum pname, GLint* params) = 0;
+	virtual void			GetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params) = 0;
+	virtual void			GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) = 0;
+	virtual void			QueryCounter(GLuint id, GLenum target) = 0;
+
+	// ---- Sync ----
+	virtual GLsync			FenceSync(GLenum condition, GLbitfield flags) = 0;
+	virtual GLenum			ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) = 0;
+	virtual void			DeleteSync(GLsync sync) = 0;
+
+	// ---- Debug markers, used to group commands into passes ----
+	virtual void			PushMarker(const char* name) = 0;
+	virtual void			PopMarker() = 0;
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include "RenderQueue.h"
+
+#include <cstring>
+
+RenderQueue::RenderQueue() :
+	m_Items(),
+	m_Sorted(),
+	m_Scratch()
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+uint64 RenderQueue::MakeKey(RenderPass pass, size_t shader, size_t materialSet, int material, GLuint vao, float depth)
+{
+	// Positive floats compare the same as their bit patterns, keep the top 24 bits
+	if (depth < 0.0f)
+		depth = 0.0f;
+
+	uint32 depthBits = 0;
+	memcpy(&depthBits, &depth, sizeof(float));
+	depthBits >>= 8;
+
+	// Whole sets (-1) sort after the individual materials of that set
+	uint64 mat = material < 0 ? 0x7F : ((uint64)material & 0x7F);
+
+	return ((uint64)pass & 0x7)			<< 61 |
+		((uint64)shader & 0xFF)			<< 53 |
+		((uint64)materialSet & 0x3FF)	<< 43 |
+		mat								<< 36 |
+		((uint64)vao & 0xFFF)			<< 24 |
+		((uint64)depthBits & 0xFFFFFF);
+}
+
+void RenderQueue::Clear()
+{
+	m_Items.clear();
+	m_Sorted.clear();
+}
+
+void RenderQueue::Push(const RenderItem& item)
+{
+	SortEntry entry = { item.key, (uint32)m_Items.size() };
+	m_Items.push_back(item);
+	m_Sorted.push_back(entry);
+}
+
+void RenderQueue::Sort()
+{
+	// LSD radix sort, one byte per pass. Bytes that are the same for every key (typically the pass
+	// and high shader bits) are detected from the histogram and skipped
+	const size_t count = m_Sorted.size();
+	if (count < 2)
+		return;
+
+	m_Scratch.resize(count);
+
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		size_t histogram[256] = { 0 };
+		for (size_t i = 0; i < count; ++i)
+		{
+			++histogram[(m_Sorted[i].key >> shift) & 0xFF];
+		}
+
+		if (histogram[(m_Sorted[0].key >> shift) & 0xFF] == count)
+			continue;
+
+		size_t offset = 0;
+		for (int b = 0; b < 256; ++b)
+		{
+			size_t c = histogram[b];
+			histogram[b] = offset;
+			offset += c;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			m_Scratch[histogram[(m_Sorted[i].key >> shift) & 0xFF]++] = m_Sorted[i];
+		}
+
+		m_Sorted.swap(m_Scratch);
+	}
+}
@@ -0,0 +1,94 @@
+#ifndef __RENDER_QUEUE_H__
+#define __RENDER_QUEUE_H__
+
+#include <vector>
+#include <map>
+
+#include "gl_headers.h"
+#include "types.h"
+
+class Transform;
+class MeshRenderer;
+class Animator;
+class ShaderProgram;
+class Mesh;
+class AnimMesh;
+struct Material;
+
+enum RenderPass
+{
+	PASS_SHADOW,
+	PASS_FORWARD,
+	PASS_GEOMETRY,
+	PASS_NORMALS,
+	NUM_RENDER_PASSES
+};
+
+// Components gathered once per frame, so each pass doesn't repeat the component lookups
+struct Renderable
+{
+	Transform*		transform;
+	MeshRenderer*	meshRenderer;
+	Animator*		animator;
+};
+
+// A single visible sub mesh (or a whole key framed mesh), everything needed to draw it is resolved up front
+struct RenderItem
+{
+	uint64								key;
+	RenderPass							pass;
+	const Renderable*					object;
+	ShaderProgram*						shader;
+	Mesh*								mesh;
+	AnimMesh*							animMesh;
+	Material*							material;
+	const std::map<unsigned, Material*>* materialSet;	// Set when every material in the set gets bound (multi texture, anim)
+	GLuint								vao;
+	unsigned							subMesh;
+	GLsizei								instances;		// > 0 when drawn instanced, object is then the group's first member
+	uint32								firstInstance;
+};
+
+/*
+	Collects render items keyed on (pass, shader, material, vao, depth) and radix sorts them, so
+	walking the queue in order only has to change program, vao and material at key boundaries.
+	Key bits from high to low: pass 3 | shader 8 | material set 10 | material 7 | vao 12 | depth 24
+*/
+class RenderQueue
+{
+	struct SortEntry
+	{
+		uint64 key;
+		uint32 index;
+	};
+
+public:
+	RenderQueue();
+	~RenderQueue();
+
+	static uint64		MakeKey(RenderPass pass, size_t shader, size_t materialSet, int material, GLuint vao, float depth);
+
+	void				Clear();
+	void				Push(const RenderItem& item);
+	void				Sort();
+
+	size_t				Size() const;
+	const RenderItem&	operator[](size_t sortedIndex) const;
+
+private:
+	std::vector<RenderItem>		m_Items;
+	std::vector<SortEntry>		m_Sorted;
+	std::vector<SortEntry>		m_Scratch;
+};
+
+INLINE size_t RenderQueue::Size() const
+{
+	return m_Sorted.size();
+}
+
+INLINE const RenderItem& RenderQueue::operator[](size_t sortedIndex) const
+{
+	return m_Items[m_Sorted[sortedIndex].index];
+}
+
+#endif
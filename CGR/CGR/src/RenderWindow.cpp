@@ -1,5 +1,7 @@
 #include "RenderWindow.h"
 
+#include "OpenGlLayer.h"
+
 #include <string>
 #include <iostream>
 
@@ -134,9 +136,11 @@ void RenderWindow::window_size_callback(GLFWwindow* window, int width, int heigh
 
 void RenderWindow::framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	Screen::m_FrameBuffWidth = width;
 	Screen::m_FrameBuffHeight = height;
-	glViewport(0, 0, width, height);
+	gl->Viewport(0, 0, width, height);
 }
 
 void RenderWindow::window_pos_callback(GLFWwindow* window, int xpos, int ypos)
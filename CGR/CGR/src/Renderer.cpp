@@ -1,15 +1,19 @@
 #include "Renderer.h"
 
+#include <algorithm>
+#include <iomanip>
+
+#include "OpenGlLayer.h"
+#include "StateCacheDevice.h"
+
 // Other Graphics
 #include "Screen.h"
 #include "Mesh.h"
 #include "Material.h"
-#include "ShadowFrameBuffer.h"
 #include "BillboardList.h"
 #include "Terrain.h"
 #include "Font.h"
 #include "Texture.h"
-#include "GBuffer.h"
 #include "ShaderProgram.h"
 #include "ResourceManager.h"
 #include "UniformBlockManager.h"
@@ -32,21 +36,73 @@
 
 #include "Input.h"
 #include "ResId.h"
+#include "JobSystem.h"
+#include "OcclusionCuller.h"
+#include "LightClusterer.h"
+#include "LightVolumeBatcher.h"
+#include "ObjectDataBuffer.h"
+#include "TextBatcher.h"
+#include "FrameGraph.h"
+#include "GpuTimers.h"
+#include "Profiler.h"
+
+// Below this many renderables per job the hand off costs more than the culling
+#define MIN_RENDERABLES_PER_JOB	64
 
 // ---- Globals ----
 const Mat4 IDENTITY(1.0f);
 
+const GLenum GBUFFER_DRAW_BUFFERS[] =
+{
+	GL_COLOR_ATTACHMENT0,
+	GL_COLOR_ATTACHMENT1,
+	GL_COLOR_ATTACHMENT2
+};
+
+// Milliseconds since start, which moves up to now so the next stage is timed from here
+static double stageMs(uint64& start)
+{
+	const uint64 now = Profiler::Now();
+	const double ms = (now - start) / 1000000.0;
+	start = now;
+	return ms;
+}
+
 Renderer::Renderer() :
 	m_ResManager(nullptr),
 	m_CameraPtr(nullptr),
-	m_Query(),
+	m_GpuTimers(nullptr),
 	m_QueryTime(0),
-	m_Gbuffer(nullptr),
+	m_FrameGraph(nullptr),
+	m_ShadowMap(0),
 	m_Frustum(nullptr),
-	m_ShadowFB(nullptr),
+	m_LightFrustum(nullptr),
+	m_Occlusion(nullptr),
+	m_RenderQueue(nullptr),
+	m_InstanceBatcher(nullptr),
+	m_ObjectData(nullptr),
+	m_Text(nullptr),
+	m_Jobs(nullptr),
+	m_QueueJobs(),
+	m_SceneTree(nullptr),
+	m_SceneProxies(),
+	m_AllRenderables(),
+	m_CameraVisible(),
+	m_LightVisible(),
+	m_TreeNodesVisited(0),
+	m_ShadowDir(0.0f),
+	m_TreeFrame(0),
+	m_PointLights(),
+	m_SpotLights(),
+	m_LightClusters(nullptr),
+	m_LightVolumes(nullptr),
+	m_Renderables(),
 	m_LightCamObj(nullptr),
 	m_LightCamera(nullptr),
 	m_UniformBlockManager(nullptr),
+	m_SceneData(),
+	m_BillboardStats(),
+	m_StageTimes(),
 	m_NumDirLightsInScene(-1),
 	m_NumPointLightsInScene(-1),
 	m_NumSpotLightsInScene(-1)
@@ -55,15 +111,17 @@ Renderer::Renderer() :
 
 bool Renderer::Init()
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 #ifdef _DEBUG
 	m_ShouldQueryFrames = true;
 #endif // _DEBUG
 
 	// Log Info
 	{
-		const GLubyte* rendererS = glGetString(GL_RENDERER);
-		const GLubyte* vendorS = glGetString(GL_VENDOR);
-		const GLubyte* versionS = glGetString(GL_VERSION);
+		const GLubyte* rendererS = gl->GetString(GL_RENDERER);
+		const GLubyte* vendorS = gl->GetString(GL_VENDOR);
+		const GLubyte* versionS = gl->GetString(GL_VERSION);
 		std::stringstream ss;
 		ss << "Renderer started..... system using: " << rendererS << ",  " << vendorS << ", GL Version: " << versionS;
 		WRITE_LOG(ss.str(), "info");
@@ -81,24 +139,37 @@ bool Renderer::Init()
 		ev->AttachEvent(EVENT_WINDOW_SIZE_CHANGE, *this);
 	}
 
-	// This is minimal point light info needed for deferred lighting
-	m_PointsInfo.resize(MAX_POINTS);
-
 	if(!m_ResManager)
 		m_ResManager = new ResourceManager();
 	
-	m_Query.Init(GL_TIME_ELAPSED);
+	// Passes are timed with timestamp pairs, read back a few frames later so the CPU never waits on them
+	if (!m_GpuTimers)
+		m_GpuTimers = new GpuTimers();
+
+	if (!m_GpuTimers->Init())
+		WRITE_LOG("GPU timers failed to init, pass timings are off", "warning");
 	
 	bool success = true;
 
 	// Create Default Engine uniform blocks, needs to be first
 	success &= createUniformBlocks();
 
+	// Culling and queue building is split across the cores, each chunk gets its own output. Resources use it while loading
+	if (!m_Jobs)
+		m_Jobs = new JobSystem();
+
+	success &= m_Jobs->Init();
+	m_QueueJobs.resize(m_Jobs->NumThreads());
+	m_ResManager->m_Jobs = m_Jobs;
+
 	// Create all default engine resources - This needs to be moved as it's a user defined thing 
 	success &= m_ResManager->createDefaultResources();
 
-	// G Buffer for deferred 
-	success &= setFrameBuffers();
+	// The blocks are allocated by the first shader using them, now their mirrors can be checked
+	success &= checkBlockLayouts();
+
+	// The frame graph owns every pass's targets, the g-buffer and shadow map included
+	success &= createFrameGraph();
 
 	// Set static shader values on default engine shaders
 	success &= setStaticDefaultShaderValues();
@@ -106,6 +177,50 @@ bool Renderer::Init()
 	if(!m_Frustum)
 		m_Frustum = new Frustum();
 
+	if (!m_LightFrustum)
+		m_LightFrustum = new Frustum();
+
+	// Scene level culling, each pass queries this for its candidates instead of walking every renderable
+	if (!m_SceneTree)
+		m_SceneTree = new DynamicAABBTree();
+
+	if (!m_Occlusion)
+		m_Occlusion = new OcclusionCuller();
+
+	success &= m_Occlusion->Init();
+
+	// Point and spot lights are binned into view space clusters each frame, the shaders only loop over their cluster's lights
+	if (!m_LightClusters)
+		m_LightClusters = new LightClusterer();
+
+	success &= m_LightClusters->Init();
+
+	// Deferred point lights are drawn as one instanced batch of volumes
+	if (!m_LightVolumes)
+		m_LightVolumes = new LightVolumeBatcher();
+
+	success &= m_LightVolumes->Init();
+
+	if (!m_RenderQueue)
+		m_RenderQueue = new RenderQueue();
+
+	if (!m_InstanceBatcher)
+		m_InstanceBatcher = new InstanceBatcher();
+
+	success &= m_InstanceBatcher->Init();
+
+	// Forward lit objects read their matrices and flags from one buffer written before the pass
+	if (!m_ObjectData)
+		m_ObjectData = new ObjectDataBuffer();
+
+	success &= m_ObjectData->Init();
+
+	// Every string of the frame is drawn from one vertex buffer when the text is flushed
+	if (!m_Text)
+		m_Text = new TextBatcher();
+
+	success &= m_Text->Init();
+
 	return success;
 }
 
@@ -119,11 +234,20 @@ void Renderer::Close()
 		ev->RemoveEvent(EVENT_WINDOW_SIZE_CHANGE, *this);
 	}
 
-	m_Query.Clean();
+	SAFE_CLOSE(m_GpuTimers);
 
-	SAFE_DELETE(m_Gbuffer);
-	SAFE_DELETE(m_ShadowFB);
+	SAFE_CLOSE(m_FrameGraph);
 	SAFE_DELETE(m_Frustum);
+	SAFE_DELETE(m_LightFrustum);
+	SAFE_DELETE(m_SceneTree);
+	SAFE_CLOSE(m_Occlusion);
+	SAFE_CLOSE(m_LightClusters);
+	SAFE_CLOSE(m_LightVolumes);
+	SAFE_DELETE(m_RenderQueue);
+	SAFE_CLOSE(m_InstanceBatcher);
+	SAFE_CLOSE(m_ObjectData);
+	SAFE_CLOSE(m_Text);
+	SAFE_CLOSE(m_Jobs);
 	SAFE_CLOSE(m_UniformBlockManager);
 	SAFE_CLOSE(m_ResManager);
 	SAFE_CLOSE(m_LightCamObj);
@@ -134,8 +258,7 @@ bool Renderer::SetSceneData(BaseCamera* camera, const Vec3& ambient_light)
 	// This needs to be called by each scene on load
 	m_CameraPtr = camera;
 
-	UniformBlock* scene = m_UniformBlockManager->GetBlock("scene");
-	scene->SetValue("ambient_light", (void*)glm::value_ptr(ambient_light));
+	m_SceneData.ambient_light = ambient_light;
 	return true;
 }
 
@@ -146,72 +269,74 @@ const std::string& Renderer::GetHardwareStr() const
 
 void Renderer::Render(std::vector<GameObject*>& gameObjects, bool withShadows)
 {
+	PROFILE_ZONE("Renderer::Render");
+
+	RenderDevice* gl = OpenGLLayer::device();
+	uint64 stageStart = Profiler::Now();
+
 	// Flush this every frame
 	m_CullCount = 0;
+	m_TreeNodesVisited = 0;
+	OpenGLLayer::state_cache()->BeginFrame();
 
-	// Queery the frame if the mode is set
-	if(m_ShouldQueryFrames)
-		m_Query.Start();
+	// Time the frame and its passes if the mode is set, the timers read back an older frame here
+	m_GpuTimers->BeginFrame(m_ShouldQueryFrames);
+	m_GpuTimers->Begin("Frame");
 
 	// The renderer updates the scene block
 	UniformBlock* scene = m_UniformBlockManager->GetBlock("scene");
 	if (scene && m_CameraPtr)
 	{
-		float dt = Time::DeltaTime();
-		scene->SetValue("view_xform", (void*)glm::value_ptr(m_CameraPtr->View()));
-		scene->SetValue("proj_xform", (void*)glm::value_ptr(m_CameraPtr->Projection()));
-		scene->SetValue("delta_time", &dt);
+		m_SceneData.proj_xform = m_CameraPtr->Projection();
+		m_SceneData.view_xform = m_CameraPtr->View();
+		m_SceneData.camera_position = m_CameraPtr->Position();
+		m_SceneData.delta_time = Time::DeltaTime();
+		scene->Write(m_SceneData);
 	}
 
-	// Copy all block data to the GPU (only if they have changed, which is checked internally) This will work for each shader that references the block
-	for (auto i = m_UniformBlockManager->m_Blocks.begin(); i != m_UniformBlockManager->m_Blocks.end(); ++i)
-	{
-		if (i->second->ShouldUpdateGPU())
-			i->second->Bind();
-	}
+	// Copy the changed block data to the GPU, this will work for each shader that references the block
+	gl->PushMarker("UniformBlocks");
+	m_UniformBlockManager->Upload();
+	gl->PopMarker();
+	m_StageTimes.prepare = stageMs(stageStart);
 
-	// Update the frustum once per frame if frustum culling is allowed
-	if (m_ShouldFrustumCull && m_CameraPtr)
-	{
-		m_Frustum->UpdateFrustum(m_CameraPtr->Projection(), m_CameraPtr->View());
-	}
+	// Gather the renderable components once, each pass builds its queue from these
+	gatherRenderables(gameObjects);
+	m_StageTimes.gather = stageMs(stageStart);
 
-	// Check which rendering mode we want
-	if (m_ShadingMode == ShadingMode::Deferred)
-	{
-		deferredRender(gameObjects);
-	}
-	else
-	{
-		// Do the shadows pass if flagged, rendering objects that do NOT receive shadows into the depth buffer
-		if (withShadows)
-		{
-			forwardRenderShadows(gameObjects);
-		}
+	// Update the frustums once per frame if frustum culling is allowed, the camera and light share one walk of the tree
+	queryScene(withShadows && m_ShadingMode == ShadingMode::Forward);
+	buildOcclusion();
+	m_StageTimes.cull = stageMs(stageStart);
 
-		// Forward render all of the game objects with the scene light data
-		forwardRender(gameObjects, withShadows);
-	}
+	gl->PushMarker("LightClusters");
+	buildLightClusters();
+	gl->PopMarker();
+	m_StageTimes.lights = stageMs(stageStart);
+
+	// The passes for the shading mode go in the frame graph, it drops anything unused and lends out the targets
+	buildFrameGraph(withShadows);
+	m_FrameGraph->Execute(m_GpuTimers);
+	m_StageTimes.passes = stageMs(stageStart);
 
 	// Set this Back after rendering meshes if the mode is set, only want wire frames for meshes
 	if (m_PolyMode == PolygonMode::WireFrame)
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		gl->PolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-	// Get Queery result
-	if (m_ShouldQueryFrames)
-	{
-		m_Query.End();
-		m_QueryTime = m_Query.Result(false);
-	}
+	// The frame time is from a few frames back, whatever the GPU has finished
+	m_GpuTimers->End();
+	const GpuTiming* frameTiming = m_GpuTimers->Find("Frame");
+	if (m_ShouldQueryFrames && frameTiming)
+		m_QueryTime = (GLuint)(frameTiming->latest * 1000000.0f);
 
 	// For switching rendering modes on the fly
 	if (m_ShadingModePending)
 	{
-		glFlush();
+		gl->Flush();
 
 		if (m_ShadingMode == ShadingMode::Deferred)
 		{
-			glDepthMask(GL_TRUE);
+			gl->DepthMask(GL_TRUE);
 		}
 
 		m_ShadingMode = m_PendingShadingMode;
@@ -221,83 +346,93 @@ void Renderer::Render(std::vector<GameObject*>& gameObjects, bool withShadows)
 	// Render info if asked
 	if (m_ShouldDisplayInfo)
 	{
-		this->RenderText(FONT_COURIER, "Frm Time Seconds: " + util::to_str(getFrameTime(TimeMeasure::Seconds)), 8, Screen::FrameBufferHeight() - 32.0f, FontAlign::Left, Colour::Red());
+		this->RenderText(FONT_COURIER, "Frm Time Seconds: " + util::to_str(getFrameTime(TimeMeasure::Seconds)) +
+			" :  Text draws: " + util::to_str(m_Text->Draws()) + " :  Glyphs: " + util::to_str(m_Text->Glyphs()), 8, Screen::FrameBufferHeight() - 32.0f, FontAlign::Left, Colour::Red());
 		this->RenderText(FONT_COURIER, "Frustum cull set to: " + util::bool_to_str(m_ShouldFrustumCull) + " :  Cull count: " + util::to_str(m_CullCount), 8, Screen::FrameBufferHeight() - 64.0f);
-	}
-}
-
-void Renderer::RenderText(size_t fontId, const std::string& txt, float x, float y, FontAlign fa, const Colour& colour)
-{
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	// Activate corresponding render state	
-	m_ResManager->m_Shaders[SHADER_FONT_FWD]->Use();
 
-	Mat4 projection = glm::ortho(0.0f, (float)Screen::FrameBufferWidth(),
-		0.0f,
-		(float)Screen::FrameBufferHeight());
+		const StateCacheStats& state = OpenGLLayer::state_cache()->FrameStats();
+		this->RenderText(FONT_COURIER, "State calls issued: " + util::to_str(state.issued) + " :  Filtered: " + util::to_str(state.filtered) +
+			" :  Block bytes: " + util::to_str(m_UniformBlockManager->FrameBytesUploaded()), 8, Screen::FrameBufferHeight() - 96.0f);
 
-	m_ResManager->m_Shaders[SHADER_FONT_FWD]->SetUniformValue<Mat4>("u_proj_xform", &projection);
-	m_ResManager->m_Shaders[SHADER_FONT_FWD]->SetUniformValue<Vec4>("text_colour", &colour.Normalize());
+		this->RenderText(FONT_COURIER, "Tree nodes visited: " + util::to_str(m_TreeNodesVisited) +
+			" :  Visible: " + util::to_str(passRenderables(PASS_FORWARD).size()) + "/" + util::to_str(m_Renderables.size()) +
+			" :  Casters: " + util::to_str(m_ShadowCull ? m_LightVisible.size() : 0) +
+			" :  Objects: " + util::to_str(m_ShadingMode == ShadingMode::Forward ? m_ObjectData->Count() : 0), 8, Screen::FrameBufferHeight() - 128.0f);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindVertexArray(m_ResManager->m_Fonts[fontId]->m_Vao);
+		const OcclusionStats& occlusion = m_Occlusion->Stats();
+		this->RenderText(FONT_COURIER, "Occlusion cull set to: " + util::bool_to_str(m_OcclusionActive) + " :  Occluders: " + util::to_str(occlusion.occluders) +
+			" :  Tris: " + util::to_str(occlusion.rasterized) + "/" + util::to_str(occlusion.triangles), 8, Screen::FrameBufferHeight() - 160.0f);
 
-	// Iterate through all characters
-	std::string::const_iterator i;
-	for (i = txt.begin(); i != txt.end(); ++i)
-	{
-		Character ch = m_ResManager->m_Fonts[fontId]->m_Characters[(*i)];
+		const ClusterStats& clusters = m_LightClusters->Stats();
+		this->RenderText(FONT_COURIER, "Clustered points: " + util::to_str(clusters.points) + "/" + util::to_str(m_PointLights.size()) +
+			" :  Spots: " + util::to_str(clusters.spots) + "/" + util::to_str(m_SpotLights.size()) +
+			" :  Refs: " + util::to_str(clusters.references) + " :  Max: " + util::to_str(clusters.maxPerCluster) +
+			" :  Volumes: " + util::to_str(m_ShadingMode == ShadingMode::Deferred ? m_LightVolumes->Count() : 0), 8, Screen::FrameBufferHeight() - 192.0f);
 
-		float xpos = x + ch.bearingX;
-		float ypos = y - (ch.sizeY - ch.bearingY);
+		// Billboards are drawn after Render, these are last frame's
+		this->RenderText(FONT_COURIER, "Billboards drawn: " + util::to_str(m_BillboardStats.drawn) + "/" + util::to_str(m_BillboardStats.billboards) +
+			" :  Cells: " + util::to_str(m_BillboardStats.visibleCells) + "/" + util::to_str(m_BillboardStats.cells), 8, Screen::FrameBufferHeight() - 224.0f);
 
-		float w = (float)ch.sizeX;
-		float h = (float)ch.sizeY;
+		const FrameGraphStats& graph = m_FrameGraph->Stats();
+		this->RenderText(FONT_COURIER, "Frame graph passes: " + util::to_str(graph.passes - graph.culled) + "/" + util::to_str(graph.passes) +
+			" :  Targets: " + util::to_str(graph.textures) + "/" + util::to_str(graph.transients) +
+			" :  KB: " + util::to_str(graph.allocatedBytes / 1024) + "/" + util::to_str(graph.requestedBytes / 1024), 8, Screen::FrameBufferHeight() - 256.0f);
 
-		if (fa == FontAlign::Centre)
-		{
-			xpos -= ((ch.advance >> 6)) * (txt.size() / 2);
-		}
-		else if (fa == FontAlign::Right)
+		// Each timing is a few frames old, ranges not timed lately (the other shading mode's passes) are left out
+		if (m_ShouldQueryFrames)
 		{
-			xpos -= ((ch.advance >> 6)) * (txt.size());
+			std::stringstream timings;
+			timings << std::fixed << std::setprecision(2) << "GPU ms";
+			for (size_t i = 0; i < m_GpuTimers->Count(); ++i)
+			{
+				if (m_GpuTimers->IsCurrent(i))
+					timings << " :  " << m_GpuTimers->Timing(i).name << ": " << m_GpuTimers->Timing(i).latest << " (" << m_GpuTimers->Average(i) << ")";
+			}
+
+			this->RenderText(FONT_COURIER, timings.str(), 8, Screen::FrameBufferHeight() - 288.0f);
 		}
+	}
+
+	m_BillboardStats = BillboardStats();
+
+	// Everything reading this frame's ring copies has been issued
+	m_UniformBlockManager->EndFrame();
+}
+
+void Renderer::RenderText(size_t fontId, const std::string& txt, float x, float y, FontAlign fa, const Colour& colour)
+{
+	m_Text->Add(m_ResManager->GetFont(fontId), txt, x, y, fa, colour);
+}
 
-		// Update VBO for each character
-		float vertices[6][4] = {
-			{ xpos,     ypos + h,   0.0, 0.0 },
-			{ xpos,     ypos,       0.0, 1.0 },
-			{ xpos + w, ypos,       1.0, 1.0 },
+void Renderer::FlushText()
+{
+	PROFILE_ZONE("Renderer::FlushText");
 
-			{ xpos,     ypos + h,   0.0, 0.0 },
-			{ xpos + w, ypos,       1.0, 1.0 },
-			{ xpos + w, ypos + h,   1.0, 0.0 }
-		};
+	RenderDevice* gl = OpenGLLayer::device();
 
-		// Render glyph texture over quad
-		glBindTexture(GL_TEXTURE_2D, ch.textureID);
+	gl->PushMarker("Text");
+	m_GpuTimers->Begin("Text");
 
-		// Update content of VBO memory
-		glBindBuffer(GL_ARRAY_BUFFER, m_ResManager->m_Fonts[fontId]->m_Vbo);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	// Activate corresponding render state
+	m_ResManager->m_Shaders[SHADER_FONT_FWD]->Use();
 
-		// Render quad
-		glDrawArrays(GL_TRIANGLES, 0, 6);
-		// Now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-		x += (ch.advance >> 6); // Bitshift by 6 to get value in pixels (2^6 = 64)
-	}
+	Mat4 projection = glm::ortho(0.0f, (float)Screen::FrameBufferWidth(),
+		0.0f,
+		(float)Screen::FrameBufferHeight());
 
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	m_ResManager->m_Shaders[SHADER_FONT_FWD]->SetUniformValue<Mat4>(UNIFORM_ID("u_proj_xform"), &projection);
 
-	glDisable(GL_BLEND);
+	m_Text->Flush();
+	m_GpuTimers->End();
+	gl->PopMarker();
 }
 
 void Renderer::RenderBillboardList(BillboardList* billboard)
 {
+	PROFILE_ZONE("Renderer::RenderBillboardList");
+
+	RenderDevice* gl = OpenGLLayer::device();
+
 	if (billboard && m_CameraPtr)
 	{
 		ShaderProgram* shader = m_ResManager->GetShader(billboard->m_ShaderIndex);
@@ -306,33 +441,45 @@ void Renderer::RenderBillboardList(BillboardList* billboard)
 			float t = Time::ElapsedTime();
 
 			shader->Use();
-			shader->SetUniformValue<Mat4>("u_view_xform", &m_CameraPtr->View());
-			shader->SetUniformValue<Mat4>("u_proj_xform", &m_CameraPtr->Projection());
-			shader->SetUniformValue<Mat4>("u_model_xform", &Mat4(1.0f));
-			shader->SetUniformValue<float>("u_time", &(t));
-			shader->SetUniformValue<float>("u_scale", &billboard->m_BillboardScale);
+			shader->SetUniformValue<Mat4>(UNIFORM_ID("u_view_xform"), &m_CameraPtr->View());
+			shader->SetUniformValue<Mat4>(UNIFORM_ID("u_proj_xform"), &m_CameraPtr->Projection());
+			shader->SetUniformValue<Mat4>(UNIFORM_ID("u_model_xform"), &Mat4(1.0f));
+			shader->SetUniformValue<float>(UNIFORM_ID("u_time"), &(t));
+			shader->SetUniformValue<float>(UNIFORM_ID("u_scale"), &billboard->m_BillboardScale);
 		}
 		
-		glEnable(GL_MULTISAMPLE);
-		glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+		gl->Enable(GL_MULTISAMPLE);
+		gl->Enable(GL_SAMPLE_ALPHA_TO_COVERAGE);
 
 		// Bind the texture we get from renderer. This needs sorting too
 		Texture* t = m_ResManager->GetTexture(billboard->m_TextureIndex);
 		if (t) t->Bind();
 
-		// I think we shoulf be asking renderer to do this 
-		glBindVertexArray(billboard->m_VAO);
-		glDrawArrays(GL_POINTS, 0, (GLsizei)billboard->m_NumInstances);
+		// Only the cells in view, thinned with distance, go out in the one call
+		const Frustum* frustum = m_ShouldFrustumCull ? m_Frustum : nullptr;
+		if (billboard->Cull(frustum, m_CameraPtr->Position()) > 0)
+		{
+			gl->BindVertexArray(billboard->m_VAO);
+			gl->MultiDrawArrays(GL_POINTS, billboard->m_DrawFirsts.data(), billboard->m_DrawCounts.data(), (GLsizei)billboard->m_DrawCounts.size());
+		}
+
+		const BillboardStats& stats = billboard->Stats();
+		m_BillboardStats.cells += stats.cells;
+		m_BillboardStats.visibleCells += stats.visibleCells;
+		m_BillboardStats.billboards += stats.billboards;
+		m_BillboardStats.drawn += stats.drawn;
 
-		glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
-		glDisable(GL_MULTISAMPLE);		
-		glBindVertexArray(0);
+		gl->Disable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+		gl->Disable(GL_MULTISAMPLE);		
+		gl->BindVertexArray(0);
 	}
 }
 
 bool Renderer::ReloadShaders()
 {
-	glFlush();
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->Flush();
 
 	for (auto sp = m_ResManager->m_Shaders.begin(); sp != m_ResManager->m_Shaders.end(); ++sp)
 	{
@@ -356,7 +503,13 @@ int Renderer::GetDirLightIndex()
 int Renderer::GetSpotLightIndex()
 {
 	int temp = m_NumSpotLightsInScene + 1;
-	return temp < MAX_SPOTS ? ++m_NumSpotLightsInScene : -1;
+	if (temp < MAX_SPOTS)
+	{
+		m_SpotLights.resize(temp + 1, SpotLightData());
+		return ++m_NumSpotLightsInScene;
+	}
+
+	return -1;
 }
 
 int Renderer::GetPointLightIndex()
@@ -364,19 +517,28 @@ int Renderer::GetPointLightIndex()
 	int temp = m_NumPointLightsInScene + 1;
 	if (temp < MAX_POINTS)
 	{
+		m_PointLights.resize(temp + 1, PointLightData());
 		return ++m_NumPointLightsInScene;
 	}
 
 	return -1;
-	//return temp < MAX_POINTS ? ++m_NumPointLightsInScene : -1;
 }
 
-void Renderer::UpdatePointLight(int index, const Vec3& position, float range)
+void Renderer::UpdatePointLight(int index, const PointLightData& light)
+{
+	if (index >= 0 && index < (int)m_PointLights.size())
+	{
+		m_PointLights[index] = light;
+		m_LightsChanged = true;
+	}
+}
+
+void Renderer::UpdateSpotLight(int index, const SpotLightData& light)
 {
-	if (index >= 0 && index < MAX_POINTS)
+	if (index >= 0 && index < (int)m_SpotLights.size())
 	{
-		m_PointsInfo[index].pos = position;
-		m_PointsInfo[index].range = range;
+		m_SpotLights[index] = light;
+		m_LightsChanged = true;
 	}
 }
 
@@ -492,6 +654,16 @@ void Renderer::SetFrustumCulling(bool should)
 	m_ShouldFrustumCull = should;
 }
 
+void Renderer::ToggleOcclusionCulling()
+{
+	m_ShouldOcclusionCull = !m_ShouldOcclusionCull;
+}
+
+void Renderer::SetOcclusionCulling(bool should)
+{
+	m_ShouldOcclusionCull = should;
+}
+
 void Renderer::ToggleDisplayInfo()
 {
 	m_ShouldDisplayInfo = !m_ShouldDisplayInfo;
@@ -503,62 +675,29 @@ void Renderer::SetDisplayInfo(bool should)
 }
 
 
-void Renderer::forwardRenderShadows(std::vector<GameObject*>& gameObjects)
+void Renderer::forwardRenderShadows()
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	// Need to check if a light has been created
 	if (!m_LightCamera)
 		return;
 
-	m_ShadowFB->BindForWriting();
-	glClear(GL_DEPTH_BUFFER_BIT);
-
-	ShaderProgram* sp = m_ResManager->GetShader(SHADER_SHADOW);
-	if (sp)
-	{
-		sp->Use();
-
-		for (auto i = gameObjects.begin(); i != gameObjects.end(); ++i)
-		{
-			Transform* t = (*i)->GetComponent<Transform>();
-			MeshRenderer* mr = (*i)->GetComponent<MeshRenderer>();
-
-			if (!t || !mr)
-				continue;
-
-			if (!mr->m_ReceiveShadows)
-			{
-				const Mat4& model_xform = t->GetModelXform();
-
-				if (sp)
-				{
-					sp->Use();
-					sp->SetUniformValue<Mat4>("u_wvp_xform", &(m_LightCamera->ProjXView() * model_xform));
-					
-					if (mr->m_HasAnimations)
-					{
-						Animator* anim = (*i)->GetComponent<Animator>();
-						if (anim)
-						{
-							this->renderAnimMesh(mr, anim, model_xform, false);
-						}
-					}
-					else
-					{
-						this->renderMesh(mr, model_xform, false, GL_TRIANGLES, true);
-					}
-				}
-			}
-		}
-	}
+	gl->Clear(GL_DEPTH_BUFFER_BIT);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	m_RenderQueue->Clear();
+	queueRenderables(PASS_SHADOW);
+	m_RenderQueue->Sort();
+	drawQueue(false);
 }
 
-void Renderer::forwardRender(std::vector<GameObject*>& gameObjects, bool withShadows)
+void Renderer::forwardRender(bool withShadows)
 {
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glEnable(GL_DEPTH_TEST);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	gl->Enable(GL_DEPTH_TEST);
+	gl->Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	if (!m_CameraPtr)
 		// Should log if that hasn't been set
@@ -567,225 +706,180 @@ void Renderer::forwardRender(std::vector<GameObject*>& gameObjects, bool withSha
 	// Render Skybox
 	if (m_CameraPtr->HasSkybox())
 	{
+		m_GpuTimers->Begin("Skybox");
 		this->renderSkybox(m_CameraPtr);
+		m_GpuTimers->End();
 	}
 
 	// Set to wire frame mode only for rendering meshes
 	if (m_PolyMode == PolygonMode::WireFrame)
 	{
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		gl->PolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 	}
 
-	// TODO : need to use the shader program that was set to each mesh or batch them 
-	ShaderProgram* np = nullptr;	
-	if(m_ShouldDisplayNormals)
-		np = m_ResManager->m_Shaders[SHADER_NORMAL_DISP_FWD];
-
-	// Render Mesh Renderers
-	for (auto i = gameObjects.begin(); i != gameObjects.end(); ++i)
-	{
-		Transform* t = (*i)->GetComponent<Transform>();
-		MeshRenderer* mr = (*i)->GetComponent<MeshRenderer>();
-
-		if (!t || !mr)
-			continue;
-
-		const Mat4& model_xform = t->GetModelXform();
-
-		ShaderProgram* sp = m_ResManager->m_Shaders[mr->m_ShaderIndex];
-		if (sp)
-		{
-			// Render Mesh normally
-			sp->Use();
-
-			if(withShadows && m_LightCamera)
-			//if (withShadows && mr->m_ReceiveShadows && m_LightCamera)	// and light cam exists
-			{
-				m_ShadowFB->BindForReading(GL_TEXTURE6);
-				sp->SetUniformValue<Mat4>("u_light_xform", &(m_LightCamera->ProjXView() * model_xform));
-			}
-
-			sp->SetUniformValue<Mat4>("u_world_xform", &(model_xform));
-			sp->SetUniformValue<int>("u_use_bumpmap", &(mr->m_HasBumpMaps));
-			sp->SetUniformValue<int>("u_use_shadow", &(mr->m_ReceiveShadows));
-
-			if (mr->m_HasAnimations)
-			{
-				Animator* anim = (*i)->GetComponent<Animator>();
-				if (anim)
-				{
-					sp->SetUniformValue<float>("u_lerp", &anim->m_AnimState.interpol);
-					this->renderAnimMesh(mr, anim, model_xform, true);
-				}
-			}
-			else
-			{
-				this->renderMesh(mr, model_xform, true, GL_TRIANGLES, false);
-			}
-
-			// Do a normal pass if required
-			if (m_ShouldDisplayNormals)
-			{
-				np->Use();
-				np->SetUniformValue<Mat4>("u_wvp", &(m_CameraPtr->ProjXView() * model_xform));
-				np->SetUniformValue<Mat4>("u_world_xform", &(model_xform));
-				this->renderMesh(mr, IDENTITY, false, GL_POINTS, true);
-			}
-		}
-	}
+	// Normals go in the same queue, their pass bits sort them after the lit meshes
+	m_RenderQueue->Clear();
+	queueRenderables(PASS_FORWARD);
+	if (m_ShouldDisplayNormals)
+		queueRenderables(PASS_NORMALS);
+	m_RenderQueue->Sort();
+	writeObjectData(withShadows);
+	drawQueue(withShadows);
 }
 
-void Renderer::deferredRender(std::vector<GameObject*>& gameObjects)
+void Renderer::buildFrameGraph(bool withShadows)
 {
-	Vec2 screenSize = Vec2((float)Screen::FrameBufferWidth(), (float)Screen::FrameBufferHeight());
-	m_Gbuffer->StartFrame();
-
-	// Geom Pass
-	{
-		// Skybox
-		if (m_CameraPtr->HasSkybox())
-			renderSkybox(m_CameraPtr);
+	PROFILE_ZONE("Renderer::buildFrameGraph");
 
-		// -- Deferred Geom pass ---
-		m_Gbuffer->BindForGeomPass();
+	FrameGraph& fg = *m_FrameGraph;
+	fg.Reset();
 
-		// Set GL States
-		glDepthMask(GL_TRUE);
-		glEnable(GL_DEPTH_TEST);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	const GLsizei width = Screen::FrameBufferWidth();
+	const GLsizei height = Screen::FrameBufferHeight();
+	const Vec2 screenSize((float)width, (float)height);
+	const FrameGraphHandle backBuffer = fg.Import("BackBuffer", 0, width, height);
 
-		ShaderProgram* sp = m_ResManager->m_Shaders[SHADER_GEOM_PASS_DEF];
+	if (m_ShadingMode == ShadingMode::Deferred)
+	{
+		const FrameGraphTextureDesc gbufferDesc = { width, height, GL_RGB32F, GL_RGB, GL_FLOAT, GL_NEAREST };
+		const FrameGraphTextureDesc depthDesc = { width, height, GL_DEPTH32F_STENCIL8, GL_DEPTH_STENCIL, GL_FLOAT_32_UNSIGNED_INT_24_8_REV, GL_NEAREST };
+		const FrameGraphTextureDesc finalDesc = { width, height, GL_RGBA, GL_RGB, GL_FLOAT, GL_NEAREST };
 
-		ShaderProgram* np = nullptr;
-		if (m_ShouldDisplayNormals)
-			np = m_ResManager->m_Shaders[SHADER_NORMAL_DISP_FWD];
+		const FrameGraphHandle position = fg.Create("GBufferPosition", gbufferDesc);
+		const FrameGraphHandle diffuse = fg.Create("GBufferDiffuse", gbufferDesc);
+		const FrameGraphHandle normal = fg.Create("GBufferNormal", gbufferDesc);
+		const FrameGraphHandle depth = fg.Create("GBufferDepth", depthDesc);
+		const FrameGraphHandle finalTarget = fg.Create("Final", finalDesc);
 
-		// Render Mesh Renderers
-		for (auto i = gameObjects.begin(); i != gameObjects.end(); ++i)
+		const uint32 geom = fg.AddPass("GeometryPass", [this, finalTarget](const FrameGraph& g)
 		{
-			Transform* t = (*i)->GetComponent<Transform>();
-			MeshRenderer* mr = (*i)->GetComponent<MeshRenderer>();
-
-			if (!t || !mr)
-				continue;
-
-			const Mat4& model_xform = t->GetModelXform();
-
-			if (sp)
-			{
-				// Render Mesh here
-				sp->Use();
-				sp->SetUniformValue<Mat4>("u_world_xform", &(model_xform));
-				this->renderMesh(mr, model_xform, true, GL_TRIANGLES, false);
-			}
-
-			// Do a normal pass if required
-			if (m_ShouldDisplayNormals && np)
-			{
-				np->Use();
-				np->SetUniformValue<Mat4>("u_wvp", &(m_CameraPtr->ProjXView() * model_xform));
-				np->SetUniformValue<Mat4>("u_world_xform", &(model_xform));
-				this->renderMesh(mr, model_xform, false, GL_POINTS, true);
-			}
-		}
-
-		glDepthMask(GL_FALSE);
+			deferredGeometryPass(g.ColourAttachment(finalTarget));
+		});
+		fg.Write(geom, position);
+		fg.Write(geom, diffuse);
+		fg.Write(geom, normal);
+		fg.Write(geom, finalTarget);
+		fg.Write(geom, depth);
+
+		// Back faces of the volumes are tested against the g-buffer depth, it's attached but not written
+		const uint32 points = fg.AddPass("PointLights", [this, screenSize](const FrameGraph&)
+		{
+			renderPointLightVolumes(screenSize);
+		});
+		fg.Read(points, position, GBUFFER_POSITION_SAMPLER);
+		fg.Read(points, diffuse, GBUFFER_DIFFUSE_SAMPLER);
+		fg.Read(points, normal, GBUFFER_NORMAL_SAMPLER);
+		fg.ReadAttachment(points, depth);
+		fg.Write(points, finalTarget);
+
+		const uint32 dirLight = fg.AddPass("DirLight", [this, screenSize](const FrameGraph&)
+		{
+			deferredDirLightPass(screenSize);
+		});
+		fg.Read(dirLight, position, GBUFFER_POSITION_SAMPLER);
+		fg.Read(dirLight, diffuse, GBUFFER_DIFFUSE_SAMPLER);
+		fg.Read(dirLight, normal, GBUFFER_NORMAL_SAMPLER);
+		fg.Write(dirLight, finalTarget);
+
+		const uint32 blit = fg.AddPass("Final", [finalTarget, width, height](const FrameGraph& g)
+		{
+			RenderDevice* gl = OpenGLLayer::device();
+
+			gl->BindFramebuffer(GL_READ_FRAMEBUFFER, g.ReadFramebuffer(finalTarget));
+			gl->BlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+			gl->BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+		});
+		fg.ReadAttachment(blit, finalTarget);
+		fg.Write(blit, backBuffer);
 	}
-
-	// Stencil and Point Lights
+	else
 	{
-		glEnable(GL_STENCIL_TEST);
-
-		for (int i = 0; i < m_NumPointLightsInScene + 1; ++i)
-		{
-			Mat4 LIGHT_TRANS = glm::translate(Mat4(1.0f), m_PointsInfo[i].pos) * glm::scale(Mat4(1.0f), Vec3(m_PointsInfo[i].range));
-
-			// Stencil
-			{
-				m_ResManager->m_Shaders[SHADER_STENCIL_PASS_DEF]->Use();
-
-				// Disable color/depth write and enable stencil
-				m_Gbuffer->BindForStencilPass();
-				glEnable(GL_DEPTH_TEST);
-
-				glDisable(GL_CULL_FACE);
-
-				glClear(GL_STENCIL_BUFFER_BIT);
+		// Without a light to render from there is nothing to cast with, the shadow pass is culled
+		const bool shadows = withShadows && m_LightCamera != nullptr;
 
-				// We need the stencil test to be enabled but we want it to succeed always. Only the depth test matters.
-				glStencilFunc(GL_ALWAYS, 0, 0);
+		const FrameGraphTextureDesc shadowDesc = { width, height, GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT, GL_FLOAT, GL_LINEAR };
+		const FrameGraphHandle shadowMap = fg.Create("ShadowMap", shadowDesc);
 
-				glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
-				glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
-
-				m_ResManager->m_Shaders[SHADER_STENCIL_PASS_DEF]->SetUniformValue<Mat4>("u_WVP", &(m_CameraPtr->Projection() * m_CameraPtr->View() * LIGHT_TRANS));
-				this->renderMesh(m_ResManager->m_Meshes[MESH_ID_SPHERE]);
-			}
+		// Objects that do NOT receive shadows go into the depth buffer
+		const uint32 shadow = fg.AddPass("Shadow", [this](const FrameGraph&)
+		{
+			forwardRenderShadows();
+		});
+		fg.Write(shadow, shadowMap);
 
-			// Point Light
-			{
-				m_Gbuffer->BindForLightPass();
+		// Forward render all of the game objects with the scene light data
+		const uint32 forward = fg.AddPass("Forward", [this, shadowMap, shadows](const FrameGraph& g)
+		{
+			m_ShadowMap = g.Texture(shadowMap);
+			forwardRender(shadows);
+		});
+		if (shadows)
+			fg.Read(forward, shadowMap, SHADOW_MAP_SAMPLER);
+		fg.Write(forward, backBuffer);
+	}
 
-				ShaderProgram* sp = m_ResManager->m_Shaders[SHADER_POINT_LIGHT_PASS_DEF];
-				sp->Use();
+	fg.Compile();
+}
 
-				sp->SetUniformValue<int>("u_LightIndex", &i);
-				sp->SetUniformValue<Vec2>("u_ScreenSize", &screenSize);
-				sp->SetUniformValue<Mat4>("u_WVP", &(m_CameraPtr->Projection() * m_CameraPtr->View() * LIGHT_TRANS));
+void Renderer::deferredGeometryPass(GLenum finalAttachment)
+{
+	RenderDevice* gl = OpenGLLayer::device();
 
-				glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+	// The skybox goes straight into the final target, the lights add on top of it
+	gl->DrawBuffer(finalAttachment);
+	gl->Clear(GL_COLOR_BUFFER_BIT);
 
-				glDisable(GL_DEPTH_TEST);
-				glEnable(GL_BLEND);
-				glBlendEquation(GL_FUNC_ADD);
-				glBlendFunc(GL_ONE, GL_ONE);
+	if (m_CameraPtr->HasSkybox())
+	{
+		m_GpuTimers->Begin("Skybox");
+		renderSkybox(m_CameraPtr);
+		m_GpuTimers->End();
+	}
 
-				glEnable(GL_CULL_FACE);
-				glCullFace(GL_FRONT);
+	// The first three attachments are the position, diffuse and normal targets
+	gl->DrawBuffers(ARRAY_SIZE_IN_ELEMENTS(GBUFFER_DRAW_BUFFERS), GBUFFER_DRAW_BUFFERS);
 
-				// Set PointLight
-				this->renderMesh(m_ResManager->m_Meshes[MESH_ID_SPHERE]);
-				glCullFace(GL_BACK);
-				glDisable(GL_BLEND);
-			}
-		}
+	// Set GL States
+	gl->DepthMask(GL_TRUE);
+	gl->Enable(GL_DEPTH_TEST);
+	gl->Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		glDisable(GL_STENCIL_TEST);
-	}
+	m_RenderQueue->Clear();
+	queueRenderables(PASS_GEOMETRY);
+	if (m_ShouldDisplayNormals)
+		queueRenderables(PASS_NORMALS);
+	m_RenderQueue->Sort();
+	drawQueue(false);
 
-	// Dir Light Pass
-	{
-		glDisable(GL_CULL_FACE);
-		m_Gbuffer->BindForLightPass();
-		m_ResManager->m_Shaders[SHADER_DIR_LIGHT_PASS_DEF]->Use();
-		
-		// Should only set once
-		m_ResManager->m_Shaders[SHADER_DIR_LIGHT_PASS_DEF]->SetUniformValue<Mat4>("u_WVP", &(Mat4(1.0f)));
-		m_ResManager->m_Shaders[SHADER_DIR_LIGHT_PASS_DEF]->SetUniformValue<Vec2>("u_ScreenSize", &screenSize);
+	gl->DepthMask(GL_FALSE);
+}
 
+void Renderer::deferredDirLightPass(const Vec2& screenSize)
+{
+	RenderDevice* gl = OpenGLLayer::device();
 
-		glDisable(GL_DEPTH_TEST);
-		glEnable(GL_BLEND);
-		glBlendEquation(GL_FUNC_ADD);
-		glBlendFunc(GL_ONE, GL_ONE);
+	gl->Disable(GL_CULL_FACE);
+	m_ResManager->m_Shaders[SHADER_DIR_LIGHT_PASS_DEF]->Use();
 
-		this->renderMesh(m_ResManager->m_Meshes[MESH_ID_QUAD]);
-		glDisable(GL_BLEND);
-	}
+	// Should only set once
+	m_ResManager->m_Shaders[SHADER_DIR_LIGHT_PASS_DEF]->SetUniformValue<Mat4>(UNIFORM_ID("u_WVP"), &(Mat4(1.0f)));
+	m_ResManager->m_Shaders[SHADER_DIR_LIGHT_PASS_DEF]->SetUniformValue<Vec2>(UNIFORM_ID("u_ScreenSize"), &screenSize);
 
-	// Final Pass
-	{
-		m_Gbuffer->BindForFinalPass();
+	gl->Disable(GL_DEPTH_TEST);
+	gl->Enable(GL_BLEND);
+	gl->BlendEquation(GL_FUNC_ADD);
+	gl->BlendFunc(GL_ONE, GL_ONE);
 
-		glBlitFramebuffer(0, 0, (int)screenSize.x, (int)screenSize.y,
-			0, 0, (int)screenSize.x, (int)screenSize.y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
-	}
+	this->renderMesh(m_ResManager->m_Meshes[MESH_ID_QUAD]);
+	gl->Disable(GL_BLEND);
 }
 
 void Renderer::renderMesh(Mesh* thisMesh)
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	// This is user for rendering meshes for deferred lighting
-	glBindVertexArray(thisMesh->m_VAO);
+	gl->BindVertexArray(thisMesh->m_VAO);
 
 	int meshIndex = 0;
 	for (std::vector<SubMesh>::iterator j = thisMesh->m_SubMeshes.begin(); j != thisMesh->m_SubMeshes.end(); j++)
@@ -794,7 +888,7 @@ void Renderer::renderMesh(Mesh* thisMesh)
 
 		if (subMesh.NumIndices > 0)
 		{
-			glDrawElementsBaseVertex(GL_TRIANGLES,
+			gl->DrawElementsBaseVertex(GL_TRIANGLES,
 				subMesh.NumIndices,
 				GL_UNSIGNED_INT,
 				(void*)(sizeof(unsigned int) * subMesh.BaseIndex),
@@ -802,177 +896,974 @@ void Renderer::renderMesh(Mesh* thisMesh)
 		}
 		else
 		{
-			glDrawArrays(GL_TRIANGLES, 0, subMesh.NumVertices);
+			gl->DrawArrays(GL_TRIANGLES, 0, subMesh.NumVertices);
 		}
 	}
 
-	glBindVertexArray(0);
+	gl->BindVertexArray(0);
 }
 
-void Renderer::renderMesh(MeshRenderer* meshRenderer, const Mat4& world_xform, bool withTextures, GLenum renderMode, bool shadow_pass)
+void Renderer::renderPointLightVolumes(const Vec2& screenSize)
 {
-	// Get the pre-loaded mesh resource from the manager 
-	Mesh* thisMesh = m_ResManager->m_Meshes[meshRenderer->m_MeshIndex];
-	
-	if (!thisMesh)
+	RenderDevice* gl = OpenGLLayer::device();
+
+	const Frustum* frustum = (m_ShouldFrustumCull && m_CameraPtr) ? m_Frustum : nullptr;
+	const GLsizei count = (GLsizei)m_LightVolumes->Upload(m_PointLights, frustum);
+	if (count == 0)
 		return;
 
-	glBindVertexArray(thisMesh->m_VAO);
+	ShaderProgram* sp = m_ResManager->m_Shaders[SHADER_POINT_LIGHT_PASS_DEF];
+	sp->Use();
+	sp->SetUniformValue<Vec2>(UNIFORM_ID("u_ScreenSize"), &screenSize);
 
-	// Used to index the sub meshes of this mesh resource
-	int meshIndex = 0;
+	// Back faces pass where the g-buffer surface is in front of them, so anything inside or in front
+	// of a volume is shaded once per light and the shader's range test drops what is only in front.
+	// This takes the place of a stencil pass per light, clamping keeps back faces past the far plane
+	gl->Enable(GL_DEPTH_TEST);
+	gl->DepthFunc(GL_GEQUAL);
+	gl->Enable(GL_DEPTH_CLAMP);
 
-	for (std::vector<SubMesh>::iterator j = thisMesh->m_SubMeshes.begin(); j != thisMesh->m_SubMeshes.end(); j++)
-	{
-		// Get the sub mesh
-		SubMesh subMesh = (*j);
+	gl->Enable(GL_CULL_FACE);
+	gl->CullFace(GL_FRONT);
+
+	gl->Enable(GL_BLEND);
+	gl->BlendEquation(GL_FUNC_ADD);
+	gl->BlendFunc(GL_ONE, GL_ONE);
 
-		// Flag for culling, we won't draw if out of frustum, but still want to when its shadow pass
-		bool should_render = true;
-		if (m_ShouldFrustumCull && !shadow_pass)	
+	Mesh* volume = m_ResManager->m_Meshes[MESH_ID_SPHERE];
+	gl->BindVertexArray(volume->m_VAO);
+	m_LightVolumes->BindInstanceAttributes();
+
+	for (std::vector<SubMesh>::iterator j = volume->m_SubMeshes.begin(); j != volume->m_SubMeshes.end(); j++)
+	{
+		if (j->NumIndices > 0)
 		{
-			Vec3 centre = Maths::Vec4To3(world_xform * Vec4(subMesh.centre, 1.0f));
-			float r = Maths::Distance(
-				Maths::Vec4To3(world_xform * Vec4(subMesh.minvertex, 1.0f)),
-				Maths::Vec4To3(world_xform * Vec4(subMesh.maxVertex, 1.0f)));
-			should_render = m_Frustum->SphereInFrustum(centre, r);
+			gl->DrawElementsInstancedBaseVertex(GL_TRIANGLES,
+				j->NumIndices,
+				GL_UNSIGNED_INT,
+				(void*)(sizeof(unsigned int) * j->BaseIndex),
+				count,
+				j->BaseVertex);
 		}
+	}
 
-		// Passed cull test
-		if (should_render)
-		{
-			// We do not care about textures when doing depth pass for shadows
-			if (withTextures)
-			{
-				// Get the map of materials from the index in the mesh renderer component
-				const size_t	MaterialSet = meshRenderer->m_MaterialIndex;
+	m_LightVolumes->UnbindInstanceAttributes();
+	gl->BindVertexArray(0);
 
-				// Get the index into the material set that this sub mesh uses
-				const unsigned	MaterialIndex = subMesh.MaterialIndex;
+	gl->Disable(GL_BLEND);
+	gl->CullFace(GL_BACK);
+	gl->Disable(GL_DEPTH_CLAMP);
+	gl->DepthFunc(GL_LESS);
+}
 
-				// Check this mat set is valid
-				if (m_ResManager->CheckMaterialSetExists(MaterialSet))
-				{
-					auto& materials = m_ResManager->m_Materials[MaterialSet];
+void Renderer::gatherRenderables(std::vector<GameObject*>& gameObjects)
+{
+	PROFILE_ZONE("Renderer::gatherRenderables");
 
-					// This flag is used when mesh/shader uses multiple diffuse textures such as terrain and binds them all
-					if (meshRenderer->m_MultiTextures)
-					{
-						for (auto i = materials.begin(); i != materials.end(); ++i)
-						{
-							i->second->Bind();
-						}
-					}
-					// This sub mesh is expected to only have one diffuse texture, possibly a normal map
-					else
-					{
-						if (materials[MaterialIndex])
-						{
-							materials[MaterialIndex]->Bind();
-						}
-					}
-				}
-			}
+	m_Renderables.clear();
 
-			// Finally Render this mesh
-			if (subMesh.NumIndices > 0)
-			{
-				glDrawElementsBaseVertex(
-					renderMode,
-					subMesh.NumIndices,
-					GL_UNSIGNED_INT,
-					(void*)(sizeof(unsigned int) * subMesh.BaseIndex),
-					subMesh.BaseVertex);
-			}
-			else
-			{
-				glDrawArrays(renderMode, 0, subMesh.NumVertices);
-			}
-		}
-		else
-		{
-			++m_CullCount;
-		}
+	for (auto i = gameObjects.begin(); i != gameObjects.end(); ++i)
+	{
+		Transform* t = (*i)->GetComponent<Transform>();
+		MeshRenderer* mr = (*i)->GetComponent<MeshRenderer>();
+
+		if (!t || !mr)
+			continue;
 
-		++meshIndex;
+		Renderable r = { t, mr, mr->m_HasAnimations ? (*i)->GetComponent<Animator>() : nullptr };
+		m_Renderables.push_back(r);
 	}
 
-	glBindVertexArray(0);
+	m_AllRenderables.resize(m_Renderables.size());
+	for (size_t i = 0; i < m_AllRenderables.size(); ++i)
+		m_AllRenderables[i] = (int)i;
+
+	updateSceneTree();
 }
 
-void Renderer::renderAnimMesh(MeshRenderer* meshRenderer, Animator* anim, const Mat4& world, bool withTextures)
+void Renderer::updateSceneTree()
 {
-	AnimMesh* thisMesh = m_ResManager->m_AnimMeshes[meshRenderer->m_MeshIndex];
-
-	if (!thisMesh)
-		return;
+	PROFILE_ZONE("Renderer::updateSceneTree");
 
-	bool should_render = true;
-	if (m_ShouldFrustumCull)
+	// Refresh the bounds caches across the cores first, the tree itself is only touched from this thread
+	m_Jobs->ParallelFor(m_Renderables.size(), MIN_RENDERABLES_PER_JOB,
+		[this](size_t begin, size_t end, unsigned chunk)
 	{
-		Vec3 centre = Maths::Vec4To3(world * Vec4(thisMesh->m_AnimData[anim->m_AnimState.curr_frame].centre, 1.0f));
-		float r = Maths::Distance(
-			Maths::Vec4To3(world * Vec4(thisMesh->m_AnimData[anim->m_AnimState.curr_frame].min, 1.0f)),
-			Maths::Vec4To3(world * Vec4(thisMesh->m_AnimData[anim->m_AnimState.curr_frame].max, 1.0f)));
-		should_render = m_Frustum->SphereInFrustum(centre, r);
-	}
+		PROFILE_ZONE("ResolveBounds");
+		Mesh* mesh;
+		AnimMesh* animMesh;
+		const WorldSphere* bounds;
+		for (size_t i = begin; i < end; ++i)
+			this->resolveRenderable(m_Renderables[i], &mesh, &animMesh, &bounds);
+	});
 
-	if (should_render)
+	++m_TreeFrame;
+
+	for (size_t i = 0; i < m_Renderables.size(); ++i)
 	{
-		glBindVertexArray(thisMesh->m_VAO);
+		MeshRenderer* mr = m_Renderables[i].meshRenderer;
+
+		// No mesh resolved, nothing to draw or bound
+		if (!mr->m_BoundsValid)
+			continue;
+
+		int proxy = mr->m_TreeProxy;
+		const bool owned = proxy >= 0 && proxy < (int)m_SceneProxies.size() && m_SceneProxies[proxy].owner == mr;
 
-		int iTotalOffset = 0;
+		if (!owned)
+		{
+			proxy = m_SceneTree->CreateProxy(mr->m_WorldMin, mr->m_WorldMax, (int)i);
+			if (proxy >= (int)m_SceneProxies.size())
+				m_SceneProxies.resize(proxy + 1);
 
-		if (withTextures)
+			m_SceneProxies[proxy].owner = mr;
+			mr->m_TreeProxy = proxy;
+			mr->m_TreeStamp = mr->m_BoundsStamp;
+		}
+		else
 		{
-			if (m_ResManager->CheckMaterialSetExists(meshRenderer->m_MaterialIndex))
+			// Only objects whose bounds were rebuilt can have left their fat box
+			if (mr->m_TreeStamp != mr->m_BoundsStamp)
 			{
-				auto& materials = m_ResManager->m_Materials[meshRenderer->m_MaterialIndex];
-				for (auto i = materials.begin(); i != materials.end(); ++i)
-				{
-					i->second->Bind();
-				}
+				m_SceneTree->MoveProxy(proxy, mr->m_WorldMin, mr->m_WorldMax);
+				mr->m_TreeStamp = mr->m_BoundsStamp;
 			}
+
+			m_SceneTree->SetUserData(proxy, (int)i);
 		}
 
-		// Change vertices pointers to current frame
-		glEnableVertexAttribArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, thisMesh->m_AnimData[anim->m_AnimState.curr_frame].vbo);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), 0);
+		m_SceneProxies[proxy].frame = m_TreeFrame;
+	}
+
+	// Anything not handed to the renderer this frame has left the scene
+	for (size_t p = 0; p < m_SceneProxies.size(); ++p)
+	{
+		SceneProxy& proxy = m_SceneProxies[p];
+		if (proxy.owner && proxy.frame != m_TreeFrame)
+		{
+			m_SceneTree->DestroyProxy((int)p);
+			proxy.owner = nullptr;
+		}
+	}
+}
+
+void Renderer::queryScene(bool withShadows)
+{
+	PROFILE_ZONE("Renderer::queryScene");
+
+	const Frustum* frustums[2];
+	std::vector<int>* lists[2];
+	int count = 0;
+
+	if (m_ShouldFrustumCull && m_CameraPtr)
+	{
+		m_Frustum->UpdateFrustum(m_CameraPtr->Projection(), m_CameraPtr->View());
+		m_CameraVisible.clear();
+		frustums[count] = m_Frustum;
+		lists[count++] = &m_CameraVisible;
+	}
+
+	// Casters outside the light's volume can't land in the shadow map, but one nearer the light than the volume still can
+	m_ShadowCull = withShadows && m_ShouldFrustumCull && m_LightCamera;
+	if (m_ShadowCull)
+	{
+		m_LightFrustum->UpdateFrustum(m_LightCamera->Projection(), m_LightCamera->View());
+		m_LightFrustum->ExtrudeNear();
+		m_ShadowDir = glm::normalize(m_LightCamera->Forward());
+		m_LightVisible.clear();
+		frustums[count] = m_LightFrustum;
+		lists[count++] = &m_LightVisible;
+	}
+
+	if (count == 0)
+		return;
+
+	m_TreeNodesVisited = m_SceneTree->Query(frustums, lists, count);
+
+	// Sorted back into scene order so the jobs split and merge the same way every frame
+	for (int i = 0; i < count; ++i)
+		std::sort(lists[i]->begin(), lists[i]->end());
+}
+
+void Renderer::buildOcclusion()
+{
+	PROFILE_ZONE("Renderer::buildOcclusion");
+
+	// Refines the camera cull, so there is nothing to do without it
+	m_OcclusionActive = m_ShouldOcclusionCull && m_ShouldFrustumCull && m_CameraPtr;
+	if (!m_OcclusionActive)
+		return;
+
+	m_Occlusion->Begin(m_CameraPtr->Projection() * m_CameraPtr->View());
+
+	// Occluders outside the frustum can't hide anything inside it
+	for (auto i = m_CameraVisible.begin(); i != m_CameraVisible.end(); ++i)
+	{
+		const Renderable& r = m_Renderables[*i];
+		if (!r.meshRenderer->m_IsOccluder || r.meshRenderer->m_HasAnimations)
+			continue;
+
+		Mesh* mesh = m_ResManager->GetMesh(r.meshRenderer->m_MeshIndex);
+		if (mesh && mesh->HasOccluder())
+			m_Occlusion->AddOccluder(mesh->OccluderVertices(), mesh->OccluderIndices(), r.transform->GetModelXform());
+	}
+
+	m_Occlusion->End();
+}
+
+void Renderer::buildLightClusters()
+{
+	PROFILE_ZONE("Renderer::buildLightClusters");
+
+	if (!m_CameraPtr)
+		return;
+
+	m_LightClusters->Build(m_PointLights, m_SpotLights, m_CameraPtr->Projection(), m_CameraPtr->View(),
+		(float)Screen::FrameBufferWidth(), (float)Screen::FrameBufferHeight());
+
+	// Light data only goes up when a light was changed, the clusters every frame
+	m_LightClusters->Upload(m_PointLights, m_SpotLights, m_LightsChanged);
+	m_LightsChanged = false;
+}
+
+const std::vector<int>& Renderer::passRenderables(RenderPass pass) const
+{
+	// Normals are a debug view and draw everything, as does any pass without a frustum this frame
+	switch (pass)
+	{
+	case PASS_FORWARD:
+	case PASS_GEOMETRY:
+		return (m_ShouldFrustumCull && m_CameraPtr) ? m_CameraVisible : m_AllRenderables;
+	case PASS_SHADOW:
+		return m_ShadowCull ? m_LightVisible : m_AllRenderables;
+	default:
+		return m_AllRenderables;
+	}
+}
+
+const Frustum* Renderer::cullFrustum(RenderPass pass) const
+{
+	// Normals are a debug view and are never culled
+	switch (pass)
+	{
+	case PASS_FORWARD:
+	case PASS_GEOMETRY:
+		return (m_ShouldFrustumCull && m_CameraPtr) ? m_Frustum : nullptr;
+	case PASS_SHADOW:
+		return m_ShadowCull ? m_LightFrustum : nullptr;
+	default:
+		return nullptr;
+	}
+}
+
+bool Renderer::sphereVisible(RenderPass pass, const Vec3& centre, float radius) const
+{
+	// The single sphere version of the batch tests in queueRange
+	const Frustum* frustum = cullFrustum(pass);
+	if (!frustum)
+		return true;
+
+	if (!frustum->SphereInFrustum(centre, radius))
+		return false;
+
+	// A caster only matters if its shadow can fall somewhere the camera sees
+	if (pass == PASS_SHADOW)
+		return !m_CameraPtr || !m_ShouldFrustumCull || m_Frustum->SweptSphereInFrustum(centre, radius, m_ShadowDir);
+
+	return !m_OcclusionActive || m_Occlusion->TestSphere(centre, radius);
+}
+
+// Resolves which material(s) a sub mesh binds, returns the material index for the sort key or -1
+static int resolveMaterial(RenderItem& item, bool multiTextures, const std::map<unsigned, Material*>* materials, const SubMesh& subMesh)
+{
+	item.material = nullptr;
+	item.materialSet = nullptr;
+
+	if (!materials)
+		return -1;
+
+	// This flag is used when mesh/shader uses multiple diffuse textures such as terrain and binds them all
+	if (multiTextures)
+	{
+		item.materialSet = materials;
+		return -1;
+	}
 
-		// Next position
-		glEnableVertexAttribArray(3);
-		glBindBuffer(GL_ARRAY_BUFFER, thisMesh->m_AnimData[anim->m_AnimState.next_frame].vbo);
-		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), 0);
+	// This sub mesh is expected to only have one diffuse texture, possibly a normal map
+	auto mat = materials->find(subMesh.MaterialIndex);
+	if (mat != materials->end() && mat->second)
+	{
+		item.material = mat->second;
+		return (int)subMesh.MaterialIndex;
+	}
 
-		// Change normal pointers to current frame
-		glEnableVertexAttribArray(2);
-		glBindBuffer(GL_ARRAY_BUFFER, thisMesh->m_AnimData[anim->m_AnimState.curr_frame].vbo);
-		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), 0);
+	return -1;
+}
 
-		// Next norm
-		glEnableVertexAttribArray(4);
-		glBindBuffer(GL_ARRAY_BUFFER, thisMesh->m_AnimData[anim->m_AnimState.next_frame].vbo);
-		glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), 0);
+const WorldSphere* Renderer::worldBounds(const Renderable& r, Mesh* mesh, AnimMesh* animMesh)
+{
+	// Each renderable is only ever touched by one job at a time, so the cache can be filled in place
+	MeshRenderer* mr = r.meshRenderer;
+	const uint32 version = r.transform->Version();
+	const int frame = animMesh ? r.animator->m_AnimState.curr_frame : -1;
 
-		for (int i = 0; i < thisMesh->m_RenderModes.size(); ++i)
+	if (mr->m_BoundsValid && mr->m_BoundsVersion == version && mr->m_BoundsFrame == frame)
+		return mr->m_WorldBounds.data();
+
+	const Mat4& world = r.transform->GetModelXform();
+
+	if (animMesh)
+	{
+		const AnimData& data = animMesh->m_AnimData[frame];
+		mr->m_WorldBounds.resize(1);
+		mr->m_WorldBounds[0].centre = Maths::Vec4To3(world * Vec4(data.centre, 1.0f));
+		mr->m_WorldBounds[0].radius = Maths::Distance(
+			Maths::Vec4To3(world * Vec4(data.min, 1.0f)),
+			Maths::Vec4To3(world * Vec4(data.max, 1.0f)));
+	}
+	else
+	{
+		mr->m_WorldBounds.resize(mesh->m_SubMeshes.size());
+		for (size_t j = 0; j < mesh->m_SubMeshes.size(); ++j)
 		{
-			glDrawArrays(thisMesh->m_RenderModes[i], iTotalOffset, thisMesh->m_NumRenderVertices[i]);
-			iTotalOffset += thisMesh->m_NumRenderVertices[i];
+			const SubMesh& subMesh = mesh->m_SubMeshes[j];
+			mr->m_WorldBounds[j].centre = Maths::Vec4To3(world * Vec4(subMesh.centre, 1.0f));
+			mr->m_WorldBounds[j].radius = Maths::Distance(
+				Maths::Vec4To3(world * Vec4(subMesh.minvertex, 1.0f)),
+				Maths::Vec4To3(world * Vec4(subMesh.maxVertex, 1.0f)));
 		}
+	}
 
-		glBindVertexArray(0);
+	// Box around the spheres for the scene tree
+	mr->m_WorldMin = mr->m_WorldBounds[0].centre - Vec3(mr->m_WorldBounds[0].radius);
+	mr->m_WorldMax = mr->m_WorldBounds[0].centre + Vec3(mr->m_WorldBounds[0].radius);
+	for (size_t j = 1; j < mr->m_WorldBounds.size(); ++j)
+	{
+		mr->m_WorldMin = glm::min(mr->m_WorldMin, mr->m_WorldBounds[j].centre - Vec3(mr->m_WorldBounds[j].radius));
+		mr->m_WorldMax = glm::max(mr->m_WorldMax, mr->m_WorldBounds[j].centre + Vec3(mr->m_WorldBounds[j].radius));
 	}
-	else
+
+	mr->m_BoundsVersion = version;
+	mr->m_BoundsFrame = frame;
+	mr->m_BoundsValid = true;
+	++mr->m_BoundsStamp;
+	return mr->m_WorldBounds.data();
+}
+
+void Renderer::queueRenderables(RenderPass pass)
+{
+	PROFILE_ZONE("Renderer::queueRenderables");
+
+	// Each job culls its slice of the renderables into its own output, nothing shared is written
+	const std::vector<int>& list = passRenderables(pass);
+	const unsigned jobs = m_Jobs->ParallelFor(list.size(), MIN_RENDERABLES_PER_JOB,
+		[this, pass, &list](size_t begin, size_t end, unsigned chunk)
+	{
+		PROFILE_ZONE("QueueRange");
+		this->queueRange(pass, list, begin, end, m_QueueJobs[chunk]);
+	});
+
+	// Merge in chunk order so the queue is the same whatever the thread timing
+	const bool instancing = (pass == PASS_FORWARD || pass == PASS_SHADOW);
+	if (instancing)
+		m_InstanceBatcher->Begin();
+
+	for (unsigned j = 0; j < jobs; ++j)
+	{
+		QueueJobOutput& out = m_QueueJobs[j];
+
+		for (auto i = out.items.begin(); i != out.items.end(); ++i)
+			m_RenderQueue->Push(*i);
+
+		for (auto c = out.instances.begin(); c != out.instances.end(); ++c)
+			m_InstanceBatcher->Add(c->key, c->object, c->object->transform->GetModelXform(), c->depth);
+
+		m_CullCount += out.cullCount;
+	}
+
+	if (instancing)
+		queueInstances(pass);
+}
+
+size_t Renderer::resolveRenderable(const Renderable& r, Mesh** mesh, AnimMesh** animMesh, const WorldSphere** bounds)
+{
+	MeshRenderer* mr = r.meshRenderer;
+	*mesh = nullptr;
+	*animMesh = nullptr;
+	*bounds = nullptr;
+
+	if (mr->m_HasAnimations)
+	{
+		*animMesh = r.animator ? m_ResManager->GetAnimMesh(mr->m_MeshIndex) : nullptr;
+		if (!*animMesh)
+			return 0;
+
+		*bounds = worldBounds(r, nullptr, *animMesh);
+		return 1;
+	}
+
+	*mesh = m_ResManager->GetMesh(mr->m_MeshIndex);
+	if (!*mesh)
+		return 0;
+
+	*bounds = worldBounds(r, *mesh, nullptr);
+	return (*mesh)->m_SubMeshes.size();
+}
+
+void Renderer::queueRange(RenderPass pass, const std::vector<int>& list, size_t begin, size_t end, QueueJobOutput& out)
+{
+	// Shadow casters are culled by the light's volume, camera passes by the camera. Normals are a debug view and never culled
+	const Frustum* frustum = cullFrustum(pass);
+	const bool cull = frustum != nullptr;
+	const bool withTextures = (pass == PASS_FORWARD || pass == PASS_GEOMETRY);
+	const bool instancing = (pass == PASS_FORWARD || pass == PASS_SHADOW);
+	const Vec3 eye = m_CameraPtr ? m_CameraPtr->Position() : Vec3(0.0f);
+
+	out.items.clear();
+	out.instances.clear();
+	out.cullCount = 0;
+
+	Mesh* thisMesh = nullptr;
+	AnimMesh* thisAnimMesh = nullptr;
+	const WorldSphere* bounds = nullptr;
+
+	// Copy every sphere in the slice into streams and cull them in one batch, the loop below reads the mask
+	if (cull)
+	{
+		out.spheres.Clear();
+		for (size_t i = begin; i < end; ++i)
+		{
+			size_t numBounds = resolveRenderable(m_Renderables[list[i]], &thisMesh, &thisAnimMesh, &bounds);
+			for (size_t j = 0; j < numBounds; ++j)
+				out.spheres.Push(bounds[j].centre, bounds[j].radius);
+		}
+
+		frustum->CullSpheres(out.spheres, out.visible);
+
+		// Casters in the light's volume whose shadow can't reach the camera's view are dropped too
+		if (pass == PASS_SHADOW)
+		{
+			if (m_CameraPtr && m_ShouldFrustumCull)
+				m_Frustum->CullSweptSpheres(out.spheres, m_ShadowDir, out.visible);
+		}
+		// Only what survived the frustum is tested against the depth buffer
+		else if (m_OcclusionActive)
+		{
+			m_Occlusion->CullSpheres(out.spheres, out.visible);
+		}
+	}
+
+	size_t sphere = 0;
+
+	for (size_t i = begin; i < end; ++i)
+	{
+		const Renderable* r = &m_Renderables[list[i]];
+		MeshRenderer* mr = r->meshRenderer;
+
+		// Spheres were pushed for every renderable, step over this one's before anything is skipped
+		const size_t firstSphere = sphere;
+		const size_t numBounds = resolveRenderable(*r, &thisMesh, &thisAnimMesh, &bounds);
+		sphere += numBounds;
+
+		if (numBounds == 0)
+			continue;
+
+		// Only meshes that do NOT receive shadows are rendered into the depth buffer
+		if (pass == PASS_SHADOW && mr->m_ReceiveShadows)
+			continue;
+
+		size_t shaderIndex = mr->m_ShaderIndex;
+		switch (pass)
+		{
+		case PASS_SHADOW:	shaderIndex = SHADER_SHADOW; break;
+		case PASS_GEOMETRY:	shaderIndex = SHADER_GEOM_PASS_DEF; break;
+		case PASS_NORMALS:	shaderIndex = SHADER_NORMAL_DISP_FWD; break;
+		default: break;
+		}
+
+		const std::map<unsigned, Material*>* materials = nullptr;
+		auto set = m_ResManager->m_Materials.find(mr->m_MaterialIndex);
+		if (withTextures && set != m_ResManager->m_Materials.end())
+			materials = &set->second;
+
+		if (thisAnimMesh)
+		{
+			// Key framed meshes only have forward and shadow shaders
+			if (pass != PASS_FORWARD && pass != PASS_SHADOW)
+				continue;
+
+			ShaderProgram* sp = m_ResManager->GetShader(shaderIndex);
+			if (!sp)
+				continue;
+
+			if (cull && !Frustum::IsVisible(out.visible, firstSphere))
+			{
+				++out.cullCount;
+				continue;
+			}
+
+			const Vec3& centre = bounds[0].centre;
+
+			RenderItem item = {};
+			item.pass = pass;
+			item.object = r;
+			item.shader = sp;
+			item.animMesh = thisAnimMesh;
+			item.vao = thisAnimMesh->m_VAO;
+			item.materialSet = materials;
+			item.key = RenderQueue::MakeKey(pass, shaderIndex, materials ? mr->m_MaterialIndex : 0, -1, item.vao, glm::dot(centre - eye, centre - eye));
+			out.items.push_back(item);
+			continue;
+		}
+
+		// Only the default lighting and shadow shaders have an instanced version, everything else draws one by one
+		if (instancing && shaderIndex != SHADER_LIGHTING_FWD && shaderIndex != SHADER_SHADOW)
+		{
+			queueMesh(pass, r, shaderIndex, materials, cull, out, cull ? &out.visible : nullptr, firstSphere);
+			continue;
+		}
+
+		// Cull the object as a whole, a group draws every sub mesh of each instance
+		bool visible = !cull;
+		bool indexed = true;
+		float depth = 0.0f;
+
+		for (size_t j = 0; j < numBounds; ++j)
+		{
+			indexed &= thisMesh->m_SubMeshes[j].NumIndices > 0;
+			visible |= cull && Frustum::IsVisible(out.visible, firstSphere + j);
+
+			float d = glm::dot(bounds[j].centre - eye, bounds[j].centre - eye);
+			if (j == 0 || d < depth)
+				depth = d;
+		}
+
+		if (!visible)
+		{
+			out.cullCount += (int)numBounds;
+			continue;
+		}
+
+		if (!indexed)
+		{
+			queueMesh(pass, r, shaderIndex, materials, cull, out, cull ? &out.visible : nullptr, firstSphere);
+			continue;
+		}
+
+		InstanceKey key;
+		key.mesh = mr->m_MeshIndex;
+		key.materialSet = pass == PASS_FORWARD ? mr->m_MaterialIndex : 0;
+		key.shader = shaderIndex;
+		key.bumpMaps = pass == PASS_FORWARD ? mr->m_HasBumpMaps : 0;
+		key.receiveShadows = pass == PASS_FORWARD ? mr->m_ReceiveShadows : 0;
+
+		InstanceCandidate candidate = { key, r, depth };
+		out.instances.push_back(candidate);
+	}
+}
+
+void Renderer::queueMesh(RenderPass pass, const Renderable* r, size_t shaderIndex, const std::map<unsigned, Material*>* materials, bool cull, QueueJobOutput& out,
+	const std::vector<uint32>* visibility, size_t firstSphere)
+{
+	MeshRenderer* mr = r->meshRenderer;
+	const Vec3 eye = m_CameraPtr ? m_CameraPtr->Position() : Vec3(0.0f);
+
+	ShaderProgram* sp = m_ResManager->GetShader(shaderIndex);
+	Mesh* thisMesh = m_ResManager->GetMesh(mr->m_MeshIndex);
+	if (!sp || !thisMesh)
+		return;
+
+	RenderItem item = {};
+	item.pass = pass;
+	item.object = r;
+	item.shader = sp;
+	item.mesh = thisMesh;
+	item.vao = thisMesh->m_VAO;
+
+	const WorldSphere* bounds = worldBounds(*r, thisMesh, nullptr);
+
+	for (unsigned j = 0; j < (unsigned)thisMesh->m_SubMeshes.size(); ++j)
+	{
+		const SubMesh& subMesh = thisMesh->m_SubMeshes[j];
+		const Vec3& centre = bounds[j].centre;
+
+		// Flag for culling, we won't draw if out of frustum or hidden. Use the batch result when the caller has one
+		const bool visible = !cull || (visibility ?
+			Frustum::IsVisible(*visibility, firstSphere + j) :
+			sphereVisible(pass, centre, bounds[j].radius));
+
+		if (!visible)
+		{
+			++out.cullCount;
+			continue;
+		}
+
+		item.subMesh = j;
+		int materialIndex = resolveMaterial(item, mr->m_MultiTextures, materials, subMesh);
+
+		item.key = RenderQueue::MakeKey(pass, shaderIndex, materials ? mr->m_MaterialIndex : 0, materialIndex, item.vao, glm::dot(centre - eye, centre - eye));
+		out.items.push_back(item);
+	}
+}
+
+void Renderer::queueInstances(RenderPass pass)
+{
+	InstanceBatcher::GroupMap& groups = m_InstanceBatcher->Groups();
+
+	for (auto g = groups.begin(); g != groups.end(); ++g)
+	{
+		const InstanceKey& key = g->first;
+		InstanceGroup& group = g->second;
+
+		if (group.objects.empty())
+			continue;
+
+		// Every member shares the material set, so the first one stands in for the group
+		const MeshRenderer* mr = group.objects[0]->meshRenderer;
+		const std::map<unsigned, Material*>* materials = nullptr;
+		auto set = m_ResManager->m_Materials.find(mr->m_MaterialIndex);
+		if (pass == PASS_FORWARD && set != m_ResManager->m_Materials.end())
+			materials = &set->second;
+
+		// Nothing to share, the object already passed the coarse cull so only its sub meshes are tested
+		if (group.objects.size() == 1)
+		{
+			QueueJobOutput& out = m_QueueJobs[0];
+			out.items.clear();
+			out.cullCount = 0;
+
+			queueMesh(pass, group.objects[0], key.shader, materials, cullFrustum(pass) != nullptr, out);
+
+			for (auto i = out.items.begin(); i != out.items.end(); ++i)
+				m_RenderQueue->Push(*i);
+			m_CullCount += out.cullCount;
+			continue;
+		}
+
+		const size_t shaderIndex = pass == PASS_SHADOW ? SHADER_SHADOW_INSTANCED : SHADER_LIGHTING_FWD_INSTANCED;
+		ShaderProgram* sp = m_ResManager->GetShader(shaderIndex);
+		Mesh* thisMesh = m_ResManager->GetMesh(key.mesh);
+		if (!sp || !thisMesh)
+			continue;
+
+		RenderItem item = {};
+		item.pass = pass;
+		item.object = group.objects[0];
+		item.shader = sp;
+		item.mesh = thisMesh;
+		item.vao = thisMesh->m_VAO;
+		item.instances = (GLsizei)group.objects.size();
+		item.firstInstance = m_InstanceBatcher->Append(group);
+
+		for (unsigned j = 0; j < (unsigned)thisMesh->m_SubMeshes.size(); ++j)
+		{
+			item.subMesh = j;
+			int materialIndex = resolveMaterial(item, mr->m_MultiTextures, materials, thisMesh->m_SubMeshes[j]);
+
+			item.key = RenderQueue::MakeKey(pass, shaderIndex, materials ? mr->m_MaterialIndex : 0, materialIndex, item.vao, group.nearestDepth);
+			m_RenderQueue->Push(item);
+		}
+	}
+}
+
+// Forward lit draws of the plain lighting shader take their object from the object data buffer
+static bool usesObjectData(const RenderItem& item, const ShaderProgram* objectShader)
+{
+	return item.pass == PASS_FORWARD && item.instances == 0 && !item.animMesh && item.shader == objectShader;
+}
+
+void Renderer::writeObjectData(bool withShadows)
+{
+	PROFILE_ZONE("Renderer::writeObjectData");
+
+	const bool useShadowMap = withShadows && m_LightCamera;
+	const Mat4 lightProjView = useShadowMap ? m_LightCamera->ProjXView() : IDENTITY;
+	const ShaderProgram* objectShader = m_ResManager->GetShader(SHADER_LIGHTING_FWD);
+
+	m_ObjectData->Begin(m_Renderables.size());
+
+	// One contiguous walk of the sorted queue, each object is written once however many sub meshes it draws
+	for (size_t i = 0; i < m_RenderQueue->Size(); ++i)
+	{
+		const RenderItem& item = (*m_RenderQueue)[i];
+
+		if (!usesObjectData(item, objectShader))
+			continue;
+
+		const Mat4& world = item.object->transform->GetModelXform();
+		const MeshRenderer* mr = item.object->meshRenderer;
+
+		m_ObjectData->Add(item.object - m_Renderables.data(), world, lightProjView * world, mr->m_HasBumpMaps, mr->m_ReceiveShadows);
+	}
+
+	m_ObjectData->Upload();
+}
+
+void Renderer::drawQueue(bool withShadows)
+{
+	PROFILE_ZONE("Renderer::drawQueue");
+
+	RenderDevice* gl = OpenGLLayer::device();
+
+	const bool useShadowMap = withShadows && m_LightCamera;
+	const Mat4 lightProjView = m_LightCamera ? m_LightCamera->ProjXView() : IDENTITY;
+	const Mat4 camProjView = m_CameraPtr ? m_CameraPtr->ProjXView() : IDENTITY;
+
+	// Last state set, only changed when the sorted keys cross a boundary
+	ShaderProgram* program = nullptr;
+	const void* material = nullptr;
+	const Renderable* object = nullptr;
+	GLuint vao = 0;
+	const ShaderProgram* objectShader = m_ResManager->GetShader(SHADER_LIGHTING_FWD);
+	bool objectIdsBound = false;
+
+	// Matrices for every instanced group in the queue go up in one upload
+	m_InstanceBatcher->Upload();
+	int64 instanceBase = -1;
+
+	for (size_t i = 0; i < m_RenderQueue->Size(); ++i)
+	{
+		const RenderItem& item = (*m_RenderQueue)[i];
+		const bool objectData = usesObjectData(item, objectShader);
+
+		if (item.shader != program)
+		{
+			program = item.shader;
+			program->Use();
+
+			// Uniforms are per program so objects need setting again
+			object = nullptr;
+
+			if (item.pass == PASS_FORWARD && useShadowMap)
+			{
+				gl->ActiveTexture(SHADOW_MAP_SAMPLER);
+				gl->BindTexture(GL_TEXTURE_2D, m_ShadowMap);
+			}
+		}
+
+		// The ids are only sized for the objects, nothing else may read them
+		if (objectIdsBound && (item.vao != vao || !objectData))
+		{
+			objectIdsBound = false;
+			m_ObjectData->UnbindIdAttribute();
+		}
+
+		// Likewise the instance matrices, the next item may draw the same mesh on its own
+		if (instanceBase >= 0 && (item.vao != vao || item.instances == 0))
+		{
+			instanceBase = -1;
+			m_InstanceBatcher->UnbindInstanceAttributes();
+		}
+
+		if (item.vao != vao)
+		{
+			vao = item.vao;
+			gl->BindVertexArray(vao);
+		}
+
+		if (objectData && !objectIdsBound)
+		{
+			objectIdsBound = true;
+			m_ObjectData->BindIdAttribute();
+		}
+
+		if (item.instances > 0 && (int64)item.firstInstance != instanceBase)
+		{
+			instanceBase = (int64)item.firstInstance;
+			m_InstanceBatcher->BindInstanceAttributes(item.firstInstance);
+		}
+
+		const void* thisMaterial = item.material ? (const void*)item.material : (const void*)item.materialSet;
+		if (thisMaterial && thisMaterial != material)
+		{
+			material = thisMaterial;
+
+			if (item.material)
+			{
+				item.material->Bind();
+			}
+			else
+			{
+				for (auto m = item.materialSet->begin(); m != item.materialSet->end(); ++m)
+				{
+					if (m->second)
+						m->second->Bind();
+				}
+			}
+		}
+
+		// Object data draws already have everything they need in the storage buffer
+		if (item.object != object && !objectData)
+		{
+			object = item.object;
+
+			MeshRenderer* mr = object->meshRenderer;
+			const Mat4& world = object->transform->GetModelXform();
+
+			// Instanced shaders read the world matrix per instance, only what the group shares is set here
+			if (item.instances > 0)
+			{
+				program->SetUniformValue<Mat4>(UNIFORM_ID("u_light_proj_view_xform"), &lightProjView);
+
+				if (item.pass == PASS_FORWARD)
+				{
+					program->SetUniformValue<int>(UNIFORM_ID("u_use_bumpmap"), &mr->m_HasBumpMaps);
+					program->SetUniformValue<int>(UNIFORM_ID("u_use_shadow"), &mr->m_ReceiveShadows);
+				}
+			}
+			else
+			{
+				switch (item.pass)
+				{
+				case PASS_SHADOW:
+				{
+					Mat4 wvp = lightProjView * world;
+					program->SetUniformValue<Mat4>(UNIFORM_ID("u_wvp_xform"), &wvp);
+					break;
+				}
+				case PASS_FORWARD:
+				{
+					if (useShadowMap)
+					{
+						Mat4 light_xform = lightProjView * world;
+						program->SetUniformValue<Mat4>(UNIFORM_ID("u_light_xform"), &light_xform);
+					}
+
+					program->SetUniformValue<Mat4>(UNIFORM_ID("u_world_xform"), &world);
+					program->SetUniformValue<int>(UNIFORM_ID("u_use_bumpmap"), &mr->m_HasBumpMaps);
+					program->SetUniformValue<int>(UNIFORM_ID("u_use_shadow"), &mr->m_ReceiveShadows);
+
+					if (item.animMesh)
+						program->SetUniformValue<float>(UNIFORM_ID("u_lerp"), &object->animator->m_AnimState.interpol);
+					break;
+				}
+				case PASS_GEOMETRY:
+				{
+					program->SetUniformValue<Mat4>(UNIFORM_ID("u_world_xform"), &world);
+					break;
+				}
+				case PASS_NORMALS:
+				{
+					Mat4 wvp = camProjView * world;
+					program->SetUniformValue<Mat4>(UNIFORM_ID("u_wvp"), &wvp);
+					program->SetUniformValue<Mat4>(UNIFORM_ID("u_world_xform"), &world);
+					break;
+				}
+				default:
+					break;
+				}
+			}
+		}
+
+		if (item.animMesh)
+		{
+			this->renderAnimMesh(item.animMesh, object->animator);
+			continue;
+		}
+
+		const SubMesh& subMesh = item.mesh->m_SubMeshes[item.subMesh];
+		const GLenum renderMode = item.pass == PASS_NORMALS ? GL_POINTS : GL_TRIANGLES;
+
+		if (objectData)
+		{
+			// A single instance whose base instance is the object's slot, the id attribute reads it back as the index
+			const uint32 slot = m_ObjectData->Slot(item.object - m_Renderables.data());
+
+			if (subMesh.NumIndices > 0)
+			{
+				gl->DrawElementsInstancedBaseVertexBaseInstance(
+					renderMode,
+					subMesh.NumIndices,
+					GL_UNSIGNED_INT,
+					(void*)(sizeof(unsigned int) * subMesh.BaseIndex),
+					1,
+					subMesh.BaseVertex,
+					slot);
+			}
+			else
+			{
+				gl->DrawArraysInstancedBaseInstance(renderMode, 0, subMesh.NumVertices, 1, slot);
+			}
+			continue;
+		}
+
+		if (item.instances > 0)
+		{
+			gl->DrawElementsInstancedBaseVertex(
+				renderMode,
+				subMesh.NumIndices,
+				GL_UNSIGNED_INT,
+				(void*)(sizeof(unsigned int) * subMesh.BaseIndex),
+				item.instances,
+				subMesh.BaseVertex);
+			continue;
+		}
+
+		if (subMesh.NumIndices > 0)
+		{
+			gl->DrawElementsBaseVertex(
+				renderMode,
+				subMesh.NumIndices,
+				GL_UNSIGNED_INT,
+				(void*)(sizeof(unsigned int) * subMesh.BaseIndex),
+				subMesh.BaseVertex);
+		}
+		else
+		{
+			gl->DrawArrays(renderMode, 0, subMesh.NumVertices);
+		}
+	}
+
+	if (objectIdsBound)
+		m_ObjectData->UnbindIdAttribute();
+
+	if (instanceBase >= 0)
+		m_InstanceBatcher->UnbindInstanceAttributes();
+
+	if (vao)
+		gl->BindVertexArray(0);
+}
+
+void Renderer::renderAnimMesh(AnimMesh* thisMesh, Animator* anim)
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	// Expects the mesh vao to be bound, points the attributes at the current and next frames
+	int iTotalOffset = 0;
+
+	// Change vertices pointers to current frame
+	gl->EnableVertexAttribArray(0);
+	gl->BindBuffer(GL_ARRAY_BUFFER, thisMesh->m_AnimData[anim->m_AnimState.curr_frame].vbo);
+	gl->VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), 0);
+
+	// Next position
+	gl->EnableVertexAttribArray(3);
+	gl->BindBuffer(GL_ARRAY_BUFFER, thisMesh->m_AnimData[anim->m_AnimState.next_frame].vbo);
+	gl->VertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), 0);
+
+	// Change normal pointers to current frame
+	gl->EnableVertexAttribArray(2);
+	gl->BindBuffer(GL_ARRAY_BUFFER, thisMesh->m_AnimData[anim->m_AnimState.curr_frame].vbo);
+	gl->VertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), 0);
+
+	// Next norm
+	gl->EnableVertexAttribArray(4);
+	gl->BindBuffer(GL_ARRAY_BUFFER, thisMesh->m_AnimData[anim->m_AnimState.next_frame].vbo);
+	gl->VertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(Vec3), 0);
+
+	for (int i = 0; i < thisMesh->m_RenderModes.size(); ++i)
 	{
-		++m_CullCount;
+		gl->DrawArrays(thisMesh->m_RenderModes[i], iTotalOffset, thisMesh->m_NumRenderVertices[i]);
+		iTotalOffset += thisMesh->m_NumRenderVertices[i];
 	}
 }
 
 void Renderer::renderSkybox(BaseCamera* cam)
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	if(m_ShadingMode == ShadingMode::Deferred)
-		glEnable(GL_DEPTH_TEST);
+		gl->Enable(GL_DEPTH_TEST);
 	
 	// Use skybox material
 	m_ResManager->m_Shaders[SHADER_SKYBOX_ANY]->Use();
@@ -981,20 +1872,20 @@ void Renderer::renderSkybox(BaseCamera* cam)
 	if (!sb)
 		return;
 
-	// States
+	// States, these reads are answered by the state cache rather than the driver
 	GLint oldCullMode, oldDepthFunc;
-	glGetIntegerv(GL_CULL_FACE_MODE, &oldCullMode);
-	glGetIntegerv(GL_DEPTH_FUNC, &oldDepthFunc);
-	glCullFace(GL_FRONT);
-	glDepthFunc(GL_LEQUAL);
+	gl->GetIntegerv(GL_CULL_FACE_MODE, &oldCullMode);
+	gl->GetIntegerv(GL_DEPTH_FUNC, &oldDepthFunc);
+	gl->CullFace(GL_FRONT);
+	gl->DepthFunc(GL_LEQUAL);
 
 	Mat4 model = glm::translate(IDENTITY, cam->Position())
 		* glm::scale(IDENTITY, Vec3(sb->scale));
 
-	m_ResManager->m_Shaders[SHADER_SKYBOX_ANY]->SetUniformValue<Mat4>("world_xform", &(model));
+	m_ResManager->m_Shaders[SHADER_SKYBOX_ANY]->SetUniformValue<Mat4>(UNIFORM_ID("world_xform"), &(model));
 
 	// Render mesh with texture here, THIS SHOULDNT BE HERE
-	glBindVertexArray(m_ResManager->m_Meshes[MESH_ID_CUBE]->m_VAO);
+	gl->BindVertexArray(m_ResManager->m_Meshes[MESH_ID_CUBE]->m_VAO);
 	Texture* t = m_ResManager->m_Textures[sb->textureIndex];
 	if (t) t->Bind();
 
@@ -1005,7 +1896,7 @@ void Renderer::renderSkybox(BaseCamera* cam)
 
 		if (subMesh.NumIndices > 0)
 		{
-			glDrawElementsBaseVertex(GL_TRIANGLES,
+			gl->DrawElementsBaseVertex(GL_TRIANGLES,
 				subMesh.NumIndices,
 				GL_UNSIGNED_INT,
 				(void*)(sizeof(unsigned int) * subMesh.BaseIndex),
@@ -1013,17 +1904,17 @@ void Renderer::renderSkybox(BaseCamera* cam)
 		}
 		else
 		{
-			glDrawArrays(GL_TRIANGLES, 0, subMesh.NumVertices);
+			gl->DrawArrays(GL_TRIANGLES, 0, subMesh.NumVertices);
 		}
 	}
 
-	glBindVertexArray(0);
+	gl->BindVertexArray(0);
 
-	glCullFace(oldCullMode);
-	glDepthFunc(oldDepthFunc);
+	gl->CullFace(oldCullMode);
+	gl->DepthFunc(oldDepthFunc);
 
 	if(m_ShadingMode == ShadingMode::Deferred)
-		glDisable(GL_DEPTH_TEST);
+		gl->Disable(GL_DEPTH_TEST);
 }
 
 void Renderer::HandleEvent(Event* e)
@@ -1048,15 +1939,27 @@ void Renderer::HandleEvent(Event* e)
 
 void Renderer::sceneChange()
 {
-	glFlush();
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->Flush();
 
 	// Scene Graph will call this when a scene is changed, TODO : Needs to be only callable by that or an event
 	m_NumDirLightsInScene = -1;
 	m_NumPointLightsInScene = -1;
 	m_NumSpotLightsInScene = -1;
+	m_PointLights.clear();
+	m_SpotLights.clear();
+	m_LightsChanged = true;
+
+	// Cached strings may belong to a font the old scene loaded
+	m_Text->Clear();
 
 	m_CameraPtr = nullptr;
 
+	// Proxies left over would only be destroyed one by one next frame, start the new scene with an empty tree
+	m_SceneTree->Clear();
+	m_SceneProxies.clear();
+
 	// Reset blocks
 	for (auto i = m_UniformBlockManager->m_Blocks.begin(); i != m_UniformBlockManager->m_Blocks.end(); ++i)
 	{
@@ -1069,40 +1972,29 @@ void Renderer::windowSizeChanged(int w, int h)
 	// Reset the camera size
 	m_CameraPtr->SetAspect(static_cast<float>(w / h));
 
-	// Re init the G Buffer
-	if (m_Gbuffer)
-	{
-		m_Gbuffer->Init();
-	}
-
-	if (m_ShadowFB)
+	// The targets are all screen sized, the next frame makes them again at the new size
+	if (m_FrameGraph)
 	{
-		m_ShadowFB->Init(Screen::FrameBufferWidth(), Screen::FrameBufferHeight());
+		m_FrameGraph->ReleaseTextures();
 	}
 
 	// TODO : Anything else that depends on screen size
 }
 
-bool Renderer::setFrameBuffers()
+bool Renderer::createFrameGraph()
 {
-	if (!m_Gbuffer)
+	// The g-buffer and shadow map are transients of the graph, only made once a pass that uses them runs
+	if (!m_FrameGraph)
 	{
-		m_Gbuffer = new GBuffer();
+		m_FrameGraph = new FrameGraph();
 	}
 
-	if (!m_Gbuffer->Init())
+	if (!m_FrameGraph->Init())
 	{
-		WRITE_LOG("Gbuffer load failed", "error");
+		WRITE_LOG("Frame graph init failed", "error");
 		return false;
-	}	
-
-	if (!m_ShadowFB)
-	{
-		m_ShadowFB = new ShadowFrameBuffer();
 	}
 
-	m_ShadowFB->Init(Screen::FrameBufferWidth(), Screen::FrameBufferHeight());
-
 	return true;
 }
 
@@ -1119,9 +2011,23 @@ bool Renderer::setStaticDefaultShaderValues()
 	if (lsp)
 	{
 		lsp->Use();
-		lsp->SetUniformValue<int>("u_sampler", &sampler);
-		lsp->SetUniformValue<int>("u_shadow_sampler", &shadow_sampler);
-		lsp->SetUniformValue<int>("u_normal_sampler", &normal_sampler);
+		lsp->SetUniformValue<int>(UNIFORM_ID("u_sampler"), &sampler);
+		lsp->SetUniformValue<int>(UNIFORM_ID("u_shadow_sampler"), &shadow_sampler);
+		lsp->SetUniformValue<int>(UNIFORM_ID("u_normal_sampler"), &normal_sampler);
+	}
+	else
+	{
+		return false;
+	}
+
+	// Forward lighting, instanced
+	ShaderProgram* ilsp = m_ResManager->GetShader(SHADER_LIGHTING_FWD_INSTANCED);
+	if (ilsp)
+	{
+		ilsp->Use();
+		ilsp->SetUniformValue<int>(UNIFORM_ID("u_sampler"), &sampler);
+		ilsp->SetUniformValue<int>(UNIFORM_ID("u_shadow_sampler"), &shadow_sampler);
+		ilsp->SetUniformValue<int>(UNIFORM_ID("u_normal_sampler"), &normal_sampler);
 	}
 	else
 	{
@@ -1133,7 +2039,19 @@ bool Renderer::setStaticDefaultShaderValues()
 	if (shadow)
 	{
 		shadow->Use();
-		shadow->SetUniformValue<int>("u_shadow_sampler", &shadow_sampler);
+		shadow->SetUniformValue<int>(UNIFORM_ID("u_shadow_sampler"), &shadow_sampler);
+	}
+	else
+	{
+		return false;
+	}
+
+	// Shadow, instanced
+	ShaderProgram* ishadow = m_ResManager->GetShader(SHADER_SHADOW_INSTANCED);
+	if (ishadow)
+	{
+		ishadow->Use();
+		ishadow->SetUniformValue<int>(UNIFORM_ID("u_shadow_sampler"), &shadow_sampler);
 	}
 	else
 	{
@@ -1146,9 +2064,9 @@ bool Renderer::setStaticDefaultShaderValues()
 	{
 		anim->Use();
 
-		anim->SetUniformValue<int>("u_sampler", &sampler);
-		anim->SetUniformValue<int>("u_shadow_sampler", &shadow_sampler);
-		anim->SetUniformValue<int>("u_normal_sampler", &normal_sampler);
+		anim->SetUniformValue<int>(UNIFORM_ID("u_sampler"), &sampler);
+		anim->SetUniformValue<int>(UNIFORM_ID("u_shadow_sampler"), &shadow_sampler);
+		anim->SetUniformValue<int>(UNIFORM_ID("u_normal_sampler"), &normal_sampler);
 	}
 	else
 	{
@@ -1160,7 +2078,7 @@ bool Renderer::setStaticDefaultShaderValues()
 	if (bill)
 	{
 		bill->Use();
-		bill->SetUniformValue<int>("u_TextureMap", &sampler);
+		bill->SetUniformValue<int>(UNIFORM_ID("u_TextureMap"), &sampler);
 	}
 	else
 	{
@@ -1172,7 +2090,7 @@ bool Renderer::setStaticDefaultShaderValues()
 	if(ds_geom)
 	{
 		ds_geom->Use();
-		ds_geom->SetUniformValue<int>("u_ColourMap", &sampler);
+		ds_geom->SetUniformValue<int>(UNIFORM_ID("u_ColourMap"), &sampler);
 	}
 	else
 	{
@@ -1181,19 +2099,19 @@ bool Renderer::setStaticDefaultShaderValues()
 	
 	// For deferred samplers
 	Vec2 screenSize((float)Screen::FrameBufferWidth(), (float)Screen::FrameBufferHeight());
-	int p = (int)GBuffer::TexTypes::Position;
-	int d = (int)GBuffer::TexTypes::Diffuse;
-	int n = (int)GBuffer::TexTypes::Normal;
+	int p = GBUFFER_POSITION_SAMPLER - GL_TEXTURE0;
+	int d = GBUFFER_DIFFUSE_SAMPLER - GL_TEXTURE0;
+	int n = GBUFFER_NORMAL_SAMPLER - GL_TEXTURE0;
 	
 	// Deferred point light
 	ShaderProgram* ds_pt = m_ResManager->GetShader(SHADER_POINT_LIGHT_PASS_DEF);
 	if (ds_pt)
 	{
 		ds_pt->Use();
-		ds_pt->SetUniformValue<int>("u_PositionMap", &p);
-		ds_pt->SetUniformValue<int>("u_ColourMap", &d);
-		ds_pt->SetUniformValue<int>("u_NormalMap", &n);
-		ds_pt->SetUniformValue<Vec2>("u_ScreenSize", &screenSize);
+		ds_pt->SetUniformValue<int>(UNIFORM_ID("u_PositionMap"), &p);
+		ds_pt->SetUniformValue<int>(UNIFORM_ID("u_ColourMap"), &d);
+		ds_pt->SetUniformValue<int>(UNIFORM_ID("u_NormalMap"), &n);
+		ds_pt->SetUniformValue<Vec2>(UNIFORM_ID("u_ScreenSize"), &screenSize);
 	}
 	else
 	{
@@ -1205,10 +2123,10 @@ bool Renderer::setStaticDefaultShaderValues()
 	if (ds_dl)
 	{
 		ds_dl->Use();
-		ds_dl->SetUniformValue<int>("u_PositionMap", &p);
-		ds_dl->SetUniformValue<int>("u_ColourMap", &d);
-		ds_dl->SetUniformValue<int>("u_NormalMap", &n);
-		ds_dl->SetUniformValue<Vec2>("u_ScreenSize", &screenSize);
+		ds_dl->SetUniformValue<int>(UNIFORM_ID("u_PositionMap"), &p);
+		ds_dl->SetUniformValue<int>(UNIFORM_ID("u_ColourMap"), &d);
+		ds_dl->SetUniformValue<int>(UNIFORM_ID("u_NormalMap"), &n);
+		ds_dl->SetUniformValue<Vec2>(UNIFORM_ID("u_ScreenSize"), &screenSize);
 	}
 	else
 	{
@@ -1232,7 +2150,8 @@ bool Renderer::createUniformBlocks()
 	names.push_back("view_xform");
 	names.push_back("proj_xform");
 	names.push_back("delta_time");
-	if (!m_UniformBlockManager->CreateBlock("scene", names))
+	// Rewritten every frame, so it streams through a mapped ring instead of waiting on the GPU
+	if (!m_UniformBlockManager->CreateBlock("scene", names, UniformBlockMode::Ring))
 	{
 		WRITE_LOG("The renderer can't create a default uniform block with name 'scene' have you used this name for custom block..", "error");
 		return false;
@@ -1242,45 +2161,42 @@ bool Renderer::createUniformBlocks()
 	//===================   Lights Block  ================================
 	names.clear();
 
-	// Dir Light
+	// Dir Light, point and spot lights live in shader storage buffers owned by the light clusterer
 	names.push_back("directionLight.direction");
 	names.push_back("directionLight.intensity");
-	
-	// Counters
-	names.push_back("numPoints");
-	names.push_back("numSpots");
 
-	// Point Lights
-	for (int i = 0; i < MAX_POINTS; ++i)
+	if (!m_UniformBlockManager->CreateBlock("Lights", names))
 	{
-		names.push_back("pointLights[" + std::to_string(i) + "].position");
-		names.push_back("pointLights[" + std::to_string(i) + "].intensity");
-		names.push_back("pointLights[" + std::to_string(i) + "].ambient_intensity");
-		names.push_back("pointLights[" + std::to_string(i) + "].aConstant");
-		names.push_back("pointLights[" + std::to_string(i) + "].aLinear");
-		names.push_back("pointLights[" + std::to_string(i) + "].aQuadratic");
+		WRITE_LOG("The renderer can't create a default uniform block with name 'Lights' have you used this name for custom block..", "error");
+		return false;
 	}
 
-	// Spot Lights
-	for (int i = 0; i < MAX_SPOTS; ++i)
+	return true;
+}
+
+bool Renderer::checkBlockLayouts()
+{
+	// The renderer and lights write these blocks as whole structs, so every member has to be where the struct puts it
+	bool success = true;
+
+	UniformBlock* scene = m_UniformBlockManager->GetBlock("scene");
+	if (scene && scene->IsBound())
 	{
-		names.push_back("spotLights[" + std::to_string(i) + "].position");
-		names.push_back("spotLights[" + std::to_string(i) + "].direction");
-		names.push_back("spotLights[" + std::to_string(i) + "].intensity");
-		names.push_back("spotLights[" + std::to_string(i) + "].coneAngle");
-		names.push_back("spotLights[" + std::to_string(i) + "].aConstant");
-		names.push_back("spotLights[" + std::to_string(i) + "].aLinear");
-		names.push_back("spotLights[" + std::to_string(i) + "].aQuadratic");
-		names.push_back("spotLights[" + std::to_string(i) + "].switched_on");
+		success &= scene->CheckOffset("proj_xform", offsetof(SceneBlockData, proj_xform));
+		success &= scene->CheckOffset("view_xform", offsetof(SceneBlockData, view_xform));
+		success &= scene->CheckOffset("camera_position", offsetof(SceneBlockData, camera_position));
+		success &= scene->CheckOffset("ambient_light", offsetof(SceneBlockData, ambient_light));
+		success &= scene->CheckOffset("delta_time", offsetof(SceneBlockData, delta_time));
 	}
 
-	if (!m_UniformBlockManager->CreateBlock("Lights", names))
+	UniformBlock* lights = m_UniformBlockManager->GetBlock("Lights");
+	if (lights && lights->IsBound())
 	{
-		WRITE_LOG("The renderer can't create a default uniform block with name 'Lights' have you used this name for custom block..", "error");
-		return false;
+		success &= lights->CheckOffset("directionLight.direction", offsetof(LightsBlockData, directionLight) + offsetof(DirectionLightData, direction));
+		success &= lights->CheckOffset("directionLight.intensity", offsetof(LightsBlockData, directionLight) + offsetof(DirectionLightData, intensity));
 	}
 
-	return true;
+	return success;
 }
 
 float Renderer::getFrameTime(TimeMeasure tm)
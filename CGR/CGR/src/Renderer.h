@@ -9,8 +9,14 @@
 #include "Time.h"
 #include "Colour.h"
 #include "FontAlign.h"
-#include "Queery.h"
 #include "EventHandler.h"
+#include "RenderQueue.h"
+#include "InstanceBatcher.h"
+#include "Frustum.h"
+#include "DynamicAABBTree.h"
+#include "Lights.h"
+#include "BlockLayouts.h"
+#include "BillboardList.h"
 
 // Forward
 class ResourceManager;
@@ -20,19 +26,49 @@ class BaseCamera;
 class Font;
 class Texture;
 class BillboardList;
-class GBuffer;
 class GameObject;
 class ShaderProgram;
-class ShadowFrameBuffer;
+class FrameGraph;
+class GpuTimers;
 class UniformBlockManager;
-class Frustum;
 class AnimMesh;
 class Animator;
+class JobSystem;
+class OcclusionCuller;
+class LightClusterer;
+class LightVolumeBatcher;
+class ObjectDataBuffer;
+class TextBatcher;
+struct Material;
+struct WorldSphere;
 
-struct DeferredPointLightInfo
+// What one queueing job produces, merged into the render queue on the render thread
+struct QueueJobOutput
 {
-	Vec3 pos;
-	float range;
+	std::vector<RenderItem>			items;
+	std::vector<InstanceCandidate>	instances;
+	int								cullCount;
+
+	// Scratch for the batch frustum test
+	SphereArrays					spheres;
+	std::vector<uint32>				visible;
+};
+
+// Who a scene tree proxy belongs to, the owner is only compared and never followed
+struct SceneProxy
+{
+	const MeshRenderer*	owner;
+	uint32				frame;
+};
+
+// CPU milliseconds the last Render spent in each stage
+struct RenderStageTimes
+{
+	double	prepare;	// Scene block and uniform upload
+	double	gather;
+	double	cull;		// Frustum, tree and occlusion
+	double	lights;
+	double	passes;		// Building and running the frame graph
 };
 
 enum ShadingMode
@@ -58,7 +94,9 @@ public:
 
 	// Public Rendering
 	void					Render(std::vector<GameObject*>& gameObjects, bool withShadows = false);
+	// Text is queued and drawn in one batch by FlushText, call that once all of the frame's text has been added
 	void					RenderText(size_t fontId, const std::string& txt, float x, float y, FontAlign fa = FontAlign::Left, const Colour& col = Colour::White());
+	void					FlushText();
 	void					RenderBillboardList(BillboardList* billboard);
 
 	// Reload
@@ -66,12 +104,16 @@ public:
 
 	// Get Resources
 	ResourceManager* const	GetResourceManager() const;
+	// Per pass GPU times and their history, recorded while frames are being queried
+	const GpuTimers* const	GetGpuTimers() const;
+	const RenderStageTimes&	GetStageTimes() const;
 
 	// Get Light info
 	int						GetDirLightIndex();
 	int						GetSpotLightIndex();
 	int						GetPointLightIndex();
-	void					UpdatePointLight(int index, const Vec3& position, float range);
+	void					UpdatePointLight(int index, const PointLightData& light);
+	void					UpdateSpotLight(int index, const SpotLightData& light);
 	void					UpdateDirLight(const Vec3& direction, const Vec3& range);
 
 	// Modes
@@ -92,17 +134,39 @@ public:
 	void					ToggleFrustumCulling();
 	void					SetFrustumCulling(bool should);
 
+	void					ToggleOcclusionCulling();
+	void					SetOcclusionCulling(bool should);
+
 	void					ToggleDisplayInfo();
 	void					SetDisplayInfo(bool should);
 
 private:
 	// Rendering
-	void forwardRenderShadows(std::vector<GameObject*>& gameObjects);
-	void forwardRender(std::vector<GameObject*>& gameObjects, bool withShadows = false);
-	void deferredRender(std::vector<GameObject*>& gameObjects);
+	void buildFrameGraph(bool withShadows);
+	void forwardRenderShadows();
+	void forwardRender(bool withShadows = false);
+	void deferredGeometryPass(GLenum finalAttachment);
+	void deferredDirLightPass(const Vec2& screenSize);
+	void gatherRenderables(std::vector<GameObject*>& gameObjects);
+	void updateSceneTree();
+	void buildOcclusion();
+	void buildLightClusters();
+	void queryScene(bool withShadows);
+	const std::vector<int>& passRenderables(RenderPass pass) const;
+	const Frustum* cullFrustum(RenderPass pass) const;
+	bool sphereVisible(RenderPass pass, const Vec3& centre, float radius) const;
+	const WorldSphere* worldBounds(const Renderable& r, Mesh* mesh, AnimMesh* animMesh);
+	size_t resolveRenderable(const Renderable& r, Mesh** mesh, AnimMesh** animMesh, const WorldSphere** bounds);
+	void queueRenderables(RenderPass pass);
+	void queueRange(RenderPass pass, const std::vector<int>& list, size_t begin, size_t end, QueueJobOutput& out);
+	void queueMesh(RenderPass pass, const Renderable* r, size_t shaderIndex, const std::map<unsigned, Material*>* materials, bool cull, QueueJobOutput& out,
+		const std::vector<uint32>* visibility = nullptr, size_t firstSphere = 0);
+	void queueInstances(RenderPass pass);
+	void writeObjectData(bool withShadows);
+	void drawQueue(bool withShadows);
 	void renderMesh(Mesh* mesh);
-	void renderMesh(MeshRenderer* mesh, const Mat4& world, bool withTextures, GLenum renderMode, bool shadow_pass);
-	void renderAnimMesh(MeshRenderer* mesh, Animator* anim, const Mat4& world, bool withTextures);
+	void renderPointLightVolumes(const Vec2& screenSize);
+	void renderAnimMesh(AnimMesh* mesh, Animator* anim);
 	void renderSkybox(BaseCamera* cam);
 
 	// Events
@@ -111,23 +175,47 @@ private:
 	void windowSizeChanged(int w, int h);
 
 	// Private init
-	bool setFrameBuffers();
+	bool createFrameGraph();
 	bool setStaticDefaultShaderValues();
 	bool createUniformBlocks();
+	bool checkBlockLayouts();
 	float getFrameTime(TimeMeasure tm);
 
 private:
-	std::vector<DeferredPointLightInfo>		m_PointsInfo;
+	std::vector<PointLightData>				m_PointLights;
+	std::vector<SpotLightData>				m_SpotLights;
+	LightClusterer*							m_LightClusters;
+	LightVolumeBatcher*						m_LightVolumes;
+	std::vector<Renderable>					m_Renderables;
+	RenderQueue*							m_RenderQueue;
+	InstanceBatcher*						m_InstanceBatcher;
+	ObjectDataBuffer*						m_ObjectData;
+	TextBatcher*							m_Text;
+	JobSystem*								m_Jobs;
+	std::vector<QueueJobOutput>				m_QueueJobs;
+	DynamicAABBTree*						m_SceneTree;
+	std::vector<SceneProxy>					m_SceneProxies;
+	std::vector<int>						m_AllRenderables;
+	std::vector<int>						m_CameraVisible;
+	std::vector<int>						m_LightVisible;
+	uint32									m_TreeNodesVisited;
+	Vec3									m_ShadowDir;
+	uint32									m_TreeFrame;
 	UniformBlockManager*					m_UniformBlockManager;
+	SceneBlockData							m_SceneData;
+	BillboardStats							m_BillboardStats;
+	RenderStageTimes						m_StageTimes;
 	ResourceManager*						m_ResManager;
 	BaseCamera*								m_CameraPtr;
-	GBuffer*								m_Gbuffer;
-	ShadowFrameBuffer*						m_ShadowFB;
+	FrameGraph*								m_FrameGraph;
+	GLuint									m_ShadowMap;
 	Frustum*								m_Frustum;
+	Frustum*								m_LightFrustum;
+	OcclusionCuller*						m_Occlusion;
 	GameObject*								m_LightCamObj;
 	BaseCamera*								m_LightCamera;
 	GLuint									m_QueryTime;
-	Query									m_Query;
+	GpuTimers*								m_GpuTimers;
 	std::string								m_HardwareStr;
 
 	int										m_NumDirLightsInScene;
@@ -142,6 +230,10 @@ private:
 	bool									m_ShouldDisplayNormals{ false };
 	bool									m_ShouldQueryFrames{ false };
 	bool									m_ShouldFrustumCull{ true };
+	bool									m_ShouldOcclusionCull{ true };
+	bool									m_OcclusionActive{ false };
+	bool									m_ShadowCull{ false };
+	bool									m_LightsChanged{ true };
 	bool									m_ShouldDisplayInfo{ true };
 	int										m_CullCount = 0;
 
@@ -152,4 +244,14 @@ INLINE ResourceManager* const Renderer::GetResourceManager() const
 	return m_ResManager;
 }
 
+INLINE const GpuTimers* const Renderer::GetGpuTimers() const
+{
+	return m_GpuTimers;
+}
+
+INLINE const RenderStageTimes& Renderer::GetStageTimes() const
+{
+	return m_StageTimes;
+}
+
 #endif
\ No newline at end of file
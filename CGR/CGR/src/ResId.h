@@ -57,13 +57,14 @@
 #define SHADER_GEOM_PASS_DEF			6
 #define SHADER_POINT_LIGHT_PASS_DEF		7
 #define SHADER_DIR_LIGHT_PASS_DEF		8
-#define SHADER_STENCIL_PASS_DEF		    9
 #define SHADER_LIGHTING_FWD			    10
 #define SHADER_NORMAL_DISP_FWD			11
 #define SHADER_FRUSTUM					12
 #define SHADER_SHADOW					13
 #define SHADER_ANIM						14
-#define SHADER_ID_COUNT					14
+#define SHADER_LIGHTING_FWD_INSTANCED	15
+#define SHADER_SHADOW_INSTANCED			16
+#define SHADER_ID_COUNT					16
 
 #define FONT_COURIER					0
 #define FONT_CONSOLA					1
@@ -8,16 +8,18 @@
 #include "Image.h"
 #include "ResId.h"
 #include "Screen.h"
-#include "GBuffer.h"
 #include "Font.h"
+#include "GlyphAtlas.h"
 #include "UniformBlockManager.h"
 #include "Material.h"
 #include "AnimMesh.h"
+#include "Profiler.h"
 
 const ShaderAttrib POS_ATTR{ 0, "vertex_position" };
 const ShaderAttrib NORM_ATTR{ 1, "vertex_normal" };
 const ShaderAttrib TEX_ATTR{ 2, "vertex_texcoord" };
 const ShaderAttrib TAN_ATTR{ 3, "vertex_tangent" };
+const ShaderAttrib COL_ATTR{ 1, "vertex_colour" };
 
 void closeShaders(std::vector<Shader>& shaders)
 {
@@ -28,9 +30,23 @@ void closeShaders(std::vector<Shader>& shaders)
 }
 
 
+ResourceManager::ResourceManager() :
+	m_Materials(),
+	m_Shaders(),
+	m_Textures(),
+	m_Meshes(),
+	m_AnimMeshes(),
+	m_Fonts(),
+	m_Glyphs(nullptr),
+	m_Jobs(nullptr)
+{
+}
+
 // ---- Resource Creation functions : will  be store in this ----
 bool ResourceManager::LoadFont(const std::string& path, size_t key, int size)
 {
+	PROFILE_ZONE("ResourceManager::LoadFont");
+
 	if (m_Fonts.find(key) != m_Fonts.end())
 	{
 		WRITE_LOG("Font already exists", "error");
@@ -39,7 +55,7 @@ bool ResourceManager::LoadFont(const std::string& path, size_t key, int size)
 
 	Font* m_Font = new Font();
 	m_Fonts[key] = m_Font;
-	if (!m_Font->CreateFont(path, size))
+	if (!m_Font->CreateFont(m_Glyphs, path, size))
 	{
 		WRITE_LOG("FONT LOAD FAIL", "error");
 		return false;
@@ -50,6 +66,8 @@ bool ResourceManager::LoadFont(const std::string& path, size_t key, int size)
 
 bool ResourceManager::LoadMesh(const std::string& path, size_t key_store, bool tangents, bool withTextures, unsigned materialSet)
 {
+	PROFILE_ZONE("ResourceManager::LoadMesh");
+
 	if (m_Meshes.find(key_store) != m_Meshes.end())
 	{
 		WRITE_LOG("Tried to use same mesh key twice", "error");
@@ -69,6 +87,8 @@ bool ResourceManager::LoadMesh(const std::string& path, size_t key_store, bool t
 
 bool ResourceManager::LoadAnimMesh(const std::string& path, size_t key_store, unsigned materialSet, bool flipUvs)
 {
+	PROFILE_ZONE("ResourceManager::LoadAnimMesh");
+
 	if (m_AnimMeshes.find(key_store) != m_AnimMeshes.end())
 	{
 		WRITE_LOG("Tried to use same anim mesh key twice", "error");
@@ -108,6 +128,8 @@ bool ResourceManager::CreateMesh(size_t key_store, const std::vector<Vertex>& ve
 
 bool ResourceManager::LoadTexture(const std::string& path, size_t key_store, int glTextureIndex)
 {
+	PROFILE_ZONE("ResourceManager::LoadTexture");
+
 	Image i;
 	std::string full_path = path;
 	if (!i.LoadImg(full_path.c_str()))
@@ -136,6 +158,8 @@ bool ResourceManager::LoadTexture(const std::string& path, size_t key_store, int
 
 bool ResourceManager::LoadCubeMap(std::string path[6], size_t key_store, int glTextureIndex)
 {
+	PROFILE_ZONE("ResourceManager::LoadCubeMap");
+
 	// Load Images for skybox
 	Image* images[6];
 	Image i0;
@@ -422,7 +446,7 @@ AnimMesh* ResourceManager::LoadAndGetAnimMesh(const std::string& path, unsigned
 Font* ResourceManager::LoadAndGetFont(const std::string& path, int size)
 {
 	Font* font = new Font();
-	if (!font->CreateFont(path, size))
+	if (!font->CreateFont(m_Glyphs, path, size))
 	{
 		SAFE_CLOSE(font);
 		WRITE_LOG("FONT LOAD FAIL", "error");
@@ -441,6 +465,12 @@ bool ResourceManager::createDefaultResources()
 	success &= this->loadDefaultDeferredShaders();
 	success &= this->loadDefaultTextures();
 	success &= this->loadDefaultMeshes();
+
+	// Every font shares the one atlas, glyph fields are built on the renderer's job threads
+	if (!m_Glyphs)
+		m_Glyphs = new GlyphAtlas();
+
+	success &= m_Glyphs->Init(m_Jobs);
 	success &= this->loadDefaultFonts();
 	return success;
 }
@@ -574,7 +604,7 @@ bool ResourceManager::loadDefaultForwardShaders()
 		Shader vert(GL_VERTEX_SHADER);
 		Shader fwd_fs(GL_FRAGMENT_SHADER);
 
-		if (!vert.LoadShader("../resources/shaders/new_lights/forward_geom_vs.glsl"))
+		if (!vert.LoadShader("../resources/shaders/new_lights/forward_geom_object_vs.glsl"))
 		{
 			WRITE_LOG("Forward Lighting vert shader failed compile", "error");
 			return false;
@@ -601,6 +631,38 @@ bool ResourceManager::loadDefaultForwardShaders()
 		}
 	}
 
+	// ---- Fwd lighting, instanced (Fwd) ----
+	{
+		Shader vert(GL_VERTEX_SHADER);
+		Shader fwd_fs(GL_FRAGMENT_SHADER);
+
+		if (!vert.LoadShader("../resources/shaders/new_lights/forward_geom_instanced_vs.glsl"))
+		{
+			WRITE_LOG("Forward Lighting instanced vert shader failed compile", "error");
+			return false;
+		}
+
+		if (!fwd_fs.LoadShader("../resources/shaders/new_lights/forward_lights_fs.glsl"))
+		{
+			WRITE_LOG("Fwd Lighting frag shader failed compile", "error");
+			return false;
+		}
+
+		vert.AddAttribute(POS_ATTR);
+		vert.AddAttribute(NORM_ATTR);
+		vert.AddAttribute(TEX_ATTR);
+
+		std::vector<Shader> shaders;
+		shaders.push_back(vert);
+		shaders.push_back(fwd_fs);
+
+		if (!this->CreateShaderProgram(shaders, SHADER_LIGHTING_FWD_INSTANCED))
+		{
+			WRITE_LOG("Shader program Link failure: forward lighting instanced", "error");
+			return false;
+		}
+	}
+
 	// ---- Anim ----
 	{
 		Shader vert(GL_VERTEX_SHADER);
@@ -674,6 +736,7 @@ bool ResourceManager::loadDefaultForwardShaders()
 		}
 
 		font_vert.AddAttribute(POS_ATTR);
+		font_vert.AddAttribute(COL_ATTR);
 
 		std::vector<Shader> shaders;
 		shaders.push_back(font_vert);
@@ -706,7 +769,7 @@ bool ResourceManager::loadDefaultForwardShaders()
 		// One off values
 		int texUnit = 0;
 		m_Shaders[SHADER_SKYBOX_ANY]->Use();
-		m_Shaders[SHADER_SKYBOX_ANY]->SetUniformValue<int>("cube_sampler", &texUnit);
+		m_Shaders[SHADER_SKYBOX_ANY]->SetUniformValue<int>(UNIFORM_ID("cube_sampler"), &texUnit);
 	}
 
 	// ---- Bill board (Fwd) ----
@@ -796,6 +859,27 @@ bool ResourceManager::loadDefaultForwardShaders()
 		}
 	}
 
+	// ---- Shadows, instanced (Fwd) ----
+	{
+		Shader vert(GL_VERTEX_SHADER);
+		Shader frag(GL_FRAGMENT_SHADER);
+		if (!vert.LoadShader("../resources/shaders/shadow/shadowmap_instanced_vs.glsl")) { return false; }
+		if (!frag.LoadShader("../resources/shaders/shadow/shadowmap_fs.glsl")) { return false; }
+		vert.AddAttribute(POS_ATTR);
+		vert.AddAttribute(NORM_ATTR);
+		vert.AddAttribute(TEX_ATTR);
+
+		std::vector<Shader> shaders;
+		shaders.push_back(vert);
+		shaders.push_back(frag);
+
+		if (!this->CreateShaderProgram(shaders, SHADER_SHADOW_INSTANCED))
+		{
+			WRITE_LOG("Shader program Link failure: shadows instanced", "error");
+			return false;
+		}
+	}
+
 	return true;
 }
 
@@ -826,8 +910,8 @@ bool ResourceManager::loadDefaultDeferredShaders()
 
 		m_Shaders[SHADER_LAVA_FWD]->Use();
 		int sampler = 0;
-		m_Shaders[SHADER_LAVA_FWD]->SetUniformValue<int>("u_Sampler", &sampler);
-		m_Shaders[SHADER_LAVA_FWD]->SetUniformValue<Vec2>("u_Resolution", &screenSize);
+		m_Shaders[SHADER_LAVA_FWD]->SetUniformValue<int>(UNIFORM_ID("u_Sampler"), &sampler);
+		m_Shaders[SHADER_LAVA_FWD]->SetUniformValue<Vec2>(UNIFORM_ID("u_Resolution"), &screenSize);
 	}
 	*/
 
@@ -852,30 +936,11 @@ bool ResourceManager::loadDefaultDeferredShaders()
 		}
 	}
 
-	// ---- Std Stencil Shader (Def) ----
+	// ---- Std Point Light Shader (Def), drawn instanced with a light per volume ----
 	{
 		Shader vert(GL_VERTEX_SHADER);
 		Shader frag(GL_FRAGMENT_SHADER);
-		if (!vert.LoadShader("../resources/shaders/deferred/stencil_pass_vs.glsl")) { return false; }
-		if (!frag.LoadShader("../resources/shaders/deferred/stencil_pass_fs.glsl")) { return false; }
-		vert.AddAttribute(POS_ATTR);
-
-		std::vector<Shader> shaders;
-		shaders.push_back(vert);
-		shaders.push_back(frag);
-
-		if (!this->CreateShaderProgram(shaders, SHADER_STENCIL_PASS_DEF))
-		{
-			WRITE_LOG("Shader program Link failure: Deferred stencil", "error");
-			return false;
-		}
-	}
-
-	// ---- Std Point Light Shader (Def) ----
-	{
-		Shader vert(GL_VERTEX_SHADER);
-		Shader frag(GL_FRAGMENT_SHADER);
-		if (!vert.LoadShader("../resources/shaders/deferred/light_pass_vs.glsl")) { return false; }
+		if (!vert.LoadShader("../resources/shaders/deferred/point_light_volume_vs.glsl")) { return false; }
 		if (!frag.LoadShader("../resources/shaders/deferred/point_light_pass_fs.glsl")) { return false; }
 		vert.AddAttribute(POS_ATTR);
 		vert.AddAttribute(NORM_ATTR);
@@ -964,6 +1029,8 @@ void ResourceManager::Close()
 		SAFE_CLOSE(i->second);
 	}
 	m_Fonts.clear();
+
+	SAFE_CLOSE(m_Glyphs);
 }
 
 
@@ -10,16 +10,25 @@
 #define NORMAL_MAP_SAMPLER		GL_TEXTURE2
 #define SHADOW_MAP_SAMPLER		GL_TEXTURE6
 
+// Units the deferred light passes read the g-buffer from
+#define GBUFFER_POSITION_SAMPLER	GL_TEXTURE0
+#define GBUFFER_DIFFUSE_SAMPLER		GL_TEXTURE1
+#define GBUFFER_NORMAL_SAMPLER		GL_TEXTURE2
+
 struct Material;
 class Texture;
 class Mesh;
 class AnimMesh;
 class Font;
+class GlyphAtlas;
+class JobSystem;
 class UniformBlockManager;
 
 class ResourceManager
 {
 public:
+	ResourceManager();
+
 	// ---- Load Functions: Will be stored in this ----
 	bool				LoadFont(const std::string& path, size_t key, int size);
 	bool				LoadMesh(const std::string& path, size_t key_store, bool tangents, bool withTextures, unsigned materialSet);
@@ -72,6 +81,8 @@ private:
 	std::map<size_t, Mesh*>								m_Meshes;
 	std::map<size_t, AnimMesh*>							m_AnimMeshes;
 	std::map<size_t, Font*>								m_Fonts;
+	GlyphAtlas*											m_Glyphs;
+	JobSystem*											m_Jobs;
 };
 
 #endif
\ No newline at end of file
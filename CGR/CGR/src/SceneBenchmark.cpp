@@ -0,0 +1,201 @@
+#include "SceneBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <cmath>
+#include <cstdio>
+
+#include "Application.h"
+#include "Renderer.h"
+#include "OpenGlLayer.h"
+#include "NullRenderDevice.h"
+#include "StateCacheDevice.h"
+#include "LogFile.h"
+#include "utils.h"
+
+typedef std::chrono::high_resolution_clock BenchClock;
+
+enum BenchStage
+{
+	STAGE_FRAME,
+	STAGE_UPDATE,
+	STAGE_RENDER,
+	STAGE_TEXT,
+	STAGE_RENDER_PREPARE,
+	STAGE_RENDER_GATHER,
+	STAGE_RENDER_CULL,
+	STAGE_RENDER_LIGHTS,
+	STAGE_RENDER_PASSES,
+	NUM_BENCH_STAGES
+};
+
+static const char* const STAGE_NAMES[NUM_BENCH_STAGES] =
+{
+	"frame",
+	"update",
+	"render",
+	"text",
+	"render.prepare",
+	"render.gather",
+	"render.cull",
+	"render.lights",
+	"render.passes"
+};
+
+static double elapsedMs(const BenchClock::time_point& start)
+{
+	return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+}
+
+// Nearest rank on sorted samples
+static double percentile(const std::vector<double>& sorted, double p)
+{
+	if (sorted.empty())
+		return 0.0;
+
+	const size_t rank = (size_t)std::ceil(p * sorted.size());
+	return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static StageTiming summarise(const char* name, std::vector<double>& samples)
+{
+	StageTiming timing = { name, 0.0, 0.0, 0.0, 0.0 };
+	if (samples.empty())
+		return timing;
+
+	std::sort(samples.begin(), samples.end());
+
+	double total = 0.0;
+	for (size_t i = 0; i < samples.size(); ++i)
+		total += samples[i];
+
+	timing.meanMs = total / samples.size();
+	timing.p50Ms = percentile(samples, 0.5);
+	timing.p99Ms = percentile(samples, 0.99);
+	timing.maxMs = samples.back();
+	return timing;
+}
+
+bool RunSceneBenchmark(Application* app, const std::string& scene, const SceneBenchmarkSettings& settings, SceneBenchmarkResult& result)
+{
+	result = SceneBenchmarkResult();
+	result.scene = scene;
+
+	if (!app || !app->GetRenderer() || settings.frames == 0 || settings.deltaTime <= 0.0f)
+		return false;
+
+	// Only the null device keeps the log the draws are counted from, it sits behind the state cache
+	RenderDevice* backend = OpenGLLayer::state_cache() ? OpenGLLayer::state_cache()->Device() : nullptr;
+	NullRenderDevice* nullDevice = backend && backend->Backend() == NullBackend ? static_cast<NullRenderDevice*>(backend) : nullptr;
+	if (!nullDevice)
+		WRITE_LOG("Scene benchmark isn't on the null device, draws and uploads won't be counted", "warning");
+
+	BenchClock::time_point start = BenchClock::now();
+	result.loaded = app->LoadScene(scene);
+	result.loadMs = elapsedMs(start);
+
+	if (!result.loaded)
+	{
+		WRITE_LOG("Scene benchmark could not load " + scene, "error");
+		return false;
+	}
+
+	for (uint32 i = 0; i < settings.warmupFrames; ++i)
+		app->StepFrame(settings.deltaTime);
+
+	// Sized up front so keeping the times allocates nothing in the frames being counted
+	std::vector<double> samples[NUM_BENCH_STAGES];
+	for (int s = 0; s < NUM_BENCH_STAGES; ++s)
+		samples[s].reserve(settings.frames);
+
+	size_t draws = 0;
+	size_t uploaded = 0;
+	uint64 allocations = 0;
+
+	for (uint32 i = 0; i < settings.frames; ++i)
+	{
+		if (nullDevice)
+			nullDevice->ClearLog();
+
+		const uint64 allocsBefore = settings.allocations ? settings.allocations() : 0;
+
+		FrameStageTimes frame;
+		app->StepFrame(settings.deltaTime, &frame);
+
+		if (settings.allocations)
+			allocations += settings.allocations() - allocsBefore;
+
+		const RenderStageTimes& render = app->GetRenderer()->GetStageTimes();
+		samples[STAGE_FRAME].push_back(frame.total);
+		samples[STAGE_UPDATE].push_back(frame.update);
+		samples[STAGE_RENDER].push_back(frame.render);
+		samples[STAGE_TEXT].push_back(frame.text);
+		samples[STAGE_RENDER_PREPARE].push_back(render.prepare);
+		samples[STAGE_RENDER_GATHER].push_back(render.gather);
+		samples[STAGE_RENDER_CULL].push_back(render.cull);
+		samples[STAGE_RENDER_LIGHTS].push_back(render.lights);
+		samples[STAGE_RENDER_PASSES].push_back(render.passes);
+
+		if (nullDevice)
+		{
+			draws += nullDevice->Count(CMD_DRAW);
+			uploaded += nullDevice->BytesUploaded();
+		}
+	}
+
+	result.frames = settings.frames;
+	for (int s = 0; s < NUM_BENCH_STAGES; ++s)
+		result.stages.push_back(summarise(STAGE_NAMES[s], samples[s]));
+
+	result.drawsPerFrame = (double)draws / settings.frames;
+	result.uploadKbPerFrame = (double)uploaded / 1024.0 / settings.frames;
+	result.allocationsPerFrame = (double)allocations / settings.frames;
+
+	const StageTiming& total = result.stages[STAGE_FRAME];
+	WRITE_LOG("Scene benchmark " + scene + ": load " + util::to_str(result.loadMs) + "ms, frame mean " + util::to_str(total.meanMs) +
+		"ms, p50 " + util::to_str(total.p50Ms) + "ms, p99 " + util::to_str(total.p99Ms) + "ms, draws " + util::to_str(result.drawsPerFrame) +
+		", allocations " + util::to_str(result.allocationsPerFrame) + " per frame", "info");
+
+	return true;
+}
+
+bool WriteSceneBenchmarkJson(const std::string& path, const SceneBenchmarkSettings& settings, const std::vector<SceneBenchmarkResult>& results)
+{
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+	if (!file.is_open())
+	{
+		WRITE_LOG("Could not write scene benchmark results: " + path, "error");
+		return false;
+	}
+
+	char line[512];
+	snprintf(line, sizeof(line), "{\"frames\":%u,\"warmupFrames\":%u,\"deltaTime\":%.6f,\"countsAllocations\":%s,\"scenes\":[\n",
+		settings.frames, settings.warmupFrames, settings.deltaTime, settings.allocations ? "true" : "false");
+	file << line;
+
+	for (size_t r = 0; r < results.size(); ++r)
+	{
+		const SceneBenchmarkResult& result = results[r];
+		snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"loaded\":%s,\"loadMs\":%.3f,\"frames\":%u,\"drawsPerFrame\":%.2f,\"uploadKbPerFrame\":%.2f,\"allocationsPerFrame\":%.2f,\"stages\":[",
+			r == 0 ? "" : ",\n", result.scene.c_str(), result.loaded ? "true" : "false", result.loadMs, result.frames,
+			result.drawsPerFrame, result.uploadKbPerFrame, result.allocationsPerFrame);
+		file << line;
+
+		for (size_t s = 0; s < result.stages.size(); ++s)
+		{
+			const StageTiming& stage = result.stages[s];
+			snprintf(line, sizeof(line), "%s\n\t{\"name\":\"%s\",\"meanMs\":%.4f,\"p50Ms\":%.4f,\"p99Ms\":%.4f,\"maxMs\":%.4f}",
+				s == 0 ? "" : ",", stage.name, stage.meanMs, stage.p50Ms, stage.p99Ms, stage.maxMs);
+			file << line;
+		}
+
+		file << "]}";
+	}
+
+	file << "\n]}\n";
+	file.close();
+
+	WRITE_LOG("Wrote scene benchmark results to " + path, "info");
+	return true;
+}
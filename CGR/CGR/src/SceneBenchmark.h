@@ -0,0 +1,52 @@
+#ifndef __SCENE_BENCHMARK_H__
+#define __SCENE_BENCHMARK_H__
+
+#include <string>
+#include <vector>
+#include "types.h"
+
+class Application;
+
+// Allocations made so far, counted by whoever replaces operator new
+typedef uint64 (*AllocationCounter)();
+
+struct SceneBenchmarkSettings
+{
+	uint32				frames;
+	uint32				warmupFrames;	// Run first and left out, pools and caches settle over these
+	float				deltaTime;		// Every frame gets the same step so runs animate the same
+	AllocationCounter	allocations;	// Null leaves allocations out
+};
+
+struct StageTiming
+{
+	const char*	name;
+	double		meanMs;
+	double		p50Ms;
+	double		p99Ms;
+	double		maxMs;
+};
+
+struct SceneBenchmarkResult
+{
+	std::string					scene;
+	bool						loaded;
+	double						loadMs;
+	uint32						frames;
+	std::vector<StageTiming>	stages;			// The whole frame first, then the application and renderer stages
+	double						drawsPerFrame;
+	double						uploadKbPerFrame;
+	double						allocationsPerFrame;
+};
+
+/*
+	Loads a scene and runs it for a fixed number of frames at a fixed step, timing each stage of every frame
+	on the CPU. Meant for the null render device, whose command log gives the draws and uploads each frame
+	issues, so the times are the engine's own with no driver or GPU in them. Results are written to the log.
+*/
+bool RunSceneBenchmark(Application* app, const std::string& scene, const SceneBenchmarkSettings& settings, SceneBenchmarkResult& result);
+
+// One object per scene, times in milliseconds
+bool WriteSceneBenchmarkJson(const std::string& path, const SceneBenchmarkSettings& settings, const std::vector<SceneBenchmarkResult>& results);
+
+#endif
@@ -5,6 +5,7 @@
 #include "EventManager.h"
 #include "utils.h"
 #include "Renderer.h"
+#include "Profiler.h"
 
 SceneGraph::SceneGraph() :
 	m_Scenes(),
@@ -28,11 +29,15 @@ IScene* SceneGraph::GetActiveScene()
 
 void SceneGraph::UpdateActiveScene(float dt)
 {
+	PROFILE_ZONE("SceneGraph::UpdateActiveScene");
+
 	m_Scenes[m_ActiveScene]->Update(dt);
 }
 
 void SceneGraph::RenderActiveScene(int withUI)
 {
+	PROFILE_ZONE("SceneGraph::RenderActiveScene");
+
 	m_Scenes[m_ActiveScene]->Render();
 
 	if (withUI)
@@ -68,6 +73,8 @@ void SceneGraph::ChangeScene(int newState, ResourceManager* resManager)
 		EventManager::Instance()->SendEvent(EVENT_SCENE_CHANGE, nullptr);
 	}
 
+	PROFILE_ZONE("OnSceneLoad");
+
 	if (m_Scenes[m_ActiveScene]->OnSceneLoad(resManager) != GE_OK)
 	{
 		// Error event
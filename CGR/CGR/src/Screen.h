@@ -16,6 +16,7 @@ public:
 
 private:
 	friend class	RenderWindow;
+	friend class	Application;
 	static int		m_ScreenWidth;
 	static int		m_ScreenHeight;
 	static int		m_FrameBuffWidth;
@@ -6,8 +6,10 @@
 
 
 ShaderProgram::ShaderProgram() :
-	m_ShaderProgram(0),
-	m_Uniforms()
+	m_Uniforms(),
+	m_UniformNames(),
+	m_Shaders(),
+	m_ShaderProgram(0)
 {
 }
 
@@ -17,8 +19,10 @@ ShaderProgram::~ShaderProgram()
 
 bool ShaderProgram::CreateProgram(const std::vector<Shader>& shaders, const std::string& fragout_identifier, GLuint frag_loc)
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	// Link shaders
-	m_ShaderProgram = glCreateProgram();
+	m_ShaderProgram = gl->CreateProgram();
 
 	std::vector<Shader>::const_iterator it;
 	bool has_fragment_shader = false;
@@ -28,11 +32,11 @@ bool ShaderProgram::CreateProgram(const std::vector<Shader>& shaders, const std:
 		if (it->m_ShaderType == GL_FRAGMENT_SHADER)
 			has_fragment_shader = true;
 
-		glAttachShader(m_ShaderProgram, (*it).m_Shader);
+		gl->AttachShader(m_ShaderProgram, (*it).m_Shader);
 
 		for (size_t j = 0; j < (*it).m_Attributes.size(); ++j)
 		{
-			glBindAttribLocation(m_ShaderProgram, (*it).m_Attributes[j].layout_location,
+			gl->BindAttribLocation(m_ShaderProgram, (*it).m_Attributes[j].layout_location,
 				(*it).m_Attributes[j].name.c_str());
 
 			if (OpenGLLayer::check_GL_error())
@@ -46,7 +50,7 @@ bool ShaderProgram::CreateProgram(const std::vector<Shader>& shaders, const std:
 	// Bind Frag
 	if (has_fragment_shader)
 	{
-		glBindFragDataLocation(m_ShaderProgram, frag_loc, fragout_identifier.c_str());
+		gl->BindFragDataLocation(m_ShaderProgram, frag_loc, fragout_identifier.c_str());
 		if (OpenGLLayer::check_GL_error())
 		{
 			WRITE_LOG("Error: binding frag data location in shader", "error");
@@ -54,16 +58,16 @@ bool ShaderProgram::CreateProgram(const std::vector<Shader>& shaders, const std:
 		}
 	}
 
-	glLinkProgram(m_ShaderProgram);
+	gl->LinkProgram(m_ShaderProgram);
 
 	GLint link_status = 0;
-	glGetProgramiv(m_ShaderProgram, GL_LINK_STATUS, &link_status);
+	gl->GetProgramiv(m_ShaderProgram, GL_LINK_STATUS, &link_status);
 
 	if (link_status != GL_TRUE)
 	{
 		const int string_length = 1024;
 		GLchar log[string_length] = "";
-		glGetProgramInfoLog(m_ShaderProgram, string_length, NULL, log);
+		gl->GetProgramInfoLog(m_ShaderProgram, string_length, NULL, log);
 		std::stringstream logger;
 		logger << log << std::endl;
 		WRITE_LOG(logger.str(), "error");
@@ -72,13 +76,13 @@ bool ShaderProgram::CreateProgram(const std::vector<Shader>& shaders, const std:
 
 	// -- Look for uniform blocks and loop through count
 	int uniform_block_total = -1;
-	glGetProgramiv(m_ShaderProgram, GL_ACTIVE_UNIFORM_BLOCKS, &uniform_block_total);
+	gl->GetProgramiv(m_ShaderProgram, GL_ACTIVE_UNIFORM_BLOCKS, &uniform_block_total);
 	for (int i = 0; i < uniform_block_total; ++i)
 	{
 		// Resolve name of this uniform block
 		char name[100];
 		int name_len = -1;
-		glGetActiveUniformBlockName(m_ShaderProgram,
+		gl->GetActiveUniformBlockName(m_ShaderProgram,
 			GLuint(i),
 			sizeof(name) - 1,
 			&name_len,
@@ -117,9 +121,26 @@ bool ShaderProgram::CreateProgram(const std::vector<Shader>& shaders, const std:
 		}
 	}
 
+	if (!this->resolveUniforms())
+		return false;
+
+	// Keep these in-case want to reload
+	m_Shaders = shaders;
+
+	return true;
+}
+
+bool ShaderProgram::resolveUniforms()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	// Anything this link doesn't find is left pointing nowhere, GL ignores location -1
+	for (auto u = m_Uniforms.begin(); u != m_Uniforms.end(); ++u)
+		u->second->Relink(-1, u->second->m_UType);
+
 	// Populate m_Uniforms
 	int total = -1;
-	glGetProgramiv(m_ShaderProgram, GL_ACTIVE_UNIFORMS, &total);
+	gl->GetProgramiv(m_ShaderProgram, GL_ACTIVE_UNIFORMS, &total);
 
 	for (int i = 0; i < total; ++i)
 	{
@@ -127,7 +148,7 @@ bool ShaderProgram::CreateProgram(const std::vector<Shader>& shaders, const std:
 		GLenum type = GL_ZERO;
 		char name[100];
 
-		glGetActiveUniform(
+		gl->GetActiveUniform(
 			m_ShaderProgram,
 			GLuint(i),
 			sizeof(name) - 1,
@@ -137,7 +158,7 @@ bool ShaderProgram::CreateProgram(const std::vector<Shader>& shaders, const std:
 			name);
 
 		name[name_len] = 0;
-		GLuint location = glGetUniformLocation(m_ShaderProgram, name);
+		GLuint location = gl->GetUniformLocation(m_ShaderProgram, name);
 
 		// Check not a uniform block
 		UniformBlockManager* ubm = UniformBlockManager::Instance();
@@ -145,19 +166,30 @@ bool ShaderProgram::CreateProgram(const std::vector<Shader>& shaders, const std:
 		{
 			if (!ubm->CheckBlockUniformExists(name))
 			{
-				// Check it doesn't exist here
-				if (m_Uniforms.find(name) == m_Uniforms.end())
+				UniformId id = hash(name);
+
+				auto known = m_UniformNames.find(id);
+				if (known != m_UniformNames.end() && known->second != name)
 				{
-					Uniform* ufm = new Uniform(location, (UniformTypes)type);
-					m_Uniforms[name] = ufm;
+					WRITE_LOG("Uniform " + std::string(name) + " hashes the same as " + known->second + ", rename one of them", "error");
+					return false;
+				}
+
+				// Reloads find the uniforms already made, they just move to the new location
+				auto u = m_Uniforms.find(id);
+				if (u == m_Uniforms.end())
+				{
+					m_Uniforms[id] = new Uniform(location, (UniformTypes)type);
+					m_UniformNames[id] = name;
+				}
+				else
+				{
+					u->second->Relink(location, (UniformTypes)type);
 				}
 			}
 		}
 	}
 
-	// Keep these in-case want to reload
-	m_Shaders = shaders;
-
 	return true;
 }
 
@@ -175,12 +207,32 @@ bool ShaderProgram::Reload()
 		temp_shaders.push_back(*shader);
 	}
 
-	return this->CreateProgram(temp_shaders, "frag_colour", 0);
+	GLuint oldProgram = m_ShaderProgram;
+	if (!this->CreateProgram(temp_shaders, "frag_colour", 0))
+	{
+		OpenGLLayer::clean_GL_program(&m_ShaderProgram);
+		m_ShaderProgram = oldProgram;
+		return false;
+	}
+
+	OpenGLLayer::clean_GL_program(&oldProgram);
+
+	// The new program starts with default values, give it back what the old one held
+	this->Use();
+	for (auto u = m_Uniforms.begin(); u != m_Uniforms.end(); ++u)
+		u->second->Resend();
+
+	return true;
 }
 
 Uniform* ShaderProgram::GetUniformByName(const std::string& name)
 {
-	auto i = m_Uniforms.find(name);
+	return this->GetUniform(hash(name.c_str()));
+}
+
+Uniform* ShaderProgram::GetUniform(UniformId id)
+{
+	auto i = m_Uniforms.find(id);
 	return ((i != m_Uniforms.end()) ? i->second : nullptr);
 }
 
@@ -197,6 +249,7 @@ void ShaderProgram::Close()
 	}
 
 	m_Uniforms.clear();
+	m_UniformNames.clear();
 
 	// Clean GL stuff
 	OpenGLLayer::clean_GL_program(&m_ShaderProgram);
@@ -204,5 +257,7 @@ void ShaderProgram::Close()
 
 void ShaderProgram::Use()
 {
-	glUseProgram(m_ShaderProgram);
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->UseProgram(m_ShaderProgram);
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include "Shader.h"
 #include "Uniform.h"
 
@@ -17,6 +18,9 @@ public:
 	ShaderProgram();
 	virtual ~ShaderProgram();
 
+	// Prefer the id overload with UNIFORM_ID("name"), the name overload hashes the string on every call
+	template<typename T>
+	void SetUniformValue(UniformId id, const T* v);
 	template<typename T>
 	void SetUniformValue(const std::string& name, const T* v);
 
@@ -26,19 +30,38 @@ public:
 	void Close();
 	bool CreateProgram(const std::vector<Shader>& shaders, const std::string& fragout_identifier, GLuint frag_loc);
 	Uniform* GetUniformByName(const std::string& name);
+	Uniform* GetUniform(UniformId id);
+
+private:
+	bool resolveUniforms();
 
 private:
-	friend class						Renderer;
-	std::map<std::string, Uniform*>		m_Uniforms;
-	std::vector<Shader>					m_Shaders;
-	GLuint								m_ShaderProgram;
+	friend class								Renderer;
+	// Uniforms stay put across reloads so ids and cached values keep working, only their locations change
+	std::unordered_map<UniformId, Uniform*>		m_Uniforms;
+	std::unordered_map<UniformId, std::string>	m_UniformNames;
+	std::vector<Shader>							m_Shaders;
+	GLuint										m_ShaderProgram;
 };
 
+template<typename T>
+void ShaderProgram::SetUniformValue(UniformId id, const T* v)
+{
+	auto i = m_Uniforms.find(id);
+	if (i != m_Uniforms.end())
+		i->second->SetValue<T>(v);
+#ifdef LOG_SHADER_ERRORS
+	else
+	{
+		WRITE_LOG("Shader error: uniform id " + std::to_string(id), "error");
+	}
+#endif
+}
+
 template<typename T>
 void ShaderProgram::SetUniformValue(const std::string& name, const T* v)
 {
-	//auto i = m_Uniforms.find(hash(name.c_str()));
-	auto i = m_Uniforms.find(name);
+	auto i = m_Uniforms.find(hash(name.c_str()));
 	if (i != m_Uniforms.end())
 		i->second->SetValue<T>(v);
 #ifdef LOG_SHADER_ERRORS
@@ -36,6 +36,8 @@ Shader::~Shader()
 
 bool Shader::LoadShader(const char* srcPath)
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	TextFile tf;
 	std::string shadersrc = tf.LoadFileIntoStr(srcPath);
 	if (shadersrc == "")
@@ -47,20 +49,20 @@ bool Shader::LoadShader(const char* srcPath)
 	const char* src = shadersrc.c_str();
 
 	// Ask openGL to create a shader of passed in type
-	m_Shader = glCreateShader(m_ShaderType);
+	m_Shader = gl->CreateShader(m_ShaderType);
 
 	// Ask OpenGL to attempt shader compilation
 	GLint compile_status = 0;
-	glShaderSource(m_Shader, 1, (const GLchar **)&src, NULL);
-	glCompileShader(m_Shader);
-	glGetShaderiv(m_Shader, GL_COMPILE_STATUS, &compile_status);
+	gl->ShaderSource(m_Shader, 1, (const GLchar **)&src, NULL);
+	gl->CompileShader(m_Shader);
+	gl->GetShaderiv(m_Shader, GL_COMPILE_STATUS, &compile_status);
 
 	if (compile_status != GL_TRUE)
 	{
 		// Log what went wrong in shader src
 		const int string_length = 1024;
 		GLchar log[string_length] = "";
-		glGetShaderInfoLog(m_Shader, string_length, NULL, log);
+		gl->GetShaderInfoLog(m_Shader, string_length, NULL, log);
 		std::stringstream logger;
 		logger << log << std::endl;
 		WRITE_LOG(logger.str(), "error");
@@ -95,6 +95,7 @@ int SponzaScene::OnSceneLoad(ResourceManager* resManager)
 		true,
 		false,
 		false);
+	m_SponzaMeshRen->SetOccluder(true);
 	m_GameObjects.push_back(sponza);
 
 	// Create some dragons
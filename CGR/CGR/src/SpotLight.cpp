@@ -1,15 +1,16 @@
 #include "SpotLight.h"
 
-#include "UniformBlockManager.h"
-#include "UniformBlock.h"
 #include "Renderer.h"
 #include "LogFile.h"
 
 int SpotLightC::m_Id = SPOT_LIGHT_COMPONENT;
 
+// Spots that hardly fade with distance are cut off here so their bounds stay finite
+#define MAX_SPOT_RANGE 10000.0f
+
 SpotLightC::SpotLightC(GameObject* owner) :
 	Component(owner),
-	m_LightBlock(nullptr),
+	m_Renderer(nullptr),
 	m_Position(),
 	m_Direction(),
 	m_Intensity(),
@@ -17,6 +18,8 @@ SpotLightC::SpotLightC(GameObject* owner) :
 	m_aConstant(0.0f),
 	m_aLinear(0.0f),
 	m_aQuadratic(0.0f),
+	m_Range(0.0f),
+	m_SwitchedOn(0),
 	m_LightIndex(-1),
 	m_LightValid(GE_FALSE)
 {
@@ -46,39 +49,19 @@ bool SpotLightC::SetLight(
 	int switchedOn
 	)
 {
-	if (!renderer)
+	m_Renderer = renderer;
+	if (!m_Renderer)
 	{
 		WRITE_LOG("Can't set a spot light without a renderer", "error");
 		return false;
 	}
 
-	UniformBlockManager* ubm = UniformBlockManager::Instance();
-	if (!ubm)
-	{
-		WRITE_LOG("Can't create spot light without uniform block manager, is the renderer created?", "error");
-		return false;
-	}
-
-	m_LightBlock = ubm->GetBlock("Lights");
-	if (!m_LightBlock)
-	{
-		WRITE_LOG("Can't create spot light without 'Lights' uniform blocks, is the renderer created?", "error");
-		return false;
-	}
-
-	if (!m_LightBlock->IsBound())
-	{
-		WRITE_LOG("Can't create spot light without 'Lights' uniform blocks being bound", "error");
-		m_LightBlock = nullptr;
-		return false;
-	}
-
-	m_LightIndex = renderer->GetSpotLightIndex();
+	m_LightIndex = m_Renderer->GetSpotLightIndex();
 
 	if (m_LightIndex < 0)
 	{
 		WRITE_LOG("Can't create spot light, exceeded max num spot lights", "warning");
-		m_LightBlock = nullptr;
+		m_Renderer = nullptr;
 		return false;
 	}
 
@@ -91,66 +74,82 @@ bool SpotLightC::SetLight(
 	m_aLinear = aLinear;
 	m_aQuadratic = aQuadratic;
 	m_LightValid = GE_TRUE;
+	m_Range = calcRange();
 
-	m_LightBlock->SetValue("spotLights[" + std::to_string(m_LightIndex) + "].position", &m_Position);
-	m_LightBlock->SetValue("spotLights[" + std::to_string(m_LightIndex) + "].direction", &m_Direction);
-	m_LightBlock->SetValue("spotLights[" + std::to_string(m_LightIndex) + "].intensity", &m_Intensity);
-	m_LightBlock->SetValue("spotLights[" + std::to_string(m_LightIndex) + "].coneAngle", &m_CosAngle);
-	m_LightBlock->SetValue("spotLights[" + std::to_string(m_LightIndex) + "].aConstant", &m_aConstant);
-	m_LightBlock->SetValue("spotLights[" + std::to_string(m_LightIndex) + "].aLinear", &m_aLinear);
-	m_LightBlock->SetValue("spotLights[" + std::to_string(m_LightIndex) + "].aQuadratic", &m_aQuadratic);
-	m_LightBlock->SetValue("spotLights[" + std::to_string(m_LightIndex) + "].switched_on", &m_SwitchedOn);
-
-	int num_spots = m_LightIndex + 1;
-	m_LightBlock->SetValue("numSpots", &num_spots);
+	updateLight();
 	return true;
 }
 
 void SpotLightC::SetPosition(const Vec3& pos)
 {
-	if (m_LightValid && m_LightBlock)
+	if (m_LightValid && m_Renderer)
 	{
 		m_Position = pos;
-		m_LightBlock->SetValue("spotLights[" + std::to_string(m_LightIndex) + "].position", &m_Position);
+		updateLight();
 	}
 }
 
 void SpotLightC::SetColour(const Vec3& col)
 {
-	if (m_LightValid && m_LightBlock)
+	if (m_LightValid && m_Renderer)
 	{
 		m_Intensity = col;
-		m_LightBlock->SetValue("spotLights[" + std::to_string(m_LightIndex) + "].intensity", &m_Intensity);
+		m_Range = calcRange();
+		updateLight();
 	}
 }
 
 void SpotLightC::SetDirection(const Vec3& dir)
 {
-	if (m_LightValid && m_LightBlock)
+	if (m_LightValid && m_Renderer)
 	{
 		m_Direction = dir;
-		m_LightBlock->SetValue("spotLights[" + std::to_string(m_LightIndex) + "].direction", &m_Direction);
+		updateLight();
 	}
 }
 
 void SpotLightC::SetAngle(float angle)
 {
-	if (m_LightValid && m_LightBlock)
+	if (m_LightValid && m_Renderer)
 	{
 		m_CosAngle = cosf(angle*3.1415f / 180.0f);
-		m_LightBlock->SetValue("spotLights[" + std::to_string(m_LightIndex) + "].coneAngle", &m_CosAngle);
+		updateLight();
 	}
 }
 
 void SpotLightC::ToggleLight()
 {
-	if (m_LightValid && m_LightBlock)
+	if (m_LightValid && m_Renderer)
 	{
 		if (m_SwitchedOn > 0)
 			m_SwitchedOn = 0;
 		else
 			m_SwitchedOn = 1;
 
-		m_LightBlock->SetValue("spotLights[" + std::to_string(m_LightIndex) + "].switched_on", &m_SwitchedOn);
+		updateLight();
 	}
 }
+
+float SpotLightC::calcRange()
+{
+	// The shader divides by distance * aLinear, past this the brightest channel is under 1/256
+	float maxChannel = fmax(fmax(m_Intensity.x, m_Intensity.y), m_Intensity.z);
+	return m_aLinear > 0.0f ? 256.0f * maxChannel / m_aLinear : MAX_SPOT_RANGE;
+}
+
+void SpotLightC::updateLight()
+{
+	SpotLightData light;
+	light.position = m_Position;
+	light.range = fmin(m_Range, MAX_SPOT_RANGE);
+	light.direction = m_Direction;
+	light.coneAngle = m_CosAngle;
+	light.intensity = m_Intensity;
+	light.switchedOn = m_SwitchedOn;
+	light.aConstant = m_aConstant;
+	light.aLinear = m_aLinear;
+	light.aQuadratic = m_aQuadratic;
+	light.pad = 0.0f;
+
+	m_Renderer->UpdateSpotLight(m_LightIndex, light);
+}
@@ -4,7 +4,6 @@
 #include "Component.h"
 #include "types.h"
 
-class UniformBlock;
 class Renderer;
 
 class SpotLightC : public Component
@@ -36,9 +35,13 @@ public:
 
 	static int GetId();
 
+private:
+	float calcRange();
+	void updateLight();
+
 private:
 	static int m_Id;
-	UniformBlock*	m_LightBlock;	//<-- Weak ptr
+	Renderer*		m_Renderer;		// <-- Weak ptr
 	Vec3			m_Position;
 	Vec3			m_Direction;
 	Vec3			m_Intensity;
@@ -46,6 +49,7 @@ private:
 	float			m_aLinear;
 	float			m_aQuadratic;
 	float			m_CosAngle;
+	float			m_Range;
 	int				m_SwitchedOn;
 	int				m_LightIndex;
 	int				m_LightValid;
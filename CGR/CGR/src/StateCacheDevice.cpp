@@ -0,0 +1,798 @@
+#include "StateCacheDevice.h"
+
+#include <cstring>
+
+static const GLuint UNKNOWN = 0xFFFFFFFF;
+
+StateCacheDevice::StateCacheDevice(RenderDevice* device) :
+	m_Device(device),
+	m_PassStats(),
+	m_PassStack()
+{
+	Invalidate();
+	BeginFrame();
+}
+
+StateCacheDevice::~StateCacheDevice()
+{
+	SAFE_DELETE(m_Device);
+}
+
+void StateCacheDevice::Invalidate()
+{
+	for (int i = 0; i < CAP_COUNT; ++i)
+		m_Caps[i] = -1;
+
+	for (int i = 0; i < STATE_CACHE_TEXTURE_UNITS; ++i)
+	{
+		m_Units[i].tex2D = UNKNOWN;
+		m_Units[i].cube = UNKNOWN;
+	}
+
+	m_Program = UNKNOWN;
+	m_VAO = UNKNOWN;
+	m_ActiveUnit = UNKNOWN;
+	m_CullFace = UNKNOWN;
+	m_DepthFunc = UNKNOWN;
+	m_DepthMask = -1;
+	m_BlendSrc = UNKNOWN;
+	m_BlendDst = UNKNOWN;
+	m_BlendEquation = UNKNOWN;
+	m_StencilFunc = UNKNOWN;
+	m_StencilRef = -1;
+	m_StencilMask = UNKNOWN;
+	m_StencilFront.sfail = m_StencilFront.dpfail = m_StencilFront.dppass = UNKNOWN;
+	m_StencilBack = m_StencilFront;
+	m_PolygonMode = UNKNOWN;
+}
+
+void StateCacheDevice::BeginFrame()
+{
+	m_FrameStats.issued = 0;
+	m_FrameStats.filtered = 0;
+
+	// Keep the entries, a pass that didn't run this frame just reads zero
+	for (auto p = m_PassStats.begin(); p != m_PassStats.end(); ++p)
+	{
+		p->second.issued = 0;
+		p->second.filtered = 0;
+	}
+}
+
+int StateCacheDevice::capIndex(GLenum cap) const
+{
+	switch (cap)
+	{
+	case GL_DEPTH_TEST:		return CAP_DEPTH_TEST;
+	case GL_CULL_FACE:		return CAP_CULL_FACE;
+	case GL_BLEND:			return CAP_BLEND;
+	case GL_STENCIL_TEST:	return CAP_STENCIL_TEST;
+	case GL_SCISSOR_TEST:	return CAP_SCISSOR_TEST;
+	default:				return -1;
+	}
+}
+
+bool StateCacheDevice::setEnabled(GLenum cap, int enabled)
+{
+	// Returns true if the call needs to reach the device
+	int i = capIndex(cap);
+	if (i < 0)
+		return true;
+
+	if (redundant(m_Caps[i] == enabled))
+		return false;
+
+	m_Caps[i] = enabled;
+	return true;
+}
+
+bool StateCacheDevice::redundant(bool same)
+{
+	StateCacheStats* pass = m_PassStack.empty() ? nullptr : m_PassStack.back();
+
+	if (same)
+	{
+		++m_FrameStats.filtered;
+		if (pass) ++pass->filtered;
+	}
+	else
+	{
+		++m_FrameStats.issued;
+		if (pass) ++pass->issued;
+	}
+
+	return same;
+}
+
+bool StateCacheDevice::cachedInteger(GLenum pname, GLint* data) const
+{
+	GLuint value = UNKNOWN;
+
+	switch (pname)
+	{
+	case GL_CULL_FACE_MODE:			value = m_CullFace; break;
+	case GL_DEPTH_FUNC:				value = m_DepthFunc; break;
+	case GL_CURRENT_PROGRAM:		value = m_Program; break;
+	case GL_VERTEX_ARRAY_BINDING:	value = m_VAO; break;
+	case GL_ACTIVE_TEXTURE:			value = m_ActiveUnit; break;
+	default: break;
+	}
+
+	if (value == UNKNOWN)
+		return false;
+
+	*data = (GLint)value;
+	return true;
+}
+
+RenderBackend StateCacheDevice::Backend() const
+{
+	return m_Device->Backend();
+}
+
+// ---- Shadowed State ----
+void StateCacheDevice::Enable(GLenum cap)
+{
+	if (setEnabled(cap, 1))
+		m_Device->Enable(cap);
+}
+
+void StateCacheDevice::Disable(GLenum cap)
+{
+	if (setEnabled(cap, 0))
+		m_Device->Disable(cap);
+}
+
+void StateCacheDevice::CullFace(GLenum mode)
+{
+	if (redundant(m_CullFace == mode))
+		return;
+
+	m_CullFace = mode;
+	m_Device->CullFace(mode);
+}
+
+void StateCacheDevice::DepthFunc(GLenum func)
+{
+	if (redundant(m_DepthFunc == func))
+		return;
+
+	m_DepthFunc = func;
+	m_Device->DepthFunc(func);
+}
+
+void StateCacheDevice::DepthMask(GLboolean flag)
+{
+	if (redundant(m_DepthMask == (GLint)flag))
+		return;
+
+	m_DepthMask = (GLint)flag;
+	m_Device->DepthMask(flag);
+}
+
+void StateCacheDevice::BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+	if (redundant(m_BlendSrc == sfactor && m_BlendDst == dfactor))
+		return;
+
+	m_BlendSrc = sfactor;
+	m_BlendDst = dfactor;
+	m_Device->BlendFunc(sfactor, dfactor);
+}
+
+void StateCacheDevice::BlendEquation(GLenum mode)
+{
+	if (redundant(m_BlendEquation == mode))
+		return;
+
+	m_BlendEquation = mode;
+	m_Device->BlendEquation(mode);
+}
+
+void StateCacheDevice::StencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+	if (redundant(m_StencilFunc == func && m_StencilRef == ref && m_StencilMask == mask))
+		return;
+
+	m_StencilFunc = func;
+	m_StencilRef = ref;
+	m_StencilMask = mask;
+	m_Device->StencilFunc(func, ref, mask);
+}
+
+void StateCacheDevice::StencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass)
+{
+	const StencilOps ops = { sfail, dpfail, dppass };
+	const bool front = (face == GL_FRONT || face == GL_FRONT_AND_BACK);
+	const bool back = (face == GL_BACK || face == GL_FRONT_AND_BACK);
+
+	bool same = front || back;
+	if (front) same &= (memcmp(&m_StencilFront, &ops, sizeof(StencilOps)) == 0);
+	if (back) same &= (memcmp(&m_StencilBack, &ops, sizeof(StencilOps)) == 0);
+
+	if (redundant(same))
+		return;
+
+	if (front) m_StencilFront = ops;
+	if (back) m_StencilBack = ops;
+	m_Device->StencilOpSeparate(face, sfail, dpfail, dppass);
+}
+
+void StateCacheDevice::PolygonMode(GLenum face, GLenum mode)
+{
+	// Core profile only has front and back together, anything else isn't shadowed
+	if (face != GL_FRONT_AND_BACK)
+	{
+		m_PolygonMode = UNKNOWN;
+		m_Device->PolygonMode(face, mode);
+		return;
+	}
+
+	if (redundant(m_PolygonMode == mode))
+		return;
+
+	m_PolygonMode = mode;
+	m_Device->PolygonMode(face, mode);
+}
+
+void StateCacheDevice::GetIntegerv(GLenum pname, GLint* data)
+{
+	if (cachedInteger(pname, data))
+	{
+		redundant(true);
+		return;
+	}
+
+	m_Device->GetIntegerv(pname, data);
+
+	// What the driver says is as good as having set it
+	switch (pname)
+	{
+	case GL_CULL_FACE_MODE:			m_CullFace = (GLenum)*data; break;
+	case GL_DEPTH_FUNC:				m_DepthFunc = (GLenum)*data; break;
+	case GL_CURRENT_PROGRAM:		m_Program = (GLuint)*data; break;
+	case GL_VERTEX_ARRAY_BINDING:	m_VAO = (GLuint)*data; break;
+	case GL_ACTIVE_TEXTURE:			m_ActiveUnit = (GLenum)*data; break;
+	default: break;
+	}
+}
+
+void StateCacheDevice::BindVertexArray(GLuint array)
+{
+	if (redundant(m_VAO == array))
+		return;
+
+	m_VAO = array;
+	m_Device->BindVertexArray(array);
+}
+
+void StateCacheDevice::DeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+	// Deleting the bound vao reverts the binding to zero
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		if (arrays[i] == m_VAO)
+			m_VAO = 0;
+	}
+
+	m_Device->DeleteVertexArrays(n, arrays);
+}
+
+void StateCacheDevice::ActiveTexture(GLenum unit)
+{
+	if (redundant(m_ActiveUnit == unit))
+		return;
+
+	m_ActiveUnit = unit;
+	m_Device->ActiveTexture(unit);
+}
+
+void StateCacheDevice::BindTexture(GLenum target, GLuint texture)
+{
+	const GLuint unit = m_ActiveUnit - GL_TEXTURE0;
+
+	GLuint* bound = nullptr;
+	if (m_ActiveUnit != UNKNOWN && unit < STATE_CACHE_TEXTURE_UNITS)
+	{
+		if (target == GL_TEXTURE_2D)
+			bound = &m_Units[unit].tex2D;
+		else if (target == GL_TEXTURE_CUBE_MAP)
+			bound = &m_Units[unit].cube;
+	}
+
+	if (!bound)
+	{
+		m_Device->BindTexture(target, texture);
+		return;
+	}
+
+	if (redundant(*bound == texture))
+		return;
+
+	*bound = texture;
+	m_Device->BindTexture(target, texture);
+}
+
+void StateCacheDevice::DeleteTextures(GLsizei n, const GLuint* textures)
+{
+	// Deleted textures are unbound from every unit
+	for (GLsizei i = 0; i < n; ++i)
+	{
+		for (int u = 0; u < STATE_CACHE_TEXTURE_UNITS; ++u)
+		{
+			if (m_Units[u].tex2D == textures[i]) m_Units[u].tex2D = 0;
+			if (m_Units[u].cube == textures[i]) m_Units[u].cube = 0;
+		}
+	}
+
+	m_Device->DeleteTextures(n, textures);
+}
+
+void StateCacheDevice::UseProgram(GLuint program)
+{
+	if (redundant(m_Program == program))
+		return;
+
+	m_Program = program;
+	m_Device->UseProgram(program);
+}
+
+void StateCacheDevice::DeleteProgram(GLuint program)
+{
+	// A deleted program stays current until replaced, but its name can be handed out again
+	if (program == m_Program)
+		m_Program = UNKNOWN;
+
+	m_Device->DeleteProgram(program);
+}
+
+// ---- Debug markers, counters are kept per innermost marker ----
+void StateCacheDevice::PushMarker(const char* name)
+{
+	m_PassStack.push_back(&m_PassStats[name]);
+	m_Device->PushMarker(name);
+}
+
+void StateCacheDevice::PopMarker()
+{
+	if (!m_PassStack.empty())
+		m_PassStack.pop_back();
+
+	m_Device->PopMarker();
+}
+
+// ---- Forwarded untouched ----
+void StateCacheDevice::Clear(GLbitfield mask)
+{
+	m_Device->Clear(mask);
+}
+
+void StateCacheDevice::ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+	m_Device->ClearColor(r, g, b, a);
+}
+
+void StateCacheDevice::Viewport(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+	m_Device->Viewport(x, y, w, h);
+}
+
+void StateCacheDevice::PixelStorei(GLenum pname, GLint param)
+{
+	m_Device->PixelStorei(pname, param);
+}
+
+void StateCacheDevice::Flush()
+{
+	m_Device->Flush();
+}
+
+const GLubyte* StateCacheDevice::GetString(GLenum name)
+{
+	return m_Device->GetString(name);
+}
+
+GLenum StateCacheDevice::GetError()
+{
+	return m_Device->GetError();
+}
+
+void StateCacheDevice::GenBuffers(GLsizei n, GLuint* buffers)
+{
+	m_Device->GenBuffers(n, buffers);
+}
+
+void StateCacheDevice::DeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+	m_Device->DeleteBuffers(n, buffers);
+}
+
+GLboolean StateCacheDevice::IsBuffer(GLuint buffer)
+{
+	return m_Device->IsBuffer(buffer);
+}
+
+void StateCacheDevice::BindBuffer(GLenum target, GLuint buffer)
+{
+	m_Device->BindBuffer(target, buffer);
+}
+
+void StateCacheDevice::BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+	m_Device->BufferData(target, size, data, usage);
+}
+
+void StateCacheDevice::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+	m_Device->BufferSubData(target, offset, size, data);
+}
+
+void StateCacheDevice::BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	m_Device->BindBufferBase(target, index, buffer);
+}
+
+void StateCacheDevice::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	m_Device->BindBufferRange(target, index, buffer, offset, size);
+}
+
+void StateCacheDevice::BufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+	m_Device->BufferStorage(target, size, data, flags);
+}
+
+void* StateCacheDevice::MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+	return m_Device->MapBufferRange(target, offset, length, access);
+}
+
+GLboolean StateCacheDevice::UnmapBuffer(GLenum target)
+{
+	return m_Device->UnmapBuffer(target);
+}
+
+void StateCacheDevice::GenVertexArrays(GLsizei n, GLuint* arrays)
+{
+	m_Device->GenVertexArrays(n, arrays);
+}
+
+GLboolean StateCacheDevice::IsVertexArray(GLuint array)
+{
+	return m_Device->IsVertexArray(array);
+}
+
+void StateCacheDevice::EnableVertexAttribArray(GLuint index)
+{
+	m_Device->EnableVertexAttribArray(index);
+}
+
+void StateCacheDevice::DisableVertexAttribArray(GLuint index)
+{
+	m_Device->DisableVertexAttribArray(index);
+}
+
+void StateCacheDevice::VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+{
+	m_Device->VertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+void StateCacheDevice::VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer)
+{
+	m_Device->VertexAttribIPointer(index, size, type, stride, pointer);
+}
+
+void StateCacheDevice::VertexAttribDivisor(GLuint index, GLuint divisor)
+{
+	m_Device->VertexAttribDivisor(index, divisor);
+}
+
+void StateCacheDevice::GenTextures(GLsizei n, GLuint* textures)
+{
+	m_Device->GenTextures(n, textures);
+}
+
+GLboolean StateCacheDevice::IsTexture(GLuint texture)
+{
+	return m_Device->IsTexture(texture);
+}
+
+void StateCacheDevice::TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+{
+	m_Device->TexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+}
+
+void StateCacheDevice::TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels)
+{
+	m_Device->TexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+}
+
+void StateCacheDevice::TexParameteri(GLenum target, GLenum pname, GLint param)
+{
+	m_Device->TexParameteri(target, pname, param);
+}
+
+void StateCacheDevice::TexParameterf(GLenum target, GLenum pname, GLfloat param)
+{
+	m_Device->TexParameterf(target, pname, param);
+}
+
+void StateCacheDevice::GenerateMipmap(GLenum target)
+{
+	m_Device->GenerateMipmap(target);
+}
+
+void StateCacheDevice::GenFramebuffers(GLsizei n, GLuint* fbos)
+{
+	m_Device->GenFramebuffers(n, fbos);
+}
+
+void StateCacheDevice::DeleteFramebuffers(GLsizei n, const GLuint* fbos)
+{
+	m_Device->DeleteFramebuffers(n, fbos);
+}
+
+GLboolean StateCacheDevice::IsFramebuffer(GLuint fbo)
+{
+	return m_Device->IsFramebuffer(fbo);
+}
+
+void StateCacheDevice::BindFramebuffer(GLenum target, GLuint fbo)
+{
+	m_Device->BindFramebuffer(target, fbo);
+}
+
+void StateCacheDevice::FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+	m_Device->FramebufferTexture2D(target, attachment, textarget, texture, level);
+}
+
+GLenum StateCacheDevice::CheckFramebufferStatus(GLenum target)
+{
+	return m_Device->CheckFramebufferStatus(target);
+}
+
+void StateCacheDevice::DrawBuffer(GLenum buf)
+{
+	m_Device->DrawBuffer(buf);
+}
+
+void StateCacheDevice::DrawBuffers(GLsizei n, const GLenum* bufs)
+{
+	m_Device->DrawBuffers(n, bufs);
+}
+
+void StateCacheDevice::ReadBuffer(GLenum src)
+{
+	m_Device->ReadBuffer(src);
+}
+
+void StateCacheDevice::BlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+	m_Device->BlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+}
+
+GLuint StateCacheDevice::CreateShader(GLenum type)
+{
+	return m_Device->CreateShader(type);
+}
+
+void StateCacheDevice::DeleteShader(GLuint shader)
+{
+	m_Device->DeleteShader(shader);
+}
+
+GLboolean StateCacheDevice::IsShader(GLuint shader)
+{
+	return m_Device->IsShader(shader);
+}
+
+void StateCacheDevice::ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+{
+	m_Device->ShaderSource(shader, count, strings, lengths);
+}
+
+void StateCacheDevice::CompileShader(GLuint shader)
+{
+	m_Device->CompileShader(shader);
+}
+
+void StateCacheDevice::GetShaderiv(GLuint shader, GLenum pname, GLint* params)
+{
+	m_Device->GetShaderiv(shader, pname, params);
+}
+
+void StateCacheDevice::GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* log)
+{
+	m_Device->GetShaderInfoLog(shader, bufSize, length, log);
+}
+
+GLuint StateCacheDevice::CreateProgram()
+{
+	return m_Device->CreateProgram();
+}
+
+GLboolean StateCacheDevice::IsProgram(GLuint program)
+{
+	return m_Device->IsProgram(program);
+}
+
+void StateCacheDevice::AttachShader(GLuint program, GLuint shader)
+{
+	m_Device->AttachShader(program, shader);
+}
+
+void StateCacheDevice::BindAttribLocation(GLuint program, GLuint index, const GLchar* name)
+{
+	m_Device->BindAttribLocation(program, index, name);
+}
+
+void StateCacheDevice::BindFragDataLocation(GLuint program, GLuint color, const GLchar* name)
+{
+	m_Device->BindFragDataLocation(program, color, name);
+}
+
+void StateCacheDevice::LinkProgram(GLuint program)
+{
+	m_Device->LinkProgram(program);
+}
+
+void StateCacheDevice::GetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+	m_Device->GetProgramiv(program, pname, params);
+}
+
+void StateCacheDevice::GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* log)
+{
+	m_Device->GetProgramInfoLog(program, bufSize, length, log);
+}
+
+GLint StateCacheDevice::GetUniformLocation(GLuint program, const GLchar* name)
+{
+	return m_Device->GetUniformLocation(program, name);
+}
+
+void StateCacheDevice::GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+	m_Device->GetActiveUniform(program, index, bufSize, length, size, type, name);
+}
+
+void StateCacheDevice::GetActiveUniformBlockName(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name)
+{
+	m_Device->GetActiveUniformBlockName(program, index, bufSize, length, name);
+}
+
+GLuint StateCacheDevice::GetUniformBlockIndex(GLuint program, const GLchar* name)
+{
+	return m_Device->GetUniformBlockIndex(program, name);
+}
+
+void StateCacheDevice::GetActiveUniformBlockiv(GLuint program, GLuint index, GLenum pname, GLint* params)
+{
+	m_Device->GetActiveUniformBlockiv(program, index, pname, params);
+}
+
+void StateCacheDevice::GetUniformIndices(GLuint program, GLsizei count, const GLchar* const* names, GLuint* indices)
+{
+	m_Device->GetUniformIndices(program, count, names, indices);
+}
+
+void StateCacheDevice::GetActiveUniformsiv(GLuint program, GLsizei count, const GLuint* indices, GLenum pname, GLint* params)
+{
+	m_Device->GetActiveUniformsiv(program, count, indices, pname, params);
+}
+
+void StateCacheDevice::Uniform1i(GLint location, GLint v)
+{
+	m_Device->Uniform1i(location, v);
+}
+
+void StateCacheDevice::Uniform1f(GLint location, GLfloat v)
+{
+	m_Device->Uniform1f(location, v);
+}
+
+void StateCacheDevice::Uniform2fv(GLint location, GLsizei count, const GLfloat* v)
+{
+	m_Device->Uniform2fv(location, count, v);
+}
+
+void StateCacheDevice::Uniform3fv(GLint location, GLsizei count, const GLfloat* v)
+{
+	m_Device->Uniform3fv(location, count, v);
+}
+
+void StateCacheDevice::Uniform4fv(GLint location, GLsizei count, const GLfloat* v)
+{
+	m_Device->Uniform4fv(location, count, v);
+}
+
+void StateCacheDevice::UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* v)
+{
+	m_Device->UniformMatrix4fv(location, count, transpose, v);
+}
+
+void StateCacheDevice::DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	m_Device->DrawArrays(mode, first, count);
+}
+
+void StateCacheDevice::MultiDrawArrays(GLenum mode, const GLint* first, const GLsizei* count, GLsizei drawcount)
+{
+	m_Device->MultiDrawArrays(mode, first, count, drawcount);
+}
+
+void StateCacheDevice::DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex)
+{
+	m_Device->DrawElementsBaseVertex(mode, count, type, indices, basevertex);
+}
+
+void StateCacheDevice::DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex)
+{
+	m_Device->DrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount, basevertex);
+}
+
+void StateCacheDevice::DrawElementsInstancedBaseVertexBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex, GLuint baseinstance)
+{
+	m_Device->DrawElementsInstancedBaseVertexBaseInstance(mode, count, type, indices, instancecount, basevertex, baseinstance);
+}
+
+void StateCacheDevice::DrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instancecount, GLuint baseinstance)
+{
+	m_Device->DrawArraysInstancedBaseInstance(mode, first, count, instancecount, baseinstance);
+}
+
+void StateCacheDevice::CreateQueries(GLenum target, GLsizei n, GLuint* ids)
+{
+	m_Device->CreateQueries(target, n, ids);
+}
+
+void StateCacheDevice::DeleteQueries(GLsizei n, const GLuint* ids)
+{
+	m_Device->DeleteQueries(n, ids);
+}
+
+void StateCacheDevice::BeginQuery(GLenum target, GLuint id)
+{
+	m_Device->BeginQuery(target, id);
+}
+
+void StateCacheDevice::EndQuery(GLenum target)
+{
+	m_Device->EndQuery(target);
+}
+
+void StateCacheDevice::GetQueryObjectiv(GLuint id, GLenum pname, GLint* params)
+{
+	m_Device->GetQueryObjectiv(id, pname, params);
+}
+
+void StateCacheDevice::GetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params)
+{
+	m_Device->GetQueryObjectuiv(id, pname, params);
+}
+
+void StateCacheDevice::GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params)
+{
+	m_Device->GetQueryObjectui64v(id, pname, params);
+}
+
+void StateCacheDevice::QueryCounter(GLuint id, GLenum target)
+{
+	m_Device->QueryCounter(id, target);
+}
+
+GLsync StateCacheDevice::FenceSync(GLenum condition, GLbitfield flags)
+{
+	return m_Device->FenceSync(condition, flags);
+}
+
+GLenum StateCacheDevice::ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+	return m_Device->ClientWaitSync(sync, flags, timeout);
+}
+
+void StateCacheDevice::DeleteSync(GLsync sync)
+{
+	m_Device->DeleteSync(sync);
+}
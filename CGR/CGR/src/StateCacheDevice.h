@@ -0,0 +1,242 @@
+#ifndef __STATE_CACHE_DEVICE_H__
+#define __STATE_CACHE_DEVICE_H__
+
+#include "RenderDevice.h"
+#include "types.h"
+
+#include <vector>
+#include <string>
+#include <map>
+
+#define STATE_CACHE_TEXTURE_UNITS	32
+
+struct StateCacheStats
+{
+	uint32 issued;
+	uint32 filtered;
+};
+
+/*
+	Sits in front of the real device and shadows the state the renderer churns through (program, vao,
+	textures per unit, enable flags, blend, stencil, depth and cull). Calls that would set a value that is
+	already current are dropped, queries for shadowed state are answered without asking the driver.
+	Anything it doesn't shadow is forwarded untouched. Counters are kept per frame and per marker.
+*/
+class StateCacheDevice : public RenderDevice
+{
+public:
+	// Takes ownership of the device
+	StateCacheDevice(RenderDevice* device);
+	~StateCacheDevice();
+
+	RenderDevice*							Device() const;
+
+	// Forget everything shadowed, for when something outside the device has touched the context
+	void									Invalidate();
+
+	// Clears the counters, call at the start of a frame
+	void									BeginFrame();
+	const StateCacheStats&					FrameStats() const;
+	const std::map<std::string, StateCacheStats>& PassStats() const;
+
+	RenderBackend	Backend() const override;
+
+	// ---- Global State ----
+	void			Enable(GLenum cap) override;
+	void			Disable(GLenum cap) override;
+	void			Clear(GLbitfield mask) override;
+	void			ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) override;
+	void			CullFace(GLenum mode) override;
+	void			DepthFunc(GLenum func) override;
+	void			DepthMask(GLboolean flag) override;
+	void			BlendFunc(GLenum sfactor, GLenum dfactor) override;
+	void			BlendEquation(GLenum mode) override;
+	void			StencilFunc(GLenum func, GLint ref, GLuint mask) override;
+	void			StencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass) override;
+	void			PolygonMode(GLenum face, GLenum mode) override;
+	void			Viewport(GLint x, GLint y, GLsizei w, GLsizei h) override;
+	void			PixelStorei(GLenum pname, GLint param) override;
+	void			Flush() override;
+	void			GetIntegerv(GLenum pname, GLint* data) override;
+	const GLubyte*	GetString(GLenum name) override;
+	GLenum			GetError() override;
+
+	// ---- Buffers and Vertex Arrays ----
+	void			GenBuffers(GLsizei n, GLuint* buffers) override;
+	void			DeleteBuffers(GLsizei n, const GLuint* buffers) override;
+	GLboolean		IsBuffer(GLuint buffer) override;
+	void			BindBuffer(GLenum target, GLuint buffer) override;
+	void			BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) override;
+	void			BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) override;
+	void			BindBufferBase(GLenum target, GLuint index, GLuint buffer) override;
+	void			BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) override;
+	void			BufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags) override;
+	void*			MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) override;
+	GLboolean		UnmapBuffer(GLenum target) override;
+	void			GenVertexArrays(GLsizei n, GLuint* arrays) override;
+	void			DeleteVertexArrays(GLsizei n, const GLuint* arrays) override;
+	GLboolean		IsVertexArray(GLuint array) override;
+	void			BindVertexArray(GLuint array) override;
+	void			EnableVertexAttribArray(GLuint index) override;
+	void			DisableVertexAttribArray(GLuint index) override;
+	void			VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) override;
+	void			VertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) override;
+	void			VertexAttribDivisor(GLuint index, GLuint divisor) override;
+
+	// ---- Textures ----
+	void			GenTextures(GLsizei n, GLuint* textures) override;
+	void			DeleteTextures(GLsizei n, const GLuint* textures) override;
+	GLboolean		IsTexture(GLuint texture) override;
+	void			ActiveTexture(GLenum unit) override;
+	void			BindTexture(GLenum target, GLuint texture) override;
+	void			TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels) override;
+	void			TexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels) override;
+	void			TexParameteri(GLenum target, GLenum pname, GLint param) override;
+	void			TexParameterf(GLenum target, GLenum pname, GLfloat param) override;
+	void			GenerateMipmap(GLenum target) override;
+
+	// ---- Frame Buffers ----
+	void			GenFramebuffers(GLsizei n, GLuint* fbos) override;
+	void			DeleteFramebuffers(GLsizei n, const GLuint* fbos) override;
+	GLboolean		IsFramebuffer(GLuint fbo) override;
+	void			BindFramebuffer(GLenum target, GLuint fbo) override;
+	void			FramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level) override;
+	GLenum			CheckFramebufferStatus(GLenum target) override;
+	void			DrawBuffer(GLenum buf) override;
+	void			DrawBuffers(GLsizei n, const GLenum* bufs) override;
+	void			ReadBuffer(GLenum src) override;
+	void			BlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter) override;
+
+	// ---- Shaders and Programs ----
+	GLuint			CreateShader(GLenum type) override;
+	void			DeleteShader(GLuint shader) override;
+	GLboolean		IsShader(GLuint shader) override;
+	void			ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths) override;
+	void			CompileShader(GLuint shader) override;
+	void			GetShaderiv(GLuint shader, GLenum pname, GLint* params) override;
+	void			GetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* log) override;
+	GLuint			CreateProgram() override;
+	void			DeleteProgram(GLuint program) override;
+	GLboolean		IsProgram(GLuint program) override;
+	void			AttachShader(GLuint program, GLuint shader) override;
+	void			BindAttribLocation(GLuint program, GLuint index, const GLchar* name) override;
+	void			BindFragDataLocation(GLuint program, GLuint color, const GLchar* name) override;
+	void			LinkProgram(GLuint program) override;
+	void			GetProgramiv(GLuint program, GLenum pname, GLint* params) override;
+	void			GetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* log) override;
+	void			UseProgram(GLuint program) override;
+	GLint			GetUniformLocation(GLuint program, const GLchar* name) override;
+	void			GetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) override;
+	void			GetActiveUniformBlockName(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLchar* name) override;
+	GLuint			GetUniformBlockIndex(GLuint program, const GLchar* name) override;
+	void			GetActiveUniformBlockiv(GLuint program, GLuint index, GLenum pname, GLint* params) override;
+	void			GetUniformIndices(GLuint program, GLsizei count, const GLchar* const* names, GLuint* indices) override;
+	void			GetActiveUniformsiv(GLuint program, GLsizei count, const GLuint* indices, GLenum pname, GLint* params) override;
+
+	// ---- Uniforms ----
+	void			Uniform1i(GLint location, GLint v) override;
+	void			Uniform1f(GLint location, GLfloat v) override;
+	void			Uniform2fv(GLint location, GLsizei count, const GLfloat* v) override;
+	void			Uniform3fv(GLint location, GLsizei count, const GLfloat* v) override;
+	void			Uniform4fv(GLint location, GLsizei count, const GLfloat* v) override;
+	void			UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* v) override;
+
+	// ---- Draws ----
+	void			DrawArrays(GLenum mode, GLint first, GLsizei count) override;
+	void			MultiDrawArrays(GLenum mode, const GLint* first, const GLsizei* count, GLsizei drawcount) override;
+	void			DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex) override;
+	void			DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex) override;
+	void			DrawElementsInstancedBaseVertexBaseInstance(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount, GLint basevertex, GLuint baseinstance) override;
+	void			DrawArraysInstancedBaseInstance(GLenum mode, GLint first, GLsizei count, GLsizei instancecount, GLuint baseinstance) override;
+
+	// ---- Queries ----
+	void			CreateQueries(GLenum target, GLsizei n, GLuint* ids) override;
+	void			DeleteQueries(GLsizei n, const GLuint* ids) override;
+	void			BeginQuery(GLenum target, GLuint id) override;
+	void			EndQuery(GLenum target) override;
+	void			GetQueryObjectiv(GLuint id, GLenum pname, GLint* params) override;
+	void			GetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params) override;
+	void			GetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params) override;
+	void			QueryCounter(GLuint id, GLenum target) override;
+
+	// ---- Sync ----
+	GLsync			FenceSync(GLenum condition, GLbitfield flags) override;
+	GLenum			ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) override;
+	void			DeleteSync(GLsync sync) override;
+
+	// ---- Debug markers, used to group commands into passes ----
+	void			PushMarker(const char* name) override;
+	void			PopMarker() override;
+
+private:
+	enum CachedCap
+	{
+		CAP_DEPTH_TEST,
+		CAP_CULL_FACE,
+		CAP_BLEND,
+		CAP_STENCIL_TEST,
+		CAP_SCISSOR_TEST,
+		CAP_COUNT
+	};
+
+	struct StencilOps
+	{
+		GLenum sfail;
+		GLenum dpfail;
+		GLenum dppass;
+	};
+
+	struct TextureUnit
+	{
+		GLuint tex2D;
+		GLuint cube;
+	};
+
+	int		capIndex(GLenum cap) const;
+	bool	setEnabled(GLenum cap, int enabled);
+	bool	redundant(bool same);
+	bool	cachedInteger(GLenum pname, GLint* data) const;
+
+private:
+	RenderDevice*							m_Device;
+
+	// Shadowed state, UNKNOWN until first set (or read back) so the first call always goes through
+	int									m_Caps[CAP_COUNT];
+	GLuint									m_Program;
+	GLuint									m_VAO;
+	GLenum									m_ActiveUnit;
+	TextureUnit								m_Units[STATE_CACHE_TEXTURE_UNITS];
+	GLenum									m_CullFace;
+	GLenum									m_DepthFunc;
+	GLint									m_DepthMask;
+	GLenum									m_BlendSrc;
+	GLenum									m_BlendDst;
+	GLenum									m_BlendEquation;
+	GLenum									m_StencilFunc;
+	GLint									m_StencilRef;
+	GLuint									m_StencilMask;
+	StencilOps								m_StencilFront;
+	StencilOps								m_StencilBack;
+	GLenum									m_PolygonMode;
+
+	StateCacheStats							m_FrameStats;
+	std::map<std::string, StateCacheStats>	m_PassStats;
+	std::vector<StateCacheStats*>			m_PassStack;
+};
+
+INLINE RenderDevice* StateCacheDevice::Device() const
+{
+	return m_Device;
+}
+
+INLINE const StateCacheStats& StateCacheDevice::FrameStats() const
+{
+	return m_FrameStats;
+}
+
+INLINE const std::map<std::string, StateCacheStats>& StateCacheDevice::PassStats() const
+{
+	return m_PassStats;
+}
+
+#endif
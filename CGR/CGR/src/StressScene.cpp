@@ -0,0 +1,372 @@
+#include "StressScene.h"
+
+#include <random>
+#include <cstdlib>
+
+#include "Renderer.h"
+#include "Camera.h"
+#include "FlyCamera.h"
+#include "GameObject.h"
+#include "Screen.h"
+#include "ResId.h"
+#include "utils.h"
+#include "LogFile.h"
+#include "TextFile.h"
+#include "Transform.h"
+#include "MeshRenderer.h"
+#include "Animator.h"
+#include "ResourceManager.h"
+#include "BillboardList.h"
+#include "AnimMesh.h"
+#include "Lights.h"
+
+#include "CgrEngine.h"
+#include "DirectionalLight.h"
+#include "PointLight.h"
+#include "SpotLight.h"
+
+// Animations the characters are given in turn when they aren't moving
+static const animType_t IDLE_ANIMS[] = { STAND, WAVE, SALUTE, POINTING, FLIP };
+
+static std::string trim(const std::string& s)
+{
+	const size_t first = s.find_first_not_of(" \t\r\n");
+	if (first == std::string::npos)
+		return std::string();
+
+	const size_t last = s.find_last_not_of(" \t\r\n");
+	return s.substr(first, last - first + 1);
+}
+
+StressSceneSettings DefaultStressSettings()
+{
+	StressSceneSettings settings;
+	settings.meshes = 1000;
+	settings.characters = 50;
+	settings.points = 64;
+	settings.spots = 16;
+	settings.billboards = 5000;
+	settings.seed = 1234;
+	settings.extent = 200.0f;
+	settings.motion = true;
+	settings.shadows = true;
+	settings.deferred = false;
+	return settings;
+}
+
+bool SetStressSetting(StressSceneSettings& settings, const std::string& key, const std::string& value)
+{
+	const std::string k = util::str_to_lower(trim(key));
+	const std::string v = trim(value);
+	const uint32 count = (uint32)strtoul(v.c_str(), nullptr, 10);
+
+	if (k == "meshes")				settings.meshes = count;
+	else if (k == "characters")		settings.characters = count;
+	else if (k == "points")			settings.points = count;
+	else if (k == "spots")			settings.spots = count;
+	else if (k == "billboards")		settings.billboards = count;
+	else if (k == "seed")			settings.seed = count;
+	else if (k == "extent")			settings.extent = util::str_to_float(v);
+	else if (k == "motion")			settings.motion = count != 0;
+	else if (k == "shadows")		settings.shadows = count != 0;
+	else if (k == "deferred")		settings.deferred = count != 0;
+	else
+		return false;
+
+	return true;
+}
+
+bool LoadStressSettings(const std::string& path, StressSceneSettings& settings)
+{
+	TextFile file;
+	if (!file.LoadFileAsLinesToBuffer(path))
+		return false;
+
+	const std::vector<std::string>& lines = file.GetBuffer();
+	for (size_t i = 0; i < lines.size(); ++i)
+	{
+		const size_t colon = lines[i].find(':');
+		if (colon == std::string::npos)
+			continue;
+
+		if (!SetStressSetting(settings, lines[i].substr(0, colon), lines[i].substr(colon + 1)))
+			WRITE_LOG("Unknown stress scene setting: " + lines[i], "warning");
+	}
+
+	return true;
+}
+
+void ParseStressArgs(int argc, char** argv, StressSceneSettings& settings)
+{
+	const std::string prefix = "--stress-";
+
+	for (int i = 1; i + 1 < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if (arg.compare(0, prefix.size(), prefix) != 0)
+			continue;
+
+		if (SetStressSetting(settings, arg.substr(prefix.size()), argv[i + 1]))
+			++i;
+		else
+			WRITE_LOG("Unknown stress scene setting: " + arg, "warning");
+	}
+}
+
+StressScene::StressScene(const std::string& name, const StressSceneSettings& settings) :
+	IScene(name),
+	m_Settings(settings),
+	m_GameObjects(),
+	m_Billboards(nullptr),
+	m_Time(0.0f)
+{
+}
+
+StressScene::~StressScene()
+{
+}
+
+int StressScene::OnSceneLoad(ResourceManager* resManager)
+{
+	const float extent = m_Settings.extent;
+
+	// Fixed seed so runs are comparable, every count draws from its own stream so changing one doesn't move the rest
+	std::mt19937 meshRng(m_Settings.seed);
+	std::mt19937 characterRng(m_Settings.seed + 1);
+	std::mt19937 lightRng(m_Settings.seed + 2);
+	std::mt19937 billboardRng(m_Settings.seed + 3);
+	std::uniform_real_distribution<float> ground(-extent, extent);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	// ---- Camera ----
+	GameObject* cam = new GameObject();
+	m_GameObjects.push_back(cam);
+	FlyCamera* fly = cam->AddComponent<FlyCamera>();
+	fly->Init(
+		CamType::Perspective,
+		Vec3(0.0f, extent * 0.4f, -extent * 1.1f),
+		Vec3(0.0f, 1.0f, 0.0f),
+		Vec3(1.0f, 0.0f, 0.0f),
+		Vec3(0.0f, 0.0f, 1.0f),
+		45.0f,
+		static_cast<float>(Screen::FrameBufferWidth()) / static_cast<float>(Screen::FrameBufferHeight()),
+		0.1f,
+		extent * 4.0f);
+	fly->SetSpeeds(extent * 0.25f, 0.2f);
+	cam->GetComponent<Transform>()->RotateX(-0.35f);
+	fly->AddSkybox(30.0f, TEX_SKYBOX_DEFAULT);
+	m_Camera = fly;
+	m_Renderer->SetSceneData(m_Camera, Vec3(0.1f));
+
+	// ---- Directional light, needed for shadows ----
+	GameObject* dlight = new GameObject();
+	m_GameObjects.push_back(dlight);
+	DirectionalLightC* dl = dlight->AddComponent<DirectionalLightC>();
+	dl->SetLight(m_Renderer, Vec3(0.1f, -0.8f, 0.1f), Vec3(0.5f), Vec3(extent * 1.5f));
+
+	// ---- Ground ----
+	GameObject* floor = new GameObject();
+	m_GameObjects.push_back(floor);
+	Transform* ft = floor->AddComponent<Transform>();
+	ft->SetPosition(Vec3(0.0f, -1.0f, 0.0f));
+	ft->SetScale(Vec3(extent, 1.0f, extent));
+	floor->AddComponent<MeshRenderer>()->SetMeshData(MESH_ID_CUBE, SHADER_LIGHTING_FWD, MATERIALS_WOOD, false, true, false, false);
+
+	// ---- Static meshes ----
+	const size_t meshIds[] = { MESH_ID_CUBE, MESH_ID_SPHERE, MESH_ID_MALE };
+	const size_t materialIds[] = { MATERIALS_WOOD, MATERIALS_WOOD, MATERIALS_MALE };
+
+	m_Meshes.reserve(m_Settings.meshes);
+	m_MeshSpin.reserve(m_Settings.meshes);
+	for (uint32 i = 0; i < m_Settings.meshes; ++i)
+	{
+		const size_t kind = i % ARRAY_SIZE_IN_ELEMENTS(meshIds);
+		const float scale = kind == 2 ? 4.0f + unit(meshRng) * 4.0f : 0.5f + unit(meshRng) * 2.0f;
+
+		GameObject* mesh = new GameObject();
+		m_GameObjects.push_back(mesh);
+		Transform* t = mesh->AddComponent<Transform>();
+		t->SetPosition(Vec3(ground(meshRng), kind == 2 ? 0.0f : scale, ground(meshRng)));
+		t->SetScale(Vec3(scale));
+		t->RotateY(unit(meshRng) * 6.28f);
+		mesh->AddComponent<MeshRenderer>()->SetMeshData(meshIds[kind], SHADER_LIGHTING_FWD, materialIds[kind], false, true, false, false);
+
+		m_Meshes.push_back(t);
+		m_MeshSpin.push_back(unit(meshRng) * 2.0f - 1.0f);
+	}
+
+	// ---- Animated characters, raised so the goblin's feet are on the ground as the outdoor scene works it out ----
+	const AnimMesh* goblinMesh = resManager->GetAnimMesh(ANIM_MESH_GOBLIN);
+	float characterHeight = 0.0f;
+
+	m_Characters.reserve(m_Settings.characters);
+	m_CharacterOrbits.reserve(m_Settings.characters);
+	for (uint32 i = 0; i < m_Settings.characters; ++i)
+	{
+		GameObject* goblin = new GameObject();
+		m_GameObjects.push_back(goblin);
+		Transform* t = goblin->AddComponent<Transform>();
+		t->SetScale(Vec3(0.35f));
+		t->RotateX(30.0f);
+
+		if (i == 0 && goblinMesh)
+		{
+			t->Update();
+			const Vec3 minVert = goblinMesh->GetMinVertex();
+			const Vec3 centre = minVert + goblinMesh->GetMaxVertex() / 2.0f;
+			characterHeight = Maths::Distance(
+				Maths::Vec4To3(t->GetModelXform() * Vec4(minVert, 1.0f)),
+				Maths::Vec4To3(t->GetModelXform() * Vec4(centre, 1.0f)));
+		}
+
+		Orbit orbit;
+		orbit.centre = Vec3(ground(characterRng), characterHeight, ground(characterRng));
+		orbit.radius = 2.0f + unit(characterRng) * 8.0f;
+		orbit.speed = 0.2f + unit(characterRng) * 0.6f;
+		orbit.phase = unit(characterRng) * 6.28f;
+		t->SetPosition(orbitPosition(orbit, 0.0f));
+
+		goblin->AddComponent<MeshRenderer>()->SetMeshData(ANIM_MESH_GOBLIN, SHADER_ANIM, MATERIALS_GOBLIN, false, false, false, true);
+		goblin->AddComponent<Animator>()->StartAnimation(m_Settings.motion ? RUN : IDLE_ANIMS[i % ARRAY_SIZE_IN_ELEMENTS(IDLE_ANIMS)]);
+
+		m_Characters.push_back(t);
+		m_CharacterOrbits.push_back(orbit);
+	}
+
+	// ---- Lights, the renderer takes up to MAX_POINTS and MAX_SPOTS and refuses the rest ----
+	if (m_Settings.points > MAX_POINTS || m_Settings.spots > MAX_SPOTS)
+		WRITE_LOG("Stress scene asked for more lights than the renderer holds, the extra ones are skipped", "warning");
+
+	for (uint32 i = 0; i < m_Settings.points; ++i)
+	{
+		Orbit orbit;
+		orbit.centre = Vec3(ground(lightRng), 5.0f + unit(lightRng) * 15.0f, ground(lightRng));
+		orbit.radius = 5.0f + unit(lightRng) * 20.0f;
+		orbit.speed = 0.5f + unit(lightRng);
+		orbit.phase = unit(lightRng) * 6.28f;
+		const Vec3 colour(unit(lightRng), unit(lightRng), unit(lightRng));
+
+		GameObject* point = CgrEngine::CreatePointLight(m_Renderer, orbitPosition(orbit, 0.0f), colour, 0.02f);
+		if (!point)
+			continue;
+
+		m_GameObjects.push_back(point);
+		m_Points.push_back(point->GetComponent<PointLightC>());
+		m_PointOrbits.push_back(orbit);
+	}
+
+	for (uint32 i = 0; i < m_Settings.spots; ++i)
+	{
+		Orbit orbit;
+		orbit.centre = Vec3(ground(lightRng), 20.0f + unit(lightRng) * 10.0f, ground(lightRng));
+		orbit.radius = 5.0f + unit(lightRng) * 20.0f;
+		orbit.speed = 0.25f + unit(lightRng) * 0.5f;
+		orbit.phase = unit(lightRng) * 6.28f;
+		const Vec3 colour(unit(lightRng), unit(lightRng), unit(lightRng));
+
+		GameObject* spot = CgrEngine::CreateSpotLight(m_Renderer, orbitPosition(orbit, 0.0f), colour, Vec3(0.1f, -0.9f, 0.1f), 0.2f, 1);
+		if (!spot)
+			continue;
+
+		m_GameObjects.push_back(spot);
+		m_Spots.push_back(spot->GetComponent<SpotLightC>());
+		m_SpotOrbits.push_back(orbit);
+	}
+
+	// ---- Billboards ----
+	if (m_Settings.billboards > 0)
+	{
+		std::vector<Vec3> positions;
+		positions.reserve(m_Settings.billboards);
+		for (uint32 i = 0; i < m_Settings.billboards; ++i)
+			positions.push_back(Vec3(ground(billboardRng), 2.0f, ground(billboardRng)));
+
+		m_Billboards = new BillboardList();
+		if (!m_Billboards->InitWithPositions(SHADER_BILLBOARD_FWD, TEX_GRASS_BILLBOARD, 4.5f, positions))
+		{
+			WRITE_LOG("Stress scene billboards failed", "error");
+			return GE_FATAL_ERROR;
+		}
+	}
+
+	// Start Game objects
+	for (auto i = m_GameObjects.begin(); i != m_GameObjects.end(); ++i)
+	{
+		(*i)->Start();
+	}
+
+	m_Renderer->SetShadingMode(m_Settings.deferred ? ShadingMode::Deferred : ShadingMode::Forward);
+	m_Time = 0.0f;
+
+	WRITE_LOG("Stress scene: " + util::to_str(m_Meshes.size()) + " meshes, " + util::to_str(m_Characters.size()) + " characters, " +
+		util::to_str(m_Points.size()) + " points, " + util::to_str(m_Spots.size()) + " spots, " + util::to_str(m_Settings.billboards) +
+		" billboards, seed " + util::to_str(m_Settings.seed), "info");
+
+	return GE_OK;
+}
+
+void StressScene::OnSceneExit()
+{
+	for (size_t i = 0; i < m_GameObjects.size(); ++i)
+	{
+		SAFE_CLOSE(m_GameObjects[i]);
+	}
+
+	m_GameObjects.clear();
+	m_Meshes.clear();
+	m_MeshSpin.clear();
+	m_Characters.clear();
+	m_CharacterOrbits.clear();
+	m_Points.clear();
+	m_PointOrbits.clear();
+	m_Spots.clear();
+	m_SpotOrbits.clear();
+
+	SAFE_DELETE(m_Billboards);
+}
+
+Vec3 StressScene::orbitPosition(const Orbit& orbit, float time)
+{
+	const float angle = orbit.phase + orbit.speed * time;
+	return orbit.centre + Vec3(cosf(angle) * orbit.radius, 0.0f, sinf(angle) * orbit.radius);
+}
+
+void StressScene::Update(float dt)
+{
+	m_Time += dt;
+
+	if (m_Settings.motion)
+	{
+		for (size_t i = 0; i < m_Meshes.size(); ++i)
+			m_Meshes[i]->RotateY(m_MeshSpin[i] * dt);
+
+		for (size_t i = 0; i < m_Characters.size(); ++i)
+			m_Characters[i]->SetPosition(orbitPosition(m_CharacterOrbits[i], m_Time));
+
+		for (size_t i = 0; i < m_Points.size(); ++i)
+			m_Points[i]->SetPosition(orbitPosition(m_PointOrbits[i], m_Time));
+
+		for (size_t i = 0; i < m_Spots.size(); ++i)
+			m_Spots[i]->SetPosition(orbitPosition(m_SpotOrbits[i], m_Time));
+	}
+
+	for (auto i = m_GameObjects.begin(); i != m_GameObjects.end(); ++i)
+	{
+		(*i)->Update();
+	}
+}
+
+void StressScene::Render()
+{
+	m_Renderer->Render(m_GameObjects, m_Settings.shadows);
+
+	if (m_Billboards)
+		m_Renderer->RenderBillboardList(m_Billboards);
+}
+
+void StressScene::RenderUI()
+{
+	m_Renderer->RenderText(FONT_CONSOLA, "Meshes: " + util::to_str(m_Meshes.size()) + " :  Characters: " + util::to_str(m_Characters.size()) +
+		" :  Points: " + util::to_str(m_Points.size()) + " :  Spots: " + util::to_str(m_Spots.size()) +
+		" :  Billboards: " + util::to_str(m_Settings.billboards), 8, 96, FontAlign::Left, Colour::Green());
+}
@@ -0,0 +1,80 @@
+#ifndef __STRESS_SCENE_H__
+#define __STRESS_SCENE_H__
+
+#include "IScene.h"
+#include <vector>
+#include <string>
+
+class GameObject;
+class Transform;
+class BillboardList;
+class PointLightC;
+class SpotLightC;
+
+struct StressSceneSettings
+{
+	uint32	meshes;			// Static meshes, cubes, spheres and the male mesh in turn
+	uint32	characters;		// Animated MD2 goblins
+	uint32	points;
+	uint32	spots;
+	uint32	billboards;
+	uint32	seed;			// Same seed, same layout
+	float	extent;			// Half the width of the square everything is scattered over
+	bool	motion;			// Meshes spin, characters run and lights circle every frame
+	bool	shadows;
+	bool	deferred;
+};
+
+StressSceneSettings DefaultStressSettings();
+// Sets the one named, e.g. "meshes" from --stress-meshes 500 or "meshes: 500" in a config file. False if there's no such setting
+bool SetStressSetting(StressSceneSettings& settings, const std::string& key, const std::string& value);
+// One "key: value" per line, a missing file leaves the settings as they were
+bool LoadStressSettings(const std::string& path, StressSceneSettings& settings);
+// Takes every --stress-<key> <value> pair, anything else is left for the caller
+void ParseStressArgs(int argc, char** argv, StressSceneSettings& settings);
+
+/*
+	Builds a scene from counts rather than assets for charting frame time against the number of objects,
+	characters, lights and billboards. Everything is placed from a seeded generator over a flat square, so
+	two runs with the same settings see the same scene, and motion moves it with the fixed step it's given.
+*/
+class StressScene : public IScene
+{
+	// Moves round a circle, for characters and lights
+	struct Orbit
+	{
+		Vec3	centre;
+		float	radius;
+		float	speed;		// Radians a second
+		float	phase;
+	};
+
+public:
+	StressScene(const std::string& name, const StressSceneSettings& settings);
+	virtual ~StressScene();
+
+	int  OnSceneLoad(ResourceManager* resManager) override;
+	void OnSceneExit() override;
+	void Update(float dt) override;
+	void Render() override;
+	void RenderUI() override;
+
+private:
+	static Vec3 orbitPosition(const Orbit& orbit, float time);
+
+private:
+	StressSceneSettings			m_Settings;
+	std::vector<GameObject*>	m_GameObjects;
+	std::vector<Transform*>		m_Meshes;
+	std::vector<float>			m_MeshSpin;
+	std::vector<Transform*>		m_Characters;
+	std::vector<Orbit>			m_CharacterOrbits;
+	std::vector<PointLightC*>	m_Points;
+	std::vector<Orbit>			m_PointOrbits;
+	std::vector<SpotLightC*>	m_Spots;
+	std::vector<Orbit>			m_SpotOrbits;
+	BillboardList*				m_Billboards;
+	float						m_Time;
+};
+
+#endif
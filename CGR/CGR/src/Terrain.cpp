@@ -827,27 +827,27 @@ void  TerrainConstructor::OnReloadShaders()
 
 		// Set Material uniforms
 		int i = 0;
-		m_Shader->SetUniformValue<int>("u_LowHeightMap", &i);
+		m_Shader->SetUniformValue<int>(UNIFORM_ID("u_LowHeightMap"), &i);
 
 		i = 1;
-		m_Shader->SetUniformValue<int>("u_MediumHeightMap", &i);
+		m_Shader->SetUniformValue<int>(UNIFORM_ID("u_MediumHeightMap"), &i);
 
 		i = 2;
-		m_Shader->SetUniformValue<int>("u_HighHeightMap", &i);
+		m_Shader->SetUniformValue<int>(UNIFORM_ID("u_HighHeightMap"), &i);
 
 		i = 3;
-		m_Shader->SetUniformValue<int>("u_PathMap", &i);
+		m_Shader->SetUniformValue<int>(UNIFORM_ID("u_PathMap"), &i);
 
 		i = 4;
-		m_Shader->SetUniformValue<int>("u_PathSampler", &i);
+		m_Shader->SetUniformValue<int>(UNIFORM_ID("u_PathSampler"), &i);
 
 		i = 6;
-		m_Shader->SetUniformValue<int>("u_shadow_sampler", &i);
+		m_Shader->SetUniformValue<int>(UNIFORM_ID("u_shadow_sampler"), &i);
 
 		// This means can only have one mesh
-		m_Shader->SetUniformValue<float>("u_MaxHeight", &m_Height);
-		m_Shader->SetUniformValue<float>("u_MaxTexU", &m_TexU);
-		m_Shader->SetUniformValue<float>("u_MaxTexV", &m_TexV);
+		m_Shader->SetUniformValue<float>(UNIFORM_ID("u_MaxHeight"), &m_Height);
+		m_Shader->SetUniformValue<float>(UNIFORM_ID("u_MaxTexU"), &m_TexU);
+		m_Shader->SetUniformValue<float>(UNIFORM_ID("u_MaxTexV"), &m_TexV);
 	}
 }
 
@@ -0,0 +1,244 @@
+#include "TextBatcher.h"
+
+#include "Font.h"
+#include "OpenGlLayer.h"
+
+#include <cstring>
+
+// Strings are cached per font and position, the text and colour are then compared to see if it's still valid
+static uint64 cacheKey(const Font* font, float x, float y, FontAlign fa)
+{
+	uint32 xBits, yBits;
+	memcpy(&xBits, &x, sizeof(float));
+	memcpy(&yBits, &y, sizeof(float));
+
+	uint64 key = (uint64)(size_t)font;
+	key = key * 1099511628211ULL ^ xBits;
+	key = key * 1099511628211ULL ^ yBits;
+	key = key * 1099511628211ULL ^ (uint64)fa;
+	return key;
+}
+
+// Decodes the UTF-8 sequence at i and moves past it, malformed bytes come out as '?'
+static uint32 nextCodepoint(const std::string& txt, size_t& i)
+{
+	const byte lead = (byte)txt[i++];
+	if (lead < 0x80)
+		return lead;
+
+	int extra;
+	uint32 codepoint;
+	if ((lead & 0xE0) == 0xC0)		{ extra = 1; codepoint = lead & 0x1F; }
+	else if ((lead & 0xF0) == 0xE0)	{ extra = 2; codepoint = lead & 0x0F; }
+	else if ((lead & 0xF8) == 0xF0)	{ extra = 3; codepoint = lead & 0x07; }
+	else							return '?';
+
+	for (int n = 0; n < extra; ++n)
+	{
+		if (i >= txt.size() || ((byte)txt[i] & 0xC0) != 0x80)
+			return '?';
+
+		codepoint = (codepoint << 6) | ((byte)txt[i++] & 0x3F);
+	}
+
+	return codepoint;
+}
+
+TextBatcher::TextBatcher() :
+	m_Cache(),
+	m_Batches(),
+	m_Vertices(),
+	m_Vao(0),
+	m_Vbo(),
+	m_Frame(0),
+	m_Draws(0),
+	m_Glyphs(0)
+{
+}
+
+TextBatcher::~TextBatcher()
+{
+}
+
+bool TextBatcher::Init()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->GenVertexArrays(1, &m_Vao);
+	if (m_Vao == 0 || !m_Vbo.Init(GL_ARRAY_BUFFER))
+		return false;
+
+	// Position and texture co-ordinate in one vec4, the colour as normalized bytes
+	gl->BindVertexArray(m_Vao);
+	gl->BindBuffer(GL_ARRAY_BUFFER, m_Vbo.Handle());
+	gl->EnableVertexAttribArray(0);
+	gl->VertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), 0);
+	gl->EnableVertexAttribArray(1);
+	gl->VertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(TextVertex), (void*)offsetof(TextVertex, colour));
+	gl->BindBuffer(GL_ARRAY_BUFFER, 0);
+	gl->BindVertexArray(0);
+
+	return true;
+}
+
+void TextBatcher::Close()
+{
+	m_Vbo.Close();
+	OpenGLLayer::clean_GL_vao(&m_Vao, 1);
+	m_Cache.clear();
+	m_Batches.clear();
+	m_Vertices.clear();
+}
+
+void TextBatcher::Add(const Font* font, const std::string& txt, float x, float y, FontAlign fa, const Colour& colour)
+{
+	if (!font || txt.empty())
+		return;
+
+	CachedString& entry = m_Cache[cacheKey(font, x, y, fa)];
+
+	// Only lay the string out again if something other than its position changed
+	if (entry.font != font || entry.text != txt || memcmp(&entry.colour, &colour, sizeof(Colour)) != 0)
+	{
+		entry.font = font;
+		entry.text = txt;
+		entry.colour = colour;
+		layout(entry, txt, x, y, fa);
+	}
+
+	entry.lastFrame = m_Frame;
+
+	std::vector<TextVertex>& batch = batchFor(font->Atlas());
+	batch.insert(batch.end(), entry.vertices.begin(), entry.vertices.end());
+}
+
+void TextBatcher::Flush()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	m_Draws = 0;
+	m_Glyphs = 0;
+
+	// Every font's quads go into the one buffer back to back
+	m_Vertices.clear();
+	for (size_t i = 0; i < m_Batches.size(); ++i)
+		m_Vertices.insert(m_Vertices.end(), m_Batches[i].vertices.begin(), m_Batches[i].vertices.end());
+
+	if (!m_Vertices.empty())
+	{
+		m_Vbo.Upload(m_Vertices.data(), m_Vertices.size() * sizeof(TextVertex));
+
+		gl->Enable(GL_BLEND);
+		gl->BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		gl->ActiveTexture(GL_TEXTURE0);
+		gl->BindVertexArray(m_Vao);
+
+		GLint first = 0;
+		for (size_t i = 0; i < m_Batches.size(); ++i)
+		{
+			const GLsizei count = (GLsizei)m_Batches[i].vertices.size();
+			if (count == 0)
+				continue;
+
+			gl->BindTexture(GL_TEXTURE_2D, m_Batches[i].texture);
+			gl->DrawArrays(GL_TRIANGLES, first, count);
+
+			first += count;
+			++m_Draws;
+		}
+
+		gl->BindVertexArray(0);
+		gl->BindTexture(GL_TEXTURE_2D, 0);
+		gl->Disable(GL_BLEND);
+
+		m_Glyphs = (uint32)(m_Vertices.size() / 6);
+	}
+
+	// Batches keep their storage for the next frame
+	for (size_t i = 0; i < m_Batches.size(); ++i)
+		m_Batches[i].vertices.clear();
+
+	++m_Frame;
+	if (m_Frame % TEXT_CACHE_FRAMES == 0)
+		evict();
+}
+
+void TextBatcher::layout(CachedString& entry, const std::string& txt, float x, float y, FontAlign fa) const
+{
+	const float scale = entry.font->Scale();
+
+	entry.vertices.clear();
+	entry.vertices.reserve(txt.size() * 6);
+
+	if (fa != FontAlign::Left)
+	{
+		float width = 0.0f;
+		for (size_t i = 0; i < txt.size();)
+			width += entry.font->GetGlyph(nextCodepoint(txt, i)).advance * scale;
+
+		x -= fa == FontAlign::Centre ? width * 0.5f : width;
+	}
+
+	for (size_t i = 0; i < txt.size();)
+	{
+		const Glyph& g = entry.font->GetGlyph(nextCodepoint(txt, i));
+
+		// Spaces and the like only move the cursor
+		if (g.width > 0.0f && g.height > 0.0f)
+		{
+			const float xpos = x + g.left * scale;
+			const float ypos = y + (g.top - g.height) * scale;
+			const float w = g.width * scale;
+			const float h = g.height * scale;
+
+			const TextVertex quad[6] = {
+				{ xpos,     ypos + h,   g.u0, g.v0, entry.colour },
+				{ xpos,     ypos,       g.u0, g.v1, entry.colour },
+				{ xpos + w, ypos,       g.u1, g.v1, entry.colour },
+
+				{ xpos,     ypos + h,   g.u0, g.v0, entry.colour },
+				{ xpos + w, ypos,       g.u1, g.v1, entry.colour },
+				{ xpos + w, ypos + h,   g.u1, g.v0, entry.colour }
+			};
+
+			entry.vertices.insert(entry.vertices.end(), quad, quad + 6);
+		}
+
+		x += g.advance * scale;
+	}
+}
+
+std::vector<TextVertex>& TextBatcher::batchFor(GLuint texture)
+{
+	// Fonts share the glyph atlas so there's normally only the one batch
+	for (size_t i = 0; i < m_Batches.size(); ++i)
+	{
+		if (m_Batches[i].texture == texture)
+			return m_Batches[i].vertices;
+	}
+
+	Batch batch;
+	batch.texture = texture;
+	m_Batches.push_back(batch);
+	return m_Batches.back().vertices;
+}
+
+void TextBatcher::evict()
+{
+	for (auto it = m_Cache.begin(); it != m_Cache.end();)
+	{
+		if (m_Frame - it->second.lastFrame > TEXT_CACHE_FRAMES)
+			it = m_Cache.erase(it);
+		else
+			++it;
+	}
+
+	// Textures that are no longer drawn lose their batch, the rest are recreated on first use
+	m_Batches.clear();
+}
+
+void TextBatcher::Clear()
+{
+	m_Cache.clear();
+	m_Batches.clear();
+}
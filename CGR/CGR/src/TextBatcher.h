@@ -0,0 +1,94 @@
+#ifndef __TEXT_BATCHER_H__
+#define __TEXT_BATCHER_H__
+
+#include <vector>
+#include <unordered_map>
+#include <string>
+
+#include "gl_headers.h"
+#include "types.h"
+#include "DynamicBuffer.h"
+#include "Colour.h"
+#include "FontAlign.h"
+
+class Font;
+
+// Strings not drawn for this many frames drop out of the cache
+#define TEXT_CACHE_FRAMES	120
+
+struct TextVertex
+{
+	float	x;
+	float	y;
+	float	u;
+	float	v;
+	Colour	colour;
+};
+
+/*
+	Lays UTF-8 strings out into glyph quads and collects them for the whole frame. Flushing uploads every
+	vertex in one go and issues one draw per atlas, with the shared glyph atlas that's one for all text.
+	Strings are cached by where they're drawn, so a line whose text and colour didn't change since the
+	last frame reuses its quads without being laid out again.
+*/
+class TextBatcher
+{
+	struct CachedString
+	{
+		const Font*					font;
+		std::string					text;
+		Colour						colour;
+		std::vector<TextVertex>		vertices;
+		uint32						lastFrame;
+	};
+
+	struct Batch
+	{
+		GLuint						texture;
+		std::vector<TextVertex>		vertices;
+	};
+
+public:
+	TextBatcher();
+	~TextBatcher();
+
+	bool							Init();
+	void							Close();
+
+	void							Add(const Font* font, const std::string& txt, float x, float y, FontAlign fa, const Colour& colour);
+	// Expects the font shader to be in use, draws everything added since the last flush
+	void							Flush();
+	// Drops every cached string, for when the fonts they were laid out with may have gone
+	void							Clear();
+
+	// Stats of the last flush
+	uint32							Draws() const;
+	uint32							Glyphs() const;
+
+private:
+	void							layout(CachedString& entry, const std::string& txt, float x, float y, FontAlign fa) const;
+	std::vector<TextVertex>&		batchFor(GLuint texture);
+	void							evict();
+
+private:
+	std::unordered_map<uint64, CachedString>	m_Cache;
+	std::vector<Batch>				m_Batches;
+	std::vector<TextVertex>			m_Vertices;
+	GLuint							m_Vao;
+	DynamicBuffer					m_Vbo;
+	uint32							m_Frame;
+	uint32							m_Draws;
+	uint32							m_Glyphs;
+};
+
+INLINE uint32 TextBatcher::Draws() const
+{
+	return m_Draws;
+}
+
+INLINE uint32 TextBatcher::Glyphs() const
+{
+	return m_Glyphs;
+}
+
+#endif
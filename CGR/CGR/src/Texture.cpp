@@ -6,14 +6,16 @@
 
 bool Texture::createTex3D(GLuint* texture, Image* images[6])
 {
-	glGenTextures(1, texture);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, *texture);
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->GenTextures(1, texture);
+	gl->BindTexture(GL_TEXTURE_CUBE_MAP, *texture);
 
 	GLenum pixel_formats[] = { 0, GL_RED, GL_RG, GL_BGR, GL_BGRA };
 
 	for (int i = 0; i < 6; ++i)
 	{
-		glTexImage2D(
+		gl->TexImage2D(
 			GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
 			0,
 			GL_RGBA,
@@ -28,13 +30,13 @@ bool Texture::createTex3D(GLuint* texture, Image* images[6])
 		OpenGLLayer::check_GL_error();
 	}
 
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	gl->TexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	gl->TexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	gl->TexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	gl->TexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	gl->TexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	gl->BindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
 	return true;
 }
@@ -43,6 +45,8 @@ bool Texture::create_tex2D(GLuint* textureOut, int active, GLint internalformat,
 	GLsizei width, GLsizei height, GLenum format, GLenum type, const void* data,
 	GLint wrapS, GLint wrapT, GLint minFilter, GLint magFilter, bool mips)
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	// Checks
 	if (magFilter != GL_NEAREST && magFilter != GL_LINEAR)
 	{
@@ -57,18 +61,18 @@ bool Texture::create_tex2D(GLuint* textureOut, int active, GLint internalformat,
 	}
 
 	// Now create Texture
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	gl->PixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-	glGenTextures(1, textureOut);
-	glBindTexture(GL_TEXTURE_2D, *textureOut);
+	gl->GenTextures(1, textureOut);
+	gl->BindTexture(GL_TEXTURE_2D, *textureOut);
 
 	// Set texture options
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+	gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
+	gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
+	gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+	gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
 
-	glTexImage2D(
+	gl->TexImage2D(
 		GL_TEXTURE_2D,
 		0,
 		internalformat,
@@ -82,11 +86,11 @@ bool Texture::create_tex2D(GLuint* textureOut, int active, GLint internalformat,
 
 	if (mips)
 	{
-		glGenerateMipmap(GL_TEXTURE_2D);
+		gl->GenerateMipmap(GL_TEXTURE_2D);
 		OpenGLLayer::check_GL_error();
 	}
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	gl->BindTexture(GL_TEXTURE_2D, 0);
 	return true;
 }
 
@@ -106,13 +110,15 @@ Texture::~Texture()
 
 bool Texture::Create(Image* images[6])
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	if (!createTex3D(&m_TexturePtr, images))
 	{
 		WRITE_LOG("Failed to create gl cubemap", "error");
 		return false;
 	}
 
-	if (!glIsTexture(m_TexturePtr))
+	if (!gl->IsTexture(m_TexturePtr))
 	{
 		WRITE_LOG("fail texture", "warning");
 		return false;
@@ -123,6 +129,8 @@ bool Texture::Create(Image* images[6])
 
 bool Texture::Create(Image* img)
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	// TODO : Need to fix this hack, it's hardcoded for JPEG's to be GL_RGB, and TGA to be GLBGRA
 	GLenum pixel_formats[] = { 0, GL_RED, GL_RG, GL_RGB, GL_BGRA };
 
@@ -143,7 +151,7 @@ bool Texture::Create(Image* img)
 		return false;
 	}
 
-	if (!glIsTexture(m_TexturePtr))
+	if (!gl->IsTexture(m_TexturePtr))
 	{
 		WRITE_LOG("fail texture", "warning");
 		return false;
@@ -154,6 +162,8 @@ bool Texture::Create(Image* img)
 
 void Texture::Bind()
 {
-	glActiveTexture(m_ActiveTexture);
-	glBindTexture(m_Target, m_TexturePtr);
+	RenderDevice* gl = OpenGLLayer::device();
+
+	gl->ActiveTexture(m_ActiveTexture);
+	gl->BindTexture(m_Target, m_TexturePtr);
 }
\ No newline at end of file
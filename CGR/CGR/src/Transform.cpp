@@ -28,6 +28,10 @@ void Transform::Start()
 
 void Transform::Update()
 {
+	// Nothing has moved since the last rebuild
+	if (!dirty)
+		return;
+
 	//model_xform = IDENTITY;
 	//model_xform = glm::translate(model_xform, this->position);
 	//model_xform = (glm::rotate(model_xform, euler.z, Vec3(0, 0, 1)));
@@ -54,14 +58,25 @@ void Transform::Update()
 			glm::yawPitchRoll(euler.y, euler.x, euler.z) *
 			glm::scale(IDENTITY, this->scale);
 	}
+
+	dirty = false;
+	++version;
 }
 
 void Transform::SetPosition(const Vec3& p)
 {
-	position = p;
+	if (p != position)
+	{
+		position = p;
+		dirty = true;
+	}
 }
 
 void Transform::SetScale(const Vec3& p)
 {
-	scale = p;
+	if (p != scale)
+	{
+		scale = p;
+		dirty = true;
+	}
 }
\ No newline at end of file
@@ -33,13 +33,18 @@ public:
 	const Vec3& Euler() const;
 	const Vec3& Scale() const;
 
+	// Bumped every time model_xform is rebuilt, anything derived from it can compare against this
+	uint32 Version() const;
+
 private:
 	static int m_Id;
 	Mat4 model_xform;
 	Vec3 position;
 	Vec3 scale;
 	Vec3 euler;
+	uint32 version = 0;
 	bool use_quats = false;
+	bool dirty = true;
 };
 
 INLINE int Transform::GetId()
@@ -50,6 +55,7 @@ INLINE int Transform::GetId()
 INLINE void Transform::MovePosition(const Vec3& p)
 {
 	this->position += p;
+	dirty = true;
 }
 
 INLINE const Mat4& Transform::GetModelXform() const
@@ -72,34 +78,48 @@ INLINE const Vec3& Transform::Scale() const
 	return scale;
 }
 
+INLINE uint32 Transform::Version() const
+{
+	return version;
+}
+
 INLINE void Transform::UseQuatsForRotation(bool use)
 {
 	this->use_quats = use;
+	dirty = true;
 }
 
 INLINE void Transform::RotateX(float angle)
 {
 	euler.x += angle;
+	dirty = true;
 }
 
 INLINE void Transform::RotateY(float angle)
 {
 	euler.y += angle;
+	dirty = true;
 }
 
 INLINE void Transform::RotateZ(float angle)
 {
 	euler.z += angle;
+	dirty = true;
 }
 
 INLINE void Transform::Rotate(float x, float y, float z)
 {
 	euler = Vec3(x, y, x);
+	dirty = true;
 }
 
 INLINE void Transform::Rotate(const Vec3& a)
 {
-	euler = a;
+	if (a != euler)
+	{
+		euler = a;
+		dirty = true;
+	}
 }
 
 #endif // ! __TRANSFORM_H__
@@ -1,23 +1,45 @@
 #include "Uniform.h"
+#include "OpenGlLayer.h"
 #include <glm/gtc/type_ptr.hpp>
 #include "types.h"
 
 Uniform::Uniform(int location, UniformTypes utype) :
 	m_UType(utype),
 	m_Location(location),
-	m_CurrentValue()
+	m_Value(),
+	m_ValueSize(0),
+	m_Sent(false)
 {
 }
 
+void Uniform::Relink(int location, UniformTypes utype)
+{
+	m_Location = location;
+	m_UType = utype;
+	m_Sent = false;
+}
+
+void Uniform::Resend()
+{
+	// Expects the program to be in use, puts back the last value set before a reload
+	if (m_ValueSize == 0 || m_Location < 0)
+		return;
+
+	SendGPU();
+	m_Sent = true;
+}
+
 void Uniform::SendGPU()
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	switch (m_UType)
 	{
 	case U_FLOAT:
-		glUniform1f(m_Location, *(float*)m_CurrentValue);
+		gl->Uniform1f(m_Location, *(float*)m_Value);
 		break;
 	case U_INT:
-		glUniform1i(m_Location, *(int*)m_CurrentValue);
+		gl->Uniform1i(m_Location, *(int*)m_Value);
 		break;
 	case U_INT2:
 		break;
@@ -34,33 +56,33 @@ void Uniform::SendGPU()
 	case U_BOOL4:
 		break;
 	case U_VEC2:
-		glUniform2fv(m_Location, 1, glm::value_ptr(*(Vec2*)m_CurrentValue));
+		gl->Uniform2fv(m_Location, 1, glm::value_ptr(*(Vec2*)m_Value));
 		break;
 	case U_VEC3:
-		glUniform3fv(m_Location, 1, glm::value_ptr(*(Vec3*)m_CurrentValue));
+		gl->Uniform3fv(m_Location, 1, glm::value_ptr(*(Vec3*)m_Value));
 		break;
 	case U_VEC4:
-		glUniform4fv(m_Location, 1, glm::value_ptr(*(Vec4*)m_CurrentValue));
+		gl->Uniform4fv(m_Location, 1, glm::value_ptr(*(Vec4*)m_Value));
 		break;
 	case U_MAT2:
 		break;
 	case U_MAT3:
 		break;
 	case U_MAT4:
-		glUniformMatrix4fv(m_Location, 1, GL_FALSE, glm::value_ptr(*(Mat4*)m_CurrentValue));
+		gl->UniformMatrix4fv(m_Location, 1, GL_FALSE, glm::value_ptr(*(Mat4*)m_Value));
 		break;
 	case U_SAMPLER:
-		glUniform1i(m_Location, *(int*)m_CurrentValue);
+		gl->Uniform1i(m_Location, *(int*)m_Value);
 		break;
 	case U_CUBE_SAMPLER:
-		glUniform1i(m_Location, *(int*)m_CurrentValue);
+		gl->Uniform1i(m_Location, *(int*)m_Value);
 		break;
 	default:
 		break;
 	}
 }
 
-void* Uniform::GetValue() const
+const void* Uniform::GetValue() const
 {
-	return m_CurrentValue;
+	return m_Value;
 }
\ No newline at end of file
@@ -2,6 +2,25 @@
 #define __UNIFORM_H__
 
 #include "gl_headers.h"
+#include "types.h"
+
+#include <cstring>
+#include <type_traits>
+
+// Largest value a uniform caches, a mat4
+#define UNIFORM_MAX_VALUE_SIZE	64
+
+// Uniforms are looked up by the hash of their name, see UNIFORM_ID
+typedef dword UniformId;
+
+// djb2, the same sums as hash() in Shaders.cpp so a name hashed by the compiler matches one hashed at link time
+constexpr UniformId uniform_hash(const char* str, UniformId h = 5381)
+{
+	return *str ? uniform_hash(str + 1, h * 33 + (UniformId)*str) : h;
+}
+
+// Hashes a literal uniform name at compile time, SetUniformValue<Mat4>(UNIFORM_ID("u_WVP"), &wvp)
+#define UNIFORM_ID(name) (std::integral_constant<UniformId, uniform_hash(name)>::value)
 
 enum UniformTypes
 {
@@ -30,23 +49,38 @@ public:
 	Uniform(int location, UniformTypes uniformType);
 
 	template<typename T> void SetValue(const T* v);
-	void* GetValue() const;
+	const void* GetValue() const;
 
 private:
 	virtual void SendGPU();
 
+	// Points the uniform at its location in a relinked program, which holds none of the old values yet
+	void Relink(int location, UniformTypes uniformType);
+	void Resend();
+
 private:
 	friend class	ShaderProgram;
 	UniformTypes	m_UType;
 	GLint			m_Location;
-	void*			m_CurrentValue;
+	alignas(16) byte	m_Value[UNIFORM_MAX_VALUE_SIZE];
+	size_t			m_ValueSize;
+	bool			m_Sent;
 };
 
 template<typename T>
 void Uniform::SetValue(const T* v)
 {
-	m_CurrentValue = (void*)v;
+	static_assert(sizeof(T) <= UNIFORM_MAX_VALUE_SIZE, "Uniform value too big to cache");
+
+	// The value is copied, callers often pass the address of a temporary. A program keeps its
+	// uniform values, so if it already holds this one there is nothing to send
+	if (m_Sent && m_ValueSize == sizeof(T) && memcmp(m_Value, v, sizeof(T)) == 0)
+		return;
+
+	memcpy(m_Value, v, sizeof(T));
+	m_ValueSize = sizeof(T);
 	SendGPU();
+	m_Sent = true;
 }
 
 
@@ -3,15 +3,28 @@
 #include "OpenGlLayer.h"
 #include "LogFile.h"
 
+#include <algorithm>
+
+// How long a ring upload waits on its copy's fence each try, in nanoseconds
+#define UNIFORM_RING_WAIT_NS	1000000
+
 UniformBlock::UniformBlock() :
 	m_Uniforms(),
+	m_Dirty(),
 	m_Buffer(nullptr),
 	m_BuffSize(0),
 	m_UboIndex(0),
 	m_UBO(0),
 	m_Bound(false),
-	m_ShouldUpdatGPU(false)
+	m_Mode(UniformBlockMode::Dynamic),
+	m_Mapped(nullptr),
+	m_SlotSize(0),
+	m_Slot(0),
+	m_SlotWritten(false),
+	m_BytesUploaded(0)
 {
+	for (int i = 0; i < UNIFORM_RING_FRAMES; ++i)
+		m_Fences[i] = nullptr;
 }
 
 UniformBlock::~UniformBlock()
@@ -20,8 +33,28 @@ UniformBlock::~UniformBlock()
 
 void UniformBlock::Close()
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
+	if (m_Mapped)
+	{
+		gl->BindBuffer(GL_UNIFORM_BUFFER, m_UBO);
+		gl->UnmapBuffer(GL_UNIFORM_BUFFER);
+		gl->BindBuffer(GL_UNIFORM_BUFFER, 0);
+		m_Mapped = nullptr;
+	}
+
+	for (int i = 0; i < UNIFORM_RING_FRAMES; ++i)
+	{
+		if (m_Fences[i])
+		{
+			gl->DeleteSync(m_Fences[i]);
+			m_Fences[i] = nullptr;
+		}
+	}
+
 	SAFE_DELETE_ARRAY(m_Buffer);
 	OpenGLLayer::clean_GL_buffer(&m_UBO, 1);
+	m_Dirty.clear();
 }
 
 bool UniformBlock::IsBound() const
@@ -31,7 +64,18 @@ bool UniformBlock::IsBound() const
 
 bool UniformBlock::ShouldUpdateGPU() const
 {
-	return m_ShouldUpdatGPU;
+	return !m_Dirty.empty();
+}
+
+void UniformBlock::SetMode(UniformBlockMode mode)
+{
+	if (m_Bound)
+	{
+		WRITE_LOG("Uniform block mode can't change once the block is allocated", "warning");
+		return;
+	}
+
+	m_Mode = mode;
 }
 
 std::vector<const char*> UniformBlock::GetUniformNames()
@@ -65,12 +109,14 @@ bool UniformBlock::AddUniform(const std::string& uniformname)
 
 bool UniformBlock::allocBlock(GLuint* shaderProg, const char* name)
 {
+	RenderDevice* gl = OpenGLLayer::device();
+
 	// Double check this, should have been checked by caller though
 	if (m_Bound)
 		return false;
 
 	// Get the index of this block
- 	m_UboIndex = glGetUniformBlockIndex(*shaderProg, name);
+ 	m_UboIndex = gl->GetUniformBlockIndex(*shaderProg, name);
 
 	if (m_UboIndex == GL_INVALID_INDEX)
 	{
@@ -80,7 +126,7 @@ bool UniformBlock::allocBlock(GLuint* shaderProg, const char* name)
 
 	// Find out buff size with index
 	m_BuffSize = -1;
-	glGetActiveUniformBlockiv(*shaderProg, m_UboIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &m_BuffSize);
+	gl->GetActiveUniformBlockiv(*shaderProg, m_UboIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &m_BuffSize);
 
 	if (m_BuffSize <= 0)
 	{
@@ -90,7 +136,7 @@ bool UniformBlock::allocBlock(GLuint* shaderProg, const char* name)
 
 	// How many uniforms in this block
 	int numUniformsInBlock = -1;
-	glGetActiveUniformBlockiv(*shaderProg, m_UboIndex, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &numUniformsInBlock);
+	gl->GetActiveUniformBlockiv(*shaderProg, m_UboIndex, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &numUniformsInBlock);
 
 	// This should have been pre-asigned
 	std::vector<const char*> names = this->GetUniformNames();
@@ -111,16 +157,16 @@ bool UniformBlock::allocBlock(GLuint* shaderProg, const char* name)
 	GLint* types = new GLint[numUniformsInBlock];
 
 	// Get Indices
-	glGetUniformIndices(*shaderProg, numUniformsInBlock, names.data(), indices);
+	gl->GetUniformIndices(*shaderProg, numUniformsInBlock, names.data(), indices);
 
 	// Get Offsets
-	glGetActiveUniformsiv(*shaderProg, numUniformsInBlock, indices, GL_UNIFORM_OFFSET, offsets);
+	gl->GetActiveUniformsiv(*shaderProg, numUniformsInBlock, indices, GL_UNIFORM_OFFSET, offsets);
 
 	// Get Size
-	glGetActiveUniformsiv(*shaderProg, numUniformsInBlock, indices, GL_UNIFORM_SIZE, sizes);
+	gl->GetActiveUniformsiv(*shaderProg, numUniformsInBlock, indices, GL_UNIFORM_SIZE, sizes);
 
 	// Get Types
-	glGetActiveUniformsiv(*shaderProg, numUniformsInBlock, indices, GL_UNIFORM_TYPE, types);
+	gl->GetActiveUniformsiv(*shaderProg, numUniformsInBlock, indices, GL_UNIFORM_TYPE, types);
 
 	// Add block for each uniform, store name, the size of the block, and the offset in the buffer with this block starts
 	for (int i = 0; i < numUniformsInBlock; ++i)
@@ -133,10 +179,19 @@ bool UniformBlock::allocBlock(GLuint* shaderProg, const char* name)
 	memset(m_Buffer, 0, m_BuffSize);
 
 	// Set Data to GPU
-	glGenBuffers(1, &m_UBO);
-	glBindBuffer(GL_UNIFORM_BUFFER, m_UBO);
-	glBufferData(GL_UNIFORM_BUFFER, m_BuffSize, m_Buffer, GL_DYNAMIC_DRAW);
-	glBindBufferBase(GL_UNIFORM_BUFFER, m_UboIndex, m_UBO);
+	if (m_Mode == UniformBlockMode::Ring && !this->allocRing())
+	{
+		WRITE_LOG("Could not map a ring for uniform block " + std::string(name) + ", falling back to dynamic uploads", "warning");
+		m_Mode = UniformBlockMode::Dynamic;
+	}
+
+	if (m_Mode == UniformBlockMode::Dynamic)
+	{
+		gl->GenBuffers(1, &m_UBO);
+		gl->BindBuffer(GL_UNIFORM_BUFFER, m_UBO);
+		gl->BufferData(GL_UNIFORM_BUFFER, m_BuffSize, m_Buffer, GL_DYNAMIC_DRAW);
+		gl->BindBufferBase(GL_UNIFORM_BUFFER, m_UboIndex, m_UBO);
+	}
 
 	// flag this so, we don't allocate the same memory when other shaders reference the same block
 	m_Bound = true;
@@ -150,15 +205,71 @@ bool UniformBlock::allocBlock(GLuint* shaderProg, const char* name)
 	return true;
 }
 
+bool UniformBlock::allocRing()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	// Each copy has to start on the binding alignment
+	GLint alignment = 0;
+	gl->GetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	if (alignment <= 0)
+		alignment = 256;
+
+	m_SlotSize = ((m_BuffSize + alignment - 1) / alignment) * alignment;
+
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLsizeiptr total = (GLsizeiptr)m_SlotSize * UNIFORM_RING_FRAMES;
+
+	gl->GenBuffers(1, &m_UBO);
+	gl->BindBuffer(GL_UNIFORM_BUFFER, m_UBO);
+	gl->BufferStorage(GL_UNIFORM_BUFFER, total, nullptr, flags);
+	m_Mapped = (byte*)gl->MapBufferRange(GL_UNIFORM_BUFFER, 0, total, flags);
+	gl->BindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	if (!m_Mapped)
+	{
+		OpenGLLayer::clean_GL_buffer(&m_UBO, 1);
+		return false;
+	}
+
+	// Start on the last copy so the first upload lands in copy 0
+	m_Slot = UNIFORM_RING_FRAMES - 1;
+	this->uploadRing();
+	return true;
+}
+
 void UniformBlock::SetValue(const std::string& uniformName, void* value)
 {
 	auto block = m_Uniforms.find(uniformName);
 	if (block != m_Uniforms.end())
-	{
-		// Use the block data info that we got from OpenGL to copy into our shared memory block
-		memcpy(m_Buffer + block->second.offset, value, block->second.size);
-		m_ShouldUpdatGPU = true;
-	}
+		this->Write((size_t)block->second.offset, value, (size_t)block->second.size);
+}
+
+void UniformBlock::Write(size_t offset, const void* data, size_t size)
+{
+	if (!m_Buffer || offset + size > (size_t)m_BuffSize)
+		return;
+
+	// Use the block data info that we got from OpenGL to copy into our shared memory block, unchanged bytes aren't sent again
+	byte* dst = m_Buffer + offset;
+	if (memcmp(dst, data, size) == 0)
+		return;
+
+	memcpy(dst, data, size);
+	this->markDirty((GLint)offset, (GLint)(offset + size));
+}
+
+bool UniformBlock::CheckOffset(const std::string& uniformName, size_t offset) const
+{
+	auto block = m_Uniforms.find(uniformName);
+	const GLint found = block != m_Uniforms.end() && m_Bound && block->second.size > 0 ? block->second.offset : -1;
+	if (found >= 0 && (size_t)found == offset)
+		return true;
+
+	std::stringstream ss;
+	ss << "Uniform block member " << uniformName << " is at " << found << " in the shader but the mirror struct expects " << offset;
+	WRITE_LOG(ss.str(), "error");
+	return false;
 }
 
 void UniformBlock::ClearBlock()
@@ -167,6 +278,43 @@ void UniformBlock::ClearBlock()
 	if (m_Bound && m_Buffer)
 	{
 		memset(m_Buffer, 0, m_BuffSize);
+		this->markDirty(0, m_BuffSize);
+	}
+}
+
+void UniformBlock::markDirty(GLint begin, GLint end)
+{
+	// Swallow every span this touches or nearly touches, a grown span can reach ones already passed so start over
+	DirtyRange range = { begin, end };
+	for (size_t i = 0; i < m_Dirty.size();)
+	{
+		const DirtyRange& r = m_Dirty[i];
+		if (range.begin <= r.end + UNIFORM_DIRTY_MERGE_GAP && r.begin <= range.end + UNIFORM_DIRTY_MERGE_GAP)
+		{
+			range.begin = std::min(range.begin, r.begin);
+			range.end = std::max(range.end, r.end);
+			m_Dirty[i] = m_Dirty.back();
+			m_Dirty.pop_back();
+			i = 0;
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	m_Dirty.push_back(range);
+
+	if (m_Dirty.size() > MAX_UNIFORM_DIRTY_RANGES)
+	{
+		for (size_t i = 1; i < m_Dirty.size(); ++i)
+		{
+			range.begin = std::min(range.begin, m_Dirty[i].begin);
+			range.end = std::max(range.end, m_Dirty[i].end);
+		}
+
+		m_Dirty.clear();
+		m_Dirty.push_back(range);
 	}
 }
 
@@ -188,10 +336,74 @@ bool UniformBlock::addBlockData(const std::string& uniformName, GLint size, GLin
 
 void UniformBlock::Bind()
 {
-	glBindBuffer(GL_UNIFORM_BUFFER, m_UBO);
-	glBufferData(GL_UNIFORM_BUFFER, m_BuffSize, m_Buffer, GL_DYNAMIC_DRAW);
-	glBindBufferBase(GL_UNIFORM_BUFFER, m_UboIndex, m_UBO);
+	if (!m_Bound)
+		return;
+
+	if (m_Mode == UniformBlockMode::Ring)
+		this->uploadRing();
+	else
+		this->uploadDirty();
 
 	// We only need to update if something in the block has been changed
-	m_ShouldUpdatGPU = false;
+	m_Dirty.clear();
+}
+
+void UniformBlock::uploadDirty()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	// Overwrite just the changed bytes in place rather than respecifying (and orphaning) the whole store
+	gl->BindBuffer(GL_UNIFORM_BUFFER, m_UBO);
+	for (auto r = m_Dirty.begin(); r != m_Dirty.end(); ++r)
+	{
+		GLint end = std::min(r->end, m_BuffSize);
+		if (end > r->begin)
+		{
+			gl->BufferSubData(GL_UNIFORM_BUFFER, r->begin, end - r->begin, m_Buffer + r->begin);
+			m_BytesUploaded += (size_t)(end - r->begin);
+		}
+	}
+	gl->BindBufferBase(GL_UNIFORM_BUFFER, m_UboIndex, m_UBO);
+}
+
+void UniformBlock::uploadRing()
+{
+	RenderDevice* gl = OpenGLLayer::device();
+
+	// The next copy was last written UNIFORM_RING_FRAMES uploads ago, make sure the GPU is done reading it
+	int slot = (m_Slot + 1) % UNIFORM_RING_FRAMES;
+	if (m_Fences[slot])
+	{
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		for (;;)
+		{
+			GLenum result = gl->ClientWaitSync(m_Fences[slot], flags, UNIFORM_RING_WAIT_NS);
+			if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+				break;
+
+			flags = 0;
+		}
+
+		gl->DeleteSync(m_Fences[slot]);
+		m_Fences[slot] = nullptr;
+	}
+
+	// The copy holds whatever was written three uploads ago, so the whole block goes rather than the dirty spans
+	const GLintptr offset = (GLintptr)slot * m_SlotSize;
+	memcpy(m_Mapped + offset, m_Buffer, m_BuffSize);
+	m_BytesUploaded += (size_t)m_BuffSize;
+
+	gl->BindBufferRange(GL_UNIFORM_BUFFER, m_UboIndex, m_UBO, offset, m_BuffSize);
+	m_Slot = slot;
+	m_SlotWritten = true;
+}
+
+void UniformBlock::EndFrame()
+{
+	if (m_Mode != UniformBlockMode::Ring || !m_SlotWritten)
+		return;
+
+	RenderDevice* gl = OpenGLLayer::device();
+	m_Fences[m_Slot] = gl->FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_SlotWritten = false;
 }
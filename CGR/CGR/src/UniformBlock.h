@@ -7,6 +7,19 @@
 #include <string>
 #include <map>
 
+// Dirty spans closer than this many bytes are sent as one upload
+#define UNIFORM_DIRTY_MERGE_GAP		64
+// Past this many separate spans the block is sent as a single span covering them all
+#define MAX_UNIFORM_DIRTY_RANGES	8
+// Copies of a ring block, the CPU writes one while the GPU may still be reading the others
+#define UNIFORM_RING_FRAMES			3
+
+enum class UniformBlockMode
+{
+	Dynamic,	// One buffer, only the bytes changed since the last upload are sent
+	Ring		// Persistently mapped, each upload writes the whole block to the next free copy
+};
+
 class UniformBlock
 {
 	struct BlockData
@@ -15,6 +28,12 @@ class UniformBlock
 		GLint offset;
 	};
 
+	struct DirtyRange
+	{
+		GLint begin;
+		GLint end;
+	};
+
 public:
 	UniformBlock();
 	~UniformBlock();
@@ -25,23 +44,74 @@ public:
 	bool ShouldUpdateGPU() const;
 	bool AddUniform(const std::string& uniformname);
 	void SetValue(const std::string& uniformName, void* value);
+
+	// Copies bytes laid out as the block's std140 mirror (see BlockLayouts.h) straight into the block
+	void Write(size_t offset, const void* data, size_t size);
+	template<typename T> void Write(const T& data);
+
+	// True if the member sits where a mirror struct expects it, logs the mismatch otherwise
+	bool CheckOffset(const std::string& uniformName, size_t offset) const;
+
 	void Bind();
 	void ClearBlock();
 
+	// Only takes effect if set before the block is allocated by the first shader using it
+	void SetMode(UniformBlockMode mode);
+	UniformBlockMode Mode() const;
+
+	// Fences the ring copy written this frame so it isn't overwritten while the GPU reads it
+	void EndFrame();
+
+	// Bytes sent since the counter was last reset
+	size_t BytesUploaded() const;
+	void ResetBytesUploaded();
+
 private:
 	bool allocBlock(GLuint* shaderProg, const char* name);
+	bool allocRing();
 	bool addBlockData(const std::string& uniformName, GLint size, GLint offset);
+	void markDirty(GLint begin, GLint end);
+	void uploadDirty();
+	void uploadRing();
 
 private:
 	friend class						ShaderProgram;
 	std::map<std::string, BlockData>	m_Uniforms;
+	std::vector<DirtyRange>				m_Dirty;
 	byte*								m_Buffer;
 	GLint								m_BuffSize;
 	GLuint								m_UboIndex;
 	GLuint								m_UBO;
 	bool								m_Bound;
-	bool								m_ShouldUpdatGPU;
+
+	UniformBlockMode					m_Mode;
+	byte*								m_Mapped;
+	GLint								m_SlotSize;
+	int									m_Slot;
+	bool								m_SlotWritten;
+	GLsync								m_Fences[UNIFORM_RING_FRAMES];
+	size_t								m_BytesUploaded;
 };
 
+template<typename T>
+INLINE void UniformBlock::Write(const T& data)
+{
+	Write(0, &data, sizeof(T));
+}
+
+INLINE UniformBlockMode UniformBlock::Mode() const
+{
+	return m_Mode;
+}
+
+INLINE size_t UniformBlock::BytesUploaded() const
+{
+	return m_BytesUploaded;
+}
+
+INLINE void UniformBlock::ResetBytesUploaded()
+{
+	m_BytesUploaded = 0;
+}
 
 #endif // ! __UNIFORM_BLOCK_H__
@@ -17,7 +17,7 @@ void UniformBlockManager::Close()
 	m_Blocks.clear();
 }
 
-bool UniformBlockManager::CreateBlock(const std::string& blockName, const std::vector<std::string>& uniformNames)
+bool UniformBlockManager::CreateBlock(const std::string& blockName, const std::vector<std::string>& uniformNames, UniformBlockMode mode)
 {
 	// First see if this block exists
 	auto result = m_Blocks.find(blockName);
@@ -28,6 +28,7 @@ bool UniformBlockManager::CreateBlock(const std::string& blockName, const std::v
 	}
 
 	m_Blocks[blockName] = new UniformBlock();
+	m_Blocks[blockName]->SetMode(mode);
 
 	for (auto i = uniformNames.begin(); i != uniformNames.end(); ++i)
 	{
@@ -42,6 +43,29 @@ bool UniformBlockManager::CreateBlock(const std::string& blockName, const std::v
 	return true;
 }
 
+void UniformBlockManager::Upload()
+{
+	m_FrameBytes = 0;
+
+	// Only blocks that changed are touched, this works for every shader referencing the block
+	for (auto i = m_Blocks.begin(); i != m_Blocks.end(); ++i)
+	{
+		UniformBlock* block = i->second;
+		block->ResetBytesUploaded();
+
+		if (block->ShouldUpdateGPU())
+			block->Bind();
+
+		m_FrameBytes += block->BytesUploaded();
+	}
+}
+
+void UniformBlockManager::EndFrame()
+{
+	for (auto i = m_Blocks.begin(); i != m_Blocks.end(); ++i)
+		i->second->EndFrame();
+}
+
 UniformBlock* UniformBlockManager::GetBlock(const std::string& blockname)
 {
 	auto result = m_Blocks.find(blockname);
@@ -2,11 +2,10 @@
 #define __UNIFORM_BLOCK_MANAGER_H__
 
 #include "Singleton.h"
+#include "UniformBlock.h"
 #include <map>
 #include <vector>
 
-class UniformBlock;
-
 class UniformBlockManager : public Singleton<UniformBlockManager>
 {
 public:
@@ -14,13 +13,26 @@ public:
 	UniformBlock* GetBlock(const std::string& blockname);
 	bool CheckBlockUniformExists(const char* name);
 
+	// Bytes sent to uniform buffers by the last Upload
+	size_t FrameBytesUploaded() const;
+
 private:
-	bool CreateBlock(const std::string& blockName, const std::vector<std::string>& uniformNames);
+	bool CreateBlock(const std::string& blockName, const std::vector<std::string>& uniformNames, UniformBlockMode mode = UniformBlockMode::Dynamic);
 	void Close();
 
+	// Sends what changed in each block, then fences the ring blocks once the frame is submitted
+	void Upload();
+	void EndFrame();
+
 private:
 	friend class							Renderer;
 	std::map<std::string, UniformBlock*>	m_Blocks;
+	size_t									m_FrameBytes{ 0 };
 };
 
+INLINE size_t UniformBlockManager::FrameBytesUploaded() const
+{
+	return m_FrameBytes;
+}
+
 #endif
\ No newline at end of file
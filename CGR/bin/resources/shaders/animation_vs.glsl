@@ -20,10 +20,14 @@ out vec3 P;
 out vec2 varying_texcoord;
 out vec3 varying_tangent;
 out vec4 varying_light_position;
+flat out int varying_use_bumpmap;
+flat out int varying_use_shadow;
 
 uniform mat4 	u_world_xform;
 uniform mat4 	u_light_xform;
 uniform float 	u_lerp;
+uniform int		u_use_bumpmap;
+uniform int		u_use_shadow;
 
 void main()
 {
@@ -47,4 +51,6 @@ void main()
 	
 	varying_light_position = u_light_xform * vec4(vertex_position, 1.0);
 	varying_tangent = vec3(0,1,0);
+	varying_use_bumpmap = u_use_bumpmap;
+	varying_use_shadow = u_use_shadow;
 }
\ No newline at end of file
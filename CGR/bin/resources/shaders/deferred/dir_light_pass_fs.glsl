@@ -1,8 +1,5 @@
 #version 450
 
-#define MAX_SPOTS 10
-#define MAX_POINTS 10
-
 struct DirectionLight
 {
 	vec3 direction;
@@ -11,19 +8,21 @@ struct DirectionLight
 
 struct Spotlight
 {
-    vec3    position;      
-	vec3    direction;     
-	vec3    intensity;      
-    float   coneAngle;       
-    float   aConstant;      
-    float   aLinear;        
-    float   aQuadratic;
+    vec3    position;
+    float   range;          //!< Cut off past this, the clusters it is binned into stop here too.
+	vec3    direction;
+    float   coneAngle;
+	vec3    intensity;
 	int 	switched_on;
+    float   aConstant;      //!< The constant co-efficient for the attenuation formula.
+    float   aLinear;        //!< The linear co-efficient for the attenuation formula.
+    float   aQuadratic;     //!< The quadratic co-efficient for the attenuation formula.
 };
 
 struct PointLight
 {
     vec3    position;
+    float   range;
     vec3    intensity;
 	float   ambient_intensity;
     float   aConstant;
@@ -34,10 +33,29 @@ struct PointLight
 layout(binding = 0, std140) uniform Lights
 {
 	DirectionLight directionLight;
-	PointLight pointLights[MAX_POINTS];
-	Spotlight spotLights[MAX_SPOTS];
-	int numSpots;
-	int numPoints;
+};
+
+layout(binding = 2, std430) readonly buffer PointLights
+{
+	PointLight pointLights[];
+};
+
+layout(binding = 3, std430) readonly buffer SpotLights
+{
+	Spotlight spotLights[];
+};
+
+// Lights binned per view space cluster on the CPU, each cluster lists its points then its spots
+layout(binding = 4, std430) readonly buffer LightClusters
+{
+	uvec4 clusterGrid;		// Cells in x, y and z
+	vec4 clusterParams;		// Slice is log(depth) * x + y, z and w are the screen size
+	uvec4 clusters[];		// Offset into the index list, number of points, number of spots
+};
+
+layout(binding = 5, std430) readonly buffer LightIndices
+{
+	uint lightIndices[];
 };
 
 layout (binding = 1, std140) uniform scene
@@ -64,6 +82,47 @@ vec4 getDirectionalLightColour(in vec3 n)
 	return vec4(directionLight.intensity * fMult, 1.0);
 }
 
+vec4 getSpotLightColor(const Spotlight spotLight, vec3 p)
+{
+	// If flashlight isn't turned on, return no color
+	if(spotLight.switched_on == 0)
+		return vec4(0.0);
+	
+	// Distance from fragment's position
+	float dist = distance(p, spotLight.position);
+  
+	// Get direction vector to fragment
+	vec3 light_dir = p - spotLight.position;
+	light_dir = normalize(light_dir);
+  
+	// Cosine between spotlight direction and directional vector to fragment
+	float angle = dot(spotLight.direction, light_dir);
+  
+	// Difference between max cosine and current cosine
+	float diff = 1.0 - spotLight.coneAngle;
+  
+	// This is how strong light is depending whether its nearer to the center of
+	// cone or nearer to its borders (onway factor in article), clamp to 0.0 and 1.0
+	float factor = clamp((angle - spotLight.coneAngle) / diff, 0.0, 1.0);
+    
+	// If we're inside cone and range, calculate color
+	if(angle > spotLight.coneAngle && dist < spotLight.range)
+	{
+		return (vec4(spotLight.intensity, 1.0) * factor) / (dist * spotLight.aLinear);
+	}
+  
+	// No color otherwise
+	return vec4(0.0, 0.0, 0.0, 0.0);
+}
+
+uvec4 getCluster(vec3 p)
+{
+	float depth = max(-(view_xform * vec4(p, 1.0)).z, 0.0001);
+	uvec2 cell = uvec2(clamp(gl_FragCoord.xy / clusterParams.zw, 0.0, 0.999999) * vec2(clusterGrid.xy));
+	uint slice = uint(clamp(log(depth) * clusterParams.x + clusterParams.y, 0.0, float(clusterGrid.z - 1)));
+	return clusters[(slice * clusterGrid.y + cell.y) * clusterGrid.x + cell.x];
+}
+
 vec2 CalcTexCoord()
 {
     return gl_FragCoord.xy / u_ScreenSize;
@@ -77,6 +136,15 @@ void main()
 	vec3 normal = texture(u_NormalMap, texcoord).xyz;
 	normal = normalize(normal);
 	
-	frag_colour = vec4(ambient_light, colour.a) + getDirectionalLightColour(normal) * colour;
+	// Point lights are drawn as volumes, the spots come from this pixel's cluster
+	vec4 total_light = getDirectionalLightColour(normal);
+	uvec4 cluster = getCluster(worldPos);
+	
+	for(uint i = 0; i < cluster.z; ++i)
+	{
+		total_light += getSpotLightColor(spotLights[lightIndices[cluster.x + cluster.y + i]], worldPos);
+	}
+	
+	frag_colour = vec4(ambient_light, colour.a) + total_light * colour;
 	//frag_colour = vec4(normal, 1.0);
 }
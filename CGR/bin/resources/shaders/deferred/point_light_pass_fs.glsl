@@ -1,29 +1,9 @@
 #version 450
 
-#define MAX_SPOTS 10
-#define MAX_POINTS 10
-
-struct DirectionLight
-{
-	vec3 direction;
-	vec3 intensity;
-};
-
-struct Spotlight
-{
-    vec3    position;      
-	vec3    direction;     
-	vec3    intensity;      
-    float   coneAngle;       
-    float   aConstant;      //!< The constant co-efficient for the attenuation formula.
-    float   aLinear;        //!< The linear co-efficient for the attenuation formula.
-    float   aQuadratic;     //!< The quadratic co-efficient for the attenuation formula.
-	int 	switched_on;
-};
-
 struct PointLight
 {
     vec3    position;
+    float   range;
     vec3    intensity;
 	float   ambient_intensity;
     float   aConstant;
@@ -31,14 +11,9 @@ struct PointLight
     float   aQuadratic;
 };
 
-layout(binding = 0, std140) uniform Lights
-{
-	DirectionLight directionLight;
-	PointLight pointLights[MAX_POINTS];
-	Spotlight spotLights[MAX_SPOTS];
-	int numSpots;
-	int numPoints;
-};
+flat in vec4 vs_position_range;
+flat in vec4 vs_intensity_ambient;
+flat in vec4 vs_attenuation;
 
 layout (binding = 1, std140) uniform scene
 { 
@@ -55,7 +30,6 @@ uniform sampler2D u_PositionMap;
 uniform sampler2D u_ColourMap;
 uniform sampler2D u_NormalMap;
 uniform vec2 u_ScreenSize;
-uniform int u_LightIndex;
 
 vec4 reflection(vec3 light_intensity, float light_ambient_intensity, vec3 light_dir, vec3 p, vec3 n)
 {
@@ -91,10 +65,7 @@ vec4 getPointLightColor(const PointLight ptLight, vec3 p, vec3 n)
 { 
    vec3 light_dir = p - ptLight.position; 
    float dist = length(light_dir); 
-   // TODO : have this for each light source in struct
-   const float light_range = 129.0f;	
-   
-   if(dist < light_range)
+   if(dist < ptLight.range)
    {
 	   light_dir = normalize(light_dir); 
 	   vec4 colour = reflection(ptLight.intensity, ptLight.ambient_intensity, light_dir, p, n);
@@ -119,5 +90,14 @@ void main()
 	vec3 normal = texture(u_NormalMap, texcoord).xyz;
 	normal = normalize(normal);
 
-	frag_colour = getPointLightColor(pointLights[u_LightIndex], worldPos, normal) * colour;
+	PointLight ptLight;
+	ptLight.position = vs_position_range.xyz;
+	ptLight.range = vs_position_range.w;
+	ptLight.intensity = vs_intensity_ambient.xyz;
+	ptLight.ambient_intensity = vs_intensity_ambient.w;
+	ptLight.aConstant = vs_attenuation.x;
+	ptLight.aLinear = vs_attenuation.y;
+	ptLight.aQuadratic = vs_attenuation.z;
+
+	frag_colour = getPointLightColor(ptLight, worldPos, normal) * colour;
 }
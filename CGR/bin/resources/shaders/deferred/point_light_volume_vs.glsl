@@ -0,0 +1,31 @@
+#version 450
+
+layout (location = 0) in vec3 vertex_position;
+
+// Per instance, the light's PointLightData as three vec4s
+layout (location = 4) in vec4 light_position_range;
+layout (location = 5) in vec4 light_intensity_ambient;
+layout (location = 6) in vec4 light_attenuation;
+
+layout (binding = 1, std140) uniform scene
+{ 
+	mat4 proj_xform;
+	mat4 view_xform;
+	vec3 camera_position;
+	vec3 ambient_light;
+	float delta_time;
+};
+
+flat out vec4 vs_position_range;
+flat out vec4 vs_intensity_ambient;
+flat out vec4 vs_attenuation;
+
+void main()
+{
+	vs_position_range = light_position_range;
+	vs_intensity_ambient = light_intensity_ambient;
+	vs_attenuation = light_attenuation;
+
+	vec3 world_pos = light_position_range.xyz + vertex_position * light_position_range.w;
+	gl_Position = proj_xform * view_xform * vec4(world_pos, 1.0);
+}
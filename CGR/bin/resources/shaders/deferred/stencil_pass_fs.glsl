@@ -1,5 +0,0 @@
-#version 450
-
-void main()
-{
-}
\ No newline at end of file
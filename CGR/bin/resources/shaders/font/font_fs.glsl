@@ -3,12 +3,15 @@
 layout(location = 0) out vec4 frag_colour;
 
 in vec2 varying_texcoords;
+in vec4 varying_colour;
 
 uniform sampler2D text;
-uniform vec4 text_colour;
 
 void main()
 {
-	vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, varying_texcoords).r);
-	frag_colour = text_colour * sampled;
+	// Glyphs are distance fields, 0.5 is the edge. Smoothing over a screen pixel keeps every size sharp
+	float dist = texture(text, varying_texcoords).r;
+	float width = fwidth(dist);
+	float alpha = smoothstep(0.5 - width, 0.5 + width, dist);
+	frag_colour = vec4(varying_colour.rgb, varying_colour.a * alpha);
 }
\ No newline at end of file
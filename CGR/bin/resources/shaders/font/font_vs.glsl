@@ -1,11 +1,14 @@
 #version 330 core
 
 layout (location = 0) in vec4 vertex_position;
+layout (location = 1) in vec4 vertex_colour;
 out vec2 varying_texcoords;
+out vec4 varying_colour;
 uniform mat4 u_proj_xform;
 
 void main()
 {
 	gl_Position = u_proj_xform * vec4(vertex_position.xy, 0.0, 1.0);
 	varying_texcoords = vertex_position.zw;
+	varying_colour = vertex_colour;
 }
\ No newline at end of file
@@ -0,0 +1,42 @@
+#version 450
+
+layout (binding = 1, std140) uniform scene
+{ 
+	mat4 proj_xform;
+	mat4 view_xform;
+	vec3 camera_position;
+	vec3 ambient_light;
+	float delta_time;
+};
+
+layout (location = 0)   in  vec3    vertex_position;       	//!< The local position of the current vertex.
+layout (location = 1)   in  vec3    vertex_normal;         	//!< The local normal vector of the current vertex.
+layout (location = 2)   in  vec2    vertex_texcoord;       	//!< The texture co-ordinates for the vertex, used for mapping a texture to the object.
+layout (location = 3) 	in 	vec3	vertex_tangent;
+layout (location = 4) 	in 	mat4	instance_world_xform;	//!< Per instance, takes locations 4 to 7.
+
+out vec3     N;
+out vec3     P;
+out vec2     varying_texcoord;   //!< The texture co-ordinate for the fragment to use for texture mapping.
+out vec3	 varying_tangent;
+out vec4 	 varying_light_position;
+flat out int varying_use_bumpmap;
+flat out int varying_use_shadow;
+
+uniform mat4 u_light_proj_view_xform;
+uniform int  u_use_bumpmap;
+uniform int  u_use_shadow;
+
+void main()
+{
+	gl_Position = proj_xform * view_xform * instance_world_xform * vec4(vertex_position, 1.0);
+	varying_texcoord = vertex_texcoord;
+	varying_tangent = (instance_world_xform * vec4(vertex_tangent, 0.0)).xyz;
+	varying_light_position = u_light_proj_view_xform * instance_world_xform * vec4(vertex_position, 1.0);
+	
+	varying_use_bumpmap = u_use_bumpmap;
+	varying_use_shadow = u_use_shadow;
+
+	N =  vec3( instance_world_xform * vec4(vertex_normal,   0.0));
+	P =  vec3( instance_world_xform * vec4(vertex_position, 1.0));
+}
\ No newline at end of file
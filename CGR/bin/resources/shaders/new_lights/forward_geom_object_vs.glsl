@@ -0,0 +1,52 @@
+#version 450
+
+layout (binding = 1, std140) uniform scene
+{
+	mat4 proj_xform;
+	mat4 view_xform;
+	vec3 camera_position;
+	vec3 ambient_light;
+	float delta_time;
+};
+
+// Same layout as ObjectData in ObjectDataBuffer.h
+struct ObjectData
+{
+	mat4	world_xform;
+	mat4	light_xform;		//!< Light proj * view * world, only valid when the object receives shadows.
+	ivec4	flags;				//!< x: use bump map, y: use shadow.
+};
+
+layout (binding = 6, std430) readonly buffer objectData
+{
+	ObjectData objects[];
+};
+
+layout (location = 0)   in  vec3    vertex_position;       	//!< The local position of the current vertex.
+layout (location = 1)   in  vec3    vertex_normal;         	//!< The local normal vector of the current vertex.
+layout (location = 2)   in  vec2    vertex_texcoord;       	//!< The texture co-ordinates for the vertex, used for mapping a texture to the object.
+layout (location = 3) 	in 	vec3	vertex_tangent;
+layout (location = 8) 	in 	uint	object_id;				//!< Per instance, the draw's base instance picks the object.
+
+out vec3     N;
+out vec3     P;
+out vec2     varying_texcoord;   //!< The texture co-ordinate for the fragment to use for texture mapping.
+out vec3	 varying_tangent;
+out vec4 	 varying_light_position;
+flat out int varying_use_bumpmap;
+flat out int varying_use_shadow;
+
+void main()
+{
+	ObjectData object = objects[object_id];
+
+	gl_Position = proj_xform * view_xform * object.world_xform * vec4(vertex_position, 1.0);
+	varying_texcoord = vertex_texcoord;
+	varying_tangent = (object.world_xform * vec4(vertex_tangent, 0.0)).xyz;
+	varying_light_position = object.light_xform * vec4(vertex_position, 1.0);
+	varying_use_bumpmap = object.flags.x;
+	varying_use_shadow = object.flags.y;
+
+	N =  vec3( object.world_xform * vec4(vertex_normal,   0.0));
+	P =  vec3( object.world_xform * vec4(vertex_position, 1.0));
+}
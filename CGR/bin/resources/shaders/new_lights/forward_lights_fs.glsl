@@ -1,8 +1,5 @@
 #version 450
 
-#define MAX_SPOTS 10
-#define MAX_POINTS 10
-
 struct DirectionLight
 {
 	vec3 direction;
@@ -11,19 +8,21 @@ struct DirectionLight
 
 struct Spotlight
 {
-    vec3    position;      
-	vec3    direction;     
-	vec3    intensity;      
-    float   coneAngle;       
+    vec3    position;
+    float   range;          //!< Cut off past this, the clusters it is binned into stop here too.
+	vec3    direction;
+    float   coneAngle;
+	vec3    intensity;
+	int 	switched_on;
     float   aConstant;      //!< The constant co-efficient for the attenuation formula.
     float   aLinear;        //!< The linear co-efficient for the attenuation formula.
     float   aQuadratic;     //!< The quadratic co-efficient for the attenuation formula.
-	int 	switched_on;
 };
 
 struct PointLight
 {
     vec3    position;
+    float   range;
     vec3    intensity;
 	float   ambient_intensity;
     float   aConstant;
@@ -31,14 +30,32 @@ struct PointLight
     float   aQuadratic;
 };
 
-
 layout(binding = 0, std140) uniform Lights
 {
 	DirectionLight directionLight;
-	PointLight pointLights[MAX_POINTS];
-	Spotlight spotLights[MAX_SPOTS];
-	int numSpots;
-	int numPoints;
+};
+
+layout(binding = 2, std430) readonly buffer PointLights
+{
+	PointLight pointLights[];
+};
+
+layout(binding = 3, std430) readonly buffer SpotLights
+{
+	Spotlight spotLights[];
+};
+
+// Lights binned per view space cluster on the CPU, each cluster lists its points then its spots
+layout(binding = 4, std430) readonly buffer LightClusters
+{
+	uvec4 clusterGrid;		// Cells in x, y and z
+	vec4 clusterParams;		// Slice is log(depth) * x + y, z and w are the screen size
+	uvec4 clusters[];		// Offset into the index list, number of points, number of spots
+};
+
+layout(binding = 5, std430) readonly buffer LightIndices
+{
+	uint lightIndices[];
 };
 
 layout (binding = 1, std140) uniform scene
@@ -53,14 +70,14 @@ layout (binding = 1, std140) uniform scene
 uniform sampler2D 	u_sampler;
 uniform sampler2D	u_shadow_sampler;
 uniform sampler2D 	u_normal_sampler;
-uniform int			u_use_bumpmap;
-uniform int			u_use_shadow;
 
 in  vec3    N;
 in  vec3 	P;
 in  vec2    varying_texcoord;  
 in 	vec3 	varying_tangent;
 in  vec4 	varying_light_position;
+flat in int	varying_use_bumpmap;
+flat in int	varying_use_shadow;
 
 out vec4    frag_colour; 		//!< The calculated colour of the fragment.
 
@@ -73,22 +90,26 @@ vec4 getPointLightColor(const PointLight ptLight, vec3 p, vec3 n);
 vec4 getSpotLightColor(const Spotlight spotLight, vec3 p);
 vec4 getSpecularColor(vec3 p, vec3 camPos, vec3 n, vec3 direction, vec3 light_colour);
 float getShadow(vec4 lightSpacePos);
+uvec4 getCluster(vec3 p);
 
 void main()
 {
-	vec3 n = (u_use_bumpmap == 1) ? calcBumpedNormal() : normalize(N);
+	vec3 n = (varying_use_bumpmap == 1) ? calcBumpedNormal() : normalize(N);
 	vec4 tex_colour = texture(u_sampler, varying_texcoord);
 	
 	vec4 total_light =  getDirectionalLightColour(n);
 	
-	for(int i = 0; i < numSpots; ++i)
+	// Only the lights binned into this fragment's cluster can reach it
+	uvec4 cluster = getCluster(P);
+	
+	for(uint i = 0; i < cluster.y; ++i)
 	{
-		total_light += getSpotLightColor(spotLights[i], P);
+		total_light += getPointLightColor(pointLights[lightIndices[cluster.x + i]], P, n);
 	}
-						
-	for(int i = 0; i < numPoints; ++i)
+	
+	for(uint i = 0; i < cluster.z; ++i)
 	{
-		total_light += getPointLightColor(pointLights[i], P, n);
+		total_light += getSpotLightColor(spotLights[lightIndices[cluster.x + cluster.y + i]], P);
 	}
 						
 	frag_colour = vec4(ambient_light, tex_colour.a) + total_light * tex_colour;
@@ -145,7 +166,7 @@ vec4 getDirectionalLightColour(in vec3 n)
 {
 	float diffuse_intensity = max(0.0, dot(n, -directionLight.direction));
 	float fMult = clamp(0.1 + diffuse_intensity, 0.0, 1.0);
-	float shadowFactor = u_use_shadow == 1 ? calcShadowFactor(varying_light_position) : 1.0;
+	float shadowFactor = varying_use_shadow == 1 ? calcShadowFactor(varying_light_position) : 1.0;
 	return vec4(directionLight.intensity * fMult, 1.0) + getSpecularColor(P, camera_position, n, directionLight.direction, directionLight.intensity) * shadowFactor;
 }
 
@@ -153,13 +174,10 @@ vec4 getPointLightColor(const PointLight ptLight, vec3 p, vec3 n)
 { 
    vec3 light_dir = p - ptLight.position; 
    float dist = length(light_dir); 
-   // TODO : have this for each light source in struct
-   const float light_range = 129.0f;	
-   
-   if(dist < light_range)
+   if(dist < ptLight.range)
    {
 		light_dir = normalize(light_dir); 
-		//float shadowFactor = u_use_shadow == 1 ? calcShadowFactor(varying_light_position) : 1.0;
+		//float shadowFactor = varying_use_shadow == 1 ? calcShadowFactor(varying_light_position) : 1.0;
 		vec4 colour = reflection(ptLight.intensity, ptLight.ambient_intensity, light_dir, p, n);
 		float attenuation = max(1.0, ptLight.aConstant + ptLight.aLinear * dist + ptLight.aQuadratic * dist*dist); 
 		return (colour ) / attenuation;
@@ -191,8 +209,8 @@ vec4 getSpotLightColor(const Spotlight spotLight, vec3 p)
 	// cone or nearer to its borders (onway factor in article), clamp to 0.0 and 1.0
 	float factor = clamp((angle - spotLight.coneAngle) / diff, 0.0, 1.0);
     
-	// If we're inside cone, calculate color
-	if(angle > spotLight.coneAngle)
+	// If we're inside cone and range, calculate color
+	if(angle > spotLight.coneAngle && dist < spotLight.range)
 	{
 		return (vec4(spotLight.intensity, 1.0) * factor) / (dist * spotLight.aLinear);
 	}
@@ -201,6 +219,14 @@ vec4 getSpotLightColor(const Spotlight spotLight, vec3 p)
 	return vec4(0.0, 0.0, 0.0, 0.0);
 }
 
+uvec4 getCluster(vec3 p)
+{
+	float depth = max(-(view_xform * vec4(p, 1.0)).z, 0.0001);
+	uvec2 cell = uvec2(clamp(gl_FragCoord.xy / clusterParams.zw, 0.0, 0.999999) * vec2(clusterGrid.xy));
+	uint slice = uint(clamp(log(depth) * clusterParams.x + clusterParams.y, 0.0, float(clusterGrid.z - 1)));
+	return clusters[(slice * clusterGrid.y + cell.y) * clusterGrid.x + cell.x];
+}
+
 float calcShadowFactor(vec4 lightSpacePos)
 {	
 	vec3 projCoords = lightSpacePos.xyz / lightSpacePos.w;
@@ -0,0 +1,16 @@
+#version 450
+
+layout(location=0) in vec3 vertex_position;
+layout(location=1) in vec3 vertex_normal;
+layout(location=2) in vec2 vertex_texcoord;
+layout(location=4) in mat4 instance_world_xform;
+
+uniform mat4 u_light_proj_view_xform;
+
+out vec2 varying_texcoord;
+
+void main()
+{
+	gl_Position = u_light_proj_view_xform * instance_world_xform * vec4(vertex_position, 1.0);
+	varying_texcoord = vertex_texcoord;
+}
\ No newline at end of file